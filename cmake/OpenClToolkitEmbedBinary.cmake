@@ -0,0 +1,17 @@
+# Script mode helper: cmake -DINPUT=<file> -DOUTPUT=<header> -DSYMBOL=<name> -P OpenClToolkitEmbedBinary.cmake
+# Writes the content of INPUT as a constexpr byte array named SYMBOL into the C++ header OUTPUT.
+
+file(READ ${INPUT} content HEX)
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${content}")
+string(TOUPPER ${SYMBOL} guard)
+
+file(WRITE ${OUTPUT}
+        "// generated from ${INPUT}, do not edit\n"
+        "#ifndef OPENCL_TOOLKIT_EMBEDDED_${guard}_H\n"
+        "#define OPENCL_TOOLKIT_EMBEDDED_${guard}_H\n\n"
+        "#include <cstddef>\n\n"
+        "namespace OpenClToolkit::Embedded {\n"
+        "\tinline constexpr unsigned char ${SYMBOL}[] = {${bytes}};\n"
+        "\tinline constexpr std::size_t ${SYMBOL}Size = sizeof(${SYMBOL});\n"
+        "}\n\n"
+        "#endif //OPENCL_TOOLKIT_EMBEDDED_${guard}_H\n")
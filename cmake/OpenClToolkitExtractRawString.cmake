@@ -0,0 +1,16 @@
+# Script mode helper:
+# cmake -DINPUT=<header> -DOUTPUT=<file.cl> -DDELIMITER=<delimiter> -P OpenClToolkitExtractRawString.cmake
+# Writes the content of the first raw string literal R"<delimiter>(...)<delimiter>" of INPUT into OUTPUT, so kernels
+# embedded as source code in a C++ header can be compiled by an OpenCL C compiler too.
+
+file(READ ${INPUT} content)
+string(FIND "${content}" "R\"${DELIMITER}(" begin)
+string(FIND "${content}" ")${DELIMITER}\"" end)
+if (begin EQUAL -1 OR end EQUAL -1 OR end LESS begin)
+    message(FATAL_ERROR "No raw string literal with the delimiter ${DELIMITER} found in ${INPUT}")
+endif ()
+string(LENGTH "R\"${DELIMITER}(" prefixLength)
+math(EXPR begin "${begin} + ${prefixLength}")
+math(EXPR length "${end} - ${begin}")
+string(SUBSTRING "${content}" ${begin} ${length} source)
+file(WRITE ${OUTPUT} "${source}")
@@ -0,0 +1,95 @@
+# Helpers to compile OpenCL C kernels into SPIR-V at build time and to embed the resulting modules as byte arrays,
+# so they can be passed to the intermediate language constructor of OpenClToolkit::Program.
+# The helpers depend on clang (OpenCL C front end) and llvm-spirv (LLVM IR to SPIR-V translator). If one of them is
+# missing, no module is produced and OPENCL_TOOLKIT_HAS_EMBEDDED_SPIRV is defined as 0 for the passed target, so the
+# client code can fall back to the kernel source code.
+
+find_program(OPENCL_TOOLKIT_CLANG NAMES clang clang-18 clang-17 clang-16 clang-15 clang-14 clang-13)
+find_program(OPENCL_TOOLKIT_LLVM_SPIRV NAMES llvm-spirv llvm-spirv-18 llvm-spirv-17 llvm-spirv-16 llvm-spirv-15
+        llvm-spirv-14 llvm-spirv-13)
+
+set(OPENCL_TOOLKIT_EMBED_BINARY_SCRIPT ${CMAKE_CURRENT_LIST_DIR}/OpenClToolkitEmbedBinary.cmake)
+set(OPENCL_TOOLKIT_EXTRACT_RAW_STRING_SCRIPT ${CMAKE_CURRENT_LIST_DIR}/OpenClToolkitExtractRawString.cmake)
+
+if (OPENCL_TOOLKIT_CLANG AND OPENCL_TOOLKIT_LLVM_SPIRV)
+    set(OPENCL_TOOLKIT_SPIRV_AVAILABLE ON)
+else ()
+    set(OPENCL_TOOLKIT_SPIRV_AVAILABLE OFF)
+    message(STATUS "clang and/or llvm-spirv not found: OpenCL kernels will not be embedded as SPIR-V")
+endif ()
+
+# _opencl_toolkit_add_spirv_module(<target> <name> <source> <opencl std> <defines>...)
+#
+# Adds the commands which compile the passed OpenCL C file into the SPIR-V module <name>.spv and embed it as the byte
+# array OpenClToolkit::Embedded::<name>Spirv into the header <name>_spirv.h. The header is added to the sources of the
+# passed target.
+function(_opencl_toolkit_add_spirv_module TARGET NAME SOURCE OPENCL_STD)
+    set(outputDirectory ${CMAKE_CURRENT_BINARY_DIR}/${TARGET}_spirv)
+    set(bitcode ${outputDirectory}/${NAME}.bc)
+    set(module ${outputDirectory}/${NAME}.spv)
+    set(header ${outputDirectory}/${NAME}_spirv.h)
+
+    add_custom_command(
+            OUTPUT ${module}
+            BYPRODUCTS ${bitcode}
+            COMMAND ${OPENCL_TOOLKIT_CLANG} -c -x cl -cl-std=${OPENCL_STD} -target spir64 -O2 -emit-llvm ${ARGN}
+            -o ${bitcode} ${SOURCE}
+            COMMAND ${OPENCL_TOOLKIT_LLVM_SPIRV} ${bitcode} -o ${module}
+            DEPENDS ${SOURCE}
+            COMMENT "Compiling ${NAME} to SPIR-V"
+            VERBATIM)
+
+    add_custom_command(
+            OUTPUT ${header}
+            COMMAND ${CMAKE_COMMAND} -DINPUT=${module} -DOUTPUT=${header} -DSYMBOL=${NAME}Spirv
+            -P ${OPENCL_TOOLKIT_EMBED_BINARY_SCRIPT}
+            DEPENDS ${module} ${OPENCL_TOOLKIT_EMBED_BINARY_SCRIPT}
+            COMMENT "Embedding ${NAME}.spv"
+            VERBATIM)
+
+    target_sources(${TARGET} PRIVATE ${header})
+endfunction()
+
+# opencl_toolkit_embed_spirv_header_kernel(<target> NAME <name> HEADER <file.h> [DELIMITER <delimiter>]
+#                                          [DEFINES <macro=value>...] [OPENCL_STD <CL1.2|CL2.0|CL3.0>])
+#
+# Compiles the kernel source code which a C++ header holds as the raw string literal R"<delimiter>(...)<delimiter>"
+# (default delimiter CLC), specialized by the passed preprocessor definitions, into a SPIR-V module. The generated
+# header is placed into a directory which is added to the private include directories of the passed target. So the
+# source code embedded for the fallback and the SPIR-V module never diverge. Call it once per specialization with
+# distinct names; the header <name>_spirv.h defines OpenClToolkit::Embedded::<name>Spirv.
+function(opencl_toolkit_embed_spirv_header_kernel TARGET)
+    cmake_parse_arguments(ARG "" "NAME;HEADER;DELIMITER;OPENCL_STD" "DEFINES" ${ARGN})
+    if (NOT ARG_DELIMITER)
+        set(ARG_DELIMITER CLC)
+    endif ()
+    if (NOT ARG_OPENCL_STD)
+        set(ARG_OPENCL_STD CL2.0)
+    endif ()
+
+    if (NOT OPENCL_TOOLKIT_SPIRV_AVAILABLE)
+        target_compile_definitions(${TARGET} PRIVATE OPENCL_TOOLKIT_HAS_EMBEDDED_SPIRV=0)
+        return()
+    endif ()
+
+    set(outputDirectory ${CMAKE_CURRENT_BINARY_DIR}/${TARGET}_spirv)
+    file(MAKE_DIRECTORY ${outputDirectory})
+    get_filename_component(headerPath ${ARG_HEADER} ABSOLUTE)
+    set(source ${outputDirectory}/${ARG_NAME}.cl)
+    add_custom_command(
+            OUTPUT ${source}
+            COMMAND ${CMAKE_COMMAND} -DINPUT=${headerPath} -DOUTPUT=${source} -DDELIMITER=${ARG_DELIMITER}
+            -P ${OPENCL_TOOLKIT_EXTRACT_RAW_STRING_SCRIPT}
+            DEPENDS ${headerPath} ${OPENCL_TOOLKIT_EXTRACT_RAW_STRING_SCRIPT}
+            COMMENT "Extracting the kernel source code of ${ARG_NAME}"
+            VERBATIM)
+
+    set(defines)
+    foreach (define IN LISTS ARG_DEFINES)
+        list(APPEND defines -D${define})
+    endforeach ()
+    _opencl_toolkit_add_spirv_module(${TARGET} ${ARG_NAME} ${source} ${ARG_OPENCL_STD} ${defines})
+
+    target_include_directories(${TARGET} PRIVATE ${outputDirectory})
+    target_compile_definitions(${TARGET} PRIVATE OPENCL_TOOLKIT_HAS_EMBEDDED_SPIRV=1)
+endfunction()
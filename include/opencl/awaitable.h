@@ -0,0 +1,83 @@
+#ifndef OPENCL_TOOLKIT_AWAITABLE_H
+#define OPENCL_TOOLKIT_AWAITABLE_H
+
+#include <coroutine>
+
+#include "portable_opencl_include.h"
+#include "event.h"
+#include "executor.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Suspends a coroutine until a device command has completed, without blocking a thread, e.g.
+	 * <code>co_await EventAwaitable(queue.enqueueCommandExecuteProgramOnDeviceAsync(...), pool)</code>.
+	 * @details The coroutine is handed to the executor from the completion callback of the event. The callback runs
+	 * on a thread of the OpenCL runtime, where blocking OpenCL calls are undefined behavior, so the executor is
+	 * explicit; a <code>ThreadPoolExecutor</code> suits any coroutine. If the command has already completed, the
+	 * coroutine is not suspended at all. Resuming throws if the command failed.
+	 */
+	class EventAwaitable {
+		private:
+			/**
+			 * The event of the awaited command.
+			 */
+			Event event_;
+
+			/**
+			 * The executor which resumes the coroutine.
+			 */
+			Executor &executor_;
+
+			/**
+			 * The suspended coroutine.
+			 */
+			std::coroutine_handle<> coroutine_;
+
+			/**
+			 * The execution status passed to the completion callback.
+			 */
+			cl_int executionStatus_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor.
+			 * @param event the event of the awaited command.
+			 * @param executor the executor which resumes the coroutine and outlives the suspension. An
+			 *                 <code>InlineExecutor</code> is only valid if the coroutine does not block until its next
+			 *                 suspension.
+			 */
+			[[maybe_unused]] EventAwaitable(Event &&event, Executor &executor);
+
+			/**
+			 * @brief Returns whether the command has already completed, so no suspension is required.
+			 * @return true if the command has completed.
+			 */
+			[[nodiscard]] bool await_ready();
+
+			/**
+			 * @brief Submits the command and registers the completion callback which resumes the passed coroutine.
+			 * @param coroutine the suspending coroutine.
+			 */
+			void await_suspend(std::coroutine_handle<> coroutine);
+
+			/**
+			 * @brief Throws if the command failed.
+			 */
+			void await_resume() const;
+
+		private:
+			/**
+			 * @brief The completion callback of the event.
+			 * @param event the event.
+			 * @param executionStatus <code>CL_COMPLETE</code> or a negative error code.
+			 * @param userData the awaitable.
+			 */
+			static void CL_CALLBACK onComplete(cl_event event, cl_int executionStatus, void *userData);
+	};
+}
+
+#endif //OPENCL_TOOLKIT_AWAITABLE_H
@@ -21,13 +21,43 @@ namespace OpenClToolkit {
 			 */
 			cl_mem self_;
 
+			/**
+			 * The context of the buffer.
+			 */
+			cl_context context_;
+
+			/**
+			 * The size of the buffer in bytes.
+			 */
+			size_t size_;
+
+			/**
+			 * True if the buffer is charged to the budget of the memory manager, i.e. it is not backed by host memory.
+			 */
+			bool isAccounted_;
+
 		protected:
 			BaseBuffer(const Context& context, size_t size, cl_mem_flags flags);
 
+			/**
+			 * @brief Creates a buffer backed by the passed host memory, e.g. with <code>CL_MEM_USE_HOST_PTR</code>.
+			 * @param context a valid OpenCL-context.
+			 * @param size the size of the buffer in bytes.
+			 * @param flags the flags of the buffer.
+			 * @param hostMemory the host memory passed to <code>clCreateBuffer</code>.
+			 */
+			BaseBuffer(const Context& context, size_t size, cl_mem_flags flags, void *hostMemory);
+
 		public:
 			virtual ~BaseBuffer();
 			operator cl_mem() const; // NOLINT(google-explicit-constructor)
 
+			/**
+			 * @brief Returns the size of the buffer in bytes.
+			 * @return the size of the buffer in bytes.
+			 */
+			[[maybe_unused]] [[nodiscard]] size_t getSizeInBytes() const;
+
 		private:
 			static std::string getFailureDescription(cl_int errorCode);
 	};
@@ -0,0 +1,209 @@
+#ifndef OPENCL_TOOLKIT_BROKER_CLIENT_H
+#define OPENCL_TOOLKIT_BROKER_CLIENT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "portable_opencl_include.h"
+#include "broker_protocol.h"
+#include "nd_range.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief A batch of copy and launch commands executed by the broker in order, see <code>BrokerClient</code>.
+	 */
+	class BrokerBatch {
+		private:
+			/**
+			 * The commands.
+			 */
+			std::vector<BrokerProtocol::Command> commands_;
+
+		public:
+			/**
+			 * @brief Appends a copy from the shared memory into a buffer.
+			 * @param bufferId the buffer id.
+			 * @param bufferOffsetInBytes the offset into the buffer.
+			 * @param sharedMemoryOffsetInBytes the offset into the shared memory.
+			 * @param numBytes the number of bytes.
+			 */
+			[[maybe_unused]] void write(
+					uint64_t bufferId,
+					uint64_t bufferOffsetInBytes,
+					uint64_t sharedMemoryOffsetInBytes,
+					uint64_t numBytes
+			);
+
+			/**
+			 * @brief Appends a copy from a buffer into the shared memory.
+			 * @param bufferId the buffer id.
+			 * @param bufferOffsetInBytes the offset into the buffer.
+			 * @param sharedMemoryOffsetInBytes the offset into the shared memory.
+			 * @param numBytes the number of bytes.
+			 */
+			[[maybe_unused]] void read(
+					uint64_t bufferId,
+					uint64_t bufferOffsetInBytes,
+					uint64_t sharedMemoryOffsetInBytes,
+					uint64_t numBytes
+			);
+
+			/**
+			 * @brief Appends setting a buffer as a kernel argument.
+			 * @param programId the program id.
+			 * @param argIndex the argument index.
+			 * @param bufferId the buffer id.
+			 */
+			[[maybe_unused]] void setBufferArg(uint64_t programId, cl_uint argIndex, uint64_t bufferId);
+
+			/**
+			 * @brief Appends setting bytes of the shared memory as a kernel argument by value. The bytes are read when
+			 * the broker executes the batch.
+			 * @param programId the program id.
+			 * @param argIndex the argument index.
+			 * @param sharedMemoryOffsetInBytes the offset of the value in the shared memory.
+			 * @param numBytes the size of the value.
+			 */
+			[[maybe_unused]] void setValueArg(
+					uint64_t programId,
+					cl_uint argIndex,
+					uint64_t sharedMemoryOffsetInBytes,
+					uint64_t numBytes
+			);
+
+			/**
+			 * @brief Appends a kernel launch.
+			 * @param programId the program id.
+			 * @param globalWorkSize the number of threads per dimension.
+			 * @param localWorkSize the number of threads per work group and dimension.
+			 */
+			[[maybe_unused]] void launch(uint64_t programId, const NDRange &globalWorkSize, const NDRange &localWorkSize);
+
+			/**
+			 * @brief Returns the commands.
+			 * @return the commands.
+			 */
+			[[maybe_unused]] [[nodiscard]] const std::vector<BrokerProtocol::Command> &getCommands() const;
+
+			/**
+			 * @brief Removes all commands.
+			 */
+			[[maybe_unused]] void clear();
+	};
+
+	/**
+	 * @brief A connection of a process to the local broker, see <code>BrokerServer</code>.
+	 * @details The client creates a shared memory region which both processes map, so bulk data is copied only once
+	 * between the process and the device. All methods block until the broker has replied and throw the errors
+	 * reported by it. An instance must not be used by several threads at the same time.
+	 * Only available on POSIX systems.
+	 */
+	class BrokerClient {
+		private:
+			/**
+			 * The connected socket.
+			 */
+			int socket_;
+
+			/**
+			 * The shared memory.
+			 */
+			unsigned char *sharedMemory_;
+
+			/**
+			 * The size of the shared memory in bytes.
+			 */
+			size_t sharedMemorySizeInBytes_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Connects to the broker and opens a session.
+			 * @param socketPath the path of the Unix domain socket of the broker.
+			 * @param sharedMemorySizeInBytes the size of the shared memory, which bounds the bytes of a batch.
+			 * @param deviceIndex the index of the device among the devices of the broker.
+			 */
+			[[maybe_unused]] BrokerClient(
+					const std::string &socketPath,
+					size_t sharedMemorySizeInBytes,
+					cl_uint deviceIndex = 0
+			);
+
+			/**
+			 * @brief Deleted copy constructor.
+			 */
+			BrokerClient(BrokerClient const &) = delete;
+
+			/**
+			 * @brief Deleted copy assignment.
+			 */
+			void operator=(BrokerClient const &) = delete;
+
+			/**
+			 * @brief The destructor. Closes the session; the broker releases its buffers and kernels.
+			 */
+			~BrokerClient();
+
+			/**
+			 * @brief Returns the shared memory, which holds the data of write, read and value commands.
+			 * @return the shared memory.
+			 */
+			[[maybe_unused]] [[nodiscard]] void *getSharedMemory() const;
+
+			/**
+			 * @brief Returns the size of the shared memory in bytes.
+			 * @return the size of the shared memory in bytes.
+			 */
+			[[maybe_unused]] [[nodiscard]] size_t getSharedMemorySizeInBytes() const;
+
+			/**
+			 * @brief Registers a kernel. The broker builds the program only if no client registered it before.
+			 * @param sourceCode the OpenCL C source.
+			 * @param kernelName the name of the kernel.
+			 * @param buildOptions the build options.
+			 * @return the program id.
+			 */
+			[[maybe_unused]] uint64_t registerProgram(
+					const std::string &sourceCode,
+					const std::string &kernelName,
+					const std::string &buildOptions = ""
+			);
+
+			/**
+			 * @brief Allocates a device buffer.
+			 * @param sizeInBytes the size in bytes.
+			 * @return the buffer id.
+			 */
+			[[maybe_unused]] uint64_t allocateBuffer(size_t sizeInBytes);
+
+			/**
+			 * @brief Frees a device buffer.
+			 * @param bufferId the buffer id.
+			 */
+			[[maybe_unused]] void freeBuffer(uint64_t bufferId);
+
+			/**
+			 * @brief Executes a batch. Returns once all commands have completed, so the results of read commands are
+			 * in the shared memory.
+			 * @param batch the batch.
+			 */
+			[[maybe_unused]] void submit(const BrokerBatch &batch);
+
+		private:
+			/**
+			 * @brief Sends a request and receives its reply.
+			 * @param type the request type.
+			 * @param payload the payload.
+			 * @param numBytes the size of the payload.
+			 * @param fileDescriptor the file descriptor to be attached, -1 for none.
+			 * @return the value of the reply.
+			 */
+			uint64_t request(BrokerProtocol::RequestType type, const void *payload, size_t numBytes, int fileDescriptor = -1);
+	};
+}
+
+#endif //OPENCL_TOOLKIT_BROKER_CLIENT_H
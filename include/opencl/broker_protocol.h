@@ -0,0 +1,204 @@
+#ifndef OPENCL_TOOLKIT_BROKER_PROTOCOL_H
+#define OPENCL_TOOLKIT_BROKER_PROTOCOL_H
+
+#include <cstdint>
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief The messages exchanged between broker clients and the broker over a Unix domain socket.
+	 * @details Every request starts with a <code>RequestHeader</code> followed by its payload and is answered by a
+	 * <code>Reply</code> followed by an error message of <code>Reply::messageLength</code> bytes. A client sends its
+	 * next request only after the reply of the previous one. Bulk data is not sent over the socket but exchanged
+	 * through a shared memory region which the client passes with its <code>Hello</code> request. Both sides run on the
+	 * same host, so the structs are sent in native layout.
+	 */
+	namespace BrokerProtocol {
+
+		/**
+		 * The first bytes of every request.
+		 */
+		inline constexpr uint32_t magic = 0x424C434F;
+
+		/**
+		 * The version of the protocol, sent by <code>Hello</code>.
+		 */
+		inline constexpr uint32_t version = 2;
+
+		/**
+		 * The largest accepted payload of a request in bytes.
+		 */
+		inline constexpr uint64_t maxPayloadSizeInBytes = 64 << 20;
+
+		/**
+		 * @brief The types of requests.
+		 */
+		enum class RequestType : uint32_t {
+			/**
+			 * Opens the session: a <code>HelloPayload</code> with the file descriptor of the shared memory attached.
+			 * Where file sealing is available, i.e. on Linux, the shared memory must be sealed with
+			 * <code>F_SEAL_SHRINK</code>.
+			 */
+			Hello = 1,
+
+			/**
+			 * Registers a kernel: a <code>RegisterProgramPayload</code> followed by the source, the kernel name and
+			 * the build options. The reply value is the program id.
+			 */
+			RegisterProgram = 2,
+
+			/**
+			 * Allocates a device buffer: a <code>BufferPayload</code> with the size. The reply value is the buffer id.
+			 */
+			AllocateBuffer = 3,
+
+			/**
+			 * Frees a device buffer: a <code>BufferPayload</code> with the buffer id.
+			 */
+			FreeBuffer = 4,
+
+			/**
+			 * Executes a batch: an array of <code>Command</code>s, answered after all of them have completed.
+			 */
+			SubmitBatch = 5
+		};
+
+		/**
+		 * @brief The types of commands of a batch.
+		 */
+		enum class CommandType : uint32_t {
+			/**
+			 * Copies bytes from the shared memory into a buffer.
+			 */
+			Write = 1,
+
+			/**
+			 * Copies bytes from a buffer into the shared memory.
+			 */
+			Read = 2,
+
+			/**
+			 * Sets a buffer as a kernel argument.
+			 */
+			SetBufferArg = 3,
+
+			/**
+			 * Sets bytes of the shared memory as a kernel argument by value.
+			 */
+			SetValueArg = 4,
+
+			/**
+			 * Launches a kernel.
+			 */
+			Launch = 5
+		};
+
+		/**
+		 * @brief The header of every request.
+		 */
+		struct RequestHeader {
+			uint32_t magic;
+			RequestType type;
+			uint64_t payloadSizeInBytes;
+		};
+
+		/**
+		 * @brief The payload of <code>Hello</code>.
+		 */
+		struct HelloPayload {
+			uint32_t version;
+			uint32_t deviceIndex;
+			uint64_t sharedMemorySizeInBytes;
+		};
+
+		/**
+		 * @brief The fixed part of the payload of <code>RegisterProgram</code>.
+		 */
+		struct RegisterProgramPayload {
+			uint64_t sourceCodeLength;
+			uint64_t kernelNameLength;
+			uint64_t buildOptionsLength;
+		};
+
+		/**
+		 * @brief The payload of <code>AllocateBuffer</code> and <code>FreeBuffer</code>.
+		 */
+		struct BufferPayload {
+			uint64_t value;
+		};
+
+		/**
+		 * @brief A command of a batch. Unused fields are 0.
+		 */
+		struct Command {
+			CommandType type;
+
+			/**
+			 * The kernel argument index of <code>SetBufferArg</code> and <code>SetValueArg</code>, the number of
+			 * dimensions of <code>Launch</code>.
+			 */
+			uint32_t index;
+
+			/**
+			 * The program id of the kernel commands.
+			 */
+			uint64_t programId;
+
+			/**
+			 * The buffer id of <code>Write</code>, <code>Read</code> and <code>SetBufferArg</code>.
+			 */
+			uint64_t bufferId;
+
+			/**
+			 * The offset into the buffer of <code>Write</code> and <code>Read</code>.
+			 */
+			uint64_t bufferOffsetInBytes;
+
+			/**
+			 * The offset into the shared memory of <code>Write</code>, <code>Read</code> and
+			 * <code>SetValueArg</code>.
+			 */
+			uint64_t sharedMemoryOffsetInBytes;
+
+			/**
+			 * The number of bytes of <code>Write</code>, <code>Read</code> and <code>SetValueArg</code>.
+			 */
+			uint64_t numBytes;
+
+			/**
+			 * The global work size per dimension of <code>Launch</code>.
+			 */
+			uint64_t globalWorkSize[3];
+
+			/**
+			 * The local work size per dimension of <code>Launch</code>.
+			 */
+			uint64_t localWorkSize[3];
+		};
+
+		/**
+		 * @brief The reply to every request.
+		 */
+		struct Reply {
+			/**
+			 * 0 on success.
+			 */
+			int32_t status;
+
+			/**
+			 * The length of the error message following the reply.
+			 */
+			uint32_t messageLength;
+
+			/**
+			 * The id created by the request, if any.
+			 */
+			uint64_t value;
+		};
+	}
+}
+
+#endif //OPENCL_TOOLKIT_BROKER_PROTOCOL_H
@@ -0,0 +1,325 @@
+#ifndef OPENCL_TOOLKIT_BROKER_SERVER_H
+#define OPENCL_TOOLKIT_BROKER_SERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "portable_opencl_include.h"
+#include "broker_protocol.h"
+#include "command_queue.h"
+#include "context.h"
+#include "program.h"
+#include "read_write_buffer.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief A local broker which owns the contexts, command queues and program cache of the devices of a host and
+	 * executes batched copy-and-launch jobs of several client processes, see <code>BrokerClient</code>.
+	 * @details Clients connect over a Unix domain socket and exchange bulk data through shared memory. Kernels are
+	 * built once per device through the program registry, whichever client registers them, and buffers live in the
+	 * single context of their device. Each device has a worker thread which executes the submitted batches and builds
+	 * the registered kernels one at a time, so the dispatcher never blocks on a device. Since a client sends its next
+	 * request only after the previous one has been answered, the workers serve the sessions round-robin, so a client
+	 * with many batches cannot starve the others. The dispatcher reads requests without blocking and buffers
+	 * incomplete ones per session, so a slow client cannot stall the others. Where file sealing is available, the
+	 * shared memory of a client is only mapped if it is sealed against shrinking, so the client cannot make the broker
+	 * crash by truncating it.
+	 * Only available on POSIX systems.
+	 */
+	class BrokerServer {
+		private:
+			struct Session;
+
+			/**
+			 * @brief A device with its context, command queue and worker.
+			 */
+			struct Device {
+				/**
+				 * The device.
+				 */
+				cl_device_id id;
+
+				/**
+				 * The context of the device.
+				 */
+				std::unique_ptr<Context> context;
+
+				/**
+				 * The command queue of the device.
+				 */
+				std::unique_ptr<CommandQueue> commandQueue;
+
+				/**
+				 * The sessions waiting for the execution of their request, in order of submission.
+				 */
+				std::deque<Session *> readySessions;
+
+				/**
+				 * The worker executing the batches and kernel builds.
+				 */
+				std::thread worker;
+			};
+
+			/**
+			 * @brief The state of a connected client.
+			 */
+			struct Session {
+				/**
+				 * The connected socket.
+				 */
+				int socket = -1;
+
+				/**
+				 * The shared memory, nullptr before <code>Hello</code>.
+				 */
+				unsigned char *sharedMemory = nullptr;
+
+				/**
+				 * The size of the shared memory in bytes.
+				 */
+				size_t sharedMemorySizeInBytes = 0;
+
+				/**
+				 * The device of the session.
+				 */
+				Device *device = nullptr;
+
+				/**
+				 * The kernels per program id. Each session has its own kernels, since kernel arguments are state.
+				 */
+				std::map<uint64_t, std::unique_ptr<Program>> programs;
+
+				/**
+				 * The buffers per buffer id.
+				 */
+				std::map<uint64_t, std::unique_ptr<ReadWriteBuffer>> buffers;
+
+				/**
+				 * The next program or buffer id.
+				 */
+				uint64_t nextId = 1;
+
+				/**
+				 * The bytes received of the incomplete request, starting with its header.
+				 */
+				std::vector<unsigned char> receivedBytes;
+
+				/**
+				 * The file descriptor attached to the incomplete request, -1 if none.
+				 */
+				int receivedFileDescriptor = -1;
+
+				/**
+				 * The type of the request handed to the worker of the device, i.e. <code>SubmitBatch</code> or
+				 * <code>RegisterProgram</code>.
+				 */
+				BrokerProtocol::RequestType pendingType = BrokerProtocol::RequestType::SubmitBatch;
+
+				/**
+				 * The payload of the request handed to the worker of the device.
+				 */
+				std::vector<unsigned char> pendingPayload;
+
+				/**
+				 * True while the request waits for or is executed by the worker of the device.
+				 */
+				std::atomic<bool> isBusy = false;
+			};
+
+			/**
+			 * The path of the listening socket.
+			 */
+			std::string socketPath_;
+
+			/**
+			 * The listening socket.
+			 */
+			int listeningSocket_;
+
+			/**
+			 * The pipe which wakes up the dispatcher, written by <code>stop</code> and by finished requests.
+			 */
+			int wakeUpPipe_[2];
+
+			/**
+			 * The devices.
+			 */
+			std::vector<std::unique_ptr<Device>> devices_;
+
+			/**
+			 * The connected sessions.
+			 */
+			std::list<std::unique_ptr<Session>> sessions_;
+
+			/**
+			 * Guards the ready sessions of all devices.
+			 */
+			std::mutex mutex_;
+
+			/**
+			 * Signals ready sessions and the stop to the workers.
+			 */
+			std::condition_variable sessionReady_;
+
+			/**
+			 * True once the broker stops.
+			 */
+			std::atomic<bool> isStopping_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Creates a context and a command queue per device, starts the
+			 * workers and listens on the passed socket path. A socket file at the path is only replaced if nobody
+			 * listens on it anymore.
+			 * @param socketPath the path of the Unix domain socket.
+			 * @param devices the devices offered to the clients, addressed by their index.
+			 * @param socketMode the access permissions of the socket file, by default for the owner only.
+			 */
+			[[maybe_unused]] BrokerServer(
+					const std::string &socketPath,
+					const std::vector<cl_device_id> &devices,
+					mode_t socketMode = 0600
+			);
+
+			/**
+			 * @brief Deleted copy constructor.
+			 */
+			BrokerServer(BrokerServer const &) = delete;
+
+			/**
+			 * @brief Deleted copy assignment.
+			 */
+			void operator=(BrokerServer const &) = delete;
+
+			/**
+			 * @brief The destructor. Stops the workers, closes all sessions and removes the socket file.
+			 */
+			~BrokerServer();
+
+			/**
+			 * @brief Accepts clients and dispatches their requests until <code>stop</code> is called.
+			 */
+			[[maybe_unused]] void run();
+
+			/**
+			 * @brief Makes <code>run</code> return. May be called from any thread or a signal handler.
+			 */
+			[[maybe_unused]] void stop();
+
+		private:
+			/**
+			 * @brief Receives the available bytes of a session without blocking and handles its request once complete.
+			 * @param session the session whose socket is readable.
+			 * @return false if the session is to be closed.
+			 */
+			bool receiveRequest(Session &session);
+
+			/**
+			 * @brief Answers a complete request of a session, or hands a batch or a kernel build to the worker of its
+			 * device.
+			 * @param session the session.
+			 * @param header the header of the request.
+			 * @param payload the payload of the request.
+			 * @param fileDescriptor the attached file descriptor, -1 if none. It is closed.
+			 */
+			void handleRequest(
+					Session &session,
+					const BrokerProtocol::RequestHeader &header,
+					std::vector<unsigned char> payload,
+					int fileDescriptor
+			);
+
+			/**
+			 * @brief Opens a session.
+			 * @param session the session.
+			 * @param payload the payload of the request.
+			 * @param sharedMemoryFileDescriptor the attached file descriptor of the shared memory, -1 if none.
+			 * @return the id to reply, 0.
+			 */
+			uint64_t hello(Session &session, const std::vector<unsigned char> &payload, int sharedMemoryFileDescriptor);
+
+			/**
+			 * @brief Registers a kernel of a session, building its program unless the registry already holds it. Called
+			 * by the worker of the device of the session.
+			 * @param session the session.
+			 * @param payload the payload of the request.
+			 * @return the program id.
+			 */
+			uint64_t registerProgram(Session &session, const std::vector<unsigned char> &payload);
+
+			/**
+			 * @brief Executes the batches and kernel builds of the sessions of a device until the stop.
+			 * @param device the device.
+			 */
+			void work(Device &device);
+
+			/**
+			 * @brief Executes the batch of a session.
+			 * @param session the session.
+			 * @param payload the commands of the batch.
+			 */
+			static void executeBatch(Session &session, const std::vector<unsigned char> &payload);
+
+			/**
+			 * @brief Returns a range of the shared memory of a session after checking its bounds.
+			 * @param session the session.
+			 * @param offsetInBytes the offset of the range.
+			 * @param numBytes the size of the range.
+			 * @return the first byte of the range.
+			 */
+			static unsigned char *getSharedMemory(const Session &session, uint64_t offsetInBytes, uint64_t numBytes);
+
+			/**
+			 * @brief Returns a kernel of a session.
+			 * @param session the session.
+			 * @param programId the program id.
+			 * @return the kernel.
+			 */
+			static Program &getProgram(const Session &session, uint64_t programId);
+
+			/**
+			 * @brief Returns a buffer of a session.
+			 * @param session the session.
+			 * @param bufferId the buffer id.
+			 * @return the buffer.
+			 */
+			static ReadWriteBuffer &getBuffer(const Session &session, uint64_t bufferId);
+
+			/**
+			 * @brief Sends a reply.
+			 * @param session the session.
+			 * @param status 0 on success.
+			 * @param value the id created by the request, if any.
+			 * @param message the error message, empty on success.
+			 */
+			static void reply(const Session &session, int32_t status, uint64_t value, const std::string &message);
+
+			/**
+			 * @brief Releases the socket and the shared memory of a session.
+			 * @param session the session.
+			 */
+			static void closeSession(Session &session);
+
+			/**
+			 * @brief Wakes up <code>run</code>.
+			 */
+			void wakeUp() const;
+	};
+}
+
+#endif //OPENCL_TOOLKIT_BROKER_SERVER_H
@@ -0,0 +1,334 @@
+#ifndef OPENCL_TOOLKIT_COHERENT_ARRAY_H
+#define OPENCL_TOOLKIT_COHERENT_ARRAY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "portable_opencl_include.h"
+#include "command_queue.h"
+#include "context.h"
+#include "program.h"
+#include "read_write_buffer.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief The ways a kernel accesses a coherent buffer.
+	 */
+	enum class DeviceAccess {
+		/**
+		 * The kernel only reads, so the host copy stays valid.
+		 */
+		Read,
+
+		/**
+		 * The kernel overwrites the whole buffer without reading it, so host changes are not uploaded.
+		 */
+		Write,
+
+		/**
+		 * The kernel reads and writes.
+		 */
+		ReadWrite
+	};
+
+	/**
+	 * @brief Represents host memory paired with a device buffer, which tracks per block which side holds the current
+	 * content and copies a block only when the other side needs it.
+	 * @details Accesses announce their intent: host reads fetch blocks whose current content is on the device, host
+	 * writes and device writes invalidate the other side, and device accesses upload blocks whose current content is on
+	 * the host. Consecutive blocks are copied by one transfer. An instance must not be used by several threads at the
+	 * same time.
+	 */
+	class CoherentBuffer {
+		private:
+			/**
+			 * @brief The states of a block.
+			 */
+			enum class BlockState : uint8_t {
+				/**
+				 * Both sides hold the current content.
+				 */
+				Synchronized,
+
+				/**
+				 * Only the host holds the current content.
+				 */
+				HostNewer,
+
+				/**
+				 * Only the device holds the current content.
+				 */
+				DeviceNewer
+			};
+
+			/**
+			 * The command queue which executes the transfers.
+			 */
+			CommandQueue &commandQueue_;
+
+			/**
+			 * The size in bytes.
+			 */
+			size_t sizeInBytes_;
+
+			/**
+			 * The granularity of the tracking in bytes.
+			 */
+			size_t blockSizeInBytes_;
+
+			/**
+			 * The host memory.
+			 */
+			std::vector<unsigned char> hostMemory_;
+
+			/**
+			 * The device memory.
+			 */
+			ReadWriteBuffer deviceMemory_;
+
+			/**
+			 * The state per block.
+			 */
+			std::vector<BlockState> blockStates_;
+
+			/**
+			 * The bytes copied from the host to the device so far.
+			 */
+			size_t numBytesUploaded_;
+
+			/**
+			 * The bytes copied from the device to the host so far.
+			 */
+			size_t numBytesDownloaded_;
+
+		public:
+			/**
+			 * The default granularity of the tracking in bytes.
+			 */
+			static constexpr size_t defaultBlockSizeInBytes = 64 << 10;
+
+			/**
+			 * @brief The parametrized constructor. The initial content is undefined on both sides.
+			 * @param context a valid OpenCL-context.
+			 * @param commandQueue the command queue which executes the transfers and outlives the current instance.
+			 * @param sizeInBytes the size in bytes.
+			 * @param blockSizeInBytes the granularity of the tracking in bytes.
+			 */
+			[[maybe_unused]] CoherentBuffer(
+					const Context &context,
+					CommandQueue &commandQueue,
+					size_t sizeInBytes,
+					size_t blockSizeInBytes = defaultBlockSizeInBytes
+			);
+
+			/**
+			 * @brief Returns the host memory of a range for reading, fetching its current content if required. The
+			 * pointer is valid until the next access of the device.
+			 * @param offsetInBytes the offset of the range in bytes.
+			 * @param numBytes the size of the range in bytes.
+			 * @return the host memory of the range.
+			 */
+			[[maybe_unused]] const void *readOnHost(size_t offsetInBytes, size_t numBytes);
+
+			/**
+			 * @brief Returns the host memory of a range for reading and writing, fetching its current content if
+			 * required. The pointer is valid until the next access of the device.
+			 * @param offsetInBytes the offset of the range in bytes.
+			 * @param numBytes the size of the range in bytes.
+			 * @return the host memory of the range.
+			 */
+			[[maybe_unused]] void *modifyOnHost(size_t offsetInBytes, size_t numBytes);
+
+			/**
+			 * @brief Returns the host memory of a range which the caller overwrites completely. Only blocks partially
+			 * covered by the range are fetched. The pointer is valid until the next access of the device.
+			 * @param offsetInBytes the offset of the range in bytes.
+			 * @param numBytes the size of the range in bytes.
+			 * @return the host memory of the range.
+			 */
+			[[maybe_unused]] void *overwriteOnHost(size_t offsetInBytes, size_t numBytes);
+
+			/**
+			 * @brief Returns the device memory prepared for the passed kind of access.
+			 * @param access the way the device accesses the whole buffer.
+			 * @return the device memory.
+			 */
+			[[maybe_unused]] const ReadWriteBuffer &getDeviceMemory(DeviceAccess access);
+
+			/**
+			 * @brief Prepares the device memory for the passed kind of access and sets it as a kernel argument.
+			 * @param program the program whose kernel receives the argument.
+			 * @param argIndex the argument index.
+			 * @param access the way the kernel accesses the whole buffer.
+			 */
+			[[maybe_unused]] void bindAsKernelArg(Program &program, cl_uint argIndex, DeviceAccess access);
+
+			/**
+			 * @brief Returns the size in bytes.
+			 * @return the size in bytes.
+			 */
+			[[maybe_unused]] [[nodiscard]] size_t getSizeInBytes() const;
+
+			/**
+			 * @brief Returns the bytes copied from the host to the device so far.
+			 * @return the bytes copied from the host to the device so far.
+			 */
+			[[maybe_unused]] [[nodiscard]] size_t getNumBytesUploaded() const;
+
+			/**
+			 * @brief Returns the bytes copied from the device to the host so far.
+			 * @return the bytes copied from the device to the host so far.
+			 */
+			[[maybe_unused]] [[nodiscard]] size_t getNumBytesDownloaded() const;
+
+		private:
+			/**
+			 * @brief Copies the blocks of a range whose current content is on the device to the host.
+			 * @param firstBlock the first block of the range.
+			 * @param endBlock the block after the range.
+			 */
+			void download(size_t firstBlock, size_t endBlock);
+
+			/**
+			 * @brief Copies the blocks of a range whose current content is on the host to the device.
+			 * @param firstBlock the first block of the range.
+			 * @param endBlock the block after the range.
+			 */
+			void upload(size_t firstBlock, size_t endBlock);
+
+			/**
+			 * @brief Sets the state of the blocks of a range.
+			 * @param firstBlock the first block of the range.
+			 * @param endBlock the block after the range.
+			 * @param state the new state.
+			 */
+			void setState(size_t firstBlock, size_t endBlock, BlockState state);
+
+			/**
+			 * @brief Returns the range of the blocks which overlap a range of bytes.
+			 * @param offsetInBytes the offset of the range in bytes.
+			 * @param numBytes the size of the range in bytes.
+			 * @return the first block and the block after the range.
+			 */
+			[[nodiscard]] std::pair<size_t, size_t> getBlocks(size_t offsetInBytes, size_t numBytes) const;
+	};
+
+	/**
+	 * @brief Represents an array of trivially copyable elements mirrored on the host and the device, see
+	 * <code>CoherentBuffer</code>.
+	 * @tparam T the type of the elements.
+	 */
+	template<typename T>
+	class CoherentArray {
+		static_assert(std::is_trivially_copyable_v<T>, "the elements are copied bytewise");
+
+		private:
+			/**
+			 * The underlying buffer.
+			 */
+			CoherentBuffer buffer_;
+
+			/**
+			 * The number of elements.
+			 */
+			size_t size_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. The initial content is undefined on both sides.
+			 * @param context a valid OpenCL-context.
+			 * @param commandQueue the command queue which executes the transfers and outlives the current instance.
+			 * @param size the number of elements.
+			 */
+			[[maybe_unused]] CoherentArray(const Context &context, CommandQueue &commandQueue, const size_t size) :
+					buffer_(context, commandQueue, size * sizeof(T)),
+					size_(size) {}
+
+			/**
+			 * @brief Returns elements for reading on the host, see <code>CoherentBuffer::readOnHost</code>.
+			 * @param first the index of the first element.
+			 * @param count the number of elements, all up to the end by default.
+			 * @return the elements.
+			 */
+			[[maybe_unused]] const T *readOnHost(const size_t first = 0, const size_t count = static_cast<size_t>(-1)) {
+				return static_cast<const T *>(buffer_.readOnHost(first * sizeof(T), clip(first, count) * sizeof(T)));
+			}
+
+			/**
+			 * @brief Returns elements for reading and writing on the host, see
+			 * <code>CoherentBuffer::modifyOnHost</code>.
+			 * @param first the index of the first element.
+			 * @param count the number of elements, all up to the end by default.
+			 * @return the elements.
+			 */
+			[[maybe_unused]] T *modifyOnHost(const size_t first = 0, const size_t count = static_cast<size_t>(-1)) {
+				return static_cast<T *>(buffer_.modifyOnHost(first * sizeof(T), clip(first, count) * sizeof(T)));
+			}
+
+			/**
+			 * @brief Returns elements which the caller overwrites completely on the host, see
+			 * <code>CoherentBuffer::overwriteOnHost</code>.
+			 * @param first the index of the first element.
+			 * @param count the number of elements, all up to the end by default.
+			 * @return the elements.
+			 */
+			[[maybe_unused]] T *overwriteOnHost(const size_t first = 0, const size_t count = static_cast<size_t>(-1)) {
+				return static_cast<T *>(buffer_.overwriteOnHost(first * sizeof(T), clip(first, count) * sizeof(T)));
+			}
+
+			/**
+			 * @brief Prepares the device memory for the passed kind of access and sets it as a kernel argument.
+			 * @param program the program whose kernel receives the argument.
+			 * @param argIndex the argument index.
+			 * @param access the way the kernel accesses the whole array.
+			 */
+			[[maybe_unused]] void bindAsKernelArg(Program &program, const cl_uint argIndex, const DeviceAccess access) {
+				buffer_.bindAsKernelArg(program, argIndex, access);
+			}
+
+			/**
+			 * @brief Returns the device memory prepared for the passed kind of access.
+			 * @param access the way the device accesses the whole array.
+			 * @return the device memory.
+			 */
+			[[maybe_unused]] const ReadWriteBuffer &getDeviceMemory(const DeviceAccess access) {
+				return buffer_.getDeviceMemory(access);
+			}
+
+			/**
+			 * @brief Returns the number of elements.
+			 * @return the number of elements.
+			 */
+			[[maybe_unused]] [[nodiscard]] size_t size() const {
+				return size_;
+			}
+
+			/**
+			 * @brief Returns the underlying buffer, e.g. for its transfer statistics.
+			 * @return the underlying buffer.
+			 */
+			[[maybe_unused]] [[nodiscard]] const CoherentBuffer &getBuffer() const {
+				return buffer_;
+			}
+
+		private:
+			/**
+			 * @brief Clips a number of elements to the end of the array.
+			 * @param first the index of the first element.
+			 * @param count the number of elements.
+			 * @return the clipped number of elements.
+			 */
+			[[nodiscard]] size_t clip(const size_t first, const size_t count) const {
+				return first < size_ ? std::min(count, size_ - first) : 0;
+			}
+	};
+}
+
+#endif //OPENCL_TOOLKIT_COHERENT_ARRAY_H
@@ -1,10 +1,19 @@
 #ifndef OPENCL_TOOLKIT_COMMAND_QUEUE_H
 #define OPENCL_TOOLKIT_COMMAND_QUEUE_H
 
+#include <map>
+#include <mutex>
+#include <vector>
+
 #include "portable_opencl_include.h"
 #include "read_only_buffer.h"
 #include "write_only_buffer.h"
+#include "read_write_buffer.h"
 #include "program.h"
+#include "nd_range.h"
+#include "image.h"
+#include "segmented_buffer.h"
+#include "event.h"
 
 /**
  * @brief Namespace of this toolkit.
@@ -22,6 +31,36 @@ namespace OpenClToolkit {
 			 */
 			cl_command_queue self_;
 
+			/**
+			 * @brief A mapping of an image for writing, whose pixels are traced when it is released.
+			 */
+			struct ImageMapping {
+				/**
+				 * The mapped image.
+				 */
+				const Image *image;
+
+				/**
+				 * The distance of the rows of the mapping.
+				 */
+				size_t rowPitchInBytes;
+
+				/**
+				 * The distance of the slices of the mapping.
+				 */
+				size_t slicePitchInBytes;
+			};
+
+			/**
+			 * The mappings of images for writing by their host pointer.
+			 */
+			std::map<void *, ImageMapping> imageMappings_;
+
+			/**
+			 * Guards the mappings of images.
+			 */
+			std::mutex imageMappingsMutex_;
+
 		public:
 			/**
 			 * @brief The parametrized constructor.
@@ -47,7 +86,301 @@ namespace OpenClToolkit {
 					size_t numBytesToCopy
 			);
 
+			[[maybe_unused]] void enqueueCommandCopyBytesFromHostMemoryIntoDeviceMemory(
+					const void *sourceHostMemory,
+					const ReadWriteBuffer& destinationDeviceMemory,
+					size_t numBytesToCopy,
+					size_t destinationOffsetInBytes = 0
+			);
+
+			[[maybe_unused]] void enqueueCommandCopyBytesFromDeviceMemoryIntoHostMemory(
+					const ReadWriteBuffer& sourceDeviceMemory,
+					void *destinationHostMemory,
+					size_t numBytesToCopy,
+					size_t sourceOffsetInBytes = 0
+			);
+
+			/**
+			 * @brief Enqueues a command which copies bytes between two device buffers of the same context. The command
+			 * is not awaited.
+			 * @param sourceDeviceMemory the device memory to copy from.
+			 * @param destinationDeviceMemory the device memory to copy to.
+			 * @param numBytesToCopy the number of bytes to be copied.
+			 * @param sourceOffsetInBytes an optional offset in bytes into the source device memory.
+			 * @param destinationOffsetInBytes an optional offset in bytes into the destination device memory.
+			 */
+			[[maybe_unused]] void enqueueCommandCopyBytesFromDeviceMemoryIntoDeviceMemory(
+					const BaseBuffer& sourceDeviceMemory,
+					const BaseBuffer& destinationDeviceMemory,
+					size_t numBytesToCopy,
+					size_t sourceOffsetInBytes = 0,
+					size_t destinationOffsetInBytes = 0
+			);
+
+			/**
+			 * @brief Enqueues a command which fills the passed device memory with a repeated pattern, e.g. to clear
+			 * it. The command is not awaited.
+			 * @param deviceMemory the device memory to be filled.
+			 * @param pattern the pattern to be repeated.
+			 * @param patternSizeInBytes the size of the pattern in bytes (1, 2, 4, ..., 128).
+			 * @param numBytesToFill the number of bytes to be filled. It must be a multiple of the pattern size.
+			 * @param offsetInBytes an optional offset in bytes into the device memory.
+			 */
+			[[maybe_unused]] void enqueueCommandFillDeviceMemory(
+					const BaseBuffer& deviceMemory,
+					const void *pattern,
+					size_t patternSizeInBytes,
+					size_t numBytesToFill,
+					size_t offsetInBytes = 0
+			);
+
 			[[maybe_unused]] void enqueueCommandExecuteProgramOnDevice(const Program &program, size_t numThreads);
+
+			/**
+			 * @brief Enqueues the execution of the passed program with an explicit work group size.
+			 * @param program the program to be executed.
+			 * @param numThreads the number of threads used to execute the kernel. It must be a multiple of
+			 *                   the passed work group size.
+			 * @param numThreadsPerWorkGroup the number of threads per work group.
+			 */
+			[[maybe_unused]] void enqueueCommandExecuteProgramOnDevice(
+					const Program &program,
+					size_t numThreads,
+					size_t numThreadsPerWorkGroup
+			);
+
+			/**
+			 * @brief Enqueues the execution of the passed program over a one-, two- or three-dimensional index space.
+			 * @param program the program to be executed.
+			 * @param globalWorkSize the number of threads per dimension. It must be a multiple of the passed work group
+			 *                       size per dimension.
+			 * @param localWorkSize the number of threads per work group and dimension. It must have as many dimensions
+			 *                      as the global work size.
+			 * @param globalWorkOffset an optional offset added to the global ids, nullptr for none.
+			 */
+			[[maybe_unused]] void enqueueCommandExecuteProgramOnDevice(
+					const Program &program,
+					const NDRange &globalWorkSize,
+					const NDRange &localWorkSize,
+					const NDRange *globalWorkOffset = nullptr
+			);
+
+			/**
+			 * @brief Copies pixels from host memory into a region of the passed image. The command is awaited.
+			 * @param sourceHostMemory the pixels to copy from.
+			 * @param destinationImage the image to copy to.
+			 * @param origin the first pixel of the region, with as many dimensions as the image.
+			 * @param region the size of the region in pixels, with as many dimensions as the image.
+			 * @param sourceRowPitchInBytes the distance of the rows in host memory, 0 for tightly packed rows.
+			 * @param sourceSlicePitchInBytes the distance of the slices in host memory, 0 for tightly packed slices.
+			 */
+			[[maybe_unused]] void enqueueCommandCopyBytesFromHostMemoryIntoImage(
+					const void *sourceHostMemory,
+					const Image &destinationImage,
+					const NDRange &origin,
+					const NDRange &region,
+					size_t sourceRowPitchInBytes = 0,
+					size_t sourceSlicePitchInBytes = 0
+			);
+
+			/**
+			 * @brief Copies tightly packed pixels from host memory into the whole passed image. The command is awaited.
+			 * @param sourceHostMemory the pixels to copy from.
+			 * @param destinationImage the image to copy to.
+			 */
+			[[maybe_unused]] void enqueueCommandCopyBytesFromHostMemoryIntoImage(
+					const void *sourceHostMemory,
+					const Image &destinationImage
+			);
+
+			/**
+			 * @brief Copies the pixels of a region of the passed image into host memory. The command is awaited.
+			 * @param sourceImage the image to copy from.
+			 * @param destinationHostMemory the host memory to copy to.
+			 * @param origin the first pixel of the region, with as many dimensions as the image.
+			 * @param region the size of the region in pixels, with as many dimensions as the image.
+			 * @param destinationRowPitchInBytes the distance of the rows in host memory, 0 for tightly packed rows.
+			 * @param destinationSlicePitchInBytes the distance of the slices in host memory, 0 for tightly packed
+			 *                                     slices.
+			 */
+			[[maybe_unused]] void enqueueCommandCopyBytesFromImageIntoHostMemory(
+					const Image &sourceImage,
+					void *destinationHostMemory,
+					const NDRange &origin,
+					const NDRange &region,
+					size_t destinationRowPitchInBytes = 0,
+					size_t destinationSlicePitchInBytes = 0
+			);
+
+			/**
+			 * @brief Copies the pixels of the whole passed image tightly packed into host memory. The command is
+			 * awaited.
+			 * @param sourceImage the image to copy from.
+			 * @param destinationHostMemory the host memory to copy to.
+			 */
+			[[maybe_unused]] void enqueueCommandCopyBytesFromImageIntoHostMemory(
+					const Image &sourceImage,
+					void *destinationHostMemory
+			);
+
+			/**
+			 * @brief Maps the whole passed image into host memory. The command is awaited. The mapping must be released
+			 * by <code>enqueueCommandUnmapMemoryObject</code> before the image is used by kernels again.
+			 * @param image the image to be mapped.
+			 * @param mapFlags <code>CL_MAP_READ</code>, <code>CL_MAP_WRITE</code> or
+			 *                 <code>CL_MAP_WRITE_INVALIDATE_REGION</code>.
+			 * @param rowPitchInBytes receives the distance of the rows of the mapping.
+			 * @param slicePitchInBytes receives the distance of the slices of the mapping, 0 for 1-D and 2-D images.
+			 * @return the host pointer of the first pixel.
+			 */
+			[[maybe_unused]] void *enqueueCommandMapImage(
+					const Image &image,
+					cl_map_flags mapFlags,
+					size_t &rowPitchInBytes,
+					size_t &slicePitchInBytes
+			);
+
+			/**
+			 * @brief Enqueues a command which releases a mapping of a buffer or image. The command is not awaited.
+			 * @param memoryObject the mapped buffer or image.
+			 * @param mappedHostMemory the host pointer returned by the mapping.
+			 */
+			[[maybe_unused]] void enqueueCommandUnmapMemoryObject(cl_mem memoryObject, void *mappedHostMemory);
+
+			/**
+			 * @brief Copies bytes from host memory into a range of the passed virtual buffer, which may span several
+			 * segments. The command is awaited.
+			 * @param sourceHostMemory the host memory to copy from.
+			 * @param destinationBuffer the virtual buffer to copy to.
+			 * @param numBytesToCopy the number of bytes to be copied.
+			 * @param destinationOffsetInBytes the offset in bytes into the virtual buffer.
+			 */
+			[[maybe_unused]] void enqueueCommandCopyBytesFromHostMemoryIntoSegmentedBuffer(
+					const void *sourceHostMemory,
+					const SegmentedBuffer &destinationBuffer,
+					size_t numBytesToCopy,
+					size_t destinationOffsetInBytes = 0
+			);
+
+			/**
+			 * @brief Copies bytes from a range of the passed virtual buffer, which may span several segments, into host
+			 * memory. The command is awaited.
+			 * @param sourceBuffer the virtual buffer to copy from.
+			 * @param destinationHostMemory the host memory to copy to.
+			 * @param numBytesToCopy the number of bytes to be copied.
+			 * @param sourceOffsetInBytes the offset in bytes into the virtual buffer.
+			 */
+			[[maybe_unused]] void enqueueCommandCopyBytesFromSegmentedBufferIntoHostMemory(
+					const SegmentedBuffer &sourceBuffer,
+					void *destinationHostMemory,
+					size_t numBytesToCopy,
+					size_t sourceOffsetInBytes = 0
+			);
+
+			/**
+			 * @brief Enqueues the execution of the passed program once per segment of the passed virtual buffer, with
+			 * one thread per element. For each launch, the segment is set as the passed kernel argument, and the global
+			 * offset is the index of the first element of the segment. So <code>get_global_id(0)</code> is the index of
+			 * the element in the virtual buffer and <code>get_global_id(0) - get_global_offset(0)</code> its index in
+			 * the segment. The other kernel arguments must be set beforehand.
+			 * @param program the program to be executed.
+			 * @param argIndex the index of the kernel argument which receives the segment.
+			 * @param buffer the virtual buffer.
+			 */
+			[[maybe_unused]] void enqueueCommandExecuteProgramOnSegments(
+					Program &program,
+					cl_uint argIndex,
+					const SegmentedBuffer &buffer
+			);
+
+			/**
+			 * @brief Enqueues a command which copies bytes from host memory into device memory without awaiting it.
+			 * The host memory must stay valid and unchanged until the command has completed.
+			 * @param sourceHostMemory the host memory to copy from.
+			 * @param destinationDeviceMemory the device memory to copy to.
+			 * @param numBytesToCopy the number of bytes to be copied.
+			 * @param destinationOffsetInBytes an optional offset in bytes into the device memory.
+			 * @return the event of the command, e.g. to be awaited by a coroutine.
+			 */
+			[[maybe_unused]] Event enqueueCommandCopyBytesFromHostMemoryIntoDeviceMemoryAsync(
+					const void *sourceHostMemory,
+					const BaseBuffer &destinationDeviceMemory,
+					size_t numBytesToCopy,
+					size_t destinationOffsetInBytes = 0
+			);
+
+			/**
+			 * @brief Enqueues a command which copies bytes from device memory into host memory without awaiting it.
+			 * The host memory must stay valid and must not be accessed until the command has completed.
+			 * @param sourceDeviceMemory the device memory to copy from.
+			 * @param destinationHostMemory the host memory to copy to.
+			 * @param numBytesToCopy the number of bytes to be copied.
+			 * @param sourceOffsetInBytes an optional offset in bytes into the device memory.
+			 * @return the event of the command, e.g. to be awaited by a coroutine.
+			 */
+			[[maybe_unused]] Event enqueueCommandCopyBytesFromDeviceMemoryIntoHostMemoryAsync(
+					const BaseBuffer &sourceDeviceMemory,
+					void *destinationHostMemory,
+					size_t numBytesToCopy,
+					size_t sourceOffsetInBytes = 0
+			);
+
+			/**
+			 * @brief Enqueues the execution of the passed program like
+			 * <code>enqueueCommandExecuteProgramOnDevice</code> and returns its event.
+			 * @param program the program to be executed.
+			 * @param globalWorkSize the number of threads per dimension.
+			 * @param localWorkSize the number of threads per work group and dimension.
+			 * @param globalWorkOffset an optional offset added to the global ids, nullptr for none.
+			 * @return the event of the command, e.g. to be awaited by a coroutine.
+			 */
+			[[maybe_unused]] Event enqueueCommandExecuteProgramOnDeviceAsync(
+					const Program &program,
+					const NDRange &globalWorkSize,
+					const NDRange &localWorkSize,
+					const NDRange *globalWorkOffset = nullptr
+			);
+
+			/**
+			 * @brief Enqueues a command which migrates buffers or images of a multi-device context to the device of the
+			 * current command queue ahead of their use. The command is not awaited, but later commands of the current
+			 * command queue start after it.
+			 * @param memoryObjects the buffers or images to be migrated.
+			 * @param migrationFlags <code>CL_MIGRATE_MEM_OBJECT_CONTENT_UNDEFINED</code> if the content is overwritten
+			 *                       anyway, <code>CL_MIGRATE_MEM_OBJECT_HOST</code> to migrate to the host instead, or 0.
+			 * @param predecessor an optional command queue of the same context whose previously enqueued commands, e.g.
+			 *                    the producer of the content, complete before the migration starts, nullptr for none. The
+			 *                    predecessor is flushed.
+			 */
+			[[maybe_unused]] void enqueueCommandMigrateMemoryObjects(
+					const std::vector<cl_mem> &memoryObjects,
+					cl_mem_migration_flags migrationFlags = 0,
+					const CommandQueue *predecessor = nullptr
+			);
+
+			/**
+			 * @brief Blocks until all previously enqueued commands have completed.
+			 */
+			[[maybe_unused]] void finish();
+
+			operator cl_command_queue() const; // NOLINT(google-explicit-constructor)
+
+		private:
+			/**
+			 * @brief Enqueues the execution of the passed program over a one-, two- or three-dimensional index space.
+			 * @param program the program to be executed.
+			 * @param globalWorkSize the number of threads per dimension.
+			 * @param localWorkSize the number of threads per work group and dimension.
+			 * @param globalWorkOffset an optional offset added to the global ids, nullptr for none.
+			 * @param event receives the event of the command, nullptr for none.
+			 */
+			void enqueueExecuteProgram(
+					const Program &program,
+					const NDRange &globalWorkSize,
+					const NDRange &localWorkSize,
+					const NDRange *globalWorkOffset,
+					cl_event *event
+			);
 	};
 }
 
@@ -0,0 +1,362 @@
+#ifndef OPENCL_TOOLKIT_COMMAND_RECORDER_H
+#define OPENCL_TOOLKIT_COMMAND_RECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+#include "portable_opencl_include.h"
+#include "image.h"
+#include "kernel_library.h"
+#include "nd_range.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief The kinds of program creation recorded in a trace.
+	 */
+	enum class RecordedProgramKind {
+		Source,
+		IntermediateLanguage
+	};
+
+	/**
+	 * @brief Records the buffer and image allocations, program builds, kernel arguments, transfers and launches of the
+	 * toolkit into a compact binary trace, which <code>CommandReplayer</code> re-executes offline.
+	 * @details The recorder is a process-wide singleton and is inactive until <code>start</code> is called or the
+	 * environment variable <code>OPENCL_TOOLKIT_TRACE</code> names a trace file when the recorder is first used. If
+	 * <code>OPENCL_TOOLKIT_TRACE_PAYLOADS</code> is set to 1 as well, the data of host-to-device copies is recorded
+	 * too. Shared virtual memory is not recorded; arguments pointing to shared virtual memory only mark the launches
+	 * of their kernel to be skipped on replay. Inactive, each hook costs one atomic load. The
+	 * <code>record...</code> methods are called by the toolkit itself.
+	 */
+	class CommandRecorder {
+		private:
+			/**
+			 * Guards the trace file.
+			 */
+			std::mutex mutex_;
+
+			/**
+			 * The trace file.
+			 */
+			std::ofstream file_;
+
+			/**
+			 * True while recording.
+			 */
+			std::atomic<bool> isRecording_;
+
+			/**
+			 * True if the data of host-to-device copies is recorded.
+			 */
+			bool isRecordingPayloads_;
+
+			/**
+			 * The start of the recording.
+			 */
+			std::chrono::steady_clock::time_point start_;
+
+			/**
+			 * @brief The default constructor. Starts recording if requested by the environment.
+			 */
+			CommandRecorder();
+
+		public:
+			/**
+			 * @brief Deleted copy constructor.
+			 */
+			CommandRecorder(CommandRecorder const &) = delete;
+
+			/**
+			 * @brief Deleted copy assignment.
+			 */
+			void operator=(CommandRecorder const &) = delete;
+
+			/**
+			 * @brief The destructor. Completes the trace.
+			 */
+			~CommandRecorder();
+
+			/**
+			 * @brief Returns the singleton instance of this class.
+			 * @return the singleton instance of this class.
+			 */
+			[[maybe_unused]] static CommandRecorder &getInstance();
+
+			/**
+			 * @brief Starts recording into a new trace file, completing the previous trace if any. Buffers and kernels
+			 * created before are unknown to the trace, so recording should start before the toolkit is used.
+			 * @param path the path of the trace file.
+			 * @param isRecordingPayloads true to record the data of host-to-device copies as well.
+			 */
+			[[maybe_unused]] void start(const std::string &path, bool isRecordingPayloads = false);
+
+			/**
+			 * @brief Stops recording and completes the trace.
+			 */
+			[[maybe_unused]] void stop();
+
+			/**
+			 * @brief Returns whether the recorder is recording.
+			 * @return true if the recorder is recording.
+			 */
+			[[maybe_unused]] [[nodiscard]] bool isRecording() const;
+
+			/**
+			 * @brief Records the creation of a buffer.
+			 * @param buffer the buffer.
+			 * @param flags the flags of the buffer.
+			 * @param sizeInBytes the size of the buffer.
+			 */
+			void recordAllocation(cl_mem buffer, cl_mem_flags flags, size_t sizeInBytes);
+
+			/**
+			 * @brief Records the creation of an image.
+			 * @param image the image.
+			 * @param flags the flags of the image.
+			 * @param format the channel order and data type of the image.
+			 * @param size the size of the image in pixels.
+			 */
+			void recordImageAllocation(
+					cl_mem image,
+					cl_mem_flags flags,
+					const cl_image_format &format,
+					const NDRange &size
+			);
+
+			/**
+			 * @brief Records the release of a buffer or image.
+			 * @param buffer the buffer or image.
+			 */
+			void recordRelease(cl_mem buffer);
+
+			/**
+			 * @brief Records the creation of a program.
+			 * @param program the program.
+			 * @param kind how the program was created.
+			 * @param buildOptions the build options.
+			 * @param data the source or module.
+			 * @param dataSizeInBytes the size of the source or module.
+			 */
+			void recordProgram(
+					cl_program program,
+					RecordedProgramKind kind,
+					const std::string &buildOptions,
+					const void *data,
+					size_t dataSizeInBytes
+			);
+
+			/**
+			 * @brief Records the creation of a program which is compiled from source and linked against a kernel
+			 * library, together with the headers, the source and the compile options of the library.
+			 * @param program the program.
+			 * @param library the kernel library.
+			 * @param sourceCode the source of the program.
+			 * @param buildOptions the options the program is compiled with in addition to those of the library.
+			 */
+			void recordLinkedProgram(
+					cl_program program,
+					const KernelLibrary &library,
+					const char *sourceCode,
+					const std::string &buildOptions
+			);
+
+			/**
+			 * @brief Records the creation of a kernel.
+			 * @param kernel the kernel.
+			 * @param program the program of the kernel.
+			 * @param kernelName the name of the kernel.
+			 */
+			void recordKernel(cl_kernel kernel, cl_program program, const std::string &kernelName);
+
+			/**
+			 * @brief Records the setting of a kernel argument by value or as local memory.
+			 * @param kernel the kernel.
+			 * @param argIndex the argument index.
+			 * @param argSize the size of the argument.
+			 * @param argValue the value, nullptr for local memory.
+			 */
+			void recordKernelArgument(cl_kernel kernel, cl_uint argIndex, size_t argSize, const void *argValue);
+
+			/**
+			 * @brief Records the setting of a buffer as kernel argument.
+			 * @param kernel the kernel.
+			 * @param argIndex the argument index.
+			 * @param buffer the buffer.
+			 */
+			void recordKernelBufferArgument(cl_kernel kernel, cl_uint argIndex, cl_mem buffer);
+
+			/**
+			 * @brief Records the setting of a sampler as kernel argument.
+			 * @param kernel the kernel.
+			 * @param argIndex the argument index.
+			 * @param sampler the sampler, whose properties are recorded.
+			 */
+			void recordKernelSamplerArgument(cl_kernel kernel, cl_uint argIndex, cl_sampler sampler);
+
+			/**
+			 * @brief Records the setting of a pipe as kernel argument.
+			 * @param kernel the kernel.
+			 * @param argIndex the argument index.
+			 * @param pipe the pipe.
+			 * @param packetSizeInBytes the size of a packet of the pipe.
+			 * @param maxNumPackets the max number of packets the pipe holds.
+			 */
+			void recordKernelPipeArgument(
+					cl_kernel kernel,
+					cl_uint argIndex,
+					cl_mem pipe,
+					cl_uint packetSizeInBytes,
+					cl_uint maxNumPackets
+			);
+
+			/**
+			 * @brief Records the setting of a kernel argument which the trace cannot represent, e.g. a pointer to
+			 * shared virtual memory, so the launches of the kernel are skipped on replay.
+			 * @param kernel the kernel.
+			 * @param argIndex the argument index.
+			 */
+			void recordUnsupportedKernelArgument(cl_kernel kernel, cl_uint argIndex);
+
+			/**
+			 * @brief Records the declaration of shared virtual memory which a kernel accesses indirectly, so the
+			 * launches of the kernel are skipped on replay.
+			 * @param kernel the kernel.
+			 */
+			void recordIndirectSvmPointers(cl_kernel kernel);
+
+			/**
+			 * @brief Records a copy from host into device memory.
+			 * @param buffer the destination buffer.
+			 * @param offsetInBytes the offset into the buffer.
+			 * @param sizeInBytes the number of bytes.
+			 * @param data the copied data, stored if payloads are recorded.
+			 */
+			void recordWrite(cl_mem buffer, size_t offsetInBytes, size_t sizeInBytes, const void *data);
+
+			/**
+			 * @brief Records a copy from device into host memory.
+			 * @param buffer the source buffer.
+			 * @param offsetInBytes the offset into the buffer.
+			 * @param sizeInBytes the number of bytes.
+			 */
+			void recordRead(cl_mem buffer, size_t offsetInBytes, size_t sizeInBytes);
+
+			/**
+			 * @brief Records a copy from host memory into a region of an image.
+			 * @param image the destination image.
+			 * @param origin the first pixel of the region in three dimensions.
+			 * @param region the size of the region in pixels in three dimensions.
+			 * @param rowPitchInBytes the distance of the rows in host memory, 0 for tightly packed rows.
+			 * @param slicePitchInBytes the distance of the slices in host memory, 0 for tightly packed slices.
+			 * @param data the copied pixels, stored if payloads are recorded.
+			 */
+			void recordImageWrite(
+					const Image &image,
+					const size_t *origin,
+					const size_t *region,
+					size_t rowPitchInBytes,
+					size_t slicePitchInBytes,
+					const void *data
+			);
+
+			/**
+			 * @brief Records a copy from a region of an image into host memory.
+			 * @param image the source image.
+			 * @param origin the first pixel of the region in three dimensions.
+			 * @param region the size of the region in pixels in three dimensions.
+			 * @param rowPitchInBytes the distance of the rows in host memory, 0 for tightly packed rows.
+			 * @param slicePitchInBytes the distance of the slices in host memory, 0 for tightly packed slices.
+			 */
+			void recordImageRead(
+					const Image &image,
+					const size_t *origin,
+					const size_t *region,
+					size_t rowPitchInBytes,
+					size_t slicePitchInBytes
+			);
+
+			/**
+			 * @brief Records a copy between buffers.
+			 * @param sourceBuffer the source buffer.
+			 * @param destinationBuffer the destination buffer.
+			 * @param sourceOffsetInBytes the offset into the source buffer.
+			 * @param destinationOffsetInBytes the offset into the destination buffer.
+			 * @param sizeInBytes the number of bytes.
+			 */
+			void recordCopy(
+					cl_mem sourceBuffer,
+					cl_mem destinationBuffer,
+					size_t sourceOffsetInBytes,
+					size_t destinationOffsetInBytes,
+					size_t sizeInBytes
+			);
+
+			/**
+			 * @brief Records the filling of a buffer.
+			 * @param buffer the buffer.
+			 * @param pattern the pattern.
+			 * @param patternSizeInBytes the size of the pattern.
+			 * @param offsetInBytes the offset into the buffer.
+			 * @param sizeInBytes the number of bytes.
+			 */
+			void recordFill(
+					cl_mem buffer,
+					const void *pattern,
+					size_t patternSizeInBytes,
+					size_t offsetInBytes,
+					size_t sizeInBytes
+			);
+
+			/**
+			 * @brief Records a kernel launch.
+			 * @param kernel the kernel.
+			 * @param numDimensions the number of dimensions.
+			 * @param globalWorkSize the global work size per dimension.
+			 * @param localWorkSize the local work size per dimension, nullptr if chosen by the runtime.
+			 * @param globalWorkOffset the global work offset per dimension, nullptr for none.
+			 */
+			void recordLaunch(
+					cl_kernel kernel,
+					cl_uint numDimensions,
+					const size_t *globalWorkSize,
+					const size_t *localWorkSize,
+					const size_t *globalWorkOffset
+			);
+
+			/**
+			 * @brief Records the wait for all enqueued commands.
+			 */
+			void recordFinish();
+
+		private:
+			/**
+			 * @brief Appends a record if recording.
+			 * @param type the record type.
+			 * @param body the struct of the record type.
+			 * @param bodySizeInBytes the size of the struct.
+			 * @param trailer the trailing bytes, nullptr for none.
+			 * @param trailerSizeInBytes the number of trailing bytes.
+			 * @param secondTrailer further trailing bytes, nullptr for none.
+			 * @param secondTrailerSizeInBytes the number of further trailing bytes.
+			 */
+			void append(
+					uint32_t type,
+					const void *body,
+					size_t bodySizeInBytes,
+					const void *trailer = nullptr,
+					size_t trailerSizeInBytes = 0,
+					const void *secondTrailer = nullptr,
+					size_t secondTrailerSizeInBytes = 0
+			);
+	};
+}
+
+#endif //OPENCL_TOOLKIT_COMMAND_RECORDER_H
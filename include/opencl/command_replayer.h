@@ -0,0 +1,123 @@
+#ifndef OPENCL_TOOLKIT_COMMAND_REPLAYER_H
+#define OPENCL_TOOLKIT_COMMAND_REPLAYER_H
+
+#include <string>
+#include <vector>
+
+#include "portable_opencl_include.h"
+#include "command_queue.h"
+#include "context.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief The time spent in the launches of one kernel during a replay.
+	 */
+	struct ReplayKernelTiming {
+		/**
+		 * The name of the kernel.
+		 */
+		std::string kernelName;
+
+		/**
+		 * The number of launches.
+		 */
+		size_t numLaunches;
+
+		/**
+		 * The total time of the launches in seconds.
+		 */
+		double seconds;
+	};
+
+	/**
+	 * @brief The result of a replay.
+	 */
+	struct ReplayStatistics {
+		/**
+		 * The number of records of the trace.
+		 */
+		size_t numRecords;
+
+		/**
+		 * The number of replayed launches.
+		 */
+		size_t numLaunches;
+
+		/**
+		 * The number of replayed copies and fills.
+		 */
+		size_t numTransfers;
+
+		/**
+		 * The number of bytes moved by the replayed copies and fills.
+		 */
+		size_t numTransferredBytes;
+
+		/**
+		 * The number of records which could not be replayed, e.g. since their program failed to build.
+		 */
+		size_t numSkippedRecords;
+
+		/**
+		 * The time of the whole replay in seconds, excluding program builds.
+		 */
+		double seconds;
+
+		/**
+		 * The time per kernel, in order of first launch. Only measured if each launch is awaited.
+		 */
+		std::vector<ReplayKernelTiming> kernels;
+	};
+
+	/**
+	 * @brief Re-executes a trace of <code>CommandRecorder</code> on a device, e.g. to bisect performance changes of the
+	 * toolkit or the driver offline.
+	 * @details All recorded buffers and images are created in the passed context, programs are built through the
+	 * program registry and every kernel gets its own instance. Copies from host memory write the recorded payloads, or
+	 * zeros if the payloads were not recorded, so results are only meaningful with payloads. Programs linked against a
+	 * kernel library are compiled and linked against a library recreated from the recorded headers, source and
+	 * options. Launches of kernels with an argument which could not be replayed, e.g. a pointer to shared virtual
+	 * memory, are skipped.
+	 */
+	class CommandReplayer {
+		private:
+			/**
+			 * A valid OpenCL-context.
+			 */
+			const Context &context_;
+
+			/**
+			 * The target device.
+			 */
+			cl_device_id device_;
+
+			/**
+			 * The command queue which executes the trace.
+			 */
+			CommandQueue &commandQueue_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor.
+			 * @param context a valid OpenCL-context which outlives the current instance.
+			 * @param device the target device.
+			 * @param commandQueue the command queue of the target device which outlives the current instance.
+			 */
+			[[maybe_unused]] CommandReplayer(const Context &context, cl_device_id device, CommandQueue &commandQueue);
+
+			/**
+			 * @brief Replays a trace and waits for its completion.
+			 * @param path the path of the trace file.
+			 * @param isAwaitingEachLaunch true to wait for each launch, which measures the time per kernel but
+			 *                             serializes the launches with the host.
+			 * @return the statistics of the replay.
+			 */
+			[[maybe_unused]] ReplayStatistics replay(const std::string &path, bool isAwaitingEachLaunch = true);
+	};
+}
+
+#endif //OPENCL_TOOLKIT_COMMAND_REPLAYER_H
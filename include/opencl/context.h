@@ -2,6 +2,7 @@
 #define OPENCL_TOOLKIT_CONTEXT_H
 
 #include <string>
+#include <vector>
 
 #include "portable_opencl_include.h"
 
@@ -18,8 +19,28 @@ namespace OpenClToolkit {
 			 */
 			cl_context self_;
 
+			/**
+			 * The devices of the context.
+			 */
+			std::vector<cl_device_id> devices_;
+
 		public:
 			[[maybe_unused]] explicit Context(cl_device_id device);
+
+			/**
+			 * @brief Creates a context over several devices of the same platform. Its buffers are allocated once and
+			 * can be used by the command queues of all devices; the runtime moves them between the devices on demand
+			 * or on explicit migration.
+			 * @param devices the devices, at least one.
+			 */
+			[[maybe_unused]] explicit Context(const std::vector<cl_device_id> &devices);
+
+			/**
+			 * @brief Returns the devices of the context.
+			 * @return the devices of the context.
+			 */
+			[[maybe_unused]] [[nodiscard]] const std::vector<cl_device_id> &getDevices() const;
+
 			~Context();
 			operator cl_context() const; // NOLINT(google-explicit-constructor)
 
@@ -0,0 +1,178 @@
+#ifndef OPENCL_TOOLKIT_CONVERTING_UPLOADER_H
+#define OPENCL_TOOLKIT_CONVERTING_UPLOADER_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "portable_opencl_include.h"
+#include "base_buffer.h"
+#include "command_queue.h"
+#include "context.h"
+#include "event.h"
+#include "layout_converter.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	class DoubleBufferedStaging;
+
+	/**
+	 * @brief Converts host data chunk by chunk straight into pinned staging memory and uploads it from there, so every
+	 * element is read once and written once on the host instead of being converted into a temporary container first.
+	 * @details Two staging buffers alternate: while the device copies one chunk, the next is converted into the other
+	 * buffer. The staging buffers stay mapped for the lifetime of an instance. An instance must not be used by several
+	 * threads at the same time.
+	 */
+	class ConvertingUploader {
+		private:
+			/**
+			 * The command queue which executes the transfers.
+			 */
+			CommandQueue &commandQueue_;
+
+			/**
+			 * The conversions.
+			 */
+			LayoutConverter converter_;
+
+			/**
+			 * The two alternating staging buffers in pinned host memory.
+			 */
+			std::unique_ptr<DoubleBufferedStaging> staging_;
+
+		public:
+			/**
+			 * The default size of the staging buffers, large enough to reach the peak transfer rate of common
+			 * devices.
+			 */
+			static constexpr size_t defaultChunkSizeInBytes = 4 << 20;
+
+			/**
+			 * @brief The parametrized constructor. Creates and maps the staging buffers.
+			 * @param context a valid OpenCL-context.
+			 * @param commandQueue the command queue of the target device which outlives the current instance.
+			 * @param converter the conversions, by default with the best instruction set of the host.
+			 * @param chunkSizeInBytes the size of each of the two staging buffers in bytes.
+			 */
+			[[maybe_unused]] ConvertingUploader(
+					const Context &context,
+					CommandQueue &commandQueue,
+					LayoutConverter converter = LayoutConverter(),
+					size_t chunkSizeInBytes = defaultChunkSizeInBytes
+			);
+
+			/**
+			 * @brief Deleted copy constructor.
+			 */
+			ConvertingUploader(ConvertingUploader const &) = delete;
+
+			/**
+			 * @brief Deleted copy assignment.
+			 */
+			void operator=(ConvertingUploader const &) = delete;
+
+			/**
+			 * @brief The destructor. Unmaps the staging buffers.
+			 */
+			~ConvertingUploader();
+
+			/**
+			 * @brief Uploads records of 32-bit fields (array of structs) into one buffer per field (struct of arrays)
+			 * and awaits the copies.
+			 * @param records the first record. The fields are the leading 32-bit words of each record.
+			 * @param numRecords the number of records.
+			 * @param recordSizeInBytes the distance of the records in bytes.
+			 * @param fieldBuffers the destination buffer per field.
+			 * @param destinationOffsetInRecords the index of the first destination element of each field buffer.
+			 */
+			[[maybe_unused]] void uploadRecordsAsFieldArrays(
+					const void *records,
+					size_t numRecords,
+					size_t recordSizeInBytes,
+					const std::vector<const BaseBuffer *> &fieldBuffers,
+					size_t destinationOffsetInRecords = 0
+			);
+
+			/**
+			 * @brief Uploads single precision floats as half precision floats and awaits the copies.
+			 * @param source the floats.
+			 * @param numElements the number of floats.
+			 * @param destinationDeviceMemory the buffer of halves to copy to.
+			 * @param destinationOffsetInElements the index of the first destination half.
+			 */
+			[[maybe_unused]] void uploadFloatsAsHalves(
+					const cl_float *source,
+					size_t numElements,
+					const BaseBuffer &destinationDeviceMemory,
+					size_t destinationOffsetInElements = 0
+			);
+
+			/**
+			 * @brief Uploads 32-bit integers as saturated 16-bit integers and awaits the copies.
+			 * @param source the integers.
+			 * @param numElements the number of integers.
+			 * @param destinationDeviceMemory the buffer of 16-bit integers to copy to.
+			 * @param destinationOffsetInElements the index of the first destination integer.
+			 */
+			[[maybe_unused]] void uploadIntegersAsShorts(
+					const cl_int *source,
+					size_t numElements,
+					const BaseBuffer &destinationDeviceMemory,
+					size_t destinationOffsetInElements = 0
+			);
+
+			/**
+			 * @brief Uploads 32-bit integers as saturated 8-bit integers and awaits the copies.
+			 * @param source the integers.
+			 * @param numElements the number of integers.
+			 * @param destinationDeviceMemory the buffer of 8-bit integers to copy to.
+			 * @param destinationOffsetInElements the index of the first destination integer.
+			 */
+			[[maybe_unused]] void uploadIntegersAsChars(
+					const cl_int *source,
+					size_t numElements,
+					const BaseBuffer &destinationDeviceMemory,
+					size_t destinationOffsetInElements = 0
+			);
+
+			/**
+			 * @brief Downloads half precision floats as single precision floats. The download of the next chunk
+			 * overlaps the conversion of the current one.
+			 * @param sourceDeviceMemory the buffer of halves to copy from.
+			 * @param destination the floats.
+			 * @param numElements the number of halves.
+			 * @param sourceOffsetInElements the index of the first source half.
+			 */
+			[[maybe_unused]] void downloadHalvesAsFloats(
+					const BaseBuffer &sourceDeviceMemory,
+					cl_float *destination,
+					size_t numElements,
+					size_t sourceOffsetInElements = 0
+			);
+
+			/**
+			 * @brief Returns the conversions.
+			 * @return the conversions.
+			 */
+			[[maybe_unused]] [[nodiscard]] const LayoutConverter &getConverter() const;
+
+		private:
+			/**
+			 * @brief Converts and uploads elements chunk by chunk and awaits the copies.
+			 * @param numElements the number of elements.
+			 * @param stagedBytesPerElement the number of staged bytes per element.
+			 * @param convertAndCopy converts a chunk given by its first element and its number of elements into the
+			 *                       passed staging memory and enqueues its copies, whose events it appends.
+			 */
+			void upload(
+					size_t numElements,
+					size_t stagedBytesPerElement,
+					const std::function<void(size_t, size_t, char *, std::vector<Event> &)> &convertAndCopy
+			);
+	};
+}
+
+#endif //OPENCL_TOOLKIT_CONVERTING_UPLOADER_H
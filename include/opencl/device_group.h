@@ -0,0 +1,112 @@
+#ifndef OPENCL_TOOLKIT_DEVICE_GROUP_H
+#define OPENCL_TOOLKIT_DEVICE_GROUP_H
+
+#include <memory>
+#include <vector>
+
+#include "portable_opencl_include.h"
+#include "command_queue.h"
+#include "context.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Represents several devices of the same platform sharing one context, with a command queue per device.
+	 * @details Buffers created from the context of the group are allocated once and usable on every device. Before a
+	 * device uses a buffer written by another device, <code>handOff</code> migrates it directly between the devices
+	 * where the runtime supports it, instead of reading it back into host memory and writing it again. The commands of
+	 * the queues are ordered among each other only through hand-offs and migrations with a predecessor.
+	 */
+	class DeviceGroup {
+		private:
+			/**
+			 * The context over all devices.
+			 */
+			Context context_;
+
+			/**
+			 * The command queue per device.
+			 */
+			std::vector<std::unique_ptr<CommandQueue>> commandQueues_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Creates the context and a command queue per device.
+			 * @param devices the devices, at least one, all of the same platform.
+			 */
+			[[maybe_unused]] explicit DeviceGroup(const std::vector<cl_device_id> &devices);
+
+			/**
+			 * @brief Deleted copy constructor.
+			 */
+			DeviceGroup(DeviceGroup const &) = delete;
+
+			/**
+			 * @brief Deleted copy assignment.
+			 */
+			void operator=(DeviceGroup const &) = delete;
+
+			/**
+			 * @brief Returns the context over all devices.
+			 * @return the context over all devices.
+			 */
+			[[maybe_unused]] [[nodiscard]] const Context &getContext() const;
+
+			/**
+			 * @brief Returns the number of devices.
+			 * @return the number of devices.
+			 */
+			[[maybe_unused]] [[nodiscard]] size_t getNumDevices() const;
+
+			/**
+			 * @brief Returns a device.
+			 * @param deviceIndex the index of the device.
+			 * @return the device.
+			 */
+			[[maybe_unused]] [[nodiscard]] cl_device_id getDevice(size_t deviceIndex) const;
+
+			/**
+			 * @brief Returns the command queue of a device.
+			 * @param deviceIndex the index of the device.
+			 * @return the command queue of the device.
+			 */
+			[[maybe_unused]] [[nodiscard]] CommandQueue &getCommandQueue(size_t deviceIndex) const;
+
+			/**
+			 * @brief Enqueues the migration of buffers or images to a device ahead of their use there. The command is
+			 * not awaited.
+			 * @param memoryObjects the buffers or images of the context of the group.
+			 * @param deviceIndex the index of the device which uses them next.
+			 * @param isContentUndefined true if the device overwrites them, so only the allocation is migrated.
+			 */
+			[[maybe_unused]] void migrate(
+					const std::vector<cl_mem> &memoryObjects,
+					size_t deviceIndex,
+					bool isContentUndefined = false
+			);
+
+			/**
+			 * @brief Enqueues the migration of buffers or images from a producing device to a consuming device. The
+			 * migration starts after all commands enqueued so far into the queue of the producer, and the commands
+			 * enqueued afterwards into the queue of the consumer start after the migration. No command is awaited.
+			 * @param memoryObjects the buffers or images of the context of the group.
+			 * @param sourceDeviceIndex the index of the producing device.
+			 * @param destinationDeviceIndex the index of the consuming device.
+			 */
+			[[maybe_unused]] void handOff(
+					const std::vector<cl_mem> &memoryObjects,
+					size_t sourceDeviceIndex,
+					size_t destinationDeviceIndex
+			);
+
+			/**
+			 * @brief Blocks until all previously enqueued commands of all devices have completed.
+			 */
+			[[maybe_unused]] void finish();
+	};
+}
+
+#endif //OPENCL_TOOLKIT_DEVICE_GROUP_H
@@ -0,0 +1,193 @@
+#ifndef OPENCL_TOOLKIT_DEVICE_INFO_H
+#define OPENCL_TOOLKIT_DEVICE_INFO_H
+
+#include <string>
+#include <vector>
+
+#include "portable_opencl_include.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Represents the descriptor of a device, i.e. the device properties which are relevant to choose kernel
+	 * parameters.
+	 * @details The descriptors are queried once per device and cached for the lifetime of the process, because the
+	 * properties of a device never change.
+	 */
+	class DeviceInfo {
+		public:
+			/**
+			 * The name of the device.
+			 */
+			std::string name;
+
+			/**
+			 * The vendor of the device.
+			 */
+			std::string vendor;
+
+			/**
+			 * The OpenCL version supported by the device, e.g. "OpenCL 3.0 ...".
+			 */
+			std::string version;
+
+			/**
+			 * The version of the driver.
+			 */
+			std::string driverVersion;
+
+			/**
+			 * The space separated list of the supported extensions.
+			 */
+			std::string extensions;
+
+			/**
+			 * The type of the device, e.g. <code>CL_DEVICE_TYPE_GPU</code>.
+			 */
+			cl_device_type type;
+
+			/**
+			 * The number of compute units.
+			 */
+			cl_uint maxComputeUnits;
+
+			/**
+			 * The max number of work items of a work group.
+			 */
+			size_t maxWorkGroupSize;
+
+			/**
+			 * The max number of work items of a work group per dimension.
+			 */
+			std::vector<size_t> maxWorkItemSizes;
+
+			/**
+			 * The size of the global memory in bytes.
+			 */
+			cl_ulong globalMemorySize;
+
+			/**
+			 * The max size of a single memory allocation in bytes.
+			 */
+			cl_ulong maxMemoryAllocationSize;
+
+			/**
+			 * The size of the local memory in bytes.
+			 */
+			cl_ulong localMemorySize;
+
+			/**
+			 * True if the local memory is dedicated on-chip memory, false if it is emulated in global memory.
+			 */
+			bool hasDedicatedLocalMemory;
+
+			/**
+			 * The size of a global memory cache line in bytes.
+			 */
+			cl_uint globalMemoryCacheLineSize;
+
+			/**
+			 * The preferred vector width for <code>float</code>.
+			 */
+			cl_uint preferredVectorWidthFloat;
+
+			/**
+			 * Whether the device supports images.
+			 */
+			bool hasImageSupport;
+
+			/**
+			 * The max width of 2-D images in pixels, 0 without image support.
+			 */
+			size_t maxImage2DWidth;
+
+			/**
+			 * The max height of 2-D images in pixels, 0 without image support.
+			 */
+			size_t maxImage2DHeight;
+
+			/**
+			 * The max width of 3-D images in pixels, 0 without image support.
+			 */
+			size_t maxImage3DWidth;
+
+			/**
+			 * The max height of 3-D images in pixels, 0 without image support.
+			 */
+			size_t maxImage3DHeight;
+
+			/**
+			 * The max depth of 3-D images in pixels, 0 without image support.
+			 */
+			size_t maxImage3DDepth;
+
+			/**
+			 * The image formats of 2-D images created with <code>CL_MEM_READ_WRITE</code>.
+			 */
+			std::vector<cl_image_format> supportedImageFormats2D;
+
+			/**
+			 * The image formats of 3-D images created with <code>CL_MEM_READ_WRITE</code>.
+			 */
+			std::vector<cl_image_format> supportedImageFormats3D;
+
+			/**
+			 * The shared virtual memory capabilities, 0 for devices before OpenCL 2.0.
+			 */
+			cl_device_svm_capabilities svmCapabilities;
+
+			/**
+			 * Whether the device supports pipes, which OpenCL 2.x requires and OpenCL 3.0 made optional.
+			 */
+			bool hasPipeSupport;
+
+			/**
+			 * The max size of a pipe packet in bytes, 0 without pipe support.
+			 */
+			cl_uint maxPipePacketSize;
+
+		private:
+			/**
+			 * @brief The parametrized constructor. Queries the properties of the passed device.
+			 * @param device the device to be queried.
+			 */
+			explicit DeviceInfo(cl_device_id device);
+
+		public:
+			/**
+			 * @brief Returns the cached descriptor of the passed device. The device is queried at the first call.
+			 * @param device a valid device.
+			 * @return the cached descriptor of the passed device.
+			 */
+			[[maybe_unused]] static const DeviceInfo &get(cl_device_id device);
+
+			/**
+			 * @brief Returns true if the device supports the passed extension.
+			 * @param extension the name of the extension, e.g. <code>cl_khr_fp16</code>.
+			 * @return true if the device supports the passed extension.
+			 */
+			[[maybe_unused]] [[nodiscard]] bool hasExtension(const std::string &extension) const;
+
+			/**
+			 * @brief Returns true if the device is a CPU.
+			 * @return true if the device is a CPU.
+			 */
+			[[maybe_unused]] [[nodiscard]] bool isCpu() const;
+
+			/**
+			 * @brief Returns whether the passed image format is supported for images of the passed type.
+			 * @param format the channel order and data type.
+			 * @param imageType <code>CL_MEM_OBJECT_IMAGE2D</code> or <code>CL_MEM_OBJECT_IMAGE3D</code>.
+			 * @return whether the passed image format is supported.
+			 */
+			[[maybe_unused]] [[nodiscard]] bool isImageFormatSupported(
+					const cl_image_format &format,
+					cl_mem_object_type imageType
+			) const;
+	};
+}
+
+#endif //OPENCL_TOOLKIT_DEVICE_INFO_H
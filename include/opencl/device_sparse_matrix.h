@@ -0,0 +1,126 @@
+#ifndef OPENCL_TOOLKIT_DEVICE_SPARSE_MATRIX_H
+#define OPENCL_TOOLKIT_DEVICE_SPARSE_MATRIX_H
+
+#include <memory>
+
+#include "portable_opencl_include.h"
+#include "command_queue.h"
+#include "program.h"
+#include "read_write_buffer.h"
+#include "sparse_matrix.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Represents a sparse matrix in device memory which is multiplied with dense vectors: y = A * x.
+	 * @details The matrix is uploaded once in the format chosen at construction. Rows of similar length are stored in
+	 * the sliced ELLPACK format with coalesced loads and no reductions. Load-imbalanced matrices such as power-law
+	 * graphs stay in the CSR format and are processed by a vector of work items per row, whose size follows the mean
+	 * row length. An instance must not be used by several threads at the same time.
+	 */
+	class DeviceSparseMatrix {
+		private:
+			/**
+			 * The command queue which executes the multiplications.
+			 */
+			CommandQueue &commandQueue_;
+
+			/**
+			 * The storage format of the matrix.
+			 */
+			SparseFormat format_;
+
+			/**
+			 * The number of rows.
+			 */
+			size_t numRows_;
+
+			/**
+			 * The number of columns.
+			 */
+			size_t numColumns_;
+
+			/**
+			 * The row offsets (CSR) or slice offsets (sliced ELLPACK).
+			 */
+			std::unique_ptr<ReadWriteBuffer> offsets_;
+
+			/**
+			 * The row lengths (sliced ELLPACK only).
+			 */
+			std::unique_ptr<ReadWriteBuffer> rowLengths_;
+
+			/**
+			 * The column indices of the stored elements.
+			 */
+			std::unique_ptr<ReadWriteBuffer> columnIndices_;
+
+			/**
+			 * The values of the stored elements.
+			 */
+			std::unique_ptr<ReadWriteBuffer> values_;
+
+			/**
+			 * The kernel of the storage format.
+			 */
+			std::unique_ptr<Program> kernel_;
+
+			/**
+			 * The number of work items per row of the CSR vector kernel, 1 for the other kernels.
+			 */
+			size_t vectorSize_;
+
+			/**
+			 * The number of threads per work group.
+			 */
+			size_t workGroupSize_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Converts the passed matrix if required and uploads it.
+			 * @param context a valid OpenCL-context.
+			 * @param device the target device.
+			 * @param commandQueue the command queue of the target device which outlives the current instance.
+			 * @param matrix a valid matrix with less than 2^32 rows.
+			 * @param format the storage format, chosen from the row length statistics if
+			 *               <code>SparseFormat::Automatic</code>.
+			 */
+			[[maybe_unused]] DeviceSparseMatrix(
+					const Context &context,
+					cl_device_id device,
+					CommandQueue &commandQueue,
+					const CsrMatrix &matrix,
+					SparseFormat format = SparseFormat::Automatic
+			);
+
+			/**
+			 * @brief Enqueues y = A * x.
+			 * @param x the dense input vector of <code>numColumns</code> floats.
+			 * @param y the dense output vector of <code>numRows</code> floats, must not alias x.
+			 */
+			[[maybe_unused]] void multiply(const BaseBuffer &x, const BaseBuffer &y);
+
+			/**
+			 * @brief Returns the storage format of the matrix.
+			 * @return the storage format of the matrix.
+			 */
+			[[maybe_unused]] [[nodiscard]] SparseFormat getFormat() const;
+
+			/**
+			 * @brief Returns the number of rows.
+			 * @return the number of rows.
+			 */
+			[[maybe_unused]] [[nodiscard]] size_t getNumRows() const;
+
+			/**
+			 * @brief Returns the number of columns.
+			 * @return the number of columns.
+			 */
+			[[maybe_unused]] [[nodiscard]] size_t getNumColumns() const;
+	};
+}
+
+#endif //OPENCL_TOOLKIT_DEVICE_SPARSE_MATRIX_H
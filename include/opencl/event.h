@@ -0,0 +1,65 @@
+#ifndef OPENCL_TOOLKIT_EVENT_H
+#define OPENCL_TOOLKIT_EVENT_H
+
+#include "portable_opencl_include.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Represents the completion of an enqueued command.
+	 */
+	class Event {
+		private:
+			/**
+			 * The event, nullptr after a move.
+			 */
+			cl_event self_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Takes over the passed event.
+			 * @param event an event returned by an enqueue function.
+			 */
+			[[maybe_unused]] explicit Event(cl_event event);
+
+			/**
+			 * @brief The move constructor.
+			 * @param other the event to be taken over.
+			 */
+			Event(Event &&other) noexcept;
+
+			/**
+			 * @brief Deleted copy constructor.
+			 */
+			Event(Event const &) = delete;
+
+			/**
+			 * @brief Deleted copy assignment.
+			 */
+			void operator=(Event const &) = delete;
+
+			/**
+			 * @brief The destructor. Releases the event; the command is not affected.
+			 */
+			~Event();
+
+			/**
+			 * @brief Blocks until the command has completed.
+			 */
+			[[maybe_unused]] void wait() const;
+
+			/**
+			 * @brief Returns the execution status of the command.
+			 * @return <code>CL_QUEUED</code>, <code>CL_SUBMITTED</code>, <code>CL_RUNNING</code>,
+			 *         <code>CL_COMPLETE</code> or a negative error code if the command failed.
+			 */
+			[[maybe_unused]] [[nodiscard]] cl_int getExecutionStatus() const;
+
+			operator cl_event() const; // NOLINT(google-explicit-constructor)
+	};
+}
+
+#endif //OPENCL_TOOLKIT_EVENT_H
@@ -0,0 +1,127 @@
+#ifndef OPENCL_TOOLKIT_EVICTABLE_BUFFER_H
+#define OPENCL_TOOLKIT_EVICTABLE_BUFFER_H
+
+#include <memory>
+#include <vector>
+
+#include "portable_opencl_include.h"
+#include "command_queue.h"
+#include "context.h"
+#include "read_write_buffer.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Represents a read-write buffer which the memory manager may evict to host memory under memory pressure
+	 * and which is restored on its next use.
+	 * @details The device buffer is only valid while the pointer returned by <code>acquire</code> is held; it cannot
+	 * be evicted meanwhile. Evictions and restorations are ordered on the command queue of the buffer and run without
+	 * the lock of the memory manager, so they do not stall the allocations of other threads.
+	 */
+	class EvictableBuffer {
+		friend class MemoryManager;
+
+		private:
+			/**
+			 * The context of the buffer.
+			 */
+			const Context &context_;
+
+			/**
+			 * The command queue which evicts and restores the buffer.
+			 */
+			CommandQueue &commandQueue_;
+
+			/**
+			 * The size of the buffer in bytes.
+			 */
+			size_t sizeInBytes_;
+
+			/**
+			 * The device buffer, nullptr while evicted.
+			 */
+			std::shared_ptr<ReadWriteBuffer> deviceBuffer_;
+
+			/**
+			 * The content while evicted.
+			 */
+			std::vector<unsigned char> hostCopy_;
+
+			/**
+			 * True while the buffer is evicted or restored outside the lock of the memory manager. Guarded by the
+			 * lock of the memory manager.
+			 */
+			bool isMoving_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Allocates the device buffer, whose content is undefined.
+			 * @param context a valid OpenCL-context which outlives the current instance.
+			 * @param commandQueue the command queue which evicts and restores the buffer and outlives the current
+			 *                     instance.
+			 * @param sizeInBytes the size of the buffer in bytes.
+			 */
+			[[maybe_unused]] EvictableBuffer(const Context &context, CommandQueue &commandQueue, size_t sizeInBytes);
+
+			/**
+			 * @brief Deleted copy constructor.
+			 */
+			EvictableBuffer(EvictableBuffer const &) = delete;
+
+			/**
+			 * @brief Deleted copy assignment.
+			 */
+			void operator=(EvictableBuffer const &) = delete;
+
+			/**
+			 * @brief The destructor. Releases the buffer.
+			 */
+			~EvictableBuffer();
+
+			/**
+			 * @brief Returns the device buffer, restoring it if it was evicted. It cannot be evicted while the returned
+			 * pointer or a copy of it is held.
+			 * @return the device buffer.
+			 */
+			[[maybe_unused]] std::shared_ptr<ReadWriteBuffer> acquire();
+
+			/**
+			 * @brief Returns whether the buffer is in device memory.
+			 * @return whether the buffer is in device memory.
+			 */
+			[[maybe_unused]] [[nodiscard]] bool isResident() const;
+
+			/**
+			 * @brief Returns the size of the buffer in bytes.
+			 * @return the size of the buffer in bytes.
+			 */
+			[[maybe_unused]] [[nodiscard]] size_t getSizeInBytes() const;
+
+		private:
+			/**
+			 * @brief Starts the eviction of the buffer if it is resident, not acquired and not moving. Marks the
+			 * buffer as moving and hands over the device buffer. The lock of the memory manager must be held.
+			 * @return the device buffer to be copied by <code>copyToHost</code>, nullptr if the buffer is not evicted.
+			 */
+			std::shared_ptr<ReadWriteBuffer> beginEviction();
+
+			/**
+			 * @brief Copies the passed device buffer into the host copy. Called without the lock of the memory
+			 * manager while the buffer is moving.
+			 * @param deviceBuffer the device buffer handed over by <code>beginEviction</code>.
+			 */
+			void copyToHost(const ReadWriteBuffer &deviceBuffer);
+
+			/**
+			 * @brief Allocates a device buffer and copies the host copy back. Called without the lock of the memory
+			 * manager while the buffer is moving.
+			 * @return the restored device buffer.
+			 */
+			std::shared_ptr<ReadWriteBuffer> restore();
+	};
+}
+
+#endif //OPENCL_TOOLKIT_EVICTABLE_BUFFER_H
@@ -0,0 +1,113 @@
+#ifndef OPENCL_TOOLKIT_EXECUTOR_H
+#define OPENCL_TOOLKIT_EXECUTOR_H
+
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Resumes coroutines whose awaited device commands have completed.
+	 */
+	class Executor {
+		public:
+			/**
+			 * @brief The destructor.
+			 */
+			virtual ~Executor() = default;
+
+			/**
+			 * @brief Resumes the passed coroutine now or later, on the current or another thread.
+			 * @param coroutine the suspended coroutine.
+			 */
+			virtual void execute(std::coroutine_handle<> coroutine) = 0;
+	};
+
+	/**
+	 * @brief Resumes coroutines immediately on the calling thread. For completion callbacks this is a thread of the
+	 * OpenCL runtime, where blocking OpenCL calls are undefined behavior. The resumed coroutine may therefore only run
+	 * non-blocking code until its next suspension, e.g. no blocking copies, <code>finish</code> or waits for events,
+	 * and should be short since it delays the callbacks of other commands.
+	 */
+	class InlineExecutor : public Executor {
+		public:
+			/**
+			 * @brief Returns the single instance.
+			 * @return the single instance.
+			 */
+			[[maybe_unused]] static InlineExecutor &getInstance();
+
+			void execute(std::coroutine_handle<> coroutine) override;
+	};
+
+	/**
+	 * @brief Resumes coroutines on a fixed number of worker threads in the order of their completion.
+	 */
+	class ThreadPoolExecutor : public Executor {
+		private:
+			/**
+			 * Guards the queue and the stop flag.
+			 */
+			std::mutex mutex_;
+
+			/**
+			 * Signals new coroutines and the stop.
+			 */
+			std::condition_variable condition_;
+
+			/**
+			 * The coroutines waiting for a worker thread.
+			 */
+			std::deque<std::coroutine_handle<>> queue_;
+
+			/**
+			 * Whether the worker threads stop.
+			 */
+			bool isStopping_;
+
+			/**
+			 * The worker threads.
+			 */
+			std::vector<std::thread> threads_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Starts the worker threads.
+			 * @param numThreads the number of worker threads, the number of hardware threads by default.
+			 */
+			[[maybe_unused]] explicit ThreadPoolExecutor(size_t numThreads = std::thread::hardware_concurrency());
+
+			/**
+			 * @brief Deleted copy constructor.
+			 */
+			ThreadPoolExecutor(ThreadPoolExecutor const &) = delete;
+
+			/**
+			 * @brief Deleted copy assignment.
+			 */
+			void operator=(ThreadPoolExecutor const &) = delete;
+
+			/**
+			 * @brief The destructor. Resumes the queued coroutines and joins the worker threads. No coroutine may be
+			 * awaiting a command which resumes on the current instance anymore.
+			 */
+			~ThreadPoolExecutor() override;
+
+			void execute(std::coroutine_handle<> coroutine) override;
+
+		private:
+			/**
+			 * @brief Resumes queued coroutines until the stop.
+			 */
+			void work();
+	};
+}
+
+#endif //OPENCL_TOOLKIT_EXECUTOR_H
@@ -0,0 +1,647 @@
+#ifndef OPENCL_TOOLKIT_EXPRESSION_H
+#define OPENCL_TOOLKIT_EXPRESSION_H
+
+#include <algorithm>
+#include <concepts>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+
+#include "portable_opencl_include.h"
+#include "base_buffer.h"
+#include "command_queue.h"
+#include "context.h"
+#include "program.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Maps the element types of expressions to their OpenCL C names.
+	 * @tparam T the element type.
+	 */
+	template<typename T>
+	struct ExpressionTypeTraits;
+
+	template<>
+	struct ExpressionTypeTraits<cl_float> {
+		static constexpr const char *name = "float";
+	};
+
+	template<>
+	struct ExpressionTypeTraits<cl_double> {
+		static constexpr const char *name = "double";
+	};
+
+	template<>
+	struct ExpressionTypeTraits<cl_int> {
+		static constexpr const char *name = "int";
+	};
+
+	template<>
+	struct ExpressionTypeTraits<cl_uint> {
+		static constexpr const char *name = "uint";
+	};
+
+	/**
+	 * @brief An element-wise expression which can be fused into one kernel. The generated code only depends on the
+	 * type of the expression: buffers and scalars become kernel arguments, numbered in the order of the traversal.
+	 */
+	template<typename E>
+	concept DeviceExpression = requires(const E &expression, Program &kernel, cl_uint &argIndex, std::string &code) {
+		typename E::ValueType;
+		{ E::emit(code, argIndex) } -> std::same_as<std::string>;
+		expression.bind(kernel, argIndex);
+		{ expression.size() } -> std::convertible_to<size_t>;
+	};
+
+	/**
+	 * @brief The elements of a device buffer as the leaf of an expression.
+	 * @tparam T the element type.
+	 */
+	template<typename T>
+	class BufferExpression {
+		private:
+			/**
+			 * The device buffer.
+			 */
+			const BaseBuffer *buffer_;
+
+			/**
+			 * The number of elements.
+			 */
+			size_t size_;
+
+		public:
+			/**
+			 * The element type.
+			 */
+			using ValueType = T;
+
+			/**
+			 * @brief The parametrized constructor.
+			 * @param buffer the device buffer which outlives the evaluation of the expression.
+			 * @param size the number of elements.
+			 */
+			[[maybe_unused]] BufferExpression(const BaseBuffer &buffer, const size_t size) : buffer_(&buffer), size_(size) {}
+
+			/**
+			 * @brief Appends the kernel parameter of the buffer and returns the code which reads the current element.
+			 * @param parameters the parameter list to be extended.
+			 * @param argIndex the index of the next kernel argument, incremented.
+			 * @return the code of the expression.
+			 */
+			static std::string emit(std::string &parameters, cl_uint &argIndex) {
+				const std::string name = "a" + std::to_string(argIndex++);
+				parameters += std::string(",\n\t\t__global const ") + ExpressionTypeTraits<T>::name + " *restrict " + name;
+				return name + "[i]";
+			}
+
+			/**
+			 * @brief Sets the buffer as the next kernel argument.
+			 * @param kernel the fused kernel.
+			 * @param argIndex the index of the next kernel argument, incremented.
+			 */
+			void bind(Program &kernel, cl_uint &argIndex) const {
+				kernel.setKernelArg(argIndex++, sizeof(cl_mem), *buffer_);
+			}
+
+			/**
+			 * @brief Returns the number of elements.
+			 * @return the number of elements.
+			 */
+			[[nodiscard]] size_t size() const {
+				return size_;
+			}
+	};
+
+	/**
+	 * @brief A scalar broadcast to all elements of an expression.
+	 * @tparam T the element type.
+	 */
+	template<typename T>
+	class ScalarExpression {
+		private:
+			/**
+			 * The value.
+			 */
+			T value_;
+
+		public:
+			/**
+			 * The element type.
+			 */
+			using ValueType = T;
+
+			/**
+			 * @brief The parametrized constructor.
+			 * @param value the value.
+			 */
+			explicit ScalarExpression(const T value) : value_(value) {}
+
+			/**
+			 * @brief Appends the kernel parameter of the scalar and returns its name.
+			 * @param parameters the parameter list to be extended.
+			 * @param argIndex the index of the next kernel argument, incremented.
+			 * @return the code of the expression.
+			 */
+			static std::string emit(std::string &parameters, cl_uint &argIndex) {
+				const std::string name = "a" + std::to_string(argIndex++);
+				parameters += std::string(",\n\t\tconst ") + ExpressionTypeTraits<T>::name + " " + name;
+				return name;
+			}
+
+			/**
+			 * @brief Sets the value as the next kernel argument.
+			 * @param kernel the fused kernel.
+			 * @param argIndex the index of the next kernel argument, incremented.
+			 */
+			void bind(Program &kernel, cl_uint &argIndex) const {
+				kernel.setKernelArg(argIndex++, sizeof(T), &value_);
+			}
+
+			/**
+			 * @brief Returns 0, since a scalar adapts to the size of the other operands.
+			 * @return 0.
+			 */
+			[[nodiscard]] size_t size() const {
+				return 0;
+			}
+	};
+
+	/**
+	 * @brief An element-wise operation of two expressions.
+	 * @tparam Operation provides <code>apply(left, right)</code> which combines the code of the operands.
+	 * @tparam L the type of the left operand.
+	 * @tparam R the type of the right operand.
+	 */
+	template<typename Operation, DeviceExpression L, DeviceExpression R>
+	class BinaryExpression {
+		private:
+			/**
+			 * The left operand.
+			 */
+			L left_;
+
+			/**
+			 * The right operand.
+			 */
+			R right_;
+
+		public:
+			/**
+			 * The element type.
+			 */
+			using ValueType = typename L::ValueType;
+
+			/**
+			 * @brief The parametrized constructor.
+			 * @param left the left operand.
+			 * @param right the right operand.
+			 */
+			BinaryExpression(const L &left, const R &right) : left_(left), right_(right) {}
+
+			/**
+			 * @brief Appends the kernel parameters of the operands and returns the code of the operation.
+			 * @param parameters the parameter list to be extended.
+			 * @param argIndex the index of the next kernel argument, incremented.
+			 * @return the code of the expression.
+			 */
+			static std::string emit(std::string &parameters, cl_uint &argIndex) {
+				// the operands are emitted in separate statements, since the evaluation order of arguments is unspecified
+				const std::string left = L::emit(parameters, argIndex);
+				const std::string right = R::emit(parameters, argIndex);
+				return Operation::apply(left, right);
+			}
+
+			/**
+			 * @brief Sets the kernel arguments of the operands.
+			 * @param kernel the fused kernel.
+			 * @param argIndex the index of the next kernel argument, incremented.
+			 */
+			void bind(Program &kernel, cl_uint &argIndex) const {
+				left_.bind(kernel, argIndex);
+				right_.bind(kernel, argIndex);
+			}
+
+			/**
+			 * @brief Returns the number of elements.
+			 * @return the number of elements, 0 if both operands are scalars.
+			 */
+			[[nodiscard]] size_t size() const {
+				const size_t left = left_.size();
+				const size_t right = right_.size();
+				if (left && right && left != right) {
+					// let it crash
+					throw std::runtime_error("Failed to combine expressions: the operands differ in size");
+				}
+				return std::max(left, right);
+			}
+	};
+
+	/**
+	 * @brief An element-wise function of an expression.
+	 * @tparam Function provides <code>apply(argument)</code> which wraps the code of the argument.
+	 * @tparam A the type of the argument.
+	 */
+	template<typename Function, DeviceExpression A>
+	class UnaryExpression {
+		private:
+			/**
+			 * The argument.
+			 */
+			A argument_;
+
+		public:
+			/**
+			 * The element type.
+			 */
+			using ValueType = typename A::ValueType;
+
+			/**
+			 * @brief The parametrized constructor.
+			 * @param argument the argument.
+			 */
+			explicit UnaryExpression(const A &argument) : argument_(argument) {}
+
+			/**
+			 * @brief Appends the kernel parameters of the argument and returns the code of the function.
+			 * @param parameters the parameter list to be extended.
+			 * @param argIndex the index of the next kernel argument, incremented.
+			 * @return the code of the expression.
+			 */
+			static std::string emit(std::string &parameters, cl_uint &argIndex) {
+				return Function::apply(A::emit(parameters, argIndex));
+			}
+
+			/**
+			 * @brief Sets the kernel arguments of the argument.
+			 * @param kernel the fused kernel.
+			 * @param argIndex the index of the next kernel argument, incremented.
+			 */
+			void bind(Program &kernel, cl_uint &argIndex) const {
+				argument_.bind(kernel, argIndex);
+			}
+
+			/**
+			 * @brief Returns the number of elements.
+			 * @return the number of elements, 0 if the argument is a scalar.
+			 */
+			[[nodiscard]] size_t size() const {
+				return argument_.size();
+			}
+	};
+
+	/**
+	 * @brief The code generators of the operations and functions. Each type is part of the expression type and thus of
+	 * the key of the cached kernels.
+	 */
+	namespace ExpressionOperations {
+		/**
+		 * @brief Generates the sum.
+		 */
+		struct Add {
+			static std::string apply(const std::string &left, const std::string &right) {
+				return "(" + left + " + " + right + ")";
+			}
+		};
+
+		/**
+		 * @brief Generates the difference.
+		 */
+		struct Subtract {
+			static std::string apply(const std::string &left, const std::string &right) {
+				return "(" + left + " - " + right + ")";
+			}
+		};
+
+		/**
+		 * @brief Generates the product.
+		 */
+		struct Multiply {
+			static std::string apply(const std::string &left, const std::string &right) {
+				return "(" + left + " * " + right + ")";
+			}
+		};
+
+		/**
+		 * @brief Generates the quotient.
+		 */
+		struct Divide {
+			static std::string apply(const std::string &left, const std::string &right) {
+				return "(" + left + " / " + right + ")";
+			}
+		};
+
+		/**
+		 * @brief Generates the minimum.
+		 */
+		struct Minimum {
+			static std::string apply(const std::string &left, const std::string &right) {
+				return "min(" + left + ", " + right + ")";
+			}
+		};
+
+		/**
+		 * @brief Generates the maximum.
+		 */
+		struct Maximum {
+			static std::string apply(const std::string &left, const std::string &right) {
+				return "max(" + left + ", " + right + ")";
+			}
+		};
+
+		/**
+		 * @brief Generates the negation.
+		 */
+		struct Negate {
+			static std::string apply(const std::string &argument) {
+				return "(-" + argument + ")";
+			}
+		};
+
+		/**
+		 * @brief A built-in function of OpenCL C with one argument.
+		 * @tparam name the name of the function.
+		 */
+		template<const char *name>
+		struct BuiltIn {
+			static std::string apply(const std::string &argument) {
+				return std::string(name) + "(" + argument + ")";
+			}
+		};
+
+		/**
+		 * The names of the supported built-in functions.
+		 */
+		inline constexpr char exp[] = "exp";
+		inline constexpr char log[] = "log";
+		inline constexpr char sqrt[] = "sqrt";
+		inline constexpr char sin[] = "sin";
+		inline constexpr char cos[] = "cos";
+		inline constexpr char tanh[] = "tanh";
+		inline constexpr char fabs[] = "fabs";
+	}
+
+	/**
+	 * @brief Two operands of which at least one is an expression, while the other one is an expression of the same
+	 * element type or an arithmetic scalar.
+	 */
+	template<typename L, typename R>
+	concept FusableOperands =
+			(DeviceExpression<L> && DeviceExpression<R> && std::same_as<typename L::ValueType, typename R::ValueType>)
+			|| (DeviceExpression<L> && std::is_arithmetic_v<R>)
+			|| (std::is_arithmetic_v<L> && DeviceExpression<R>);
+
+	/**
+	 * @brief Returns an operand as an expression, converting scalars to the passed element type.
+	 * @tparam V the element type.
+	 * @tparam X the type of the operand.
+	 * @param operand the operand.
+	 * @return the expression of the operand.
+	 */
+	template<typename V, typename X>
+	auto toExpression(const X &operand) {
+		if constexpr (DeviceExpression<X>) {
+			return operand;
+		} else {
+			return ScalarExpression<V>(static_cast<V>(operand));
+		}
+	}
+
+	/**
+	 * @brief Combines two operands by an element-wise operation.
+	 * @tparam Operation the operation.
+	 * @param left the left operand.
+	 * @param right the right operand.
+	 * @return the expression of the operation.
+	 */
+	template<typename Operation, typename L, typename R>
+	auto combine(const L &left, const R &right) {
+		using V = typename std::conditional_t<DeviceExpression<L>, L, R>::ValueType;
+		using LeftExpression = decltype(toExpression<V>(left));
+		using RightExpression = decltype(toExpression<V>(right));
+		return BinaryExpression<Operation, LeftExpression, RightExpression>(
+				toExpression<V>(left),
+				toExpression<V>(right)
+		);
+	}
+
+	template<typename L, typename R> requires FusableOperands<L, R>
+	[[maybe_unused]] auto operator+(const L &left, const R &right) {
+		return combine<ExpressionOperations::Add>(left, right);
+	}
+
+	template<typename L, typename R> requires FusableOperands<L, R>
+	[[maybe_unused]] auto operator-(const L &left, const R &right) {
+		return combine<ExpressionOperations::Subtract>(left, right);
+	}
+
+	template<typename L, typename R> requires FusableOperands<L, R>
+	[[maybe_unused]] auto operator*(const L &left, const R &right) {
+		return combine<ExpressionOperations::Multiply>(left, right);
+	}
+
+	template<typename L, typename R> requires FusableOperands<L, R>
+	[[maybe_unused]] auto operator/(const L &left, const R &right) {
+		return combine<ExpressionOperations::Divide>(left, right);
+	}
+
+	template<typename L, typename R> requires FusableOperands<L, R>
+	[[maybe_unused]] auto min(const L &left, const R &right) {
+		return combine<ExpressionOperations::Minimum>(left, right);
+	}
+
+	template<typename L, typename R> requires FusableOperands<L, R>
+	[[maybe_unused]] auto max(const L &left, const R &right) {
+		return combine<ExpressionOperations::Maximum>(left, right);
+	}
+
+	template<DeviceExpression A>
+	[[maybe_unused]] auto operator-(const A &argument) {
+		return UnaryExpression<ExpressionOperations::Negate, A>(argument);
+	}
+
+	/**
+	 * An expression of a floating-point element type, the argument type of the built-in math functions.
+	 */
+	template<typename A>
+	concept FloatingPointExpression = DeviceExpression<A> && std::is_floating_point_v<typename A::ValueType>;
+
+	template<FloatingPointExpression A>
+	[[maybe_unused]] auto exp(const A &argument) {
+		return UnaryExpression<ExpressionOperations::BuiltIn<ExpressionOperations::exp>, A>(argument);
+	}
+
+	template<FloatingPointExpression A>
+	[[maybe_unused]] auto log(const A &argument) {
+		return UnaryExpression<ExpressionOperations::BuiltIn<ExpressionOperations::log>, A>(argument);
+	}
+
+	template<FloatingPointExpression A>
+	[[maybe_unused]] auto sqrt(const A &argument) {
+		return UnaryExpression<ExpressionOperations::BuiltIn<ExpressionOperations::sqrt>, A>(argument);
+	}
+
+	template<FloatingPointExpression A>
+	[[maybe_unused]] auto sin(const A &argument) {
+		return UnaryExpression<ExpressionOperations::BuiltIn<ExpressionOperations::sin>, A>(argument);
+	}
+
+	template<FloatingPointExpression A>
+	[[maybe_unused]] auto cos(const A &argument) {
+		return UnaryExpression<ExpressionOperations::BuiltIn<ExpressionOperations::cos>, A>(argument);
+	}
+
+	template<FloatingPointExpression A>
+	[[maybe_unused]] auto tanh(const A &argument) {
+		return UnaryExpression<ExpressionOperations::BuiltIn<ExpressionOperations::tanh>, A>(argument);
+	}
+
+	template<FloatingPointExpression A>
+	[[maybe_unused]] auto fabs(const A &argument) {
+		return UnaryExpression<ExpressionOperations::BuiltIn<ExpressionOperations::fabs>, A>(argument);
+	}
+
+	/**
+	 * @brief Evaluates element-wise expressions of device buffers by one fused kernel each, e.g.
+	 * <code>evaluator.assign(z, exp(a * x + b) * w)</code>, without intermediate buffers.
+	 * @details The kernel source is generated once per expression type and the kernel is built through the program
+	 * registry, so the build is shared by all evaluators of the same context and device. An instance keeps one kernel
+	 * per expression type and must not be used by several threads at the same time.
+	 */
+	class ExpressionEvaluator {
+		private:
+			/**
+			 * @brief A fused kernel and its launch configuration.
+			 */
+			struct FusedKernel {
+				/**
+				 * The kernel.
+				 */
+				std::unique_ptr<Program> kernel;
+
+				/**
+				 * The number of threads per work group.
+				 */
+				size_t workGroupSize;
+			};
+
+			/**
+			 * The context of the device buffers.
+			 */
+			const Context &context_;
+
+			/**
+			 * The target device.
+			 */
+			cl_device_id device_;
+
+			/**
+			 * The command queue which executes the kernels.
+			 */
+			CommandQueue &commandQueue_;
+
+			/**
+			 * The fused kernels per expression type.
+			 */
+			std::map<std::type_index, FusedKernel> kernels_;
+
+		public:
+			/**
+			 * The name of the generated kernels.
+			 */
+			static constexpr const char *kernelName = "fusedElementWise";
+
+			/**
+			 * @brief The parametrized constructor.
+			 * @param context a valid OpenCL-context which outlives the current instance.
+			 * @param device the target device.
+			 * @param commandQueue the command queue of the target device which outlives the current instance.
+			 */
+			[[maybe_unused]] ExpressionEvaluator(const Context &context, cl_device_id device, CommandQueue &commandQueue);
+
+			/**
+			 * @brief Deleted copy constructor.
+			 */
+			ExpressionEvaluator(ExpressionEvaluator const &) = delete;
+
+			/**
+			 * @brief Deleted copy assignment.
+			 */
+			void operator=(ExpressionEvaluator const &) = delete;
+
+			/**
+			 * @brief Enqueues the fused kernel which writes the elements of the passed expression into the output. The
+			 * output may be one of the operands, since every element only depends on the operands at its index.
+			 * @param output the buffer receiving as many elements of the element type as the expression has.
+			 * @param expression the expression, containing at least one buffer.
+			 */
+			template<DeviceExpression E>
+			[[maybe_unused]] void assign(const BaseBuffer &output, const E &expression) {
+				const size_t numElements = expression.size();
+				if (!numElements) {
+					// let it crash
+					throw std::runtime_error("Failed to evaluate expression: it contains no buffer");
+				}
+				FusedKernel &fusedKernel = acquireKernel(typeid(E), getSourceCode<E>());
+				const cl_ulong n = numElements;
+				cl_uint argIndex = 0;
+				fusedKernel.kernel->setKernelArg(argIndex++, sizeof(cl_mem), output);
+				fusedKernel.kernel->setKernelArg(argIndex++, sizeof(cl_ulong), &n);
+				expression.bind(*fusedKernel.kernel, argIndex);
+				launch(fusedKernel, numElements);
+			}
+
+			/**
+			 * @brief Returns the kernel source generated for an expression type.
+			 * @return the kernel source.
+			 */
+			template<DeviceExpression E>
+			[[maybe_unused]] static const std::string &getSourceCode() {
+				static const std::string sourceCode = [] {
+					std::string parameters;
+					cl_uint argIndex = 2;
+					const std::string body = E::emit(parameters, argIndex);
+					return composeSourceCode(ExpressionTypeTraits<typename E::ValueType>::name, parameters, body);
+				}();
+				return sourceCode;
+			}
+
+		private:
+			/**
+			 * @brief Returns the kernel of an expression type, building it on first use.
+			 * @param expressionType the expression type.
+			 * @param sourceCode the kernel source of the expression type.
+			 * @return the kernel.
+			 */
+			FusedKernel &acquireKernel(std::type_index expressionType, const std::string &sourceCode);
+
+			/**
+			 * @brief Enqueues a kernel with one thread per element.
+			 * @param fusedKernel the kernel whose arguments are set.
+			 * @param numElements the number of elements.
+			 */
+			void launch(const FusedKernel &fusedKernel, size_t numElements);
+
+			/**
+			 * @brief Returns the source of a fused kernel.
+			 * @param typeName the OpenCL C name of the element type.
+			 * @param parameters the parameters of the operands, each preceded by a comma.
+			 * @param body the code of the expression for the element at index <code>i</code>.
+			 * @return the kernel source.
+			 */
+			static std::string composeSourceCode(
+					const std::string &typeName,
+					const std::string &parameters,
+					const std::string &body
+			);
+	};
+}
+
+#endif //OPENCL_TOOLKIT_EXPRESSION_H
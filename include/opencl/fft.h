@@ -0,0 +1,169 @@
+#ifndef OPENCL_TOOLKIT_FFT_H
+#define OPENCL_TOOLKIT_FFT_H
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "portable_opencl_include.h"
+#include "command_queue.h"
+#include "nd_range.h"
+#include "program.h"
+#include "read_write_buffer.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Represents a plan of batched 1-D or 2-D fast Fourier transforms of interleaved complex floats in device
+	 * memory.
+	 * @details The transforms run as radix-8, radix-4 and radix-2 Stockham passes which ping-pong between the data and a
+	 * scratch buffer of the plan. 2-D transforms transform the rows and then the columns with strided accesses, so no
+	 * transposition is required. The kernels are shared by all plans through the program registry, and the twiddle
+	 * tables are shared by all plans of the same context and length. An instance must not be used by several threads
+	 * at the same time.
+	 */
+	class FftPlan {
+		private:
+			/**
+			 * @brief Represents a pass over all transforms of one dimension.
+			 */
+			struct Pass {
+				/**
+				 * The kernel of the radix of the pass.
+				 */
+				Program *kernel;
+
+				/**
+				 * The twiddle table of the transform length.
+				 */
+				const ReadWriteBuffer *twiddles;
+
+				/**
+				 * The transform length.
+				 */
+				cl_uint length;
+
+				/**
+				 * The length of the sub-transforms before the pass.
+				 */
+				cl_uint subTransformLength;
+
+				/**
+				 * The radix of the pass.
+				 */
+				cl_uint radix;
+
+				/**
+				 * The index of the dimension whose transforms are computed.
+				 */
+				cl_uint dimension;
+			};
+
+			/**
+			 * The command queue which executes the transforms.
+			 */
+			CommandQueue &commandQueue_;
+
+			/**
+			 * The transform size, the first dimension being contiguous.
+			 */
+			NDRange size_;
+
+			/**
+			 * The number of transforms per batch.
+			 */
+			size_t batchSize_;
+
+			/**
+			 * The kernels per radix.
+			 */
+			std::map<cl_uint, std::unique_ptr<Program>> kernels_;
+
+			/**
+			 * The twiddle tables per dimension.
+			 */
+			std::vector<std::shared_ptr<ReadWriteBuffer>> twiddles_;
+
+			/**
+			 * The passes in order of execution.
+			 */
+			std::vector<Pass> passes_;
+
+			/**
+			 * The buffer which receives every other pass.
+			 */
+			ReadWriteBuffer scratch_;
+
+			/**
+			 * The number of threads per work group and dimension.
+			 */
+			size_t workGroupSize_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Builds or reuses the kernels and twiddle tables.
+			 * @param context a valid OpenCL-context.
+			 * @param device the target device.
+			 * @param commandQueue the command queue of the target device which outlives the current instance.
+			 * @param size the transform size with one or two dimensions, each a power of two. The first dimension is
+			 *             contiguous (row-major).
+			 * @param batchSize the number of transforms stored one after the other.
+			 */
+			[[maybe_unused]] FftPlan(
+					const Context &context,
+					cl_device_id device,
+					CommandQueue &commandQueue,
+					const NDRange &size,
+					size_t batchSize = 1
+			);
+
+			/**
+			 * @brief Deleted copy constructor.
+			 */
+			FftPlan(FftPlan const &) = delete;
+
+			/**
+			 * @brief Deleted copy assignment.
+			 */
+			void operator=(FftPlan const &) = delete;
+
+			/**
+			 * @brief Enqueues the forward transforms, X[k] = sum x[m] exp(-2 pi i m k / n), in place.
+			 * @param data the batch of complex floats (<code>cl_float2</code>).
+			 */
+			[[maybe_unused]] void forward(const BaseBuffer &data);
+
+			/**
+			 * @brief Enqueues the inverse transforms, x[m] = sum X[k] exp(2 pi i m k / n), in place. The result is not
+			 * divided by the number of elements.
+			 * @param data the batch of complex floats (<code>cl_float2</code>).
+			 */
+			[[maybe_unused]] void inverse(const BaseBuffer &data);
+
+			/**
+			 * @brief Returns the transform size.
+			 * @return the transform size.
+			 */
+			[[maybe_unused]] [[nodiscard]] const NDRange &getSize() const;
+
+			/**
+			 * @brief Returns the number of transforms per batch.
+			 * @return the number of transforms per batch.
+			 */
+			[[maybe_unused]] [[nodiscard]] size_t getBatchSize() const;
+
+		private:
+			/**
+			 * @brief Enqueues all passes and copies the result back into the data if the last pass wrote the scratch
+			 * buffer.
+			 * @param data the batch of complex floats.
+			 * @param sign 1 for the forward, -1 for the inverse transforms.
+			 */
+			void execute(const BaseBuffer &data, cl_float sign);
+	};
+}
+
+#endif //OPENCL_TOOLKIT_FFT_H
@@ -0,0 +1,178 @@
+#ifndef OPENCL_TOOLKIT_FILE_LOADER_H
+#define OPENCL_TOOLKIT_FILE_LOADER_H
+
+#include <limits>
+#include <string>
+
+#include "portable_opencl_include.h"
+#include "base_buffer.h"
+#include "command_queue.h"
+#include "context.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief The ways of <code>FileLoader</code> to read a file.
+	 */
+	enum class FileLoadStrategy {
+		/**
+		 * Memory-mapped, falling back to staged reads if the file cannot be mapped.
+		 */
+		Automatic,
+
+		/**
+		 * The file is mapped and the device copies straight from the page cache.
+		 */
+		MemoryMapped,
+
+		/**
+		 * The file is read with <code>pread</code> into two pinned staging buffers, one being filled while the other
+		 * is copied to the device.
+		 */
+		StagedRead
+	};
+
+	/**
+	 * @brief Represents the outcome of loading a file.
+	 */
+	struct FileLoadStatistics {
+		/**
+		 * The number of bytes loaded.
+		 */
+		size_t numBytes;
+
+		/**
+		 * The wall time from opening the file until the last byte arrived on the device.
+		 */
+		double seconds;
+
+		/**
+		 * The achieved throughput in 10^6 bytes per second.
+		 */
+		double megabytesPerSecond;
+
+		/**
+		 * Whether the file was memory-mapped rather than read into staging buffers.
+		 */
+		bool isMemoryMapped;
+	};
+
+	/**
+	 * @brief Streams files in chunks into device buffers without copying them into a host container first, so every
+	 * byte is touched once on the host and the peak resident memory stays at a few chunks. The disk readahead of the
+	 * next chunk overlaps the device transfer of the current one. Only POSIX systems are supported.
+	 */
+	class FileLoader {
+		private:
+			/**
+			 * The context of the staging buffers.
+			 */
+			const Context &context_;
+
+			/**
+			 * The command queue which executes the transfers.
+			 */
+			CommandQueue &commandQueue_;
+
+			/**
+			 * The number of bytes per transfer.
+			 */
+			size_t chunkSizeInBytes_;
+
+			/**
+			 * The way to read the files.
+			 */
+			FileLoadStrategy strategy_;
+
+		public:
+			/**
+			 * The default number of bytes per transfer, large enough to reach the peak transfer rate of common
+			 * devices.
+			 */
+			static constexpr size_t defaultChunkSizeInBytes = 16 << 20;
+
+			/**
+			 * The number of bytes meaning "up to the end of the file".
+			 */
+			static constexpr size_t toEndOfFile = std::numeric_limits<size_t>::max();
+
+			/**
+			 * @brief The parametrized constructor.
+			 * @param context a valid OpenCL-context which outlives the current instance.
+			 * @param commandQueue the command queue of the target device which outlives the current instance.
+			 * @param chunkSizeInBytes the number of bytes per transfer.
+			 * @param strategy the way to read the files.
+			 */
+			[[maybe_unused]] FileLoader(
+					const Context &context,
+					CommandQueue &commandQueue,
+					size_t chunkSizeInBytes = defaultChunkSizeInBytes,
+					FileLoadStrategy strategy = FileLoadStrategy::Automatic
+			);
+
+			/**
+			 * @brief Copies a range of the passed file into the passed device buffer and awaits the copy.
+			 * @param path the path of the file.
+			 * @param destinationDeviceMemory the device memory to copy to.
+			 * @param destinationOffsetInBytes the offset in bytes into the device memory.
+			 * @param fileOffsetInBytes the offset in bytes of the first byte to load.
+			 * @param numBytes the number of bytes to load, clipped to the end of the file.
+			 * @return the number of bytes loaded and the achieved throughput.
+			 * @throws std::runtime_error if the file cannot be read or the copy fails.
+			 */
+			[[maybe_unused]] FileLoadStatistics load(
+					const std::string &path,
+					const BaseBuffer &destinationDeviceMemory,
+					size_t destinationOffsetInBytes = 0,
+					size_t fileOffsetInBytes = 0,
+					size_t numBytes = toEndOfFile
+			);
+
+			/**
+			 * @brief Returns the size of the passed file.
+			 * @param path the path of the file.
+			 * @return the size of the file in bytes.
+			 * @throws std::runtime_error if the file cannot be accessed.
+			 */
+			[[maybe_unused]] static size_t getFileSize(const std::string &path);
+
+		private:
+			/**
+			 * @brief Copies a range of the open file by mapping it.
+			 * @param fileDescriptor the open file.
+			 * @param destinationDeviceMemory the device memory to copy to.
+			 * @param destinationOffsetInBytes the offset in bytes into the device memory.
+			 * @param fileOffsetInBytes the offset in bytes of the first byte to load.
+			 * @param numBytes the number of bytes to load.
+			 * @return whether the file could be mapped. If not, nothing was copied.
+			 */
+			bool loadMemoryMapped(
+					int fileDescriptor,
+					const BaseBuffer &destinationDeviceMemory,
+					size_t destinationOffsetInBytes,
+					size_t fileOffsetInBytes,
+					size_t numBytes
+			);
+
+			/**
+			 * @brief Copies a range of the open file through pinned staging buffers.
+			 * @param fileDescriptor the open file.
+			 * @param destinationDeviceMemory the device memory to copy to.
+			 * @param destinationOffsetInBytes the offset in bytes into the device memory.
+			 * @param fileOffsetInBytes the offset in bytes of the first byte to load.
+			 * @param numBytes the number of bytes to load.
+			 */
+			void loadStaged(
+					int fileDescriptor,
+					const BaseBuffer &destinationDeviceMemory,
+					size_t destinationOffsetInBytes,
+					size_t fileOffsetInBytes,
+					size_t numBytes
+			);
+	};
+}
+
+#endif //OPENCL_TOOLKIT_FILE_LOADER_H
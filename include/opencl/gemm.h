@@ -0,0 +1,194 @@
+#ifndef OPENCL_TOOLKIT_GEMM_H
+#define OPENCL_TOOLKIT_GEMM_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "portable_opencl_include.h"
+#include "command_queue.h"
+#include "program.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief The storage precisions of the matrices of a matrix multiplication.
+	 */
+	enum class GemmPrecision {
+		/**
+		 * The matrices are stored as <code>float</code>.
+		 */
+		Single,
+
+		/**
+		 * The matrices are stored as <code>half</code> (<code>cl_half</code> on the host) and accumulated in
+		 * <code>float</code>. No <code>cl_khr_fp16</code> support is required.
+		 */
+		Half
+	};
+
+	/**
+	 * @brief Represents the compile-time tiling of the matrix multiplication kernel.
+	 */
+	struct GemmTileConfiguration {
+		/**
+		 * The number of rows of C computed by a work group.
+		 */
+		size_t tileM;
+
+		/**
+		 * The number of columns of C computed by a work group.
+		 */
+		size_t tileN;
+
+		/**
+		 * The depth of the tiles of A and B staged in local memory.
+		 */
+		size_t tileK;
+
+		/**
+		 * The number of rows of C computed by a work item.
+		 */
+		size_t workPerThreadM;
+
+		/**
+		 * The number of columns of C computed by a work item.
+		 */
+		size_t workPerThreadN;
+
+		/**
+		 * The width of the vector loads (1, 2, 4 or 8).
+		 */
+		size_t vectorWidth;
+
+		/**
+		 * @brief Returns the number of work items per work group.
+		 * @return the number of work items per work group.
+		 */
+		[[nodiscard]] size_t getWorkGroupSize() const;
+
+		/**
+		 * @brief Returns the local memory demand of a work group in bytes.
+		 * @return the local memory demand of a work group in bytes.
+		 */
+		[[nodiscard]] size_t getLocalMemorySizeInBytes() const;
+
+		/**
+		 * @brief Returns the build options which specialize the kernel for the current tiling.
+		 * @return the build options which specialize the kernel for the current tiling.
+		 */
+		[[nodiscard]] std::string toBuildOptions() const;
+	};
+
+	/**
+	 * @brief Multiplies dense row-major matrices: C = alpha * A * B + beta * C.
+	 * @details Each work group stages tiles of A and B in local memory (with vector loads for interior tiles), and each
+	 * work item accumulates a register tile of C. The tiling is fixed at compile time per device: it is taken from the
+	 * autotuning results of the current process if the device was tuned, else chosen from the cached device
+	 * descriptor. An instance must not be used by several threads at the same time.
+	 */
+	class Gemm {
+		private:
+			/**
+			 * The context of the device buffers.
+			 */
+			const Context &context_;
+
+			/**
+			 * The target device.
+			 */
+			cl_device_id device_;
+
+			/**
+			 * The command queue which executes the multiplications.
+			 */
+			CommandQueue &commandQueue_;
+
+			/**
+			 * The storage precision of the matrices.
+			 */
+			GemmPrecision precision_;
+
+			/**
+			 * The current tiling.
+			 */
+			GemmTileConfiguration configuration_;
+
+			/**
+			 * The kernel specialized for the current tiling.
+			 */
+			std::unique_ptr<Program> kernel_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Chooses the tiling and builds the kernel.
+			 * @param context a valid OpenCL-context which outlives the current instance.
+			 * @param device the target device.
+			 * @param commandQueue the command queue of the target device which outlives the current instance.
+			 * @param precision the storage precision of the matrices.
+			 */
+			[[maybe_unused]] Gemm(
+					const Context &context,
+					cl_device_id device,
+					CommandQueue &commandQueue,
+					GemmPrecision precision = GemmPrecision::Single
+			);
+
+			/**
+			 * @brief Enqueues C = alpha * A * B + beta * C for row-major matrices.
+			 * @param m the number of rows of A and C.
+			 * @param n the number of columns of B and C.
+			 * @param k the number of columns of A and rows of B.
+			 * @param alpha the factor of the product.
+			 * @param a the m x k matrix A.
+			 * @param b the k x n matrix B.
+			 * @param beta the factor of C. If 0, C is not read.
+			 * @param c the m x n matrix C.
+			 */
+			[[maybe_unused]] void multiply(
+					size_t m,
+					size_t n,
+					size_t k,
+					float alpha,
+					const BaseBuffer &a,
+					const BaseBuffer &b,
+					float beta,
+					const BaseBuffer &c
+			);
+
+			/**
+			 * @brief Measures the candidate tilings which fit the device with the passed problem size and keeps the
+			 * fastest one. The result is remembered for the device and precision, so later instances use it without
+			 * tuning again.
+			 * @param m the number of rows of A and C of a representative problem.
+			 * @param n the number of columns of B and C of a representative problem.
+			 * @param k the number of columns of A and rows of B of a representative problem.
+			 * @return the fastest tiling.
+			 */
+			[[maybe_unused]] GemmTileConfiguration autotune(size_t m, size_t n, size_t k);
+
+			/**
+			 * @brief Returns the current tiling.
+			 * @return the current tiling.
+			 */
+			[[maybe_unused]] [[nodiscard]] const GemmTileConfiguration &getTileConfiguration() const;
+
+		private:
+			/**
+			 * @brief Builds the kernel for the passed tiling and makes it the current one.
+			 * @param configuration the tiling to be used.
+			 */
+			void useTileConfiguration(const GemmTileConfiguration &configuration);
+
+			/**
+			 * @brief Returns the candidate tilings which fit the device, the preferred one first.
+			 * @return the candidate tilings which fit the device.
+			 */
+			[[nodiscard]] std::vector<GemmTileConfiguration> getCandidateTileConfigurations() const;
+	};
+}
+
+#endif //OPENCL_TOOLKIT_GEMM_H
@@ -0,0 +1,103 @@
+#ifndef OPENCL_TOOLKIT_IMAGE_H
+#define OPENCL_TOOLKIT_IMAGE_H
+
+#include "portable_opencl_include.h"
+#include "context.h"
+#include "nd_range.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Represents a 1-D, 2-D or 3-D image. Kernels read images through samplers, which use the texture cache and
+	 * the hardware filtering and addressing of the device.
+	 */
+	class Image {
+		private:
+			/**
+			 * The image.
+			 */
+			cl_mem self_;
+
+			/**
+			 * The context of the image.
+			 */
+			cl_context context_;
+
+			/**
+			 * The channel order and data type of the image.
+			 */
+			cl_image_format format_;
+
+			/**
+			 * The size of the image in pixels.
+			 */
+			NDRange size_;
+
+			/**
+			 * The size of the image in bytes.
+			 */
+			size_t sizeInBytes_;
+
+			/**
+			 * True if the image is charged to the budget of the memory manager, i.e. it is not allocated in host
+			 * memory.
+			 */
+			bool isAccounted_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Creates an image by the passed parameters.
+			 * @param context a valid OpenCL-context.
+			 * @param format the channel order and data type, see <code>DeviceInfo::supportedImageFormats2D</code> and
+			 *               <code>DeviceInfo::supportedImageFormats3D</code>.
+			 * @param size the width, height and depth in pixels. Its number of dimensions determines the image type.
+			 * @param flags the memory flags, e.g. <code>CL_MEM_READ_ONLY</code> for images which are only sampled.
+			 */
+			[[maybe_unused]] Image(
+					const Context &context,
+					const cl_image_format &format,
+					const NDRange &size,
+					cl_mem_flags flags = CL_MEM_READ_WRITE
+			);
+
+			/**
+			 * @brief Deleted copy constructor.
+			 */
+			Image(Image const &) = delete;
+
+			/**
+			 * @brief Deleted copy assignment.
+			 */
+			void operator=(Image const &) = delete;
+
+			/**
+			 * @brief The destructor. Releases the current image.
+			 */
+			~Image();
+
+			/**
+			 * @brief Returns the channel order and data type of the image.
+			 * @return the channel order and data type of the image.
+			 */
+			[[maybe_unused]] [[nodiscard]] const cl_image_format &getFormat() const;
+
+			/**
+			 * @brief Returns the size of the image in pixels.
+			 * @return the size of the image in pixels.
+			 */
+			[[maybe_unused]] [[nodiscard]] const NDRange &getSize() const;
+
+			/**
+			 * @brief Returns the size of a pixel in bytes.
+			 * @return the size of a pixel in bytes.
+			 */
+			[[maybe_unused]] [[nodiscard]] size_t getPixelSizeInBytes() const;
+
+			operator cl_mem() const; // NOLINT(google-explicit-constructor)
+	};
+}
+
+#endif //OPENCL_TOOLKIT_IMAGE_H
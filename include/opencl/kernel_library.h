@@ -0,0 +1,179 @@
+#ifndef OPENCL_TOOLKIT_KERNEL_LIBRARY_H
+#define OPENCL_TOOLKIT_KERNEL_LIBRARY_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "portable_opencl_include.h"
+#include "context.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Represents a header which can be included by kernel source code without being part of it.
+	 */
+	struct KernelHeader {
+		/**
+		 * The name used to include the header, e.g. <code>"utils.h"</code> for <code>#include "utils.h"</code>.
+		 */
+		std::string name;
+
+		/**
+		 * The source code of the header.
+		 */
+		std::string sourceCode;
+	};
+
+	/**
+	 * @brief Represents shared device code which is compiled once per device and linked into many programs.
+	 * @details The library consists of embedded headers, which are made available to <code>#include</code> directives
+	 * of the programs linked against the library, and of the library source code, which contains the definitions of
+	 * the functions declared in the headers. The library source code is compiled with <code>clCompileProgram</code>
+	 * at the first use per device. The compiled objects are cached in memory and, if a cache directory is given, on
+	 * disk so later processes skip the compilation as well.
+	 */
+	class KernelLibrary {
+		private:
+			/**
+			 * The context the library is compiled in.
+			 */
+			cl_context context_;
+
+			/**
+			 * The program objects of the embedded headers.
+			 */
+			std::vector<cl_program> headerPrograms_;
+
+			/**
+			 * The embedded headers in the same order as the header programs.
+			 */
+			std::vector<KernelHeader> headers_;
+
+			/**
+			 * The source code of the library.
+			 */
+			std::string librarySourceCode_;
+
+			/**
+			 * The options passed to the compiler for the library and for the programs linked against it.
+			 */
+			std::string compileOptions_;
+
+			/**
+			 * The directory where compiled objects are cached, empty if they are cached in memory only.
+			 */
+			std::string cacheDirectory_;
+
+			/**
+			 * The compiled objects of the library per device.
+			 */
+			std::map<cl_device_id, cl_program> compiledObjects_;
+
+			/**
+			 * Guards the compiled objects.
+			 */
+			mutable std::mutex mutex_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Creates a library which is compiled lazily per device.
+			 * @param context a valid OpenCL-context which outlives the library.
+			 * @param headers the headers which can be included by the library and the programs linked against it.
+			 * @param librarySourceCode the source code with the definitions of the shared device functions.
+			 * @param compileOptions an optional string with the options passed to the OpenCL compiler.
+			 * @param cacheDirectory an optional directory where compiled objects are cached across processes.
+			 */
+			[[maybe_unused]] KernelLibrary(
+					const Context &context,
+					const std::vector<KernelHeader> &headers,
+					std::string librarySourceCode,
+					std::string compileOptions = "",
+					std::string cacheDirectory = ""
+			);
+
+			/**
+			 * @brief The destructor. Releases the header programs and all compiled objects.
+			 */
+			~KernelLibrary();
+
+			/**
+			 * @brief The copy constructor.
+			 */
+			KernelLibrary(KernelLibrary const &) = delete;
+
+			/**
+			 * @brief The assigment operator.
+			 */
+			void operator=(KernelLibrary const &) = delete;
+
+			/**
+			 * @brief Returns the compiled object of the library for the passed device. The library is compiled or
+			 * loaded from the disk cache at the first call per device.
+			 * @param device the target device.
+			 * @return the compiled object of the library for the passed device. It is owned by the library.
+			 */
+			[[nodiscard]] cl_program getCompiledObject(cl_device_id device);
+
+			/**
+			 * @brief Returns the embedded headers.
+			 * @return the embedded headers.
+			 */
+			[[maybe_unused]] [[nodiscard]] const std::vector<KernelHeader> &getHeaders() const;
+
+			/**
+			 * @brief Returns the source code of the library.
+			 * @return the source code of the library.
+			 */
+			[[maybe_unused]] [[nodiscard]] const std::string &getSourceCode() const;
+
+			/**
+			 * @brief Returns the options passed to the compiler for the library and for the programs linked against it.
+			 * @return the options passed to the compiler for the library and for the programs linked against it.
+			 */
+			[[maybe_unused]] [[nodiscard]] const std::string &getCompileOptions() const;
+
+			/**
+			 * @brief Compiles the passed source code with the embedded headers of the library. The result is not
+			 * linked yet.
+			 * @param sourceCode the source code to be compiled.
+			 * @param device the target device.
+			 * @param compileOptions the options passed to the OpenCL compiler in addition to the library options.
+			 * @return the compiled object. The caller takes the ownership.
+			 */
+			[[nodiscard]] cl_program compile(
+					const std::string &sourceCode,
+					cl_device_id device,
+					const std::string &compileOptions = ""
+			) const;
+
+		private:
+			/**
+			 * @brief Returns the path of the file caching the compiled library for the passed device.
+			 * @param device the target device.
+			 * @return the path of the file caching the compiled library for the passed device.
+			 */
+			[[nodiscard]] std::string getCacheFilePath(cl_device_id device) const;
+
+			/**
+			 * @brief Loads the compiled library for the passed device from the disk cache.
+			 * @param device the target device.
+			 * @return the compiled object or nullptr if it is not cached.
+			 */
+			[[nodiscard]] cl_program loadFromDiskCache(cl_device_id device) const;
+
+			/**
+			 * @brief Stores the passed compiled library for the passed device in the disk cache. Failures are reported
+			 * on stderr only, because the cache is an optimization.
+			 * @param device the target device.
+			 * @param compiledObject the compiled object to be stored.
+			 */
+			void storeInDiskCache(cl_device_id device, cl_program compiledObject) const;
+	};
+}
+
+#endif //OPENCL_TOOLKIT_KERNEL_LIBRARY_H
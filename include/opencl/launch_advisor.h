@@ -0,0 +1,97 @@
+#ifndef OPENCL_TOOLKIT_LAUNCH_ADVISOR_H
+#define OPENCL_TOOLKIT_LAUNCH_ADVISOR_H
+
+#include <string>
+#include <vector>
+
+#include "portable_opencl_include.h"
+#include "nd_range.h"
+#include "program.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief A launch configuration recommended by the <code>LaunchAdvisor</code>.
+	 */
+	struct LaunchRecommendation {
+		/**
+		 * The resource usage of the kernel which the recommendation is based on.
+		 */
+		KernelResources resources;
+
+		/**
+		 * The recommended number of work items per work group and dimension.
+		 */
+		NDRange localWorkSize;
+
+		/**
+		 * The requested global work size rounded up to a multiple of the local work size. The kernel must ignore the
+		 * padding work items if it is larger than the requested size.
+		 */
+		NDRange globalWorkSize;
+
+		/**
+		 * The number of work groups of the launch.
+		 */
+		size_t numWorkGroups;
+
+		/**
+		 * The estimated number of work groups which a compute unit runs at the same time.
+		 */
+		size_t workGroupsPerComputeUnit;
+
+		/**
+		 * The estimated share of the resident work items of the device which the launch occupies, between 0 and 1.
+		 */
+		double occupancy;
+
+		/**
+		 * The reasons why the launch is expected to perform poorly, empty if there are none.
+		 */
+		std::vector<std::string> warnings;
+	};
+
+	/**
+	 * @brief Recommends launch configurations from the resource usage of kernels and the descriptors of their devices,
+	 * so a good work group size is found without an empirical tuning pass.
+	 * @details OpenCL reports neither the register usage of a kernel nor the number of work items a compute unit holds,
+	 * so the advisor estimates the latter per vendor (e.g. 64 warps of NVIDIA GPUs, 40 wavefronts of AMD GPUs and one
+	 * work group per hardware thread of CPUs). It chooses among the power of two multiples of the preferred work
+	 * group size multiple the one with the highest occupancy for the requested global work size, limited by the local
+	 * memory of the kernel. A <code>reqd_work_group_size</code> attribute of the kernel is always honored.
+	 */
+	class LaunchAdvisor {
+		public:
+			/**
+			 * @brief Deleted default constructor, the advisor only has static functions.
+			 */
+			LaunchAdvisor() = delete;
+
+			/**
+			 * @brief Recommends a launch configuration for the kernel of the passed program.
+			 * @param program the program whose kernel is launched. The arguments it is launched with should be set, so
+			 *                their local memory is accounted.
+			 * @param globalWorkSize the requested number of work items per dimension.
+			 * @param localMemoryBytesPerWorkItem the local memory per work item in bytes of the local memory arguments
+			 *                                    which are not set yet and scale with the work group size, 0 if none.
+			 * @return the recommended launch configuration.
+			 */
+			[[maybe_unused]] [[nodiscard]] static LaunchRecommendation advise(
+					const Program &program,
+					const NDRange &globalWorkSize,
+					size_t localMemoryBytesPerWorkItem = 0
+			);
+
+			/**
+			 * @brief Prints the resource usage of a kernel, the recommended launch configuration and its warnings.
+			 * @param recommendation a recommendation of the current advisor.
+			 * @param useStderr an optional flag. If true, the report is printed to stderr, else to stdout.
+			 */
+			[[maybe_unused]] static void printReport(const LaunchRecommendation &recommendation, bool useStderr = false);
+	};
+}
+
+#endif //OPENCL_TOOLKIT_LAUNCH_ADVISOR_H
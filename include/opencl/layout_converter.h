@@ -0,0 +1,140 @@
+#ifndef OPENCL_TOOLKIT_LAYOUT_CONVERTER_H
+#define OPENCL_TOOLKIT_LAYOUT_CONVERTER_H
+
+#include <cstddef>
+
+#include "portable_opencl_include.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief The vector instructions of the host which a conversion uses.
+	 */
+	enum class SimdInstructionSet {
+		/**
+		 * Plain C++ without vector instructions, available everywhere.
+		 */
+		Scalar,
+
+		/**
+		 * AVX2 with the F16C half precision conversions of x86 processors.
+		 */
+		Avx2,
+
+		/**
+		 * AVX-512 foundation of x86 processors.
+		 */
+		Avx512,
+
+		/**
+		 * NEON of 64-bit ARM processors.
+		 */
+		Neon
+	};
+
+	/**
+	 * @brief Converts host data into the layouts and precisions which kernels expect, e.g. right before it is
+	 * uploaded.
+	 * @details Each conversion has vectorized variants for AVX2, AVX-512 and NEON and a scalar fallback. The variant
+	 * is selected at runtime by the instruction set of the current instance, so the toolkit is built without special
+	 * compiler flags. The vectorized variants of x86 are only available with GCC or Clang. All variants produce the
+	 * same results: halves are rounded to nearest even and integers are narrowed with saturation.
+	 */
+	class LayoutConverter {
+		private:
+			/**
+			 * The instruction set of the conversions.
+			 */
+			SimdInstructionSet instructionSet_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor.
+			 * @param instructionSet the instruction set of the conversions, by default the best one of the host.
+			 * @throws std::runtime_error if the host does not support the passed instruction set.
+			 */
+			[[maybe_unused]] explicit LayoutConverter(SimdInstructionSet instructionSet = detectInstructionSet());
+
+			/**
+			 * @brief Returns the instruction set of the conversions.
+			 * @return the instruction set of the conversions.
+			 */
+			[[maybe_unused]] [[nodiscard]] SimdInstructionSet getInstructionSet() const;
+
+			/**
+			 * @brief Transposes records of 32-bit fields (array of structs) into one array per field (struct of
+			 * arrays).
+			 * @param records the first record. The fields are the leading 32-bit words of each record.
+			 * @param numRecords the number of records.
+			 * @param recordSizeInBytes the distance of the records in bytes, a multiple of 4 of at least 4 times the
+			 *                          number of fields.
+			 * @param numFields the number of fields to be transposed.
+			 * @param fieldArrays the destination array per field, each of <code>numRecords</code> 32-bit words.
+			 */
+			[[maybe_unused]] void transposeRecordsToFieldArrays(
+					const void *records,
+					size_t numRecords,
+					size_t recordSizeInBytes,
+					size_t numFields,
+					void *const *fieldArrays
+			) const;
+
+			/**
+			 * @brief Converts single precision floats into half precision floats.
+			 * @param source the floats to be converted.
+			 * @param destination the halves.
+			 * @param numElements the number of floats.
+			 */
+			[[maybe_unused]] void convertFloatsToHalves(
+					const cl_float *source,
+					cl_half *destination,
+					size_t numElements
+			) const;
+
+			/**
+			 * @brief Converts half precision floats into single precision floats.
+			 * @param source the halves to be converted.
+			 * @param destination the floats.
+			 * @param numElements the number of halves.
+			 */
+			[[maybe_unused]] void convertHalvesToFloats(
+					const cl_half *source,
+					cl_float *destination,
+					size_t numElements
+			) const;
+
+			/**
+			 * @brief Narrows 32-bit integers into 16-bit integers, clamping them to the range of the latter.
+			 * @param source the integers to be narrowed.
+			 * @param destination the narrowed integers.
+			 * @param numElements the number of integers.
+			 */
+			[[maybe_unused]] void narrowIntegers(const cl_int *source, cl_short *destination, size_t numElements) const;
+
+			/**
+			 * @brief Narrows 32-bit integers into 8-bit integers, clamping them to the range of the latter.
+			 * @param source the integers to be narrowed.
+			 * @param destination the narrowed integers.
+			 * @param numElements the number of integers.
+			 */
+			[[maybe_unused]] void narrowIntegers(const cl_int *source, cl_char *destination, size_t numElements) const;
+
+			/**
+			 * @brief Returns the best instruction set of the host.
+			 * @return the best instruction set of the host.
+			 */
+			[[maybe_unused]] [[nodiscard]] static SimdInstructionSet detectInstructionSet();
+
+			/**
+			 * @brief Returns whether the host supports the passed instruction set.
+			 * @param instructionSet the instruction set to be checked.
+			 * @return whether the host supports the passed instruction set.
+			 */
+			[[maybe_unused]] [[nodiscard]] static bool isSupported(SimdInstructionSet instructionSet);
+	};
+}
+
+#endif //OPENCL_TOOLKIT_LAYOUT_CONVERTER_H
@@ -0,0 +1,252 @@
+#ifndef OPENCL_TOOLKIT_MEMORY_MANAGER_H
+#define OPENCL_TOOLKIT_MEMORY_MANAGER_H
+
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "portable_opencl_include.h"
+#include "context.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	class EvictableBuffer;
+
+	class ReadWriteBuffer;
+
+	/**
+	 * @brief Represents the device memory accounting of a context.
+	 */
+	struct MemoryMetrics {
+		/**
+		 * The budget in bytes.
+		 */
+		size_t budgetInBytes;
+
+		/**
+		 * The bytes currently allocated by buffers and images.
+		 */
+		size_t allocatedInBytes;
+
+		/**
+		 * The most bytes allocated at once so far.
+		 */
+		size_t peakAllocatedInBytes;
+
+		/**
+		 * The allocated bytes relative to the budget, above 1 if overcommitted.
+		 */
+		double pressure;
+
+		/**
+		 * The number of allocations so far.
+		 */
+		size_t numAllocations;
+
+		/**
+		 * The number of buffers evicted to host memory so far.
+		 */
+		size_t numEvictions;
+
+		/**
+		 * The bytes evicted to host memory so far.
+		 */
+		size_t evictedBytes;
+
+		/**
+		 * The number of buffers restored from host memory so far.
+		 */
+		size_t numRestorations;
+
+		/**
+		 * The bytes restored from host memory so far.
+		 */
+		size_t restoredBytes;
+
+		/**
+		 * The number of allocations which exceeded the budget because not enough buffers could be evicted.
+		 */
+		size_t numBudgetOverruns;
+	};
+
+	/**
+	 * @brief Represents the thread-safe, process-wide accounting of device memory per context.
+	 * @details Every buffer and image reports its allocation and release, except for buffers backed by host memory,
+	 * i.e. created with <code>CL_MEM_ALLOC_HOST_PTR</code> or <code>CL_MEM_USE_HOST_PTR</code>. If an allocation would exceed the budget of
+	 * its context, the least recently used <code>EvictableBuffer</code>s which are not acquired are evicted to host
+	 * memory until it fits. If that is not enough the allocation proceeds anyway and is counted as a budget overrun.
+	 * The budget is unlimited until set.
+	 */
+	class MemoryManager {
+		friend class EvictableBuffer;
+
+		private:
+			/**
+			 * @brief Represents the accounting of a context.
+			 */
+			struct Account {
+				/**
+				 * The metrics of the context.
+				 */
+				MemoryMetrics metrics{static_cast<size_t>(-1), 0, 0, 0.0, 0, 0, 0, 0, 0, 0};
+
+				/**
+				 * The evictable buffers of the context, the least recently used first.
+				 */
+				std::list<EvictableBuffer *> evictableBuffers;
+
+				/**
+				 * The bytes of the buffers being evicted, which are still allocated until their copies completed.
+				 */
+				size_t evictingInBytes = 0;
+			};
+
+			/**
+			 * @brief Represents an eviction selected under the lock and completed without it.
+			 */
+			struct Eviction {
+				/**
+				 * The buffer being evicted.
+				 */
+				EvictableBuffer *buffer;
+
+				/**
+				 * The device buffer handed over by the evicted buffer.
+				 */
+				std::shared_ptr<ReadWriteBuffer> deviceBuffer;
+			};
+
+			/**
+			 * The accounts per context.
+			 */
+			std::map<cl_context, Account> accounts_;
+
+			/**
+			 * Guards the accounts and the states of the evictable buffers. It is held while victims are selected,
+			 * but not while they are copied, so allocations of other threads never wait for transfers.
+			 */
+			std::recursive_mutex mutex_;
+
+			/**
+			 * Signals that an evictable buffer stopped moving between device and host memory.
+			 */
+			std::condition_variable_any movingCompleted_;
+
+		public:
+			/**
+			 * @brief Returns the instance of this singleton class.
+			 * @return the instance of this singleton class.
+			 */
+			[[maybe_unused]] static MemoryManager &getInstance();
+
+			/**
+			 * @brief Deleted copy constructor.
+			 */
+			MemoryManager(MemoryManager const &) = delete;
+
+			/**
+			 * @brief Deleted copy assignment.
+			 */
+			void operator=(MemoryManager const &) = delete;
+
+			/**
+			 * @brief Sets the budget of the passed context. Evicts buffers if the context already exceeds it.
+			 * @param context the context.
+			 * @param budgetInBytes the budget in bytes.
+			 */
+			[[maybe_unused]] void setBudget(cl_context context, size_t budgetInBytes);
+
+			/**
+			 * @brief Sets the budget of the passed context to a fraction of the global memory of the passed device.
+			 * @param context the context.
+			 * @param device the device of the context.
+			 * @param fraction the fraction of the global memory, leaving room for the driver and other processes.
+			 */
+			[[maybe_unused]] void setBudgetFromDevice(cl_context context, cl_device_id device, double fraction = 0.9);
+
+			/**
+			 * @brief Returns the metrics of the passed context.
+			 * @param context the context.
+			 * @return the metrics of the passed context.
+			 */
+			[[maybe_unused]] [[nodiscard]] MemoryMetrics getMetrics(cl_context context);
+
+			/**
+			 * @brief Accounts an allocation, evicting buffers first if it would exceed the budget.
+			 * @param context the context of the allocation.
+			 * @param sizeInBytes the size of the allocation in bytes.
+			 */
+			void reserve(cl_context context, size_t sizeInBytes);
+
+			/**
+			 * @brief Accounts the release of an allocation.
+			 * @param context the context of the allocation.
+			 * @param sizeInBytes the size of the allocation in bytes.
+			 */
+			void release(cl_context context, size_t sizeInBytes);
+
+			/**
+			 * @brief Evicts all evictable buffers of the passed context which are not acquired, e.g. after the device
+			 * rejected an allocation within the budget.
+			 * @param context the context.
+			 * @return the number of bytes evicted.
+			 */
+			size_t evictAll(cl_context context);
+
+		private:
+			/**
+			 * @brief The default constructor.
+			 */
+			MemoryManager() = default;
+
+			/**
+			 * @brief Selects the least recently used buffers which are neither acquired nor moving until the passed
+			 * number of bytes fits into the budget or no buffer is left, and starts their evictions. The mutex must
+			 * be held.
+			 * @param account the account of the context.
+			 * @param sizeInBytes the number of bytes to make room for.
+			 * @param evictAll if true, all such buffers are selected regardless of the budget.
+			 * @return the started evictions to be passed to <code>completeEvictions</code>.
+			 */
+			static std::vector<Eviction> selectEvictions(Account &account, size_t sizeInBytes, bool evictAll = false);
+
+			/**
+			 * @brief Copies the selected buffers into host memory and releases their device buffers. The mutex must
+			 * not be held. If a copy fails, the remaining buffers stay resident and the failure is rethrown.
+			 * @param context the context of the buffers.
+			 * @param evictions the evictions started by <code>selectEvictions</code>.
+			 * @return the number of bytes evicted.
+			 */
+			size_t completeEvictions(cl_context context, std::vector<Eviction> &evictions);
+
+			/**
+			 * @brief Registers an evictable buffer as the most recently used one.
+			 * @param context the context of the buffer.
+			 * @param buffer the buffer.
+			 */
+			void registerBuffer(cl_context context, EvictableBuffer *buffer);
+
+			/**
+			 * @brief Unregisters an evictable buffer.
+			 * @param context the context of the buffer.
+			 * @param buffer the buffer.
+			 */
+			void unregisterBuffer(cl_context context, EvictableBuffer *buffer);
+
+			/**
+			 * @brief Marks an evictable buffer as the most recently used one and restores it if it was evicted.
+			 * @param context the context of the buffer.
+			 * @param buffer the buffer.
+			 * @return the device buffer, which cannot be evicted while the caller holds it.
+			 */
+			std::shared_ptr<ReadWriteBuffer> acquire(cl_context context, EvictableBuffer *buffer);
+	};
+}
+
+#endif //OPENCL_TOOLKIT_MEMORY_MANAGER_H
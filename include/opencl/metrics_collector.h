@@ -0,0 +1,328 @@
+#ifndef OPENCL_TOOLKIT_METRICS_COLLECTOR_H
+#define OPENCL_TOOLKIT_METRICS_COLLECTOR_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "portable_opencl_include.h"
+#include "context.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Represents the state of a histogram at the time of a snapshot.
+	 */
+	struct HistogramSnapshot {
+		/**
+		 * The inclusive upper bounds of the buckets in ascending order. The last bucket, which is not listed, has no
+		 * upper bound.
+		 */
+		std::vector<double> upperBounds;
+
+		/**
+		 * The number of observations per bucket, one more than the upper bounds. The counts are not cumulative.
+		 */
+		std::vector<uint64_t> bucketCounts;
+
+		/**
+		 * The number of observations.
+		 */
+		uint64_t count;
+
+		/**
+		 * The sum of the observed values.
+		 */
+		double sum;
+	};
+
+	/**
+	 * @brief Represents the buffer and image memory of a device at the time of a snapshot.
+	 */
+	struct DeviceMemorySnapshot {
+		/**
+		 * The device.
+		 */
+		cl_device_id device;
+
+		/**
+		 * The name of the device.
+		 */
+		std::string deviceName;
+
+		/**
+		 * The position of the device in the order of the first allocation, which tells devices with the same name
+		 * apart.
+		 */
+		size_t deviceIndex;
+
+		/**
+		 * The bytes currently allocated.
+		 */
+		uint64_t liveBytes;
+
+		/**
+		 * The most bytes allocated at once so far.
+		 */
+		uint64_t peakBytes;
+
+		/**
+		 * The number of allocations so far.
+		 */
+		uint64_t numAllocations;
+	};
+
+	/**
+	 * @brief Represents the lookups of a cache at the time of a snapshot.
+	 */
+	struct CacheSnapshot {
+		/**
+		 * The number of lookups which found the entry.
+		 */
+		uint64_t numHits;
+
+		/**
+		 * The number of lookups which did not find the entry.
+		 */
+		uint64_t numMisses;
+	};
+
+	/**
+	 * @brief Represents the metrics of the toolkit aggregated over all threads at the time of a snapshot.
+	 */
+	struct MetricsSnapshot {
+		/**
+		 * The bytes copied from host memory into device memory.
+		 */
+		uint64_t uploadedBytes;
+
+		/**
+		 * The bytes copied from device memory into host memory.
+		 */
+		uint64_t downloadedBytes;
+
+		/**
+		 * The number of copies from host memory into device memory.
+		 */
+		uint64_t numUploads;
+
+		/**
+		 * The number of copies from device memory into host memory.
+		 */
+		uint64_t numDownloads;
+
+		/**
+		 * The sizes in bytes of the copies in both directions.
+		 */
+		HistogramSnapshot transferSizes;
+
+		/**
+		 * The buffer and image memory per device in the order of the first allocation.
+		 */
+		std::vector<DeviceMemorySnapshot> devices;
+
+		/**
+		 * The number of launches per kernel name.
+		 */
+		std::map<std::string, uint64_t> kernelLaunches;
+
+		/**
+		 * The build durations in seconds per kind of build, i.e. "source", "intermediate_language", "linked" and
+		 * "library".
+		 */
+		std::map<std::string, HistogramSnapshot> buildDurations;
+
+		/**
+		 * The lookups per cache, i.e. "program_registry", "kernel_library" and "kernel_library_disk".
+		 */
+		std::map<std::string, CacheSnapshot> caches;
+	};
+
+	/**
+	 * @brief Collects low-overhead counters and histograms of the transfers, allocations, kernel launches, program
+	 * builds and cache lookups of the toolkit, e.g. to be scraped by Prometheus.
+	 * @details The collector is a process-wide singleton which is always active. Each thread counts into a shard of
+	 * its own, whose lock is only contended while a snapshot is taken, and the shards are aggregated on
+	 * <code>snapshot</code>. The shard of a thread which exits is added to the totals of the exited threads. Only the
+	 * live and peak bytes per device are kept in one shared table, because a peak requires a global order of the
+	 * allocations; a buffer counts towards the first device of its context. The <code>record...</code> methods are
+	 * called by the toolkit itself.
+	 */
+	class MetricsCollector {
+		private:
+			/**
+			 * @brief Represents the counters of one thread.
+			 */
+			struct Shard;
+
+			/**
+			 * @brief Registers the shard of the current thread and adds it to the totals when the thread exits.
+			 */
+			class ShardOwner;
+
+			/**
+			 * @brief Represents the buffer and image memory of a device.
+			 */
+			struct DeviceMemory {
+				/**
+				 * The name of the device.
+				 */
+				std::string deviceName;
+
+				/**
+				 * The position of the device in the order of the first allocation.
+				 */
+				size_t deviceIndex;
+
+				/**
+				 * The bytes currently allocated.
+				 */
+				uint64_t liveBytes;
+
+				/**
+				 * The most bytes allocated at once so far.
+				 */
+				uint64_t peakBytes;
+
+				/**
+				 * The number of allocations so far.
+				 */
+				uint64_t numAllocations;
+			};
+
+			/**
+			 * Guards the shards and the totals of the exited threads.
+			 */
+			std::mutex shardsMutex_;
+
+			/**
+			 * The shards of the running threads.
+			 */
+			std::vector<Shard *> shards_;
+
+			/**
+			 * The totals of the exited threads.
+			 */
+			std::unique_ptr<Shard> exitedThreads_;
+
+			/**
+			 * Guards the device memory and the devices of the contexts.
+			 */
+			std::mutex memoryMutex_;
+
+			/**
+			 * The device memory per device.
+			 */
+			std::map<cl_device_id, DeviceMemory> deviceMemory_;
+
+			/**
+			 * The device which the buffers of a context count towards, per context.
+			 */
+			std::map<cl_context, cl_device_id> contextDevices_;
+
+			/**
+			 * @brief The default constructor.
+			 */
+			MetricsCollector();
+
+		public:
+			/**
+			 * @brief Deleted copy constructor.
+			 */
+			MetricsCollector(MetricsCollector const &) = delete;
+
+			/**
+			 * @brief Deleted copy assignment.
+			 */
+			void operator=(MetricsCollector const &) = delete;
+
+			/**
+			 * @brief The destructor.
+			 */
+			~MetricsCollector();
+
+			/**
+			 * @brief Returns the singleton instance of this class.
+			 * @return the singleton instance of this class.
+			 */
+			[[maybe_unused]] static MetricsCollector &getInstance();
+
+			/**
+			 * @brief Aggregates the metrics of all threads.
+			 * @return the aggregated metrics.
+			 */
+			[[maybe_unused]] [[nodiscard]] MetricsSnapshot snapshot();
+
+			/**
+			 * @brief Formats the passed metrics in the Prometheus text exposition format.
+			 * @param snapshot the metrics to be formatted.
+			 * @param prefix the prefix of the metric names.
+			 * @return the formatted metrics, one sample per line.
+			 */
+			[[maybe_unused]] [[nodiscard]] static std::string formatPrometheus(
+					const MetricsSnapshot &snapshot,
+					const std::string &prefix = "opencl_toolkit"
+			);
+
+			/**
+			 * @brief Records a copy from host memory into device memory.
+			 * @param numBytes the number of bytes copied.
+			 */
+			void recordUpload(size_t numBytes);
+
+			/**
+			 * @brief Records a copy from device memory into host memory.
+			 * @param numBytes the number of bytes copied.
+			 */
+			void recordDownload(size_t numBytes);
+
+			/**
+			 * @brief Records the allocation of a buffer or an image.
+			 * @param context the context of the allocation.
+			 * @param sizeInBytes the size of the allocation.
+			 */
+			void recordAllocation(const Context &context, size_t sizeInBytes);
+
+			/**
+			 * @brief Records the release of a buffer or an image.
+			 * @param context the context of the allocation.
+			 * @param sizeInBytes the size of the allocation.
+			 */
+			void recordRelease(cl_context context, size_t sizeInBytes);
+
+			/**
+			 * @brief Records the launch of a kernel.
+			 * @param kernelName the name of the kernel.
+			 */
+			void recordLaunch(const std::string &kernelName);
+
+			/**
+			 * @brief Records a program build.
+			 * @param kind the kind of build, e.g. "source".
+			 * @param seconds the duration of the build.
+			 */
+			void recordBuild(const char *kind, double seconds);
+
+			/**
+			 * @brief Records a cache lookup.
+			 * @param cache the name of the cache, e.g. "program_registry".
+			 * @param isHit true if the lookup found the entry.
+			 */
+			void recordCacheLookup(const char *cache, bool isHit);
+
+		private:
+			/**
+			 * @brief Returns the shard of the current thread, registering it at the first call.
+			 * @return the shard of the current thread.
+			 */
+			Shard &getShard();
+	};
+}
+
+#endif //OPENCL_TOOLKIT_METRICS_COLLECTOR_H
@@ -0,0 +1,58 @@
+#ifndef OPENCL_TOOLKIT_ND_RANGE_H
+#define OPENCL_TOOLKIT_ND_RANGE_H
+
+#include <cstddef>
+
+#include "portable_opencl_include.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Represents the sizes or offsets of a one-, two- or three-dimensional index space.
+	 */
+	struct NDRange {
+		/**
+		 * The number of dimensions, between 1 and 3.
+		 */
+		cl_uint numDimensions;
+
+		/**
+		 * The size per dimension, unused dimensions are 1.
+		 */
+		size_t sizes[3];
+
+		/**
+		 * @brief Creates a one-dimensional range.
+		 * @param x the size of the first dimension.
+		 */
+		NDRange(size_t x) : numDimensions(1), sizes{x, 1, 1} {} // NOLINT(google-explicit-constructor)
+
+		/**
+		 * @brief Creates a two-dimensional range.
+		 * @param x the size of the first dimension.
+		 * @param y the size of the second dimension.
+		 */
+		NDRange(size_t x, size_t y) : numDimensions(2), sizes{x, y, 1} {}
+
+		/**
+		 * @brief Creates a three-dimensional range.
+		 * @param x the size of the first dimension.
+		 * @param y the size of the second dimension.
+		 * @param z the size of the third dimension.
+		 */
+		NDRange(size_t x, size_t y, size_t z) : numDimensions(3), sizes{x, y, z} {}
+
+		/**
+		 * @brief Returns the product of the sizes of all dimensions.
+		 * @return the product of the sizes of all dimensions.
+		 */
+		[[nodiscard]] size_t getTotalSize() const {
+			return sizes[0] * sizes[1] * sizes[2];
+		}
+	};
+}
+
+#endif //OPENCL_TOOLKIT_ND_RANGE_H
@@ -0,0 +1,304 @@
+#ifndef OPENCL_TOOLKIT_PARALLEL_PRIMITIVES_H
+#define OPENCL_TOOLKIT_PARALLEL_PRIMITIVES_H
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "portable_opencl_include.h"
+#include "command_queue.h"
+#include "program.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief The associative operations supported by reductions and scans.
+	 */
+	enum class BinaryOperation {
+		Sum,
+		Min,
+		Max
+	};
+
+	/**
+	 * @brief Provides tuned parallel primitives on device buffers: reduction, scan, transform, stream compaction and
+	 * histogram.
+	 * @details The kernels are specialized per element type and operation through the build options and are built
+	 * once per process via the program registry. Reductions use subgroup functions where the device supports
+	 * <code>cl_khr_subgroups</code> and a local memory tree otherwise. Scans use the work-efficient Blelloch algorithm
+	 * per tile and recursively scan the tile totals. The work group sizes are chosen per kernel from the max work
+	 * group size and the local memory size of the device.
+	 * Supported element types are <code>cl_int</code>, <code>cl_uint</code>, <code>cl_long</code>,
+	 * <code>cl_ulong</code>, <code>cl_float</code> and <code>cl_double</code>. An instance must not be used by
+	 * several threads at the same time. All commands are enqueued into the passed command queue.
+	 * @tparam T the element type.
+	 */
+	template<typename T>
+	class ParallelPrimitives {
+		private:
+			/**
+			 * The context of the device buffers.
+			 */
+			const Context &context_;
+
+			/**
+			 * The target device.
+			 */
+			cl_device_id device_;
+
+			/**
+			 * The command queue which executes the primitives.
+			 */
+			CommandQueue &commandQueue_;
+
+			/**
+			 * The operation of the reductions and scans.
+			 */
+			BinaryOperation operation_;
+
+			/**
+			 * The kernel reducing the input to partial results.
+			 */
+			std::unique_ptr<Program> reduce_;
+
+			/**
+			 * The kernel scanning the tiles of the input.
+			 */
+			std::unique_ptr<Program> scanBlocks_;
+
+			/**
+			 * The kernel adding the scanned tile totals to the tiles.
+			 */
+			std::unique_ptr<Program> addBlockOffsets_;
+
+			/**
+			 * The kernel flagging the non-zero elements.
+			 */
+			std::unique_ptr<Program> markNonZero_;
+
+			/**
+			 * The kernel moving the flagged elements to their compacted positions.
+			 */
+			std::unique_ptr<Program> scatterFlagged_;
+
+			/**
+			 * The kernel counting elements per bin in local memory.
+			 */
+			std::unique_ptr<Program> histogramLocal_;
+
+			/**
+			 * The kernel counting elements per bin in global memory.
+			 */
+			std::unique_ptr<Program> histogramGlobal_;
+
+			/**
+			 * The kernel scanning the tiles of the flags of a stream compaction.
+			 */
+			std::unique_ptr<Program> scanFlagBlocks_;
+
+			/**
+			 * The kernel adding the scanned tile totals to the tiles of the flags of a stream compaction.
+			 */
+			std::unique_ptr<Program> addFlagBlockOffsets_;
+
+			/**
+			 * The kernel normalizing the flags of a stream compaction to 0 and 1 before they are scanned.
+			 */
+			std::unique_ptr<Program> normalizeFlags_;
+
+			/**
+			 * The work group size of the reduction.
+			 */
+			size_t reduceWorkGroupSize_;
+
+			/**
+			 * The work group size of the scan, a tile consists of twice as many elements.
+			 */
+			size_t scanWorkGroupSize_;
+
+			/**
+			 * The work group size of the scan of the flags of a stream compaction.
+			 */
+			size_t flagScanWorkGroupSize_;
+
+			/**
+			 * The work group size of the element-wise kernels.
+			 */
+			size_t elementWiseWorkGroupSize_;
+
+			/**
+			 * @brief A transform kernel.
+			 */
+			struct Transform {
+				/**
+				 * The kernel applying the operation.
+				 */
+				std::unique_ptr<Program> kernel;
+
+				/**
+				 * The work group size of the kernel.
+				 */
+				size_t workGroupSize;
+			};
+
+			/**
+			 * The transform kernels by their operation.
+			 */
+			std::map<std::string, Transform> transforms_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Builds the kernels or takes them from the program registry.
+			 * @param context a valid OpenCL-context which outlives the current instance.
+			 * @param device the target device.
+			 * @param commandQueue the command queue of the target device which outlives the current instance.
+			 * @param operation the operation of the reductions and scans.
+			 */
+			[[maybe_unused]] ParallelPrimitives(
+					const Context &context,
+					cl_device_id device,
+					CommandQueue &commandQueue,
+					BinaryOperation operation = BinaryOperation::Sum
+			);
+
+			/**
+			 * @brief Reduces the passed elements with the operation of the current instance.
+			 * @param input the elements to be reduced.
+			 * @param numElements the number of elements to be reduced.
+			 * @return the result of the reduction. The identity of the operation if there are no elements.
+			 */
+			[[maybe_unused]] T reduce(const BaseBuffer &input, size_t numElements);
+
+			/**
+			 * @brief Scans the passed elements with the operation of the current instance.
+			 * @param input the elements to be scanned.
+			 * @param output the buffer receiving the scanned elements. It may be the input buffer.
+			 * @param numElements the number of elements to be scanned.
+			 * @param isInclusive true for an inclusive scan, false for an exclusive scan.
+			 */
+			[[maybe_unused]] void scan(
+					const BaseBuffer &input,
+					const BaseBuffer &output,
+					size_t numElements,
+					bool isInclusive = false
+			);
+
+			/**
+			 * @brief Applies an element-wise operation to the passed elements.
+			 * @param input the elements to be transformed.
+			 * @param output the buffer receiving the transformed elements. It may be the input buffer.
+			 * @param numElements the number of elements to be transformed.
+			 * @param operation an OpenCL C expression of the element <code>x</code>, e.g. <code>"x * x + 1"</code>. The
+			 *                  kernel of each distinct operation is built once.
+			 */
+			[[maybe_unused]] void transform(
+					const BaseBuffer &input,
+					const BaseBuffer &output,
+					size_t numElements,
+					const std::string &operation
+			);
+
+			/**
+			 * @brief Copies the flagged elements in their original order to the front of the output.
+			 * @param input the elements to be compacted.
+			 * @param flags one <code>cl_uint</code> per element. The element is kept if its flag is not zero.
+			 * @param output the buffer receiving the kept elements. It must not be the input buffer.
+			 * @param numElements the number of elements to be compacted.
+			 * @return the number of kept elements.
+			 */
+			[[maybe_unused]] size_t compact(
+					const BaseBuffer &input,
+					const BaseBuffer &flags,
+					const BaseBuffer &output,
+					size_t numElements
+			);
+
+			/**
+			 * @brief Copies the non-zero elements in their original order to the front of the output.
+			 * @param input the elements to be compacted.
+			 * @param output the buffer receiving the kept elements. It must not be the input buffer.
+			 * @param numElements the number of elements to be compacted.
+			 * @return the number of kept elements.
+			 */
+			[[maybe_unused]] size_t compactNonZero(const BaseBuffer &input, const BaseBuffer &output, size_t numElements);
+
+			/**
+			 * @brief Counts the elements per bin. The range [lowerBound, upperBound) is split into bins of equal
+			 * width; elements outside the range are ignored.
+			 * @param input the elements to be counted.
+			 * @param numElements the number of elements to be counted.
+			 * @param bins the buffer receiving one <code>cl_uint</code> count per bin. It is cleared first.
+			 * @param numBins the number of bins.
+			 * @param lowerBound the inclusive lower bound of the first bin.
+			 * @param upperBound the exclusive upper bound of the last bin.
+			 */
+			[[maybe_unused]] void histogram(
+					const BaseBuffer &input,
+					size_t numElements,
+					const BaseBuffer &bins,
+					cl_uint numBins,
+					T lowerBound,
+					T upperBound
+			);
+
+		private:
+			/**
+			 * @brief Copies the flagged elements in their original order to the front of the output.
+			 * @param input the elements to be compacted.
+			 * @param normalizedFlags one <code>cl_uint</code> per element, 1 to keep the element and 0 to drop it.
+			 * @param output the buffer receiving the kept elements.
+			 * @param numElements the number of elements to be compacted, at least 1.
+			 * @return the number of kept elements.
+			 */
+			size_t compactNormalized(
+					const BaseBuffer &input,
+					const BaseBuffer &normalizedFlags,
+					const BaseBuffer &output,
+					size_t numElements
+			);
+
+			/**
+			 * @brief Enqueues the scan of the passed elements with the passed kernels and recursively scans the tile
+			 * totals.
+			 * @param scanBlocks the kernel scanning the tiles.
+			 * @param addBlockOffsets the kernel adding the scanned tile totals.
+			 * @param workGroupSize the work group size of both kernels.
+			 * @param elementSize the size of an element in bytes.
+			 * @param input the elements to be scanned.
+			 * @param output the buffer receiving the scanned elements.
+			 * @param numElements the number of elements to be scanned.
+			 * @param isInclusive true for an inclusive scan, false for an exclusive scan.
+			 */
+			void enqueueScan(
+					Program &scanBlocks,
+					Program &addBlockOffsets,
+					size_t workGroupSize,
+					size_t elementSize,
+					cl_mem input,
+					cl_mem output,
+					size_t numElements,
+					bool isInclusive
+			);
+
+			/**
+			 * @brief Returns the number of work items which cover the passed number of elements with the passed work
+			 * group size.
+			 * @param numElements the number of elements.
+			 * @param workGroupSize the work group size.
+			 * @return the number of work items rounded up to a multiple of the work group size.
+			 */
+			static size_t roundUp(size_t numElements, size_t workGroupSize);
+	};
+
+	extern template class ParallelPrimitives<cl_int>;
+	extern template class ParallelPrimitives<cl_uint>;
+	extern template class ParallelPrimitives<cl_long>;
+	extern template class ParallelPrimitives<cl_ulong>;
+	extern template class ParallelPrimitives<cl_float>;
+	extern template class ParallelPrimitives<cl_double>;
+}
+
+#endif //OPENCL_TOOLKIT_PARALLEL_PRIMITIVES_H
@@ -0,0 +1,206 @@
+#ifndef OPENCL_TOOLKIT_PIPE_H
+#define OPENCL_TOOLKIT_PIPE_H
+
+#include "portable_opencl_include.h"
+#include "command_queue.h"
+#include "context.h"
+#include "nd_range.h"
+#include "program.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Represents a pipe, a FIFO of fixed size packets through which kernels stream data to other kernels without
+	 * materializing it in a buffer. Pass it to <code>Program::setKernelArg</code> for a <code>pipe</code> argument.
+	 * @details Pipes require OpenCL 2.x, or OpenCL 3.0 with pipe support. Depending on the device, the packets live in
+	 * on-chip memory (e.g. FPGAs) or in global memory.
+	 */
+	class Pipe {
+		private:
+			/**
+			 * The pipe.
+			 */
+			cl_mem self_;
+
+			/**
+			 * The size of a packet in bytes.
+			 */
+			cl_uint packetSizeInBytes_;
+
+			/**
+			 * The max number of packets the pipe holds.
+			 */
+			cl_uint maxNumPackets_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Creates a pipe by the passed parameters.
+			 * @param context a valid OpenCL-context whose devices all support pipes.
+			 * @param packetSizeInBytes the size of a packet in bytes.
+			 * @param maxNumPackets the max number of packets the pipe holds.
+			 * @throws std::runtime_error if a device does not support pipes or the packet size.
+			 */
+			[[maybe_unused]] Pipe(const Context &context, cl_uint packetSizeInBytes, cl_uint maxNumPackets);
+
+			/**
+			 * @brief Deleted copy constructor.
+			 */
+			Pipe(Pipe const &) = delete;
+
+			/**
+			 * @brief Deleted copy assignment.
+			 */
+			void operator=(Pipe const &) = delete;
+
+			/**
+			 * @brief The destructor. Releases the current pipe.
+			 */
+			virtual ~Pipe();
+
+			operator cl_mem() const; // NOLINT(google-explicit-constructor)
+
+			/**
+			 * @brief Returns the size of a packet in bytes.
+			 * @return the size of a packet in bytes.
+			 */
+			[[maybe_unused]] [[nodiscard]] cl_uint getPacketSizeInBytes() const;
+
+			/**
+			 * @brief Returns the max number of packets the current pipe holds.
+			 * @return the max number of packets the current pipe holds.
+			 */
+			[[maybe_unused]] [[nodiscard]] cl_uint getMaxNumPackets() const;
+
+			/**
+			 * @brief Returns true if the passed device supports pipes.
+			 * @param device the device to be checked.
+			 * @return true if the passed device supports pipes.
+			 */
+			[[maybe_unused]] [[nodiscard]] static bool isSupported(cl_device_id device);
+	};
+
+	/**
+	 * @brief Represents a pipe whose packets are values of a type, e.g. <code>cl_float4</code> for a kernel argument
+	 * <code>pipe float4</code>.
+	 * @tparam T the type of the packets.
+	 */
+	template<typename T>
+	class TypedPipe : public Pipe {
+		public:
+			/**
+			 * @brief The parametrized constructor. Creates a pipe of packets of the passed type.
+			 * @param context a valid OpenCL-context whose devices all support pipes.
+			 * @param maxNumPackets the max number of packets the pipe holds.
+			 */
+			[[maybe_unused]] TypedPipe(const Context &context, const cl_uint maxNumPackets) :
+					Pipe(context, sizeof(T), maxNumPackets) {}
+	};
+
+	/**
+	 * @brief The ways of <code>PipeLauncher</code> to schedule the stages.
+	 */
+	enum class PipeScheduling {
+		/**
+		 * The stages run on separate command queues and may overlap, so the consumer drains the pipe while the
+		 * producer fills it. OpenCL does not guarantee that they overlap, so the kernels must not wait for each
+		 * other, and the pipe should hold all packets of a launch unless the device is known to run them
+		 * concurrently.
+		 */
+		Concurrent,
+
+		/**
+		 * The consumer starts after the producer has completed, so the pipe must hold all packets of a launch.
+		 */
+		ProducerFirst
+	};
+
+	/**
+	 * @brief A kernel launch which reads from or writes to a pipe.
+	 */
+	struct PipeStage {
+		/**
+		 * The program whose kernel is launched.
+		 */
+		Program &program;
+
+		/**
+		 * The index of the pipe argument of the kernel.
+		 */
+		cl_uint pipeArgIndex;
+
+		/**
+		 * The number of work items per dimension.
+		 */
+		NDRange globalWorkSize;
+
+		/**
+		 * The number of work items per work group and dimension.
+		 */
+		NDRange localWorkSize;
+	};
+
+	/**
+	 * @brief Launches producer and consumer kernels of a device which are connected by a pipe, each stage on its own
+	 * command queue.
+	 */
+	class PipeLauncher {
+		private:
+			/**
+			 * The pipe between the stages.
+			 */
+			const Pipe &pipe_;
+
+			/**
+			 * The command queue of the producers.
+			 */
+			CommandQueue producerQueue_;
+
+			/**
+			 * The command queue of the consumers.
+			 */
+			CommandQueue consumerQueue_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Creates the command queues of the stages.
+			 * @param context a valid OpenCL-context.
+			 * @param device the device which runs both stages.
+			 * @param pipe the pipe between the stages which outlives the current instance.
+			 */
+			[[maybe_unused]] PipeLauncher(const Context &context, cl_device_id device, const Pipe &pipe);
+
+			/**
+			 * @brief Binds the pipe to both kernels and enqueues them without awaiting them.
+			 * @param producer the launch of the kernel which writes the packets.
+			 * @param consumer the launch of the kernel which reads the packets.
+			 * @param scheduling whether the stages may overlap.
+			 */
+			[[maybe_unused]] void launch(
+					const PipeStage &producer,
+					const PipeStage &consumer,
+					PipeScheduling scheduling = PipeScheduling::Concurrent
+			);
+
+			/**
+			 * @brief Awaits all launched stages.
+			 */
+			[[maybe_unused]] void finish();
+
+			/**
+			 * @brief Returns the command queue of the producers, e.g. to upload their input.
+			 * @return the command queue of the producers.
+			 */
+			[[maybe_unused]] [[nodiscard]] CommandQueue &getProducerQueue();
+
+			/**
+			 * @brief Returns the command queue of the consumers, e.g. to download their output.
+			 * @return the command queue of the consumers.
+			 */
+			[[maybe_unused]] [[nodiscard]] CommandQueue &getConsumerQueue();
+	};
+}
+
+#endif //OPENCL_TOOLKIT_PIPE_H
@@ -2,16 +2,58 @@
 #define OPENCL_TOOLKIT_PROGRAM_H
 
 #include <string>
+#include <vector>
 
 #include "portable_opencl_include.h"
 #include "read_only_buffer.h"
 #include "write_only_buffer.h"
+#include "kernel_library.h"
 
 /**
  * @brief Namespace of this toolkit.
  */
 namespace OpenClToolkit {
 
+	class Pipe;
+
+	/**
+	 * @brief The resource usage of a kernel on its target device, as reported by the compiler.
+	 */
+	struct KernelResources {
+		/**
+		 * The name of the kernel.
+		 */
+		std::string kernelName;
+
+		/**
+		 * The max number of work items of a work group, which the register usage of the kernel may lower below the
+		 * max of the device.
+		 */
+		size_t maxWorkGroupSize;
+
+		/**
+		 * The work group size required by the <code>reqd_work_group_size</code> attribute, all 0 if none.
+		 */
+		size_t compileWorkGroupSize[3];
+
+		/**
+		 * The local memory of a work group in bytes, including the local memory arguments set so far.
+		 */
+		cl_ulong localMemorySize;
+
+		/**
+		 * The private memory of a work item in bytes. Drivers which keep private variables in registers only report
+		 * the spilled part.
+		 */
+		cl_ulong privateMemorySize;
+
+		/**
+		 * The multiple of work group sizes which the device executes best, typically the width of a warp or
+		 * wavefront.
+		 */
+		size_t preferredWorkGroupSizeMultiple;
+	};
+
 	/**
 	 * @brief Represents a program written in OpenCL that consists of one kernel.
 	 */
@@ -45,14 +87,67 @@ namespace OpenClToolkit {
 			 *                   passed source code.
 			 * @param context a valid OpenCL-context.
 			 * @param device the target device of the current program.
+			 * @param buildOptions an optional string with the build options passed to the OpenCL compiler.
+			 */
+			[[maybe_unused]] Program(
+					const char *kernelSourceCode,
+					const std::string &kernelName,
+					const Context& context,
+					cl_device_id device,
+					const std::string &buildOptions = ""
+			);
+
+			/**
+			 * @brief The parametrized constructor. Creates an OpenCL-program from an intermediate language (e.g. SPIR-V)
+			 * module, so the OpenCL C front end of the driver is skipped at build time.
+			 * @param intermediateLanguage the intermediate language module, e.g. the content of a <code>.spv</code> file.
+			 * @param intermediateLanguageSizeInBytes the size of the passed intermediate language module in bytes.
+			 * @param kernelName the name of the function declared with the <code>__kernel</code> qualifier inside the
+			 *                   passed module.
+			 * @param context a valid OpenCL-context.
+			 * @param device the target device of the current program.
+			 * @param buildOptions an optional string with the build options passed to the OpenCL compiler.
+			 */
+			[[maybe_unused]] Program(
+					const void *intermediateLanguage,
+					size_t intermediateLanguageSizeInBytes,
+					const std::string &kernelName,
+					const Context& context,
+					cl_device_id device,
+					const std::string &buildOptions = ""
+			);
+
+			/**
+			 * @brief The parametrized constructor. Creates an OpenCL-program by compiling the passed source code with
+			 * the embedded headers of the passed library and linking it against the compiled library, so the shared
+			 * device code is not compiled again for each program.
+			 * @param kernelSourceCode the kernel source code as a <strong>null-terminated C-style</strong> string. It
+			 *                         may include the headers of the passed library.
+			 * @param kernelName the name of the function declared with the <code>__kernel</code> qualifier inside the
+			 *                   passed source code or inside the library.
+			 * @param library the library to be linked against.
+			 * @param context a valid OpenCL-context. It must be the context of the passed library.
+			 * @param device the target device of the current program.
+			 * @param buildOptions an optional string with the compile options in addition to the library options.
 			 */
 			[[maybe_unused]] Program(
 					const char *kernelSourceCode,
 					const std::string &kernelName,
+					KernelLibrary &library,
 					const Context& context,
-					cl_device_id device
+					cl_device_id device,
+					const std::string &buildOptions = ""
 			);
 
+			/**
+			 * @brief The parametrized constructor. Creates another kernel of an already built OpenCL-program. The
+			 * program object is shared, but the kernel and thus its arguments belong to the new instance only.
+			 * @param builtProgram the already built program.
+			 * @param kernelName the name of the function declared with the <code>__kernel</code> qualifier inside the
+			 *                   passed program.
+			 */
+			[[maybe_unused]] Program(const Program &builtProgram, const std::string &kernelName);
+
 			/**
 			 * @brief The destructor.
 			 */
@@ -64,6 +159,24 @@ namespace OpenClToolkit {
 			 */
 			[[maybe_unused]] [[nodiscard]] cl_kernel getKernel() const;
 
+			/**
+			 * @brief Returns the target device of the current program.
+			 * @return the target device of the current program.
+			 */
+			[[maybe_unused]] [[nodiscard]] cl_device_id getDevice() const;
+
+			/**
+			 * @brief Returns the name of the function declared with the <code>__kernel</code> qualifier.
+			 * @return the name of the kernel.
+			 */
+			[[maybe_unused]] [[nodiscard]] const std::string &getKernelName() const;
+
+			/**
+			 * @brief Queries the resource usage of the kernel of the current program on the target device.
+			 * @return the resource usage of the kernel.
+			 */
+			[[maybe_unused]] [[nodiscard]] KernelResources getKernelResources() const;
+
 			/**
 			 * @brief Sets the argument value for a specific argument of the current associated kernel.
 			 * @param argIndex the argument index. 0 for the leftmost argument to n - 1.
@@ -80,6 +193,35 @@ namespace OpenClToolkit {
 			 */
 			[[maybe_unused]] void setKernelArg(cl_uint argIndex, size_t argSize, cl_mem buffer);
 
+			/**
+			 * @brief Sets a sampler as the argument value for a specific argument of the current associated kernel.
+			 * @param argIndex the argument index. 0 for the leftmost argument to n - 1.
+			 * @param sampler the sampler that should be used as the argument value for argument specified by arg_index.
+			 */
+			[[maybe_unused]] void setKernelArg(cl_uint argIndex, cl_sampler sampler);
+
+			/**
+			 * @brief Sets a pipe as the argument value for a specific argument of the current associated kernel.
+			 * @param argIndex the argument index. 0 for the leftmost argument to n - 1.
+			 * @param pipe the pipe that should be used as the argument value for argument specified by arg_index.
+			 */
+			[[maybe_unused]] void setKernelArg(cl_uint argIndex, const Pipe &pipe);
+
+			/**
+			 * @brief Sets a pointer into shared virtual memory as the argument value for a specific argument of the
+			 * current associated kernel.
+			 * @param argIndex the argument index. 0 for the leftmost argument to n - 1.
+			 * @param pointer the pointer into memory of an <code>SvmAllocator</code> with shared virtual memory.
+			 */
+			[[maybe_unused]] void setKernelArgSvmPointer(cl_uint argIndex, const void *pointer);
+
+			/**
+			 * @brief Declares the shared virtual memory which the kernel reaches only through pointers stored inside
+			 * other memory, e.g. the nodes of a tree. Replaces the previous declaration.
+			 * @param pointers the pointers to the allocations reached indirectly.
+			 */
+			[[maybe_unused]] void setIndirectSvmPointers(const std::vector<void *> &pointers);
+
 			/**
 			 * @brief Returns the max work group size in bytes for the kernel of the current program.
 			 * @return the max work group size in bytes for the kernel of the current program.
@@ -117,7 +259,37 @@ namespace OpenClToolkit {
 			 */
 			[[maybe_unused]] void printDeviceMemoryInfo(bool useStderr = false) const;
 
+			/**
+			 * @brief Returns true if the passed device accepts SPIR-V modules, i.e. if programs can be created from an
+			 * intermediate language for it.
+			 * @param device the device to be checked.
+			 * @return true if the passed device accepts SPIR-V modules.
+			 */
+			[[maybe_unused]] [[nodiscard]] static bool isIntermediateLanguageSupported(cl_device_id device);
+
 		private:
+			/**
+			 * @brief Builds the created program object for the target device and creates the kernel of the current
+			 * program.
+			 * @param buildOptions the build options passed to the OpenCL compiler.
+			 * @param buildKind the kind of build reported to the metrics, e.g. "source".
+			 */
+			void buildAndCreateKernel(const std::string &buildOptions, const char *buildKind);
+
+			/**
+			 * @brief Creates the kernel of the current program from the built program object.
+			 */
+			void createKernel();
+
+			/**
+			 * @brief Sets the argument value for a specific argument of the current associated kernel without
+			 * recording it.
+			 * @param argIndex the argument index. 0 for the leftmost argument to n - 1.
+			 * @param argSize  specifies the size of the argument value.
+			 * @param argValue the pointer to the argument value, nullptr for local memory.
+			 */
+			void applyKernelArg(cl_uint argIndex, size_t argSize, const void *argValue);
+
 			/**
 			 * @brief Converts the passed error code into a meaningful failure message why the kernel creation failed.
 			 * @param errorCode the error code to be converted into a meaningful failure message.
@@ -0,0 +1,130 @@
+#ifndef OPENCL_TOOLKIT_PROGRAM_BUILDER_H
+#define OPENCL_TOOLKIT_PROGRAM_BUILDER_H
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "portable_opencl_include.h"
+#include "program.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Builds OpenCL-programs concurrently on a small pool of worker threads.
+	 * @details Each submitted build runs <code>clBuildProgram</code> on one of the workers, so several programs are
+	 * compiled at the same time and the total build time is dominated by the slowest single build. Each build is
+	 * represented by a future which becomes ready as soon as its program is usable. Errors raised while building are
+	 * rethrown by <code>std::future::get</code>.
+	 * The passed contexts must outlive the submitted builds.
+	 */
+	class ProgramBuilder {
+		private:
+			/**
+			 * The pending builds.
+			 */
+			std::deque<std::packaged_task<std::unique_ptr<Program>()>> pendingBuilds_;
+
+			/**
+			 * Guards the pending builds and the shutdown flag.
+			 */
+			std::mutex mutex_;
+
+			/**
+			 * Signals the workers that a build was submitted or the builder shuts down.
+			 */
+			std::condition_variable buildSubmitted_;
+
+			/**
+			 * True if the builder shuts down.
+			 */
+			bool isShuttingDown_;
+
+			/**
+			 * The worker threads.
+			 */
+			std::vector<std::thread> workers_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Starts the worker threads.
+			 * @param numWorkers the number of builds which are executed at the same time. If 0, the number of
+			 *                   concurrent threads supported by the current system is used.
+			 */
+			[[maybe_unused]] explicit ProgramBuilder(size_t numWorkers = 0);
+
+			/**
+			 * @brief The destructor. Finishes all pending builds and stops the worker threads.
+			 */
+			~ProgramBuilder();
+
+			/**
+			 * @brief The copy constructor.
+			 */
+			ProgramBuilder(ProgramBuilder const &) = delete;
+
+			/**
+			 * @brief The assigment operator.
+			 */
+			void operator=(ProgramBuilder const &) = delete;
+
+			/**
+			 * @brief Submits the build of an OpenCL-program from kernel source code.
+			 * @param kernelSourceCode the kernel source code.
+			 * @param kernelName the name of the function declared with the <code>__kernel</code> qualifier inside the
+			 *                   passed source code.
+			 * @param context a valid OpenCL-context which outlives the build.
+			 * @param device the target device of the program.
+			 * @param buildOptions an optional string with the build options passed to the OpenCL compiler.
+			 * @return a future which becomes ready as soon as the program is built.
+			 */
+			[[maybe_unused]] std::future<std::unique_ptr<Program>> submit(
+					std::string kernelSourceCode,
+					std::string kernelName,
+					const Context &context,
+					cl_device_id device,
+					std::string buildOptions = ""
+			);
+
+			/**
+			 * @brief Submits the build of an OpenCL-program from an intermediate language (e.g. SPIR-V) module.
+			 * @param intermediateLanguage the intermediate language module.
+			 * @param kernelName the name of the function declared with the <code>__kernel</code> qualifier inside the
+			 *                   passed module.
+			 * @param context a valid OpenCL-context which outlives the build.
+			 * @param device the target device of the program.
+			 * @param buildOptions an optional string with the build options passed to the OpenCL compiler.
+			 * @return a future which becomes ready as soon as the program is built.
+			 */
+			[[maybe_unused]] std::future<std::unique_ptr<Program>> submit(
+					std::vector<unsigned char> intermediateLanguage,
+					std::string kernelName,
+					const Context &context,
+					cl_device_id device,
+					std::string buildOptions = ""
+			);
+
+		private:
+			/**
+			 * @brief Enqueues the passed build and wakes up a worker.
+			 * @param build the build to be enqueued.
+			 * @return the future of the passed build.
+			 */
+			std::future<std::unique_ptr<Program>> enqueue(std::packaged_task<std::unique_ptr<Program>()> build);
+
+			/**
+			 * @brief The loop of each worker thread. Executes the pending builds until the builder shuts down.
+			 */
+			void work();
+	};
+}
+
+#endif //OPENCL_TOOLKIT_PROGRAM_BUILDER_H
@@ -0,0 +1,171 @@
+#ifndef OPENCL_TOOLKIT_PROGRAM_REGISTRY_H
+#define OPENCL_TOOLKIT_PROGRAM_REGISTRY_H
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+#include "portable_opencl_include.h"
+#include "program.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Represents a thread-safe, process-wide registry of built OpenCL-programs.
+	 * @details Programs are keyed by their source code or intermediate language module, the build options, the
+	 * context and the device, so all kernels of a source share one build. Concurrent requests for the same key trigger
+	 * exactly one build while the other callers wait for it. Requests for the kernel the program was built with share
+	 * the registered program, requests for another kernel of it get a kernel created from the registered program.
+	 * Once the registry holds more programs than its capacity, the least recently used programs which are no longer
+	 * referenced outside the registry are evicted.
+	 * Since the returned programs are shared, so are their kernel arguments. Callers which set kernel arguments
+	 * concurrently should create a private kernel with <code>Program(const Program &, const std::string &)</code>.
+	 */
+	class ProgramRegistry {
+		private:
+			/**
+			 * The key of a program: the source hash, whether the source is an intermediate language module, the source
+			 * code or module, the build options, the context and the device. The hash orders most keys without
+			 * comparing the source, which still tells apart sources with colliding hashes.
+			 */
+			using Key = std::tuple<uint64_t, bool, std::string, std::string, cl_context, cl_device_id>;
+
+			/**
+			 * @brief Represents a registered program.
+			 */
+			struct Entry {
+				/**
+				 * The program, ready as soon as its single build finished.
+				 */
+				std::shared_future<std::shared_ptr<Program>> program;
+
+				/**
+				 * The position of the key in the usage order.
+				 */
+				std::list<Key>::iterator usagePosition;
+			};
+
+			/**
+			 * The registered programs.
+			 */
+			std::map<Key, Entry> entries_;
+
+			/**
+			 * The keys of the registered programs, the most recently used first.
+			 */
+			std::list<Key> usageOrder_;
+
+			/**
+			 * The number of programs above which unreferenced programs are evicted.
+			 */
+			size_t capacity_;
+
+			/**
+			 * Guards the entries and the usage order.
+			 */
+			mutable std::mutex mutex_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor.
+			 * @param capacity the number of programs above which unreferenced programs are evicted.
+			 */
+			[[maybe_unused]] explicit ProgramRegistry(size_t capacity = 64);
+
+			/**
+			 * @brief The copy constructor.
+			 */
+			ProgramRegistry(ProgramRegistry const &) = delete;
+
+			/**
+			 * @brief The assigment operator.
+			 */
+			void operator=(ProgramRegistry const &) = delete;
+
+			/**
+			 * @brief Returns the process-wide instance of this class.
+			 * @return the process-wide instance of this class.
+			 */
+			[[maybe_unused]] static ProgramRegistry &getInstance();
+
+			/**
+			 * @brief Returns a kernel of the registered program for the passed parameters. If no such program is
+			 * registered, it is built by the current thread while concurrent callers with the same parameters wait for
+			 * it.
+			 * @param kernelSourceCode the kernel source code.
+			 * @param kernelName the name of the function declared with the <code>__kernel</code> qualifier inside the
+			 *                   passed source code.
+			 * @param context a valid OpenCL-context which outlives the registered program.
+			 * @param device the target device of the program.
+			 * @param buildOptions an optional string with the build options passed to the OpenCL compiler.
+			 * @return the shared program.
+			 */
+			[[maybe_unused]] std::shared_ptr<Program> acquire(
+					const std::string &kernelSourceCode,
+					const std::string &kernelName,
+					const Context &context,
+					cl_device_id device,
+					const std::string &buildOptions = ""
+			);
+
+			/**
+			 * @brief Returns a kernel of the registered program built from the passed intermediate language module,
+			 * e.g. SPIR-V. If no such program is registered, it is built by the current thread while concurrent callers
+			 * with the same parameters wait for it.
+			 * @param intermediateLanguage the module.
+			 * @param intermediateLanguageSizeInBytes the size of the module in bytes.
+			 * @param kernelName the name of a kernel inside the passed module.
+			 * @param context a valid OpenCL-context which outlives the registered program.
+			 * @param device the target device of the program.
+			 * @param buildOptions an optional string with the build options passed to the OpenCL compiler.
+			 * @return the shared program.
+			 */
+			[[maybe_unused]] std::shared_ptr<Program> acquireIntermediateLanguage(
+					const void *intermediateLanguage,
+					size_t intermediateLanguageSizeInBytes,
+					const std::string &kernelName,
+					const Context &context,
+					cl_device_id device,
+					const std::string &buildOptions = ""
+			);
+
+			/**
+			 * @brief Returns the number of registered programs, including the ones being built.
+			 * @return the number of registered programs.
+			 */
+			[[maybe_unused]] [[nodiscard]] size_t size() const;
+
+			/**
+			 * @brief Evicts all programs which are no longer referenced outside the registry.
+			 */
+			[[maybe_unused]] void evictUnreferenced();
+
+		private:
+			/**
+			 * @brief Returns the registered program for the passed key. If no such program is registered, it is built
+			 * by the current thread while concurrent callers with the same key wait for it.
+			 * @param key the key of the program.
+			 * @param build builds the program.
+			 * @return the shared program.
+			 */
+			std::shared_ptr<Program> acquire(const Key &key, const std::function<std::shared_ptr<Program>()> &build);
+
+			/**
+			 * @brief Evicts the least recently used, unreferenced programs until the capacity is met or no such program
+			 * is left. The caller must hold the mutex.
+			 * @param evictAll if true, all unreferenced programs are evicted regardless of the capacity.
+			 */
+			void evict(bool evictAll);
+	};
+}
+
+#endif //OPENCL_TOOLKIT_PROGRAM_REGISTRY_H
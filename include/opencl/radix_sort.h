@@ -0,0 +1,108 @@
+#ifndef OPENCL_TOOLKIT_RADIX_SORT_H
+#define OPENCL_TOOLKIT_RADIX_SORT_H
+
+#include <memory>
+
+#include "portable_opencl_include.h"
+#include "command_queue.h"
+#include "parallel_primitives.h"
+#include "program.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Sorts unsigned keys, optionally together with <code>cl_uint</code> values, directly in device buffers.
+	 * @details The sort is a stable least significant digit radix sort with 4-bit digits. Each pass counts the digits
+	 * per block in local memory, scans the counts with <code>ParallelPrimitives</code> and scatters the keys after
+	 * sorting each chunk by the digit in local memory, so writes of equal digits are contiguous.
+	 * Signed or floating-point keys can be sorted after mapping them to unsigned keys which preserve the order, e.g. by
+	 * flipping the sign bit. To sort larger payloads, sort their indices as values and gather the payloads afterwards.
+	 * At most 2^32 - 1 elements can be sorted at once. An instance must not be used by several threads at the same
+	 * time. All commands are enqueued into the passed command queue.
+	 * Supported key types are <code>cl_uint</code> and <code>cl_ulong</code>.
+	 * @tparam K the key type.
+	 */
+	template<typename K>
+	class RadixSort {
+		private:
+			/**
+			 * The context of the device buffers.
+			 */
+			const Context &context_;
+
+			/**
+			 * The command queue which executes the sort.
+			 */
+			CommandQueue &commandQueue_;
+
+			/**
+			 * The kernel counting the digits per block.
+			 */
+			std::unique_ptr<Program> histogram_;
+
+			/**
+			 * The kernel moving the keys and values to their positions for the current digit.
+			 */
+			std::unique_ptr<Program> scatter_;
+
+			/**
+			 * Scans the digit counts.
+			 */
+			ParallelPrimitives<cl_uint> scan_;
+
+			/**
+			 * The work group size of both kernels.
+			 */
+			size_t workGroupSize_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Builds the kernels or takes them from the program registry.
+			 * @param context a valid OpenCL-context which outlives the current instance.
+			 * @param device the target device.
+			 * @param commandQueue the command queue of the target device which outlives the current instance.
+			 */
+			[[maybe_unused]] RadixSort(const Context &context, cl_device_id device, CommandQueue &commandQueue);
+
+			/**
+			 * @brief Sorts the passed keys in ascending order.
+			 * @param keys the keys to be sorted in place.
+			 * @param numElements the number of keys.
+			 * @param numKeyBits an optional number of the least significant bits which are sorted by, e.g. 20 if all
+			 *                   keys are less than 2^20. Fewer bits take fewer passes.
+			 */
+			[[maybe_unused]] void sort(const BaseBuffer &keys, size_t numElements, size_t numKeyBits = sizeof(K) * 8);
+
+			/**
+			 * @brief Sorts the passed keys in ascending order and moves the values along with their keys.
+			 * @param keys the keys to be sorted in place.
+			 * @param values one <code>cl_uint</code> value per key, permuted in place.
+			 * @param numElements the number of keys.
+			 * @param numKeyBits an optional number of the least significant bits which are sorted by.
+			 */
+			[[maybe_unused]] void sortByKey(
+					const BaseBuffer &keys,
+					const BaseBuffer &values,
+					size_t numElements,
+					size_t numKeyBits = sizeof(K) * 8
+			);
+
+		private:
+			/**
+			 * @brief Enqueues all passes of the sort.
+			 * @param keys the keys to be sorted in place.
+			 * @param values the values to be permuted in place or nullptr.
+			 * @param numElements the number of keys.
+			 * @param numKeyBits the number of the least significant bits which are sorted by.
+			 */
+			void enqueueSort(const BaseBuffer &keys, const BaseBuffer *values, size_t numElements, size_t numKeyBits);
+	};
+
+	extern template class RadixSort<cl_uint>;
+	extern template class RadixSort<cl_ulong>;
+}
+
+#endif //OPENCL_TOOLKIT_RADIX_SORT_H
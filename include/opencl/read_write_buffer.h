@@ -0,0 +1,26 @@
+#ifndef OPENCL_TOOLKIT_READ_WRITE_BUFFER_H
+#define OPENCL_TOOLKIT_READ_WRITE_BUFFER_H
+
+#include "base_buffer.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Represents a buffer which is read and written by kernels, e.g. for intermediate results.
+	 */
+	class ReadWriteBuffer : public BaseBuffer {
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Creates an instance of this class by the passed parameters.
+			 * @param context a valid OpenCL-context.
+			 * @param size the size of the buffer in bytes.
+			 */
+			[[maybe_unused]] ReadWriteBuffer(const Context& context, size_t size);
+	};
+}
+
+#endif //OPENCL_TOOLKIT_READ_WRITE_BUFFER_H
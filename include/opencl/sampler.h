@@ -0,0 +1,59 @@
+#ifndef OPENCL_TOOLKIT_SAMPLER_H
+#define OPENCL_TOOLKIT_SAMPLER_H
+
+#include "portable_opencl_include.h"
+#include "context.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Represents a sampler, which defines how kernels read images: the coordinate normalization, the boundary
+	 * handling and the filtering. Pass it to <code>Program::setKernelArg</code> for a <code>sampler_t</code> argument.
+	 */
+	class Sampler {
+		private:
+			/**
+			 * The sampler.
+			 */
+			cl_sampler self_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Creates a sampler by the passed parameters.
+			 * @param context a valid OpenCL-context.
+			 * @param isNormalizedCoordinates whether the coordinates are in [0, 1) instead of pixels.
+			 * @param addressingMode the handling of coordinates outside the image, e.g.
+			 *                       <code>CL_ADDRESS_CLAMP_TO_EDGE</code>.
+			 * @param filterMode <code>CL_FILTER_LINEAR</code> for bilinear (trilinear in 3-D) interpolation,
+			 *                   <code>CL_FILTER_NEAREST</code> for none.
+			 */
+			[[maybe_unused]] Sampler(
+					const Context &context,
+					bool isNormalizedCoordinates,
+					cl_addressing_mode addressingMode,
+					cl_filter_mode filterMode
+			);
+
+			/**
+			 * @brief Deleted copy constructor.
+			 */
+			Sampler(Sampler const &) = delete;
+
+			/**
+			 * @brief Deleted copy assignment.
+			 */
+			void operator=(Sampler const &) = delete;
+
+			/**
+			 * @brief The destructor. Releases the current sampler.
+			 */
+			~Sampler();
+
+			operator cl_sampler() const; // NOLINT(google-explicit-constructor)
+	};
+}
+
+#endif //OPENCL_TOOLKIT_SAMPLER_H
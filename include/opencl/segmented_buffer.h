@@ -0,0 +1,112 @@
+#ifndef OPENCL_TOOLKIT_SEGMENTED_BUFFER_H
+#define OPENCL_TOOLKIT_SEGMENTED_BUFFER_H
+
+#include <memory>
+#include <vector>
+
+#include "portable_opencl_include.h"
+#include "base_buffer.h"
+#include "context.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Represents a virtual buffer which spans several allocations, so its size is not limited by
+	 * <code>CL_DEVICE_MAX_MEM_ALLOC_SIZE</code>. No element straddles two segments.
+	 * @details Use <code>CommandQueue::enqueueCommandCopyBytesFromHostMemoryIntoSegmentedBuffer</code> and its
+	 * counterpart for transfers across segment boundaries, and
+	 * <code>CommandQueue::enqueueCommandExecuteProgramOnSegments</code> to run a kernel over all segments.
+	 */
+	class SegmentedBuffer {
+		private:
+			/**
+			 * The segments in order.
+			 */
+			std::vector<std::unique_ptr<BaseBuffer>> segments_;
+
+			/**
+			 * The size of the virtual buffer in bytes.
+			 */
+			size_t sizeInBytes_;
+
+			/**
+			 * The size of an element in bytes.
+			 */
+			size_t elementSizeInBytes_;
+
+			/**
+			 * The size of all segments but the last one in bytes, a multiple of the element size.
+			 */
+			size_t segmentSizeInBytes_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Allocates as few segments as the device allows.
+			 * @param context a valid OpenCL-context.
+			 * @param device the device whose allocation limit applies.
+			 * @param sizeInBytes the size of the virtual buffer in bytes, a multiple of the element size.
+			 * @param elementSizeInBytes the size of an element in bytes.
+			 * @param flags the memory flags of the segments.
+			 * @param maxSegmentSizeInBytes the max size of a segment in bytes, 0 for the allocation limit of the device.
+			 */
+			[[maybe_unused]] SegmentedBuffer(
+					const Context &context,
+					cl_device_id device,
+					size_t sizeInBytes,
+					size_t elementSizeInBytes = 1,
+					cl_mem_flags flags = CL_MEM_READ_WRITE,
+					size_t maxSegmentSizeInBytes = 0
+			);
+
+			/**
+			 * @brief Returns the size of the virtual buffer in bytes.
+			 * @return the size of the virtual buffer in bytes.
+			 */
+			[[maybe_unused]] [[nodiscard]] size_t getSizeInBytes() const;
+
+			/**
+			 * @brief Returns the size of an element in bytes.
+			 * @return the size of an element in bytes.
+			 */
+			[[maybe_unused]] [[nodiscard]] size_t getElementSizeInBytes() const;
+
+			/**
+			 * @brief Returns the number of segments.
+			 * @return the number of segments.
+			 */
+			[[maybe_unused]] [[nodiscard]] size_t getNumSegments() const;
+
+			/**
+			 * @brief Returns a segment.
+			 * @param index the index of the segment.
+			 * @return the segment.
+			 */
+			[[maybe_unused]] [[nodiscard]] const BaseBuffer &getSegment(size_t index) const;
+
+			/**
+			 * @brief Returns the offset of a segment in the virtual buffer.
+			 * @param index the index of the segment.
+			 * @return the offset of the segment in bytes.
+			 */
+			[[maybe_unused]] [[nodiscard]] size_t getSegmentOffsetInBytes(size_t index) const;
+
+			/**
+			 * @brief Returns the size of a segment.
+			 * @param index the index of the segment.
+			 * @return the size of the segment in bytes.
+			 */
+			[[maybe_unused]] [[nodiscard]] size_t getSegmentSizeInBytes(size_t index) const;
+
+			/**
+			 * @brief Returns the index of the segment which holds the passed byte.
+			 * @param offsetInBytes the offset of the byte in the virtual buffer.
+			 * @return the index of the segment.
+			 */
+			[[maybe_unused]] [[nodiscard]] size_t getSegmentIndex(size_t offsetInBytes) const;
+	};
+}
+
+#endif //OPENCL_TOOLKIT_SEGMENTED_BUFFER_H
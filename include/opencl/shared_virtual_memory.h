@@ -0,0 +1,272 @@
+#ifndef OPENCL_TOOLKIT_SHARED_VIRTUAL_MEMORY_H
+#define OPENCL_TOOLKIT_SHARED_VIRTUAL_MEMORY_H
+
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include "portable_opencl_include.h"
+#include "command_queue.h"
+#include "context.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief The kinds of memory handed out by <code>SvmAllocator</code>, ordered by increasing capability.
+	 */
+	enum class SvmGranularity {
+		/**
+		 * Plain host memory, used if the device lacks the requested shared virtual memory. It cannot be passed to
+		 * kernels.
+		 */
+		None,
+
+		/**
+		 * Coarse-grained shared virtual memory. The host must map it (see <code>SvmMapGuard</code>) before accessing
+		 * it while kernels may use it.
+		 */
+		CoarseGrain,
+
+		/**
+		 * Fine-grained shared virtual memory. The host and the device may access it without mapping.
+		 */
+		FineGrain
+	};
+
+	/**
+	 * @brief Returns the finest granularity up to the passed one which the passed device supports.
+	 * @param device the target device.
+	 * @param requestedGranularity the finest granularity wanted.
+	 * @return the granularity to be used, <code>SvmGranularity::None</code> if the device lacks shared virtual memory.
+	 */
+	[[maybe_unused]] SvmGranularity getSupportedSvmGranularity(
+			cl_device_id device,
+			SvmGranularity requestedGranularity = SvmGranularity::FineGrain
+	);
+
+	/**
+	 * @brief Allocates shared virtual memory, or host memory for <code>SvmGranularity::None</code>.
+	 * @param context the context of the memory.
+	 * @param granularity the kind of memory.
+	 * @param sizeInBytes the size in bytes.
+	 * @param alignment the alignment in bytes, a power of two.
+	 * @return the allocated memory.
+	 * @throws std::bad_alloc if the memory cannot be allocated.
+	 */
+	void *allocateSharedVirtualMemory(
+			cl_context context,
+			SvmGranularity granularity,
+			size_t sizeInBytes,
+			size_t alignment
+	);
+
+	/**
+	 * @brief Frees memory allocated by <code>allocateSharedVirtualMemory</code>.
+	 * @param context the context of the memory.
+	 * @param granularity the kind of memory.
+	 * @param memory the memory to be freed.
+	 * @param alignment the alignment passed to the allocation.
+	 */
+	void freeSharedVirtualMemory(
+			cl_context context,
+			SvmGranularity granularity,
+			void *memory,
+			size_t alignment
+	) noexcept;
+
+	/**
+	 * @brief An allocator of shared virtual memory which satisfies the allocator requirements of the standard library,
+	 * so containers such as <code>std::vector</code> or node-based structures can be passed to kernels without
+	 * flattening them. Pointers inside the memory stay valid on the device.
+	 * @details The containers construct, copy and destroy their elements on the host at any time, which coarse-grained
+	 * shared virtual memory only allows while mapped. So the allocator hands out fine-grained shared virtual memory
+	 * only, and falls back to plain host memory if the device lacks it; <code>getGranularity</code> tells which. The
+	 * host may access the elements without mapping, but not while a kernel which uses them is running. For
+	 * coarse-grained memory, use <code>allocateSharedVirtualMemory</code> and <code>SvmMapGuard</code> directly. The
+	 * context must outlive all memory of the allocator.
+	 * @tparam T the type of the elements.
+	 */
+	template<typename T>
+	class SvmAllocator {
+		template<typename U>
+		friend class SvmAllocator;
+
+		private:
+			/**
+			 * The context of the memory.
+			 */
+			cl_context context_;
+
+			/**
+			 * The kind of memory.
+			 */
+			SvmGranularity granularity_;
+
+		public:
+			/**
+			 * The type of the elements.
+			 */
+			using value_type = T;
+
+			/**
+			 * @brief The parametrized constructor.
+			 * @param context a valid OpenCL-context which outlives all memory of the allocator.
+			 * @param device the device which uses the memory.
+			 * @param requestedGranularity <code>SvmGranularity::FineGrain</code>, or <code>SvmGranularity::None</code>
+			 *                             for host memory.
+			 * @throws std::runtime_error if coarse-grained memory is requested.
+			 */
+			[[maybe_unused]] SvmAllocator(
+					const Context &context,
+					cl_device_id device,
+					SvmGranularity requestedGranularity = SvmGranularity::FineGrain
+			) : context_(context), granularity_(toAllocatorGranularity(device, requestedGranularity)) {}
+
+			/**
+			 * @brief The converting constructor required to rebind the allocator to other element types.
+			 * @param other the allocator to be rebound.
+			 */
+			template<typename U>
+			SvmAllocator(const SvmAllocator<U> &other) noexcept : // NOLINT(google-explicit-constructor)
+					context_(other.context_),
+					granularity_(other.granularity_) {}
+
+			/**
+			 * @brief Allocates memory for the passed number of elements.
+			 * @param numElements the number of elements.
+			 * @return the allocated memory.
+			 * @throws std::bad_alloc if the memory cannot be allocated.
+			 */
+			[[nodiscard]] T *allocate(const size_t numElements) {
+				if (numElements > static_cast<size_t>(-1) / sizeof(T)) {
+					throw std::bad_array_new_length();
+				}
+				return static_cast<T *>(allocateSharedVirtualMemory(
+						context_,
+						granularity_,
+						numElements * sizeof(T),
+						alignof(T)
+				));
+			}
+
+			/**
+			 * @brief Frees memory allocated by the current allocator or an equal one.
+			 * @param elements the memory to be freed.
+			 */
+			void deallocate(T *elements, size_t) noexcept {
+				freeSharedVirtualMemory(context_, granularity_, elements, alignof(T));
+			}
+
+			/**
+			 * @brief Returns the kind of memory handed out.
+			 * @return the kind of memory handed out.
+			 */
+			[[maybe_unused]] [[nodiscard]] SvmGranularity getGranularity() const {
+				return granularity_;
+			}
+
+			/**
+			 * @brief Returns whether both allocators can free the memory of each other.
+			 * @param other the other allocator.
+			 * @return whether both allocators can free the memory of each other.
+			 */
+			template<typename U>
+			bool operator==(const SvmAllocator<U> &other) const {
+				return context_ == other.context_ && granularity_ == other.granularity_;
+			}
+
+			/**
+			 * @brief Returns whether the allocators cannot free the memory of each other.
+			 * @param other the other allocator.
+			 * @return whether the allocators cannot free the memory of each other.
+			 */
+			template<typename U>
+			bool operator!=(const SvmAllocator<U> &other) const {
+				return !(*this == other);
+			}
+
+		private:
+			/**
+			 * @brief Returns the granularity of the memory handed out for the passed device.
+			 * @param device the device which uses the memory.
+			 * @param requestedGranularity the finest granularity wanted.
+			 * @return <code>SvmGranularity::FineGrain</code> if requested and supported, otherwise
+			 *         <code>SvmGranularity::None</code>.
+			 */
+			static SvmGranularity toAllocatorGranularity(
+					cl_device_id device,
+					const SvmGranularity requestedGranularity
+			) {
+				if (requestedGranularity == SvmGranularity::CoarseGrain) {
+					// let it crash
+					throw std::runtime_error("Coarse-grained shared virtual memory cannot be accessed without mapping");
+				}
+				const SvmGranularity granularity = getSupportedSvmGranularity(device, requestedGranularity);
+				return granularity == SvmGranularity::FineGrain ? granularity : SvmGranularity::None;
+			}
+	};
+
+	/**
+	 * @brief A vector in fine-grained shared virtual memory, or in host memory if the device lacks it.
+	 * @tparam T the type of the elements.
+	 */
+	template<typename T>
+	using SvmVector = std::vector<T, SvmAllocator<T>>;
+
+	/**
+	 * @brief Maps coarse-grained shared virtual memory for host access for the lifetime of an instance. Fine-grained
+	 * shared virtual memory and host memory need no mapping, so the guard does nothing for them, e.g. for the memory
+	 * of an <code>SvmAllocator</code>.
+	 */
+	class SvmMapGuard {
+		private:
+			/**
+			 * The command queue which maps and unmaps the memory.
+			 */
+			CommandQueue &commandQueue_;
+
+			/**
+			 * The mapped memory, nullptr if nothing was mapped.
+			 */
+			void *memory_;
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Maps the passed memory and awaits the mapping.
+			 * @param commandQueue the command queue which outlives the current instance.
+			 * @param granularity the kind of the memory.
+			 * @param memory the memory to be mapped.
+			 * @param sizeInBytes the size in bytes of the memory to be mapped.
+			 * @param mapFlags <code>CL_MAP_READ</code>, <code>CL_MAP_WRITE</code> or
+			 *                 <code>CL_MAP_WRITE_INVALIDATE_REGION</code>.
+			 */
+			[[maybe_unused]] SvmMapGuard(
+					CommandQueue &commandQueue,
+					SvmGranularity granularity,
+					void *memory,
+					size_t sizeInBytes,
+					cl_map_flags mapFlags = CL_MAP_READ | CL_MAP_WRITE
+			);
+
+			/**
+			 * @brief Deleted copy constructor.
+			 */
+			SvmMapGuard(SvmMapGuard const &) = delete;
+
+			/**
+			 * @brief Deleted copy assignment.
+			 */
+			void operator=(SvmMapGuard const &) = delete;
+
+			/**
+			 * @brief The destructor. Enqueues the unmapping, so kernels enqueued afterwards see the host writes.
+			 */
+			~SvmMapGuard();
+	};
+}
+
+#endif //OPENCL_TOOLKIT_SHARED_VIRTUAL_MEMORY_H
@@ -0,0 +1,181 @@
+#ifndef OPENCL_TOOLKIT_SPARSE_MATRIX_H
+#define OPENCL_TOOLKIT_SPARSE_MATRIX_H
+
+#include <vector>
+
+#include "portable_opencl_include.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Represents a sparse matrix in the compressed sparse row format on the host.
+	 */
+	struct CsrMatrix {
+		/**
+		 * The number of rows.
+		 */
+		size_t numRows;
+
+		/**
+		 * The number of columns.
+		 */
+		size_t numColumns;
+
+		/**
+		 * The index of the first element of each row and the number of elements at the end (numRows + 1 entries).
+		 */
+		std::vector<cl_uint> rowOffsets;
+
+		/**
+		 * The column index of each element.
+		 */
+		std::vector<cl_uint> columnIndices;
+
+		/**
+		 * The value of each element.
+		 */
+		std::vector<cl_float> values;
+	};
+
+	/**
+	 * @brief Represents a sparse matrix in the sliced ELLPACK format on the host.
+	 * @details The rows are grouped into slices of <code>sliceHeight</code> rows. Each slice is padded to its longest
+	 * row and stored column-major, so element j of row r is at <code>sliceOffsets[r / sliceHeight] + j * sliceHeight +
+	 * r % sliceHeight</code>. The padding is never read.
+	 */
+	struct SlicedEllMatrix {
+		/**
+		 * The number of rows.
+		 */
+		size_t numRows;
+
+		/**
+		 * The number of columns.
+		 */
+		size_t numColumns;
+
+		/**
+		 * The number of rows per slice.
+		 */
+		size_t sliceHeight;
+
+		/**
+		 * The index of the first element of each slice and the number of stored elements at the end.
+		 */
+		std::vector<cl_uint> sliceOffsets;
+
+		/**
+		 * The number of elements of each row without padding.
+		 */
+		std::vector<cl_uint> rowLengths;
+
+		/**
+		 * The column index of each stored element, 0 for padding.
+		 */
+		std::vector<cl_uint> columnIndices;
+
+		/**
+		 * The value of each stored element, 0 for padding.
+		 */
+		std::vector<cl_float> values;
+	};
+
+	/**
+	 * @brief Represents the row length statistics of a sparse matrix which drive the choice of the storage format.
+	 */
+	struct RowLengthStatistics {
+		/**
+		 * The number of rows.
+		 */
+		size_t numRows;
+
+		/**
+		 * The number of elements.
+		 */
+		size_t numNonZeros;
+
+		/**
+		 * The mean number of elements per row.
+		 */
+		double meanRowLength;
+
+		/**
+		 * The standard deviation of the number of elements per row.
+		 */
+		double rowLengthStandardDeviation;
+
+		/**
+		 * The maximum number of elements per row.
+		 */
+		size_t maxRowLength;
+
+		/**
+		 * The number of stored elements including padding in the sliced ELLPACK format.
+		 */
+		size_t slicedEllSize;
+	};
+
+	/**
+	 * @brief The storage formats and kernels of the sparse matrix-vector multiplication.
+	 */
+	enum class SparseFormat {
+		/**
+		 * The format is chosen from the row length statistics.
+		 */
+		Automatic,
+
+		/**
+		 * Compressed sparse row, one work item per row.
+		 */
+		CsrScalar,
+
+		/**
+		 * Compressed sparse row, a vector of work items per row.
+		 */
+		CsrVector,
+
+		/**
+		 * Sliced ELLPACK, one work item per row.
+		 */
+		SlicedEll
+	};
+
+	/**
+	 * The default number of rows per slice of the sliced ELLPACK format, a multiple of the SIMD width of common GPUs.
+	 */
+	inline constexpr size_t defaultSliceHeight = 32;
+
+	/**
+	 * @brief Computes the row length statistics of the passed matrix.
+	 * @param matrix a valid matrix.
+	 * @param sliceHeight the number of rows per slice of the sliced ELLPACK format.
+	 * @return the row length statistics.
+	 */
+	[[maybe_unused]] RowLengthStatistics computeRowLengthStatistics(
+			const CsrMatrix &matrix,
+			size_t sliceHeight = defaultSliceHeight
+	);
+
+	/**
+	 * @brief Chooses the storage format for the passed row length statistics. The sliced ELLPACK format is chosen if
+	 * its padding is small, the vector kernel if the rows are long or their lengths vary strongly (e.g. power-law
+	 * graphs), else the scalar kernel.
+	 * @param statistics the row length statistics of the matrix.
+	 * @return the chosen format, never <code>SparseFormat::Automatic</code>.
+	 */
+	[[maybe_unused]] SparseFormat chooseSparseFormat(const RowLengthStatistics &statistics);
+
+	/**
+	 * @brief Converts the passed matrix into the sliced ELLPACK format.
+	 * @param matrix a valid matrix.
+	 * @param sliceHeight the number of rows per slice.
+	 * @return the converted matrix.
+	 * @throws std::runtime_error if the matrix is invalid or the padded matrix exceeds 2^32 - 1 elements.
+	 */
+	[[maybe_unused]] SlicedEllMatrix toSlicedEll(const CsrMatrix &matrix, size_t sliceHeight = defaultSliceHeight);
+}
+
+#endif //OPENCL_TOOLKIT_SPARSE_MATRIX_H
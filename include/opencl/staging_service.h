@@ -0,0 +1,245 @@
+#ifndef OPENCL_TOOLKIT_STAGING_SERVICE_H
+#define OPENCL_TOOLKIT_STAGING_SERVICE_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "portable_opencl_include.h"
+#include "base_buffer.h"
+#include "command_queue.h"
+#include "context.h"
+#include "event.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	class DoubleBufferedStaging;
+
+	/**
+	 * @brief A range of host memory to be gathered.
+	 */
+	struct HostMemoryRange {
+		/**
+		 * The first byte of the range.
+		 */
+		const void *memory;
+
+		/**
+		 * The size of the range in bytes.
+		 */
+		size_t sizeInBytes;
+	};
+
+	/**
+	 * @brief Copies between host memory and device memory through pinned staging buffers on the NUMA node of the
+	 * device, so the transfers of the device never cross the socket interconnect.
+	 * @details A few worker threads, pinned to the processors of that node, copy or gather the host memory into one
+	 * staging buffer while the device copies from the other. The node of a PCI device is found through sysfs with the
+	 * extensions <code>cl_khr_pci_bus_info</code> or <code>cl_nv_device_attribute_query</code>, or it is passed
+	 * explicitly. The placement and the pinning of threads require Linux; elsewhere the service still parallelizes
+	 * the host-side copies. An instance must not be used by several threads at the same time.
+	 */
+	class StagingService {
+		private:
+			/**
+			 * The command queue which executes the transfers.
+			 */
+			CommandQueue &commandQueue_;
+
+			/**
+			 * The NUMA node of the staging memory and the worker threads, -1 if unknown.
+			 */
+			int numaNode_;
+
+			/**
+			 * The size of each staging buffer in bytes.
+			 */
+			size_t chunkSizeInBytes_;
+
+			/**
+			 * The host memory of the staging buffers, allocated on the NUMA node.
+			 */
+			void *hostMemory_;
+
+			/**
+			 * The size of the host memory in bytes, a multiple of the page size.
+			 */
+			size_t hostMemorySizeInBytes_;
+
+			/**
+			 * The two alternating staging buffers which pin the host memory.
+			 */
+			std::unique_ptr<DoubleBufferedStaging> staging_;
+
+			/**
+			 * Guards the task, its progress and the stop flag.
+			 */
+			std::mutex mutex_;
+
+			/**
+			 * Signals a new task and the stop to the worker threads.
+			 */
+			std::condition_variable taskAvailable_;
+
+			/**
+			 * Signals the completion of a task to the caller.
+			 */
+			std::condition_variable taskCompleted_;
+
+			/**
+			 * The current task, called with the index of each worker thread.
+			 */
+			const std::function<void(size_t)> *task_;
+
+			/**
+			 * The number of the current task, so each worker thread runs it once.
+			 */
+			size_t taskGeneration_;
+
+			/**
+			 * The number of worker threads which have not completed the current task yet.
+			 */
+			size_t numBusyWorkers_;
+
+			/**
+			 * The first failure of a worker thread in the current task.
+			 */
+			std::exception_ptr failure_;
+
+			/**
+			 * Whether the worker threads stop.
+			 */
+			bool isStopping_;
+
+			/**
+			 * The worker threads.
+			 */
+			std::vector<std::thread> workers_;
+
+		public:
+			/**
+			 * The NUMA node meaning "the node of the device".
+			 */
+			static constexpr int automaticNumaNode = -2;
+
+			/**
+			 * The default size of the staging buffers.
+			 */
+			static constexpr size_t defaultChunkSizeInBytes = 8 << 20;
+
+			/**
+			 * @brief The parametrized constructor. Allocates the staging buffers and starts the worker threads.
+			 * @param context a valid OpenCL-context.
+			 * @param commandQueue the command queue of the target device which outlives the current instance.
+			 * @param device the target device.
+			 * @param numThreads the number of worker threads.
+			 * @param numaNode the NUMA node of the staging memory and the worker threads, -1 for no placement.
+			 * @param chunkSizeInBytes the size of each of the two staging buffers in bytes.
+			 */
+			[[maybe_unused]] StagingService(
+					const Context &context,
+					CommandQueue &commandQueue,
+					cl_device_id device,
+					size_t numThreads = 4,
+					int numaNode = automaticNumaNode,
+					size_t chunkSizeInBytes = defaultChunkSizeInBytes
+			);
+
+			/**
+			 * @brief Deleted copy constructor.
+			 */
+			StagingService(StagingService const &) = delete;
+
+			/**
+			 * @brief Deleted copy assignment.
+			 */
+			void operator=(StagingService const &) = delete;
+
+			/**
+			 * @brief The destructor. Stops the worker threads and releases the staging buffers.
+			 */
+			~StagingService();
+
+			/**
+			 * @brief Copies bytes from host memory into device memory and awaits the copy.
+			 * @param sourceHostMemory the host memory to copy from.
+			 * @param destinationDeviceMemory the device memory to copy to.
+			 * @param numBytesToCopy the number of bytes to be copied.
+			 * @param destinationOffsetInBytes the offset in bytes into the device memory.
+			 */
+			[[maybe_unused]] void copyFromHostMemoryIntoDeviceMemory(
+					const void *sourceHostMemory,
+					const BaseBuffer &destinationDeviceMemory,
+					size_t numBytesToCopy,
+					size_t destinationOffsetInBytes = 0
+			);
+
+			/**
+			 * @brief Concatenates ranges of host memory into device memory and awaits the copy.
+			 * @param sourceRanges the ranges of host memory in order of their destination.
+			 * @param destinationDeviceMemory the device memory to copy to.
+			 * @param destinationOffsetInBytes the offset in bytes of the first range in the device memory.
+			 */
+			[[maybe_unused]] void gatherFromHostMemoryIntoDeviceMemory(
+					const std::vector<HostMemoryRange> &sourceRanges,
+					const BaseBuffer &destinationDeviceMemory,
+					size_t destinationOffsetInBytes = 0
+			);
+
+			/**
+			 * @brief Copies bytes from device memory into host memory and awaits the copy. The download of the next
+			 * chunk overlaps the host-side copy of the current one.
+			 * @param sourceDeviceMemory the device memory to copy from.
+			 * @param destinationHostMemory the host memory to copy to.
+			 * @param numBytesToCopy the number of bytes to be copied.
+			 * @param sourceOffsetInBytes the offset in bytes into the device memory.
+			 */
+			[[maybe_unused]] void copyFromDeviceMemoryIntoHostMemory(
+					const BaseBuffer &sourceDeviceMemory,
+					void *destinationHostMemory,
+					size_t numBytesToCopy,
+					size_t sourceOffsetInBytes = 0
+			);
+
+			/**
+			 * @brief Returns the NUMA node of the staging memory and the worker threads.
+			 * @return the NUMA node, -1 if the memory is not placed.
+			 */
+			[[maybe_unused]] [[nodiscard]] int getNumaNode() const;
+
+			/**
+			 * @brief Returns the NUMA node of the passed device, as reported by sysfs for its PCI function.
+			 * @param device the device to be queried.
+			 * @return the NUMA node of the device, -1 if it is unknown, e.g. on single-socket hosts.
+			 */
+			[[maybe_unused]] [[nodiscard]] static int findNumaNode(cl_device_id device);
+
+		private:
+			/**
+			 * @brief Runs a task on all worker threads and awaits it.
+			 * @param task the task, called with the index of each worker thread.
+			 * @throws the first exception thrown by the task.
+			 */
+			void runOnWorkers(const std::function<void(size_t)> &task);
+
+			/**
+			 * @brief Runs the tasks of the worker threads until the stop.
+			 * @param index the index of the worker thread.
+			 */
+			void work(size_t index);
+
+			/**
+			 * @brief Stops and joins the worker threads.
+			 */
+			void stopWorkers() noexcept;
+	};
+}
+
+#endif //OPENCL_TOOLKIT_STAGING_SERVICE_H
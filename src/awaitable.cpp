@@ -0,0 +1,53 @@
+#include <stdexcept>
+
+#include "opencl/awaitable.h"
+#include "opencl/error.h"
+
+using namespace OpenClToolkit;
+
+[[maybe_unused]] EventAwaitable::EventAwaitable(Event &&event, Executor &executor) :
+		event_(std::move(event)),
+		executor_(executor),
+		coroutine_(nullptr),
+		executionStatus_(CL_COMPLETE) {}
+
+bool EventAwaitable::await_ready() {
+	executionStatus_ = event_.getExecutionStatus();
+	return executionStatus_ <= CL_COMPLETE;
+}
+
+void EventAwaitable::await_suspend(std::coroutine_handle<> coroutine) {
+	coroutine_ = coroutine;
+	cl_command_queue commandQueue;
+	cl_int status = clGetEventInfo(
+			event_,
+			CL_EVENT_COMMAND_QUEUE,
+			sizeof(cl_command_queue),
+			&commandQueue,
+			nullptr
+	);
+	if (!status) {
+		// the callback only fires once the command has been submitted to the device
+		status = clFlush(commandQueue);
+	}
+	if (!status) {
+		status = clSetEventCallback(event_, CL_COMPLETE, &EventAwaitable::onComplete, this);
+	}
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Failed to await event. " + toErrorDescription(status));
+	}
+}
+
+void EventAwaitable::await_resume() const {
+	if (executionStatus_ < 0) {
+		// let it crash
+		throw std::runtime_error("The awaited command failed. " + toErrorDescription(executionStatus_));
+	}
+}
+
+void CL_CALLBACK EventAwaitable::onComplete(cl_event, const cl_int executionStatus, void *userData) {
+	auto *awaitable = static_cast<EventAwaitable *>(userData);
+	awaitable->executionStatus_ = executionStatus;
+	awaitable->executor_.execute(awaitable->coroutine_);
+}
@@ -2,29 +2,62 @@
 #include <iostream>
 
 #include "opencl/base_buffer.h"
+#include "opencl/command_recorder.h"
+#include "opencl/memory_manager.h"
+#include "opencl/metrics_collector.h"
 
 using namespace OpenClToolkit;
 
-BaseBuffer::BaseBuffer(const Context &context, const size_t size, const cl_mem_flags flags) {
+BaseBuffer::BaseBuffer(const Context &context, const size_t size, const cl_mem_flags flags) :
+		BaseBuffer(context, size, flags, nullptr) {}
+
+BaseBuffer::BaseBuffer(const Context &context, const size_t size, const cl_mem_flags flags, void *hostMemory) :
+		context_(context),
+		size_(size),
+		// pinned staging and zero-copy buffers live in host memory, so they do not count towards the device budget
+		isAccounted_(!(flags & (CL_MEM_ALLOC_HOST_PTR | CL_MEM_USE_HOST_PTR))) {
+	MemoryManager &memoryManager = MemoryManager::getInstance();
+	if (isAccounted_) {
+		memoryManager.reserve(context_, size_);
+	}
 	cl_int status;
-	self_ = clCreateBuffer(context, flags, size, nullptr, &status);
+	self_ = clCreateBuffer(context, flags, size, hostMemory, &status);
+	// the device may hold less than the budget, then evicting the cold buffers makes room
+	if (isAccounted_ && (status == CL_MEM_OBJECT_ALLOCATION_FAILURE || status == CL_OUT_OF_RESOURCES) &&
+		memoryManager.evictAll(context_)) {
+		self_ = clCreateBuffer(context, flags, size, hostMemory, &status);
+	}
 	if (status) {
+		if (isAccounted_) {
+			memoryManager.release(context_, size_);
+		}
 		// let it crash
 		throw std::runtime_error("Failed to create buffer: " + getFailureDescription(status));
 	}
+	CommandRecorder::getInstance().recordAllocation(self_, flags, size_);
+	MetricsCollector::getInstance().recordAllocation(context, size_);
 }
 
 BaseBuffer::~BaseBuffer() {
+	CommandRecorder::getInstance().recordRelease(self_);
 	const cl_int status = clReleaseMemObject(self_);
 	if (status) {
 		std::cerr << "Failed to release buffer: " + getFailureDescription(status) << std::endl;
 	}
+	if (isAccounted_) {
+		MemoryManager::getInstance().release(context_, size_);
+	}
+	MetricsCollector::getInstance().recordRelease(context_, size_);
 }
 
 BaseBuffer::operator cl_mem() const {
 	return self_;
 }
 
+[[maybe_unused]] size_t BaseBuffer::getSizeInBytes() const {
+	return size_;
+}
+
 std::string BaseBuffer::getFailureDescription(const cl_int errorCode) {
 	switch (errorCode) {
 		case CL_INVALID_CONTEXT:
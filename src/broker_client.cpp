@@ -0,0 +1,252 @@
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include "opencl/broker_client.h"
+#include "socket_io.h"
+
+using namespace OpenClToolkit;
+using namespace OpenClToolkit::BrokerProtocol;
+
+namespace {
+	/**
+	 * @brief Creates an anonymous shared memory region. Where file sealing is available, the region is sealed
+	 * against shrinking, so the broker can rely on its size.
+	 * @param sizeInBytes the size in bytes.
+	 * @return the file descriptor of the region.
+	 */
+	int createSharedMemory(const size_t sizeInBytes) {
+#if defined(F_SEAL_SHRINK)
+		const int fileDescriptor = memfd_create("opencl-toolkit-broker", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+		static std::atomic<unsigned> counter = 0;
+		const std::string name = "/opencl-toolkit-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+		const int fileDescriptor = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+#endif
+		if (fileDescriptor < 0) {
+			// let it crash
+			throw std::runtime_error("Failed to create shared memory: " + toSystemErrorDescription());
+		}
+#if !defined(F_SEAL_SHRINK)
+		// the name is only needed to open the region, which lives on as long as it is open or mapped
+		shm_unlink(name.c_str());
+#endif
+		if (ftruncate(fileDescriptor, static_cast<off_t>(sizeInBytes))) {
+			const std::string description = toSystemErrorDescription();
+			close(fileDescriptor);
+			// let it crash
+			throw std::runtime_error("Failed to size shared memory: " + description);
+		}
+#if defined(F_SEAL_SHRINK)
+		if (fcntl(fileDescriptor, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_SEAL)) {
+			const std::string description = toSystemErrorDescription();
+			close(fileDescriptor);
+			// let it crash
+			throw std::runtime_error("Failed to seal shared memory: " + description);
+		}
+#endif
+		return fileDescriptor;
+	}
+}
+
+[[maybe_unused]] void BrokerBatch::write(
+		const uint64_t bufferId,
+		const uint64_t bufferOffsetInBytes,
+		const uint64_t sharedMemoryOffsetInBytes,
+		const uint64_t numBytes
+) {
+	Command command{};
+	command.type = CommandType::Write;
+	command.bufferId = bufferId;
+	command.bufferOffsetInBytes = bufferOffsetInBytes;
+	command.sharedMemoryOffsetInBytes = sharedMemoryOffsetInBytes;
+	command.numBytes = numBytes;
+	commands_.push_back(command);
+}
+
+[[maybe_unused]] void BrokerBatch::read(
+		const uint64_t bufferId,
+		const uint64_t bufferOffsetInBytes,
+		const uint64_t sharedMemoryOffsetInBytes,
+		const uint64_t numBytes
+) {
+	Command command{};
+	command.type = CommandType::Read;
+	command.bufferId = bufferId;
+	command.bufferOffsetInBytes = bufferOffsetInBytes;
+	command.sharedMemoryOffsetInBytes = sharedMemoryOffsetInBytes;
+	command.numBytes = numBytes;
+	commands_.push_back(command);
+}
+
+[[maybe_unused]] void BrokerBatch::setBufferArg(const uint64_t programId, const cl_uint argIndex, const uint64_t bufferId) {
+	Command command{};
+	command.type = CommandType::SetBufferArg;
+	command.index = argIndex;
+	command.programId = programId;
+	command.bufferId = bufferId;
+	commands_.push_back(command);
+}
+
+[[maybe_unused]] void BrokerBatch::setValueArg(
+		const uint64_t programId,
+		const cl_uint argIndex,
+		const uint64_t sharedMemoryOffsetInBytes,
+		const uint64_t numBytes
+) {
+	Command command{};
+	command.type = CommandType::SetValueArg;
+	command.index = argIndex;
+	command.programId = programId;
+	command.sharedMemoryOffsetInBytes = sharedMemoryOffsetInBytes;
+	command.numBytes = numBytes;
+	commands_.push_back(command);
+}
+
+[[maybe_unused]] void BrokerBatch::launch(
+		const uint64_t programId,
+		const NDRange &globalWorkSize,
+		const NDRange &localWorkSize
+) {
+	if (globalWorkSize.numDimensions != localWorkSize.numDimensions) {
+		// let it crash
+		throw std::runtime_error("Invalid launch: the ranges have different numbers of dimensions");
+	}
+	Command command{};
+	command.type = CommandType::Launch;
+	command.index = globalWorkSize.numDimensions;
+	command.programId = programId;
+	for (size_t i = 0; i < 3; ++i) {
+		command.globalWorkSize[i] = globalWorkSize.sizes[i];
+		command.localWorkSize[i] = localWorkSize.sizes[i];
+	}
+	commands_.push_back(command);
+}
+
+[[maybe_unused]] const std::vector<Command> &BrokerBatch::getCommands() const {
+	return commands_;
+}
+
+[[maybe_unused]] void BrokerBatch::clear() {
+	commands_.clear();
+}
+
+[[maybe_unused]] BrokerClient::BrokerClient(
+		const std::string &socketPath,
+		const size_t sharedMemorySizeInBytes,
+		const cl_uint deviceIndex
+) : socket_(-1),
+	sharedMemory_(nullptr),
+	sharedMemorySizeInBytes_(sharedMemorySizeInBytes) {
+	sockaddr_un address{};
+	toUnixSocketAddress(socketPath, address);
+	socket_ = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (socket_ < 0 || connect(socket_, reinterpret_cast<const sockaddr *>(&address), sizeof(address))) {
+		const std::string description = toSystemErrorDescription();
+		if (socket_ >= 0) {
+			close(socket_);
+		}
+		// let it crash
+		throw std::runtime_error("Failed to connect to the broker at " + socketPath + ": " + description);
+	}
+
+	int fileDescriptor = -1;
+	try {
+		fileDescriptor = createSharedMemory(sharedMemorySizeInBytes);
+		void *memory = mmap(
+				nullptr,
+				sharedMemorySizeInBytes,
+				PROT_READ | PROT_WRITE,
+				MAP_SHARED,
+				fileDescriptor,
+				0
+		);
+		if (memory == MAP_FAILED) {
+			// let it crash
+			throw std::runtime_error("Failed to map shared memory: " + toSystemErrorDescription());
+		}
+		sharedMemory_ = static_cast<unsigned char *>(memory);
+		const HelloPayload hello{version, deviceIndex, sharedMemorySizeInBytes};
+		request(RequestType::Hello, &hello, sizeof(hello), fileDescriptor);
+		close(fileDescriptor);
+	} catch (...) {
+		if (fileDescriptor >= 0) {
+			close(fileDescriptor);
+		}
+		if (sharedMemory_) {
+			munmap(sharedMemory_, sharedMemorySizeInBytes_);
+		}
+		close(socket_);
+		throw;
+	}
+}
+
+BrokerClient::~BrokerClient() {
+	munmap(sharedMemory_, sharedMemorySizeInBytes_);
+	close(socket_);
+}
+
+[[maybe_unused]] void *BrokerClient::getSharedMemory() const {
+	return sharedMemory_;
+}
+
+[[maybe_unused]] size_t BrokerClient::getSharedMemorySizeInBytes() const {
+	return sharedMemorySizeInBytes_;
+}
+
+[[maybe_unused]] uint64_t BrokerClient::registerProgram(
+		const std::string &sourceCode,
+		const std::string &kernelName,
+		const std::string &buildOptions
+) {
+	const RegisterProgramPayload header{sourceCode.size(), kernelName.size(), buildOptions.size()};
+	std::string payload(reinterpret_cast<const char *>(&header), sizeof(header));
+	payload += sourceCode;
+	payload += kernelName;
+	payload += buildOptions;
+	return request(RequestType::RegisterProgram, payload.data(), payload.size());
+}
+
+[[maybe_unused]] uint64_t BrokerClient::allocateBuffer(const size_t sizeInBytes) {
+	const BufferPayload payload{sizeInBytes};
+	return request(RequestType::AllocateBuffer, &payload, sizeof(payload));
+}
+
+[[maybe_unused]] void BrokerClient::freeBuffer(const uint64_t bufferId) {
+	const BufferPayload payload{bufferId};
+	request(RequestType::FreeBuffer, &payload, sizeof(payload));
+}
+
+[[maybe_unused]] void BrokerClient::submit(const BrokerBatch &batch) {
+	const auto &commands = batch.getCommands();
+	request(RequestType::SubmitBatch, commands.data(), commands.size() * sizeof(Command));
+}
+
+uint64_t BrokerClient::request(
+		const RequestType type,
+		const void *payload,
+		const size_t numBytes,
+		const int fileDescriptor
+) {
+	const RequestHeader header{magic, type, numBytes};
+	Reply reply{};
+	if (!sendAll(socket_, &header, sizeof(header), fileDescriptor) ||
+		(numBytes && !sendAll(socket_, payload, numBytes)) ||
+		!receiveAll(socket_, &reply, sizeof(reply))) {
+		// let it crash
+		throw std::runtime_error("Failed to communicate with the broker: " + toSystemErrorDescription());
+	}
+	std::string message(reply.messageLength, '\0');
+	if (reply.messageLength && !receiveAll(socket_, message.data(), message.size())) {
+		// let it crash
+		throw std::runtime_error("Failed to communicate with the broker: " + toSystemErrorDescription());
+	}
+	if (reply.status) {
+		// let it crash
+		throw std::runtime_error("The broker rejected the request: " + message);
+	}
+	return reply.value;
+}
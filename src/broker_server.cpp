@@ -0,0 +1,520 @@
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "opencl/broker_server.h"
+#include "opencl/nd_range.h"
+#include "opencl/program_registry.h"
+#include "socket_io.h"
+
+using namespace OpenClToolkit;
+using namespace OpenClToolkit::BrokerProtocol;
+
+namespace {
+	/**
+	 * @brief Reads a struct from a payload after checking its size.
+	 * @tparam T the type of the struct.
+	 * @param payload the payload.
+	 * @return the struct at the beginning of the payload.
+	 */
+	template<typename T>
+	T readPayload(const std::vector<unsigned char> &payload) {
+		if (payload.size() < sizeof(T)) {
+			// let it crash
+			throw std::runtime_error("Invalid request: the payload is too short");
+		}
+		T value;
+		std::memcpy(&value, payload.data(), sizeof(T));
+		return value;
+	}
+
+	/**
+	 * @brief Converts the work sizes of a launch command.
+	 * @param numDimensions the number of dimensions.
+	 * @param sizes the size per dimension.
+	 * @return the work sizes.
+	 */
+	NDRange toNDRange(const uint32_t numDimensions, const uint64_t sizes[3]) {
+		switch (numDimensions) {
+			case 1:
+				return {sizes[0]};
+			case 2:
+				return {sizes[0], sizes[1]};
+			case 3:
+				return {sizes[0], sizes[1], sizes[2]};
+			default:
+				// let it crash
+				throw std::runtime_error("Invalid launch: a kernel has one to three dimensions");
+		}
+	}
+
+	/**
+	 * @brief Removes the socket file at the passed path if no broker listens on it anymore, e.g. after a crash. Only
+	 * a refused connection proves that nobody listens, so the socket of a running broker is never taken over.
+	 * @param path the path of the socket.
+	 * @param address the address of the socket.
+	 */
+	void removeStaleSocket(const std::string &path, const sockaddr_un &address) {
+		struct stat status{};
+		if (lstat(path.c_str(), &status) || !S_ISSOCK(status.st_mode)) {
+			// nothing to remove, or a file which is not a socket and makes the bind fail
+			return;
+		}
+		const int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (probe < 0) {
+			// let it crash
+			throw std::runtime_error("Failed to probe the socket " + path + ": " + toSystemErrorDescription());
+		}
+		const bool isConnected = !connect(probe, reinterpret_cast<const sockaddr *>(&address), sizeof(address));
+		const int connectError = errno;
+		close(probe);
+		if (isConnected) {
+			// let it crash
+			throw std::runtime_error("Failed to listen on " + path + ": another broker listens on it");
+		}
+		if (connectError == ECONNREFUSED && unlink(path.c_str()) && errno != ENOENT) {
+			// let it crash
+			throw std::runtime_error("Failed to remove the stale socket " + path + ": " + toSystemErrorDescription());
+		}
+	}
+}
+
+[[maybe_unused]] BrokerServer::BrokerServer(
+		const std::string &socketPath,
+		const std::vector<cl_device_id> &devices,
+		const mode_t socketMode
+) :
+		socketPath_(socketPath),
+		listeningSocket_(-1),
+		wakeUpPipe_{-1, -1},
+		isStopping_(false) {
+	for (const cl_device_id id: devices) {
+		auto device = std::make_unique<Device>();
+		device->id = id;
+		device->context = std::make_unique<Context>(id);
+		device->commandQueue = std::make_unique<CommandQueue>(*device->context, id);
+		devices_.push_back(std::move(device));
+	}
+
+	sockaddr_un address{};
+	toUnixSocketAddress(socketPath_, address);
+	removeStaleSocket(socketPath_, address);
+	if (pipe(wakeUpPipe_) || fcntl(wakeUpPipe_[0], F_SETFL, O_NONBLOCK) || fcntl(wakeUpPipe_[1], F_SETFL, O_NONBLOCK)) {
+		// let it crash
+		throw std::runtime_error("Failed to create the wake-up pipe of the broker: " + toSystemErrorDescription());
+	}
+	listeningSocket_ = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listeningSocket_ >= 0) {
+		// Linux creates the socket file with the mode of the socket, other systems reject this and rely on the chmod
+		// before listening
+		fchmod(listeningSocket_, socketMode);
+	}
+	if (listeningSocket_ < 0 ||
+		bind(listeningSocket_, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) ||
+		chmod(socketPath_.c_str(), socketMode) ||
+		listen(listeningSocket_, SOMAXCONN)) {
+		const std::string description = toSystemErrorDescription();
+		close(wakeUpPipe_[0]);
+		close(wakeUpPipe_[1]);
+		if (listeningSocket_ >= 0) {
+			close(listeningSocket_);
+		}
+		// let it crash
+		throw std::runtime_error("Failed to listen on " + socketPath_ + ": " + description);
+	}
+
+	for (auto &device: devices_) {
+		device->worker = std::thread(&BrokerServer::work, this, std::ref(*device));
+	}
+}
+
+BrokerServer::~BrokerServer() {
+	stop();
+	{
+		// the lock orders the stop before the next wait of the workers
+		std::lock_guard<std::mutex> lock(mutex_);
+	}
+	sessionReady_.notify_all();
+	for (auto &device: devices_) {
+		device->worker.join();
+	}
+	for (auto &session: sessions_) {
+		closeSession(*session);
+	}
+	close(listeningSocket_);
+	close(wakeUpPipe_[0]);
+	close(wakeUpPipe_[1]);
+	if (unlink(socketPath_.c_str())) {
+		std::cerr << "Failed to remove the socket of the broker: " + toSystemErrorDescription() << std::endl;
+	}
+}
+
+[[maybe_unused]] void BrokerServer::run() {
+	std::vector<pollfd> pollFileDescriptors;
+	std::vector<Session *> polledSessions;
+	while (!isStopping_) {
+		pollFileDescriptors = {{listeningSocket_, POLLIN, 0}, {wakeUpPipe_[0], POLLIN, 0}};
+		polledSessions.clear();
+		// busy sessions are not polled, so a session is only accessed by one thread at a time
+		for (auto &session: sessions_) {
+			if (!session->isBusy) {
+				pollFileDescriptors.push_back({session->socket, POLLIN, 0});
+				polledSessions.push_back(session.get());
+			}
+		}
+		if (poll(pollFileDescriptors.data(), pollFileDescriptors.size(), -1) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			// let it crash
+			throw std::runtime_error("Failed to poll the sockets of the broker: " + toSystemErrorDescription());
+		}
+
+		if (pollFileDescriptors[1].revents) {
+			char buffer[64];
+			while (read(wakeUpPipe_[0], buffer, sizeof(buffer)) > 0) {}
+		}
+		if (pollFileDescriptors[0].revents & POLLIN) {
+			const int client = accept(listeningSocket_, nullptr, nullptr);
+			if (client >= 0) {
+				auto session = std::make_unique<Session>();
+				session->socket = client;
+				sessions_.push_back(std::move(session));
+			}
+		}
+		for (size_t i = 0; i < polledSessions.size(); ++i) {
+			if (pollFileDescriptors[i + 2].revents && !receiveRequest(*polledSessions[i])) {
+				closeSession(*polledSessions[i]);
+				polledSessions[i]->socket = -1;
+			}
+		}
+		sessions_.remove_if([](const std::unique_ptr<Session> &session) { return session->socket < 0; });
+	}
+}
+
+[[maybe_unused]] void BrokerServer::stop() {
+	isStopping_ = true;
+	wakeUp();
+}
+
+bool BrokerServer::receiveRequest(Session &session) {
+	std::vector<unsigned char> &received = session.receivedBytes;
+	RequestHeader header{};
+	while (true) {
+		// only the bytes of the current request are received, so the next one stays in the socket until it is answered
+		size_t numExpected = sizeof(RequestHeader);
+		if (received.size() >= sizeof(RequestHeader)) {
+			std::memcpy(&header, received.data(), sizeof(header));
+			if (header.magic != magic || header.payloadSizeInBytes > maxPayloadSizeInBytes) {
+				return false;
+			}
+			numExpected += header.payloadSizeInBytes;
+		}
+		if (received.size() == numExpected) {
+			break;
+		}
+		const size_t numReceived = received.size();
+		received.resize(numExpected);
+		const ssize_t numAvailable = receiveAvailable(
+				session.socket,
+				received.data() + numReceived,
+				numExpected - numReceived,
+				&session.receivedFileDescriptor
+		);
+		if (numAvailable < 0) {
+			return false;
+		}
+		received.resize(numReceived + static_cast<size_t>(numAvailable));
+		if (!numAvailable) {
+			// the rest of the request arrives later
+			return true;
+		}
+	}
+
+	std::vector<unsigned char> payload(received.begin() + sizeof(RequestHeader), received.end());
+	std::vector<unsigned char>().swap(received);
+	const int fileDescriptor = session.receivedFileDescriptor;
+	session.receivedFileDescriptor = -1;
+	handleRequest(session, header, std::move(payload), fileDescriptor);
+	return true;
+}
+
+void BrokerServer::handleRequest(
+		Session &session,
+		const RequestHeader &header,
+		std::vector<unsigned char> payload,
+		int fileDescriptor
+) {
+	if (fileDescriptor >= 0 && header.type != RequestType::Hello) {
+		close(fileDescriptor);
+		fileDescriptor = -1;
+	}
+	try {
+		if (header.type != RequestType::Hello && !session.sharedMemory) {
+			// let it crash
+			throw std::runtime_error("Invalid request: the session was not opened by Hello");
+		}
+		uint64_t value = 0;
+		switch (header.type) {
+			case RequestType::Hello:
+				value = hello(session, payload, fileDescriptor);
+				break;
+			case RequestType::RegisterProgram:
+			case RequestType::SubmitBatch:
+				if (header.type == RequestType::SubmitBatch && payload.size() % sizeof(Command)) {
+					// let it crash
+					throw std::runtime_error("Invalid request: the batch is no array of commands");
+				}
+				// builds and batches block on the device, so they run on its worker, which replies once done
+				session.pendingType = header.type;
+				session.pendingPayload = std::move(payload);
+				session.isBusy = true;
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					session.device->readySessions.push_back(&session);
+				}
+				sessionReady_.notify_all();
+				return;
+			case RequestType::AllocateBuffer:
+				value = session.nextId++;
+				session.buffers[value] = std::make_unique<ReadWriteBuffer>(
+						*session.device->context,
+						readPayload<BufferPayload>(payload).value
+				);
+				break;
+			case RequestType::FreeBuffer:
+				if (!session.buffers.erase(readPayload<BufferPayload>(payload).value)) {
+					// let it crash
+					throw std::runtime_error("Invalid request: unknown buffer id");
+				}
+				break;
+			default:
+				// let it crash
+				throw std::runtime_error("Invalid request: unknown request type");
+		}
+		reply(session, 0, value, "");
+	} catch (const std::exception &exception) {
+		reply(session, -1, 0, exception.what());
+	}
+}
+
+uint64_t BrokerServer::hello(
+		Session &session,
+		const std::vector<unsigned char> &payload,
+		const int sharedMemoryFileDescriptor
+) {
+	if (sharedMemoryFileDescriptor < 0) {
+		// let it crash
+		throw std::runtime_error("Invalid request: no shared memory was attached");
+	}
+#if defined(F_SEAL_SHRINK)
+	// a client which shrinks the region after the size check would make the broker crash with SIGBUS on access
+	const int seals = fcntl(sharedMemoryFileDescriptor, F_GET_SEALS);
+	const bool isSealed = seals >= 0 && (seals & F_SEAL_SHRINK);
+#else
+	const bool isSealed = true;
+#endif
+	struct stat status{};
+	const bool isMappable = payload.size() >= sizeof(HelloPayload) && !session.sharedMemory && isSealed &&
+							!fstat(sharedMemoryFileDescriptor, &status);
+	const auto request = isMappable ? readPayload<HelloPayload>(payload) : HelloPayload{};
+	const bool isValid = isMappable && request.version == version && request.deviceIndex < devices_.size() &&
+						 request.sharedMemorySizeInBytes &&
+						 static_cast<uint64_t>(status.st_size) >= request.sharedMemorySizeInBytes;
+	void *memory = isValid ? mmap(
+			nullptr,
+			request.sharedMemorySizeInBytes,
+			PROT_READ | PROT_WRITE,
+			MAP_SHARED,
+			sharedMemoryFileDescriptor,
+			0
+	) : MAP_FAILED;
+	// the mapping stays valid after closing
+	close(sharedMemoryFileDescriptor);
+	if (memory == MAP_FAILED) {
+		// let it crash
+		throw std::runtime_error(
+				"Invalid request: the session is already open, or the version, the device index or the shared memory "
+				"is invalid, e.g. not sealed against shrinking"
+		);
+	}
+	session.sharedMemory = static_cast<unsigned char *>(memory);
+	session.sharedMemorySizeInBytes = request.sharedMemorySizeInBytes;
+	session.device = devices_[request.deviceIndex].get();
+	return 0;
+}
+
+uint64_t BrokerServer::registerProgram(Session &session, const std::vector<unsigned char> &payload) {
+	const auto request = readPayload<RegisterProgramPayload>(payload);
+	const uint64_t totalLength = request.sourceCodeLength + request.kernelNameLength + request.buildOptionsLength;
+	if (totalLength != payload.size() - sizeof(RegisterProgramPayload)) {
+		// let it crash
+		throw std::runtime_error("Invalid request: the string lengths do not match the payload");
+	}
+	const auto *strings = reinterpret_cast<const char *>(payload.data() + sizeof(RegisterProgramPayload));
+	const std::string sourceCode(strings, request.sourceCodeLength);
+	const std::string kernelName(strings + request.sourceCodeLength, request.kernelNameLength);
+	const std::string buildOptions(
+			strings + request.sourceCodeLength + request.kernelNameLength,
+			request.buildOptionsLength
+	);
+	// the registry builds each program once per device, whichever session registers it
+	const auto program = ProgramRegistry::getInstance().acquire(
+			sourceCode,
+			kernelName,
+			*session.device->context,
+			session.device->id,
+			buildOptions
+	);
+	const uint64_t programId = session.nextId++;
+	session.programs[programId] = std::make_unique<Program>(*program, kernelName);
+	return programId;
+}
+
+void BrokerServer::work(Device &device) {
+	while (true) {
+		Session *session;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			sessionReady_.wait(lock, [this, &device] { return isStopping_ || !device.readySessions.empty(); });
+			if (isStopping_) {
+				return;
+			}
+			session = device.readySessions.front();
+			device.readySessions.pop_front();
+		}
+		try {
+			uint64_t value = 0;
+			if (session->pendingType == RequestType::RegisterProgram) {
+				value = registerProgram(*session, session->pendingPayload);
+			} else {
+				executeBatch(*session, session->pendingPayload);
+			}
+			reply(*session, 0, value, "");
+		} catch (const std::exception &exception) {
+			reply(*session, -1, 0, exception.what());
+		}
+		std::vector<unsigned char>().swap(session->pendingPayload);
+		session->isBusy = false;
+		wakeUp();
+	}
+}
+
+void BrokerServer::executeBatch(Session &session, const std::vector<unsigned char> &payload) {
+	std::vector<Command> batch(payload.size() / sizeof(Command));
+	std::memcpy(batch.data(), payload.data(), batch.size() * sizeof(Command));
+	CommandQueue &commandQueue = *session.device->commandQueue;
+	for (const Command &command: batch) {
+		switch (command.type) {
+			case CommandType::Write:
+				commandQueue.enqueueCommandCopyBytesFromHostMemoryIntoDeviceMemory(
+						getSharedMemory(session, command.sharedMemoryOffsetInBytes, command.numBytes),
+						getBuffer(session, command.bufferId),
+						command.numBytes,
+						command.bufferOffsetInBytes
+				);
+				break;
+			case CommandType::Read:
+				commandQueue.enqueueCommandCopyBytesFromDeviceMemoryIntoHostMemory(
+						getBuffer(session, command.bufferId),
+						getSharedMemory(session, command.sharedMemoryOffsetInBytes, command.numBytes),
+						command.numBytes,
+						command.bufferOffsetInBytes
+				);
+				break;
+			case CommandType::SetBufferArg:
+				getProgram(session, command.programId).setKernelArg(
+						command.index,
+						sizeof(cl_mem),
+						getBuffer(session, command.bufferId)
+				);
+				break;
+			case CommandType::SetValueArg:
+				getProgram(session, command.programId).setKernelArg(
+						command.index,
+						command.numBytes,
+						static_cast<const void *>(
+								getSharedMemory(session, command.sharedMemoryOffsetInBytes, command.numBytes)
+						)
+				);
+				break;
+			case CommandType::Launch:
+				commandQueue.enqueueCommandExecuteProgramOnDevice(
+						getProgram(session, command.programId),
+						toNDRange(command.index, command.globalWorkSize),
+						toNDRange(command.index, command.localWorkSize)
+				);
+				break;
+			default:
+				// let it crash
+				throw std::runtime_error("Invalid batch: unknown command type");
+		}
+	}
+	commandQueue.finish();
+}
+
+unsigned char *BrokerServer::getSharedMemory(
+		const Session &session,
+		const uint64_t offsetInBytes,
+		const uint64_t numBytes
+) {
+	if (offsetInBytes > session.sharedMemorySizeInBytes || numBytes > session.sharedMemorySizeInBytes - offsetInBytes) {
+		// let it crash
+		throw std::runtime_error("Invalid batch: the range exceeds the shared memory");
+	}
+	return session.sharedMemory + offsetInBytes;
+}
+
+Program &BrokerServer::getProgram(const Session &session, const uint64_t programId) {
+	const auto iterator = session.programs.find(programId);
+	if (iterator == session.programs.end()) {
+		// let it crash
+		throw std::runtime_error("Invalid batch: unknown program id");
+	}
+	return *iterator->second;
+}
+
+ReadWriteBuffer &BrokerServer::getBuffer(const Session &session, const uint64_t bufferId) {
+	const auto iterator = session.buffers.find(bufferId);
+	if (iterator == session.buffers.end()) {
+		// let it crash
+		throw std::runtime_error("Invalid batch: unknown buffer id");
+	}
+	return *iterator->second;
+}
+
+void BrokerServer::reply(const Session &session, const int32_t status, const uint64_t value, const std::string &message) {
+	const Reply header{status, static_cast<uint32_t>(message.size()), value};
+	// a failed reply closes the session at its next poll
+	if (sendAll(session.socket, &header, sizeof(header)) && !message.empty()) {
+		sendAll(session.socket, message.data(), message.size());
+	}
+}
+
+void BrokerServer::closeSession(Session &session) {
+	session.programs.clear();
+	session.buffers.clear();
+	if (session.sharedMemory) {
+		munmap(session.sharedMemory, session.sharedMemorySizeInBytes);
+		session.sharedMemory = nullptr;
+	}
+	if (session.receivedFileDescriptor >= 0) {
+		close(session.receivedFileDescriptor);
+		session.receivedFileDescriptor = -1;
+	}
+	if (session.socket >= 0) {
+		close(session.socket);
+	}
+}
+
+void BrokerServer::wakeUp() const {
+	const char signal = 1;
+	// a full pipe already wakes up the dispatcher
+	[[maybe_unused]] const ssize_t numWritten = write(wakeUpPipe_[1], &signal, 1);
+}
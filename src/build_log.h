@@ -0,0 +1,34 @@
+#ifndef OPENCL_TOOLKIT_BUILD_LOG_H
+#define OPENCL_TOOLKIT_BUILD_LOG_H
+
+#include <string>
+
+#include "opencl/portable_opencl_include.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Returns the log of the last build, compilation or linking of the passed program for the passed device.
+	 * @param program the program to query the log of.
+	 * @param device the device the program was built for.
+	 * @return the complete log or an empty string if it cannot be queried.
+	 */
+	inline std::string getBuildLog(cl_program program, cl_device_id device) {
+		size_t size = 0;
+		if (clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &size) || !size) {
+			return "";
+		}
+		std::string log(size, '\0');
+		if (clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, size, log.data(), nullptr)) {
+			return "";
+		}
+		// drop the terminating null character
+		log.resize(size - 1);
+		return log;
+	}
+}
+
+#endif //OPENCL_TOOLKIT_BUILD_LOG_H
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "opencl/coherent_array.h"
+
+using namespace OpenClToolkit;
+
+[[maybe_unused]] CoherentBuffer::CoherentBuffer(
+		const Context &context,
+		CommandQueue &commandQueue,
+		const size_t sizeInBytes,
+		const size_t blockSizeInBytes
+) : commandQueue_(commandQueue),
+	sizeInBytes_(sizeInBytes),
+	blockSizeInBytes_(blockSizeInBytes),
+	hostMemory_(sizeInBytes),
+	deviceMemory_(context, std::max<size_t>(sizeInBytes, 1)),
+	blockStates_(blockSizeInBytes ? (sizeInBytes + blockSizeInBytes - 1) / blockSizeInBytes : 0,
+				 BlockState::Synchronized),
+	numBytesUploaded_(0),
+	numBytesDownloaded_(0) {
+	if (!blockSizeInBytes) {
+		// let it crash
+		throw std::runtime_error("Failed to create coherent buffer: the block size is 0");
+	}
+}
+
+[[maybe_unused]] const void *CoherentBuffer::readOnHost(const size_t offsetInBytes, const size_t numBytes) {
+	const auto [firstBlock, endBlock] = getBlocks(offsetInBytes, numBytes);
+	download(firstBlock, endBlock);
+	return hostMemory_.data() + offsetInBytes;
+}
+
+[[maybe_unused]] void *CoherentBuffer::modifyOnHost(const size_t offsetInBytes, const size_t numBytes) {
+	const auto [firstBlock, endBlock] = getBlocks(offsetInBytes, numBytes);
+	download(firstBlock, endBlock);
+	setState(firstBlock, endBlock, BlockState::HostNewer);
+	return hostMemory_.data() + offsetInBytes;
+}
+
+[[maybe_unused]] void *CoherentBuffer::overwriteOnHost(const size_t offsetInBytes, const size_t numBytes) {
+	const auto [firstBlock, endBlock] = getBlocks(offsetInBytes, numBytes);
+	if (firstBlock < endBlock) {
+		// only the bytes of the boundary blocks outside the range must be preserved
+		if (offsetInBytes % blockSizeInBytes_) {
+			download(firstBlock, firstBlock + 1);
+		}
+		const size_t end = offsetInBytes + numBytes;
+		if (end % blockSizeInBytes_ && end < sizeInBytes_) {
+			download(endBlock - 1, endBlock);
+		}
+		setState(firstBlock, endBlock, BlockState::HostNewer);
+	}
+	return hostMemory_.data() + offsetInBytes;
+}
+
+[[maybe_unused]] const ReadWriteBuffer &CoherentBuffer::getDeviceMemory(const DeviceAccess access) {
+	if (access != DeviceAccess::Write) {
+		upload(0, blockStates_.size());
+	}
+	if (access != DeviceAccess::Read) {
+		setState(0, blockStates_.size(), BlockState::DeviceNewer);
+	}
+	return deviceMemory_;
+}
+
+[[maybe_unused]] void CoherentBuffer::bindAsKernelArg(Program &program, const cl_uint argIndex, const DeviceAccess access) {
+	program.setKernelArg(argIndex, sizeof(cl_mem), getDeviceMemory(access));
+}
+
+[[maybe_unused]] size_t CoherentBuffer::getSizeInBytes() const {
+	return sizeInBytes_;
+}
+
+[[maybe_unused]] size_t CoherentBuffer::getNumBytesUploaded() const {
+	return numBytesUploaded_;
+}
+
+[[maybe_unused]] size_t CoherentBuffer::getNumBytesDownloaded() const {
+	return numBytesDownloaded_;
+}
+
+void CoherentBuffer::download(const size_t firstBlock, const size_t endBlock) {
+	for (size_t block = firstBlock; block < endBlock;) {
+		if (blockStates_[block] != BlockState::DeviceNewer) {
+			++block;
+			continue;
+		}
+		// consecutive stale blocks are fetched by one transfer
+		size_t runEnd = block + 1;
+		while (runEnd < endBlock && blockStates_[runEnd] == BlockState::DeviceNewer) {
+			++runEnd;
+		}
+		const size_t offset = block * blockSizeInBytes_;
+		const size_t numBytes = std::min(runEnd * blockSizeInBytes_, sizeInBytes_) - offset;
+		commandQueue_.enqueueCommandCopyBytesFromDeviceMemoryIntoHostMemory(
+				deviceMemory_,
+				hostMemory_.data() + offset,
+				numBytes,
+				offset
+		);
+		numBytesDownloaded_ += numBytes;
+		setState(block, runEnd, BlockState::Synchronized);
+		block = runEnd;
+	}
+}
+
+void CoherentBuffer::upload(const size_t firstBlock, const size_t endBlock) {
+	for (size_t block = firstBlock; block < endBlock;) {
+		if (blockStates_[block] != BlockState::HostNewer) {
+			++block;
+			continue;
+		}
+		// consecutive stale blocks are sent by one transfer
+		size_t runEnd = block + 1;
+		while (runEnd < endBlock && blockStates_[runEnd] == BlockState::HostNewer) {
+			++runEnd;
+		}
+		const size_t offset = block * blockSizeInBytes_;
+		const size_t numBytes = std::min(runEnd * blockSizeInBytes_, sizeInBytes_) - offset;
+		commandQueue_.enqueueCommandCopyBytesFromHostMemoryIntoDeviceMemory(
+				hostMemory_.data() + offset,
+				deviceMemory_,
+				numBytes,
+				offset
+		);
+		numBytesUploaded_ += numBytes;
+		setState(block, runEnd, BlockState::Synchronized);
+		block = runEnd;
+	}
+}
+
+void CoherentBuffer::setState(const size_t firstBlock, const size_t endBlock, const BlockState state) {
+	std::fill(blockStates_.begin() + static_cast<std::ptrdiff_t>(firstBlock),
+			  blockStates_.begin() + static_cast<std::ptrdiff_t>(endBlock),
+			  state);
+}
+
+std::pair<size_t, size_t> CoherentBuffer::getBlocks(const size_t offsetInBytes, const size_t numBytes) const {
+	if (offsetInBytes > sizeInBytes_ || numBytes > sizeInBytes_ - offsetInBytes) {
+		// let it crash
+		throw std::runtime_error("Failed to access coherent buffer: the range exceeds the buffer");
+	}
+	if (!numBytes) {
+		return {0, 0};
+	}
+	return {offsetInBytes / blockSizeInBytes_, (offsetInBytes + numBytes + blockSizeInBytes_ - 1) / blockSizeInBytes_};
+}
@@ -1,11 +1,64 @@
+#include <algorithm>
+#include <optional>
 #include <stdexcept>
 #include <iostream>
 
 #include "opencl/command_queue.h"
+#include "opencl/command_recorder.h"
+#include "opencl/metrics_collector.h"
 #include "opencl/error.h"
 
 using namespace OpenClToolkit;
 
+namespace {
+	/**
+	 * @brief Converts the passed origin and region of an image into the three-dimensional form of OpenCL.
+	 * @param image the image.
+	 * @param origin the first pixel of the region.
+	 * @param region the size of the region in pixels.
+	 * @param imageOrigin receives the origin, 0 for unused dimensions.
+	 * @param imageRegion receives the region, 1 for unused dimensions.
+	 */
+	void toImageRegion(
+			const Image &image,
+			const NDRange &origin,
+			const NDRange &region,
+			size_t (&imageOrigin)[3],
+			size_t (&imageRegion)[3]
+	) {
+		const cl_uint numDimensions = image.getSize().numDimensions;
+		if (origin.numDimensions != numDimensions || region.numDimensions != numDimensions) {
+			// let it crash
+			throw std::runtime_error("Failed to copy the image: the region has a different number of dimensions");
+		}
+		for (cl_uint dimension = 0; dimension < 3; ++dimension) {
+			imageOrigin[dimension] = dimension < numDimensions ? origin.sizes[dimension] : 0;
+			imageRegion[dimension] = dimension < numDimensions ? region.sizes[dimension] : 1;
+		}
+	}
+
+	/**
+	 * @brief Returns the number of bytes of the pixels of a region of an image.
+	 * @param image the image.
+	 * @param imageRegion the region in three dimensions.
+	 * @return the number of bytes of the pixels of the region.
+	 */
+	size_t toImageRegionSizeInBytes(const Image &image, const size_t (&imageRegion)[3]) {
+		return imageRegion[0] * imageRegion[1] * imageRegion[2] * image.getPixelSizeInBytes();
+	}
+
+	/**
+	 * @brief Returns an origin at the first pixel with as many dimensions as the passed image.
+	 * @param image the image.
+	 * @return the origin at the first pixel.
+	 */
+	NDRange getImageStart(const Image &image) {
+		NDRange origin = image.getSize();
+		origin.sizes[0] = origin.sizes[1] = origin.sizes[2] = 0;
+		return origin;
+	}
+}
+
 [[maybe_unused]] CommandQueue::CommandQueue(const Context &context, cl_device_id deviceId) {
 	cl_int status = CL_SUCCESS;
 	self_ = clCreateCommandQueueWithProperties(context, deviceId, nullptr, &status);
@@ -27,6 +80,8 @@ CommandQueue::~CommandQueue() {
 		const ReadOnlyBuffer &destinationDeviceMemory,
 		const size_t numBytesToCopy
 ) {
+	CommandRecorder::getInstance().recordWrite(destinationDeviceMemory, 0, numBytesToCopy, sourceHostMemory);
+	MetricsCollector::getInstance().recordUpload(numBytesToCopy);
 	const cl_int status = clEnqueueWriteBuffer(
 			self_,
 			destinationDeviceMemory,
@@ -51,6 +106,8 @@ CommandQueue::~CommandQueue() {
 		void *destinationHostMemory,
 		const size_t numBytesToCopy
 ) {
+	CommandRecorder::getInstance().recordRead(sourceDeviceMemory, 0, numBytesToCopy);
+	MetricsCollector::getInstance().recordDownload(numBytesToCopy);
 	const cl_int status = clEnqueueReadBuffer(
 			self_,
 			sourceDeviceMemory,
@@ -70,10 +127,625 @@ CommandQueue::~CommandQueue() {
 	}
 }
 
+[[maybe_unused]] void CommandQueue::enqueueCommandCopyBytesFromHostMemoryIntoDeviceMemory(
+		const void *sourceHostMemory,
+		const ReadWriteBuffer &destinationDeviceMemory,
+		const size_t numBytesToCopy,
+		const size_t destinationOffsetInBytes
+) {
+	CommandRecorder::getInstance().recordWrite(
+			destinationDeviceMemory,
+			destinationOffsetInBytes,
+			numBytesToCopy,
+			sourceHostMemory
+	);
+	MetricsCollector::getInstance().recordUpload(numBytesToCopy);
+	const cl_int status = clEnqueueWriteBuffer(
+			self_,
+			destinationDeviceMemory,
+			CL_TRUE,
+			destinationOffsetInBytes,
+			numBytesToCopy,
+			sourceHostMemory,
+			0,
+			nullptr,
+			nullptr
+	);
+	if (status) {
+		// let it crash
+		throw std::runtime_error(
+				"Failed to copy data from host memory do device memory. " + toErrorDescription(status)
+		);
+	}
+}
+
+[[maybe_unused]] void CommandQueue::enqueueCommandCopyBytesFromDeviceMemoryIntoHostMemory(
+		const ReadWriteBuffer &sourceDeviceMemory,
+		void *destinationHostMemory,
+		const size_t numBytesToCopy,
+		const size_t sourceOffsetInBytes
+) {
+	CommandRecorder::getInstance().recordRead(sourceDeviceMemory, sourceOffsetInBytes, numBytesToCopy);
+	MetricsCollector::getInstance().recordDownload(numBytesToCopy);
+	const cl_int status = clEnqueueReadBuffer(
+			self_,
+			sourceDeviceMemory,
+			CL_TRUE,
+			sourceOffsetInBytes,
+			numBytesToCopy,
+			destinationHostMemory,
+			0,
+			nullptr,
+			nullptr
+	);
+	if (status) {
+		// let it crash
+		throw std::runtime_error(
+				"Failed to copy data from device memory to host memory. " + toErrorDescription(status)
+		);
+	}
+}
+
+[[maybe_unused]] void CommandQueue::enqueueCommandCopyBytesFromDeviceMemoryIntoDeviceMemory(
+		const BaseBuffer &sourceDeviceMemory,
+		const BaseBuffer &destinationDeviceMemory,
+		const size_t numBytesToCopy,
+		const size_t sourceOffsetInBytes,
+		const size_t destinationOffsetInBytes
+) {
+	CommandRecorder::getInstance().recordCopy(
+			sourceDeviceMemory,
+			destinationDeviceMemory,
+			sourceOffsetInBytes,
+			destinationOffsetInBytes,
+			numBytesToCopy
+	);
+	const cl_int status = clEnqueueCopyBuffer(
+			self_,
+			sourceDeviceMemory,
+			destinationDeviceMemory,
+			sourceOffsetInBytes,
+			destinationOffsetInBytes,
+			numBytesToCopy,
+			0,
+			nullptr,
+			nullptr
+	);
+	if (status) {
+		// let it crash
+		throw std::runtime_error(
+				"Failed to copy data from device memory to device memory. " + toErrorDescription(status)
+		);
+	}
+}
+
+[[maybe_unused]] void CommandQueue::enqueueCommandFillDeviceMemory(
+		const BaseBuffer &deviceMemory,
+		const void *pattern,
+		const size_t patternSizeInBytes,
+		const size_t numBytesToFill,
+		const size_t offsetInBytes
+) {
+	CommandRecorder::getInstance().recordFill(deviceMemory, pattern, patternSizeInBytes, offsetInBytes, numBytesToFill);
+	const cl_int status = clEnqueueFillBuffer(
+			self_,
+			deviceMemory,
+			pattern,
+			patternSizeInBytes,
+			offsetInBytes,
+			numBytesToFill,
+			0,
+			nullptr,
+			nullptr
+	);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Failed to fill device memory. " + toErrorDescription(status));
+	}
+}
+
+[[maybe_unused]] void CommandQueue::enqueueCommandExecuteProgramOnDevice(
+		const Program &program,
+		const size_t numThreads,
+		const size_t numThreadsPerWorkGroup
+) {
+	CommandRecorder::getInstance().recordLaunch(program.getKernel(), 1, &numThreads, &numThreadsPerWorkGroup, nullptr);
+	MetricsCollector::getInstance().recordLaunch(program.getKernelName());
+	const cl_int status = clEnqueueNDRangeKernel(
+			self_,
+			program.getKernel(),
+			1,
+			nullptr,
+			&numThreads,
+			&numThreadsPerWorkGroup,
+			0,
+			nullptr,
+			nullptr
+	);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Failed to executed the program: " + toErrorDescription(status));
+	}
+}
+
+[[maybe_unused]] void CommandQueue::enqueueCommandExecuteProgramOnDevice(
+		const Program &program,
+		const NDRange &globalWorkSize,
+		const NDRange &localWorkSize,
+		const NDRange *globalWorkOffset
+) {
+	enqueueExecuteProgram(program, globalWorkSize, localWorkSize, globalWorkOffset, nullptr);
+}
+
+[[maybe_unused]] void CommandQueue::enqueueCommandCopyBytesFromHostMemoryIntoImage(
+		const void *sourceHostMemory,
+		const Image &destinationImage,
+		const NDRange &origin,
+		const NDRange &region,
+		const size_t sourceRowPitchInBytes,
+		const size_t sourceSlicePitchInBytes
+) {
+	size_t imageOrigin[3];
+	size_t imageRegion[3];
+	toImageRegion(destinationImage, origin, region, imageOrigin, imageRegion);
+	CommandRecorder::getInstance().recordImageWrite(
+			destinationImage,
+			imageOrigin,
+			imageRegion,
+			sourceRowPitchInBytes,
+			sourceSlicePitchInBytes,
+			sourceHostMemory
+	);
+	MetricsCollector::getInstance().recordUpload(toImageRegionSizeInBytes(destinationImage, imageRegion));
+	const cl_int status = clEnqueueWriteImage(
+			self_,
+			destinationImage,
+			CL_TRUE,
+			imageOrigin,
+			imageRegion,
+			sourceRowPitchInBytes,
+			sourceSlicePitchInBytes,
+			sourceHostMemory,
+			0,
+			nullptr,
+			nullptr
+	);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Failed to copy bytes into the image: " + toErrorDescription(status));
+	}
+}
+
+[[maybe_unused]] void CommandQueue::enqueueCommandCopyBytesFromHostMemoryIntoImage(
+		const void *sourceHostMemory,
+		const Image &destinationImage
+) {
+	enqueueCommandCopyBytesFromHostMemoryIntoImage(
+			sourceHostMemory,
+			destinationImage,
+			getImageStart(destinationImage),
+			destinationImage.getSize()
+	);
+}
+
+[[maybe_unused]] void CommandQueue::enqueueCommandCopyBytesFromImageIntoHostMemory(
+		const Image &sourceImage,
+		void *destinationHostMemory,
+		const NDRange &origin,
+		const NDRange &region,
+		const size_t destinationRowPitchInBytes,
+		const size_t destinationSlicePitchInBytes
+) {
+	size_t imageOrigin[3];
+	size_t imageRegion[3];
+	toImageRegion(sourceImage, origin, region, imageOrigin, imageRegion);
+	CommandRecorder::getInstance().recordImageRead(
+			sourceImage,
+			imageOrigin,
+			imageRegion,
+			destinationRowPitchInBytes,
+			destinationSlicePitchInBytes
+	);
+	MetricsCollector::getInstance().recordDownload(toImageRegionSizeInBytes(sourceImage, imageRegion));
+	const cl_int status = clEnqueueReadImage(
+			self_,
+			sourceImage,
+			CL_TRUE,
+			imageOrigin,
+			imageRegion,
+			destinationRowPitchInBytes,
+			destinationSlicePitchInBytes,
+			destinationHostMemory,
+			0,
+			nullptr,
+			nullptr
+	);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Failed to copy bytes from the image: " + toErrorDescription(status));
+	}
+}
+
+[[maybe_unused]] void CommandQueue::enqueueCommandCopyBytesFromImageIntoHostMemory(
+		const Image &sourceImage,
+		void *destinationHostMemory
+) {
+	enqueueCommandCopyBytesFromImageIntoHostMemory(
+			sourceImage,
+			destinationHostMemory,
+			getImageStart(sourceImage),
+			sourceImage.getSize()
+	);
+}
+
+[[maybe_unused]] void *CommandQueue::enqueueCommandMapImage(
+		const Image &image,
+		const cl_map_flags mapFlags,
+		size_t &rowPitchInBytes,
+		size_t &slicePitchInBytes
+) {
+	size_t imageOrigin[3];
+	size_t imageRegion[3];
+	toImageRegion(image, getImageStart(image), image.getSize(), imageOrigin, imageRegion);
+	cl_int status;
+	void *mappedHostMemory = clEnqueueMapImage(
+			self_,
+			image,
+			CL_TRUE,
+			mapFlags,
+			imageOrigin,
+			imageRegion,
+			&rowPitchInBytes,
+			&slicePitchInBytes,
+			0,
+			nullptr,
+			nullptr,
+			&status
+	);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Failed to map the image: " + toErrorDescription(status));
+	}
+
+	// the pitches of the mapping are only known once it is mapped
+	if (!(mapFlags & CL_MAP_WRITE_INVALIDATE_REGION)) {
+		CommandRecorder::getInstance().recordImageRead(
+				image,
+				imageOrigin,
+				imageRegion,
+				rowPitchInBytes,
+				slicePitchInBytes
+		);
+		MetricsCollector::getInstance().recordDownload(toImageRegionSizeInBytes(image, imageRegion));
+	}
+	if (mapFlags & (CL_MAP_WRITE | CL_MAP_WRITE_INVALIDATE_REGION)) {
+		std::lock_guard<std::mutex> lock(imageMappingsMutex_);
+		imageMappings_[mappedHostMemory] = ImageMapping{&image, rowPitchInBytes, slicePitchInBytes};
+	}
+	return mappedHostMemory;
+}
+
+[[maybe_unused]] void CommandQueue::enqueueCommandUnmapMemoryObject(cl_mem memoryObject, void *mappedHostMemory) {
+	std::optional<ImageMapping> imageMapping;
+	{
+		std::lock_guard<std::mutex> lock(imageMappingsMutex_);
+		const auto iterator = imageMappings_.find(mappedHostMemory);
+		if (iterator != imageMappings_.end() && static_cast<cl_mem>(*iterator->second.image) == memoryObject) {
+			imageMapping = iterator->second;
+			imageMappings_.erase(iterator);
+		}
+	}
+	if (imageMapping) {
+		// the pixels written through the mapping reach the device when it is released
+		const Image &image = *imageMapping->image;
+		size_t imageOrigin[3];
+		size_t imageRegion[3];
+		toImageRegion(image, getImageStart(image), image.getSize(), imageOrigin, imageRegion);
+		CommandRecorder::getInstance().recordImageWrite(
+				image,
+				imageOrigin,
+				imageRegion,
+				imageMapping->rowPitchInBytes,
+				imageMapping->slicePitchInBytes,
+				mappedHostMemory
+		);
+		MetricsCollector::getInstance().recordUpload(toImageRegionSizeInBytes(image, imageRegion));
+	}
+	const cl_int status = clEnqueueUnmapMemObject(self_, memoryObject, mappedHostMemory, 0, nullptr, nullptr);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Failed to unmap the memory object: " + toErrorDescription(status));
+	}
+}
+
+[[maybe_unused]] void CommandQueue::enqueueCommandCopyBytesFromHostMemoryIntoSegmentedBuffer(
+		const void *sourceHostMemory,
+		const SegmentedBuffer &destinationBuffer,
+		const size_t numBytesToCopy,
+		const size_t destinationOffsetInBytes
+) {
+	if (destinationOffsetInBytes > destinationBuffer.getSizeInBytes() ||
+		numBytesToCopy > destinationBuffer.getSizeInBytes() - destinationOffsetInBytes) {
+		// let it crash
+		throw std::runtime_error("Failed to copy data: the range exceeds the segmented device memory");
+	}
+	const auto *source = static_cast<const char *>(sourceHostMemory);
+	const size_t end = destinationOffsetInBytes + numBytesToCopy;
+	for (size_t offset = destinationOffsetInBytes; offset < end;) {
+		const size_t index = destinationBuffer.getSegmentIndex(offset);
+		const size_t segmentOffset = offset - destinationBuffer.getSegmentOffsetInBytes(index);
+		const size_t numBytes = std::min(end - offset, destinationBuffer.getSegmentSizeInBytes(index) - segmentOffset);
+		CommandRecorder::getInstance().recordWrite(
+				destinationBuffer.getSegment(index),
+				segmentOffset,
+				numBytes,
+				source + (offset - destinationOffsetInBytes)
+		);
+		MetricsCollector::getInstance().recordUpload(numBytes);
+		// the queue is in order, so awaiting the last copy awaits all of them
+		const cl_int status = clEnqueueWriteBuffer(
+				self_,
+				destinationBuffer.getSegment(index),
+				offset + numBytes == end ? CL_TRUE : CL_FALSE,
+				segmentOffset,
+				numBytes,
+				source + (offset - destinationOffsetInBytes),
+				0,
+				nullptr,
+				nullptr
+		);
+		if (status) {
+			// let it crash
+			throw std::runtime_error("Failed to copy data from host memory to segmented device memory. " +
+									 toErrorDescription(status));
+		}
+		offset += numBytes;
+	}
+}
+
+[[maybe_unused]] void CommandQueue::enqueueCommandCopyBytesFromSegmentedBufferIntoHostMemory(
+		const SegmentedBuffer &sourceBuffer,
+		void *destinationHostMemory,
+		const size_t numBytesToCopy,
+		const size_t sourceOffsetInBytes
+) {
+	if (sourceOffsetInBytes > sourceBuffer.getSizeInBytes() ||
+		numBytesToCopy > sourceBuffer.getSizeInBytes() - sourceOffsetInBytes) {
+		// let it crash
+		throw std::runtime_error("Failed to copy data: the range exceeds the segmented device memory");
+	}
+	auto *destination = static_cast<char *>(destinationHostMemory);
+	const size_t end = sourceOffsetInBytes + numBytesToCopy;
+	for (size_t offset = sourceOffsetInBytes; offset < end;) {
+		const size_t index = sourceBuffer.getSegmentIndex(offset);
+		const size_t segmentOffset = offset - sourceBuffer.getSegmentOffsetInBytes(index);
+		const size_t numBytes = std::min(end - offset, sourceBuffer.getSegmentSizeInBytes(index) - segmentOffset);
+		CommandRecorder::getInstance().recordRead(sourceBuffer.getSegment(index), segmentOffset, numBytes);
+		MetricsCollector::getInstance().recordDownload(numBytes);
+		// the queue is in order, so awaiting the last copy awaits all of them
+		const cl_int status = clEnqueueReadBuffer(
+				self_,
+				sourceBuffer.getSegment(index),
+				offset + numBytes == end ? CL_TRUE : CL_FALSE,
+				segmentOffset,
+				numBytes,
+				destination + (offset - sourceOffsetInBytes),
+				0,
+				nullptr,
+				nullptr
+		);
+		if (status) {
+			// let it crash
+			throw std::runtime_error("Failed to copy data from segmented device memory to host memory. " +
+									 toErrorDescription(status));
+		}
+		offset += numBytes;
+	}
+}
+
+[[maybe_unused]] void CommandQueue::enqueueCommandExecuteProgramOnSegments(
+		Program &program,
+		const cl_uint argIndex,
+		const SegmentedBuffer &buffer
+) {
+	const size_t elementSize = buffer.getElementSizeInBytes();
+	for (size_t index = 0; index < buffer.getNumSegments(); ++index) {
+		program.setKernelArg(argIndex, sizeof(cl_mem), buffer.getSegment(index));
+		const size_t globalWorkOffset = buffer.getSegmentOffsetInBytes(index) / elementSize;
+		const size_t numThreads = buffer.getSegmentSizeInBytes(index) / elementSize;
+		CommandRecorder::getInstance().recordLaunch(program.getKernel(), 1, &numThreads, nullptr, &globalWorkOffset);
+		MetricsCollector::getInstance().recordLaunch(program.getKernelName());
+		const cl_int status = clEnqueueNDRangeKernel(
+				self_,
+				program.getKernel(),
+				1,
+				&globalWorkOffset,
+				&numThreads,
+				nullptr,
+				0,
+				nullptr,
+				nullptr
+		);
+		if (status) {
+			// let it crash
+			throw std::runtime_error("Failed to executed the program on segment " + std::to_string(index) + ": " +
+									 toErrorDescription(status));
+		}
+	}
+}
+
+[[maybe_unused]] Event CommandQueue::enqueueCommandCopyBytesFromHostMemoryIntoDeviceMemoryAsync(
+		const void *sourceHostMemory,
+		const BaseBuffer &destinationDeviceMemory,
+		const size_t numBytesToCopy,
+		const size_t destinationOffsetInBytes
+) {
+	CommandRecorder::getInstance().recordWrite(
+			destinationDeviceMemory,
+			destinationOffsetInBytes,
+			numBytesToCopy,
+			sourceHostMemory
+	);
+	MetricsCollector::getInstance().recordUpload(numBytesToCopy);
+	cl_event event;
+	const cl_int status = clEnqueueWriteBuffer(
+			self_,
+			destinationDeviceMemory,
+			CL_FALSE,
+			destinationOffsetInBytes,
+			numBytesToCopy,
+			sourceHostMemory,
+			0,
+			nullptr,
+			&event
+	);
+	if (status) {
+		// let it crash
+		throw std::runtime_error(
+				"Failed to copy data from host memory do device memory. " + toErrorDescription(status)
+		);
+	}
+	return Event(event);
+}
+
+[[maybe_unused]] Event CommandQueue::enqueueCommandCopyBytesFromDeviceMemoryIntoHostMemoryAsync(
+		const BaseBuffer &sourceDeviceMemory,
+		void *destinationHostMemory,
+		const size_t numBytesToCopy,
+		const size_t sourceOffsetInBytes
+) {
+	CommandRecorder::getInstance().recordRead(sourceDeviceMemory, sourceOffsetInBytes, numBytesToCopy);
+	MetricsCollector::getInstance().recordDownload(numBytesToCopy);
+	cl_event event;
+	const cl_int status = clEnqueueReadBuffer(
+			self_,
+			sourceDeviceMemory,
+			CL_FALSE,
+			sourceOffsetInBytes,
+			numBytesToCopy,
+			destinationHostMemory,
+			0,
+			nullptr,
+			&event
+	);
+	if (status) {
+		// let it crash
+		throw std::runtime_error(
+				"Failed to copy data from device memory to host memory. " + toErrorDescription(status)
+		);
+	}
+	return Event(event);
+}
+
+[[maybe_unused]] Event CommandQueue::enqueueCommandExecuteProgramOnDeviceAsync(
+		const Program &program,
+		const NDRange &globalWorkSize,
+		const NDRange &localWorkSize,
+		const NDRange *globalWorkOffset
+) {
+	cl_event event;
+	enqueueExecuteProgram(program, globalWorkSize, localWorkSize, globalWorkOffset, &event);
+	return Event(event);
+}
+
+void CommandQueue::enqueueExecuteProgram(
+		const Program &program,
+		const NDRange &globalWorkSize,
+		const NDRange &localWorkSize,
+		const NDRange *globalWorkOffset,
+		cl_event *event
+) {
+	if (globalWorkSize.numDimensions != localWorkSize.numDimensions ||
+		(globalWorkOffset && globalWorkOffset->numDimensions != globalWorkSize.numDimensions)) {
+		// let it crash
+		throw std::runtime_error("Failed to executed the program: the ranges have different numbers of dimensions");
+	}
+	CommandRecorder::getInstance().recordLaunch(
+			program.getKernel(),
+			globalWorkSize.numDimensions,
+			globalWorkSize.sizes,
+			localWorkSize.sizes,
+			globalWorkOffset ? globalWorkOffset->sizes : nullptr
+	);
+	MetricsCollector::getInstance().recordLaunch(program.getKernelName());
+	const cl_int status = clEnqueueNDRangeKernel(
+			self_,
+			program.getKernel(),
+			globalWorkSize.numDimensions,
+			globalWorkOffset ? globalWorkOffset->sizes : nullptr,
+			globalWorkSize.sizes,
+			localWorkSize.sizes,
+			0,
+			nullptr,
+			event
+	);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Failed to executed the program: " + toErrorDescription(status));
+	}
+}
+
+[[maybe_unused]] void CommandQueue::enqueueCommandMigrateMemoryObjects(
+		const std::vector<cl_mem> &memoryObjects,
+		const cl_mem_migration_flags migrationFlags,
+		const CommandQueue *predecessor
+) {
+	if (memoryObjects.empty()) {
+		return;
+	}
+	cl_event marker = nullptr;
+	if (predecessor) {
+		// a marker without wait list completes when all commands enqueued before it have completed
+		cl_int status = clEnqueueMarkerWithWaitList(*predecessor, 0, nullptr, &marker);
+		if (status) {
+			// let it crash
+			throw std::runtime_error("Failed to enqueue marker. " + toErrorDescription(status));
+		}
+		// the migration waits for the marker across queues, which never completes unless its queue is flushed
+		status = clFlush(*predecessor);
+		if (status) {
+			clReleaseEvent(marker);
+			// let it crash
+			throw std::runtime_error("Failed to flush the predecessor queue. " + toErrorDescription(status));
+		}
+	}
+	const cl_int status = clEnqueueMigrateMemObjects(
+			self_,
+			static_cast<cl_uint>(memoryObjects.size()),
+			memoryObjects.data(),
+			migrationFlags,
+			marker ? 1 : 0,
+			marker ? &marker : nullptr,
+			nullptr
+	);
+	if (marker) {
+		clReleaseEvent(marker);
+	}
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Failed to migrate memory objects. " + toErrorDescription(status));
+	}
+}
+
+[[maybe_unused]] void CommandQueue::finish() {
+	CommandRecorder::getInstance().recordFinish();
+	const cl_int status = clFinish(self_);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Failed to finish the command queue. " + toErrorDescription(status));
+	}
+}
+
+CommandQueue::operator cl_command_queue() const {
+	return self_;
+}
+
 [[maybe_unused]] void CommandQueue::enqueueCommandExecuteProgramOnDevice(
 		const Program &program,
 		const size_t numThreads
 ) {
+	CommandRecorder::getInstance().recordLaunch(program.getKernel(), 1, &numThreads, nullptr, nullptr);
+	MetricsCollector::getInstance().recordLaunch(program.getKernelName());
 	const cl_int status = clEnqueueNDRangeKernel(
 			self_,
 			program.getKernel(),
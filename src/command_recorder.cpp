@@ -0,0 +1,494 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include "opencl/command_recorder.h"
+#include "command_trace_format.h"
+
+using namespace OpenClToolkit;
+using namespace OpenClToolkit::CommandTraceFormat;
+
+namespace {
+	/**
+	 * @brief Converts an OpenCL handle into the id stored in a trace.
+	 * @param handle the handle.
+	 * @return the id.
+	 */
+	uint64_t toId(const void *handle) {
+		return reinterpret_cast<uintptr_t>(handle);
+	}
+
+	/**
+	 * @brief Copies up to three sizes into a record, filling unused dimensions with 0.
+	 * @param numDimensions the number of dimensions.
+	 * @param sizes the sizes, nullptr for none.
+	 * @param destination receives the sizes.
+	 */
+	void copySizes(const cl_uint numDimensions, const size_t *sizes, uint64_t destination[3]) {
+		for (cl_uint i = 0; i < 3; ++i) {
+			destination[i] = sizes && i < numDimensions ? sizes[i] : 0;
+		}
+	}
+
+	/**
+	 * @brief Describes a copy between host memory and a region of an image.
+	 * @param image the image.
+	 * @param origin the first pixel of the region in three dimensions.
+	 * @param region the size of the region in pixels in three dimensions.
+	 * @param rowPitchInBytes the distance of the rows in host memory, 0 for tightly packed rows.
+	 * @param slicePitchInBytes the distance of the slices in host memory, 0 for tightly packed slices.
+	 * @param hasPayload true if the pixels follow the record.
+	 * @return the record of the copy.
+	 */
+	ImageTransferRecord toImageTransferRecord(
+			const Image &image,
+			const size_t *origin,
+			const size_t *region,
+			const size_t rowPitchInBytes,
+			const size_t slicePitchInBytes,
+			const bool hasPayload
+	) {
+		ImageTransferRecord record{};
+		record.image = toId(static_cast<cl_mem>(image));
+		copySizes(3, origin, record.origin);
+		copySizes(3, region, record.region);
+		record.rowPitchInBytes = rowPitchInBytes;
+		record.slicePitchInBytes = slicePitchInBytes;
+		if (region[0] && region[1] && region[2]) {
+			// the last row of the last slice ends after its pixels, not after its pitch
+			const size_t rowSizeInBytes = region[0] * image.getPixelSizeInBytes();
+			const size_t rowPitch = rowPitchInBytes ? rowPitchInBytes : rowSizeInBytes;
+			const size_t slicePitch = slicePitchInBytes ? slicePitchInBytes : rowPitch * region[1];
+			record.sizeInBytes = slicePitch * (region[2] - 1) + rowPitch * (region[1] - 1) + rowSizeInBytes;
+		}
+		record.hasPayload = hasPayload;
+		return record;
+	}
+}
+
+CommandRecorder::CommandRecorder() : isRecording_(false), isRecordingPayloads_(false) {
+	const char *path = std::getenv("OPENCL_TOOLKIT_TRACE");
+	if (path && *path) {
+		const char *payloads = std::getenv("OPENCL_TOOLKIT_TRACE_PAYLOADS");
+		start(path, payloads && std::strcmp(payloads, "1") == 0);
+	}
+}
+
+CommandRecorder::~CommandRecorder() {
+	stop();
+}
+
+[[maybe_unused]] CommandRecorder &CommandRecorder::getInstance() {
+	static CommandRecorder instance;
+	return instance;
+}
+
+[[maybe_unused]] void CommandRecorder::start(const std::string &path, const bool isRecordingPayloads) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (file_.is_open()) {
+		file_.close();
+	}
+	file_.open(path, std::ios::binary | std::ios::trunc);
+	if (!file_) {
+		isRecording_ = false;
+		// let it crash
+		throw std::runtime_error("Failed to open trace file " + path);
+	}
+	FileHeader header{};
+	std::memcpy(header.magic, magic, sizeof(magic));
+	header.version = version;
+	file_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	isRecordingPayloads_ = isRecordingPayloads;
+	start_ = std::chrono::steady_clock::now();
+	isRecording_ = true;
+}
+
+[[maybe_unused]] void CommandRecorder::stop() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	isRecording_ = false;
+	if (file_.is_open()) {
+		file_.close();
+		if (!file_) {
+			std::cerr << "Failed to complete the trace file" << std::endl;
+		}
+	}
+}
+
+[[maybe_unused]] bool CommandRecorder::isRecording() const {
+	return isRecording_;
+}
+
+void CommandRecorder::recordAllocation(cl_mem buffer, const cl_mem_flags flags, const size_t sizeInBytes) {
+	if (!isRecording_) {
+		return;
+	}
+	const AllocationRecord record{toId(buffer), flags, sizeInBytes};
+	append(static_cast<uint32_t>(RecordType::Allocation), &record, sizeof(record));
+}
+
+void CommandRecorder::recordImageAllocation(
+		cl_mem image,
+		const cl_mem_flags flags,
+		const cl_image_format &format,
+		const NDRange &size
+) {
+	if (!isRecording_) {
+		return;
+	}
+	ImageAllocationRecord record{};
+	record.image = toId(image);
+	record.flags = flags;
+	record.channelOrder = format.image_channel_order;
+	record.channelDataType = format.image_channel_data_type;
+	record.numDimensions = size.numDimensions;
+	copySizes(size.numDimensions, size.sizes, record.size);
+	append(static_cast<uint32_t>(RecordType::ImageAllocation), &record, sizeof(record));
+}
+
+void CommandRecorder::recordRelease(cl_mem buffer) {
+	if (!isRecording_) {
+		return;
+	}
+	const ReleaseRecord record{toId(buffer)};
+	append(static_cast<uint32_t>(RecordType::Release), &record, sizeof(record));
+}
+
+void CommandRecorder::recordProgram(
+		cl_program program,
+		const RecordedProgramKind kind,
+		const std::string &buildOptions,
+		const void *data,
+		const size_t dataSizeInBytes
+) {
+	if (!isRecording_) {
+		return;
+	}
+	ProgramRecord record{};
+	record.program = toId(program);
+	switch (kind) {
+		case RecordedProgramKind::Source:
+			record.kind = ProgramKind::Source;
+			break;
+		case RecordedProgramKind::IntermediateLanguage:
+			record.kind = ProgramKind::IntermediateLanguage;
+			break;
+	}
+	record.buildOptionsLength = buildOptions.size();
+	record.dataLength = dataSizeInBytes;
+	append(
+			static_cast<uint32_t>(RecordType::Program),
+			&record,
+			sizeof(record),
+			buildOptions.data(),
+			buildOptions.size(),
+			data,
+			dataSizeInBytes
+	);
+}
+
+void CommandRecorder::recordLinkedProgram(
+		cl_program program,
+		const KernelLibrary &library,
+		const char *sourceCode,
+		const std::string &buildOptions
+) {
+	if (!isRecording_) {
+		return;
+	}
+	const auto &headers = library.getHeaders();
+	const LinkedProgramRecord record{
+			toId(program),
+			headers.size(),
+			library.getCompileOptions().size(),
+			library.getSourceCode().size(),
+			buildOptions.size(),
+			std::strlen(sourceCode)
+	};
+	std::string trailer;
+	for (const auto &header: headers) {
+		const KernelHeaderRecord headerRecord{header.name.size(), header.sourceCode.size()};
+		trailer.append(reinterpret_cast<const char *>(&headerRecord), sizeof(headerRecord));
+		trailer += header.name;
+		trailer += header.sourceCode;
+	}
+	trailer += library.getCompileOptions();
+	trailer += library.getSourceCode();
+	trailer += buildOptions;
+	append(
+			static_cast<uint32_t>(RecordType::LinkedProgram),
+			&record,
+			sizeof(record),
+			trailer.data(),
+			trailer.size(),
+			sourceCode,
+			record.sourceLength
+	);
+}
+
+void CommandRecorder::recordKernel(cl_kernel kernel, cl_program program, const std::string &kernelName) {
+	if (!isRecording_) {
+		return;
+	}
+	const KernelRecord record{toId(kernel), toId(program), kernelName.size()};
+	append(static_cast<uint32_t>(RecordType::Kernel), &record, sizeof(record), kernelName.data(), kernelName.size());
+}
+
+void CommandRecorder::recordKernelArgument(
+		cl_kernel kernel,
+		const cl_uint argIndex,
+		const size_t argSize,
+		const void *argValue
+) {
+	if (!isRecording_) {
+		return;
+	}
+	const KernelArgumentRecord record{
+			toId(kernel),
+			argIndex,
+			argValue ? ArgumentKind::Value : ArgumentKind::Local,
+			argSize,
+			0
+	};
+	append(
+			static_cast<uint32_t>(RecordType::KernelArgument),
+			&record,
+			sizeof(record),
+			argValue,
+			argValue ? argSize : 0
+	);
+}
+
+void CommandRecorder::recordKernelBufferArgument(cl_kernel kernel, const cl_uint argIndex, cl_mem buffer) {
+	if (!isRecording_) {
+		return;
+	}
+	const KernelArgumentRecord record{toId(kernel), argIndex, ArgumentKind::Buffer, sizeof(cl_mem), toId(buffer)};
+	append(static_cast<uint32_t>(RecordType::KernelArgument), &record, sizeof(record));
+}
+
+void CommandRecorder::recordKernelSamplerArgument(cl_kernel kernel, const cl_uint argIndex, cl_sampler sampler) {
+	if (!isRecording_) {
+		return;
+	}
+	const auto query = [sampler](const cl_sampler_info name, const size_t size, void *value) {
+		return clGetSamplerInfo(sampler, name, size, value, nullptr) == CL_SUCCESS;
+	};
+	cl_bool isNormalizedCoordinates = CL_FALSE;
+	cl_addressing_mode addressingMode = 0;
+	cl_filter_mode filterMode = 0;
+	if (!query(CL_SAMPLER_NORMALIZED_COORDS, sizeof(isNormalizedCoordinates), &isNormalizedCoordinates) ||
+		!query(CL_SAMPLER_ADDRESSING_MODE, sizeof(addressingMode), &addressingMode) ||
+		!query(CL_SAMPLER_FILTER_MODE, sizeof(filterMode), &filterMode)) {
+		recordUnsupportedKernelArgument(kernel, argIndex);
+		return;
+	}
+	const KernelArgumentRecord record{toId(kernel), argIndex, ArgumentKind::Sampler, sizeof(cl_sampler), 0};
+	const SamplerArgument sampling{isNormalizedCoordinates, addressingMode, filterMode, 0};
+	append(static_cast<uint32_t>(RecordType::KernelArgument), &record, sizeof(record), &sampling, sizeof(sampling));
+}
+
+void CommandRecorder::recordKernelPipeArgument(
+		cl_kernel kernel,
+		const cl_uint argIndex,
+		cl_mem pipe,
+		const cl_uint packetSizeInBytes,
+		const cl_uint maxNumPackets
+) {
+	if (!isRecording_) {
+		return;
+	}
+	const KernelArgumentRecord record{toId(kernel), argIndex, ArgumentKind::Pipe, sizeof(cl_mem), toId(pipe)};
+	const PipeArgument properties{packetSizeInBytes, maxNumPackets};
+	append(
+			static_cast<uint32_t>(RecordType::KernelArgument),
+			&record,
+			sizeof(record),
+			&properties,
+			sizeof(properties)
+	);
+}
+
+void CommandRecorder::recordUnsupportedKernelArgument(cl_kernel kernel, const cl_uint argIndex) {
+	if (!isRecording_) {
+		return;
+	}
+	const KernelArgumentRecord record{toId(kernel), argIndex, ArgumentKind::Unsupported, 0, 0};
+	append(static_cast<uint32_t>(RecordType::KernelArgument), &record, sizeof(record));
+}
+
+void CommandRecorder::recordIndirectSvmPointers(cl_kernel kernel) {
+	recordUnsupportedKernelArgument(kernel, executionInfoIndex);
+}
+
+void CommandRecorder::recordWrite(
+		cl_mem buffer,
+		const size_t offsetInBytes,
+		const size_t sizeInBytes,
+		const void *data
+) {
+	if (!isRecording_) {
+		return;
+	}
+	const bool hasPayload = isRecordingPayloads_ && data;
+	const WriteRecord record{toId(buffer), offsetInBytes, sizeInBytes, hasPayload};
+	append(
+			static_cast<uint32_t>(RecordType::Write),
+			&record,
+			sizeof(record),
+			hasPayload ? data : nullptr,
+			hasPayload ? sizeInBytes : 0
+	);
+}
+
+void CommandRecorder::recordRead(cl_mem buffer, const size_t offsetInBytes, const size_t sizeInBytes) {
+	if (!isRecording_) {
+		return;
+	}
+	const ReadRecord record{toId(buffer), offsetInBytes, sizeInBytes};
+	append(static_cast<uint32_t>(RecordType::Read), &record, sizeof(record));
+}
+
+void CommandRecorder::recordImageWrite(
+		const Image &image,
+		const size_t *origin,
+		const size_t *region,
+		const size_t rowPitchInBytes,
+		const size_t slicePitchInBytes,
+		const void *data
+) {
+	if (!isRecording_) {
+		return;
+	}
+	const bool hasPayload = isRecordingPayloads_ && data;
+	const ImageTransferRecord record = toImageTransferRecord(
+			image,
+			origin,
+			region,
+			rowPitchInBytes,
+			slicePitchInBytes,
+			hasPayload
+	);
+	append(
+			static_cast<uint32_t>(RecordType::ImageWrite),
+			&record,
+			sizeof(record),
+			hasPayload ? data : nullptr,
+			hasPayload ? record.sizeInBytes : 0
+	);
+}
+
+void CommandRecorder::recordImageRead(
+		const Image &image,
+		const size_t *origin,
+		const size_t *region,
+		const size_t rowPitchInBytes,
+		const size_t slicePitchInBytes
+) {
+	if (!isRecording_) {
+		return;
+	}
+	const ImageTransferRecord record = toImageTransferRecord(
+			image,
+			origin,
+			region,
+			rowPitchInBytes,
+			slicePitchInBytes,
+			false
+	);
+	append(static_cast<uint32_t>(RecordType::ImageRead), &record, sizeof(record));
+}
+
+void CommandRecorder::recordCopy(
+		cl_mem sourceBuffer,
+		cl_mem destinationBuffer,
+		const size_t sourceOffsetInBytes,
+		const size_t destinationOffsetInBytes,
+		const size_t sizeInBytes
+) {
+	if (!isRecording_) {
+		return;
+	}
+	const CopyRecord record{
+			toId(sourceBuffer),
+			toId(destinationBuffer),
+			sourceOffsetInBytes,
+			destinationOffsetInBytes,
+			sizeInBytes
+	};
+	append(static_cast<uint32_t>(RecordType::Copy), &record, sizeof(record));
+}
+
+void CommandRecorder::recordFill(
+		cl_mem buffer,
+		const void *pattern,
+		const size_t patternSizeInBytes,
+		const size_t offsetInBytes,
+		const size_t sizeInBytes
+) {
+	if (!isRecording_) {
+		return;
+	}
+	const FillRecord record{toId(buffer), offsetInBytes, sizeInBytes, patternSizeInBytes};
+	append(static_cast<uint32_t>(RecordType::Fill), &record, sizeof(record), pattern, patternSizeInBytes);
+}
+
+void CommandRecorder::recordLaunch(
+		cl_kernel kernel,
+		const cl_uint numDimensions,
+		const size_t *globalWorkSize,
+		const size_t *localWorkSize,
+		const size_t *globalWorkOffset
+) {
+	if (!isRecording_) {
+		return;
+	}
+	LaunchRecord record{};
+	record.kernel = toId(kernel);
+	record.numDimensions = numDimensions;
+	record.flags = (localWorkSize ? 1 : 0) | (globalWorkOffset ? 2 : 0);
+	copySizes(numDimensions, globalWorkSize, record.globalWorkSize);
+	copySizes(numDimensions, localWorkSize, record.localWorkSize);
+	copySizes(numDimensions, globalWorkOffset, record.globalWorkOffset);
+	append(static_cast<uint32_t>(RecordType::Launch), &record, sizeof(record));
+}
+
+void CommandRecorder::recordFinish() {
+	if (!isRecording_) {
+		return;
+	}
+	append(static_cast<uint32_t>(RecordType::Finish), nullptr, 0);
+}
+
+void CommandRecorder::append(
+		const uint32_t type,
+		const void *body,
+		const size_t bodySizeInBytes,
+		const void *trailer,
+		const size_t trailerSizeInBytes,
+		const void *secondTrailer,
+		const size_t secondTrailerSizeInBytes
+) {
+	const auto timestamp = std::chrono::steady_clock::now();
+	std::lock_guard<std::mutex> lock(mutex_);
+	// the recording may have stopped since the check of the caller
+	if (!isRecording_) {
+		return;
+	}
+	const RecordHeader header{
+			static_cast<RecordType>(type),
+			0,
+			static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp - start_).count()),
+			bodySizeInBytes + trailerSizeInBytes + secondTrailerSizeInBytes
+	};
+	file_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	if (bodySizeInBytes) {
+		file_.write(static_cast<const char *>(body), static_cast<std::streamsize>(bodySizeInBytes));
+	}
+	if (trailerSizeInBytes) {
+		file_.write(static_cast<const char *>(trailer), static_cast<std::streamsize>(trailerSizeInBytes));
+	}
+	if (secondTrailerSizeInBytes) {
+		file_.write(static_cast<const char *>(secondTrailer), static_cast<std::streamsize>(secondTrailerSizeInBytes));
+	}
+}
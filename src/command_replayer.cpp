@@ -0,0 +1,617 @@
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+
+#include "opencl/command_replayer.h"
+#include "opencl/image.h"
+#include "opencl/kernel_library.h"
+#include "opencl/pipe.h"
+#include "opencl/program.h"
+#include "opencl/program_registry.h"
+#include "opencl/read_write_buffer.h"
+#include "opencl/sampler.h"
+#include "command_trace_format.h"
+
+using namespace OpenClToolkit;
+using namespace OpenClToolkit::CommandTraceFormat;
+
+namespace {
+	/**
+	 * @brief A recorded program.
+	 */
+	struct RecordedProgram {
+		/**
+		 * How the program was created.
+		 */
+		ProgramKind kind;
+
+		/**
+		 * The build options.
+		 */
+		std::string buildOptions;
+
+		/**
+		 * The source or module.
+		 */
+		std::string data;
+
+		/**
+		 * The kernel library the source is linked against, nullptr if the program is built by itself.
+		 */
+		KernelLibrary *library;
+
+		/**
+		 * The linked program once a kernel was created from it, which the further kernels share.
+		 */
+		std::shared_ptr<Program> linked;
+	};
+
+	/**
+	 * @brief A replayed kernel.
+	 */
+	struct ReplayedKernel {
+		/**
+		 * The kernel.
+		 */
+		std::unique_ptr<Program> program;
+
+		/**
+		 * The index of the timing of the kernel in the statistics.
+		 */
+		size_t timingIndex;
+
+		/**
+		 * The samplers of the sampler arguments by argument index.
+		 */
+		std::map<uint32_t, std::unique_ptr<Sampler>> samplers;
+
+		/**
+		 * The indices of the arguments which could not be replayed. The kernel is not launched while there are any.
+		 */
+		std::set<uint32_t> unsupportedArguments;
+	};
+
+	/**
+	 * @brief Reads a struct from the beginning of a record.
+	 * @tparam T the type of the struct.
+	 * @param record the record after its header.
+	 * @return the struct.
+	 */
+	template<typename T>
+	T readRecord(const std::string &record) {
+		if (record.size() < sizeof(T)) {
+			// let it crash
+			throw std::runtime_error("Invalid trace: a record is truncated");
+		}
+		T value;
+		std::memcpy(&value, record.data(), sizeof(T));
+		return value;
+	}
+
+	/**
+	 * @brief Returns the trailing bytes of a record.
+	 * @param record the record after its header.
+	 * @param offset the offset of the trailing bytes.
+	 * @param length the number of trailing bytes.
+	 * @return the trailing bytes.
+	 */
+	std::string readTrailer(const std::string &record, const size_t offset, const uint64_t length) {
+		if (offset > record.size() || length > record.size() - offset) {
+			// let it crash
+			throw std::runtime_error("Invalid trace: a record is truncated");
+		}
+		return record.substr(offset, length);
+	}
+
+	/**
+	 * @brief Converts recorded sizes.
+	 * @param numDimensions the number of dimensions.
+	 * @param sizes the recorded sizes.
+	 * @return the sizes.
+	 */
+	NDRange toNDRange(const uint32_t numDimensions, const uint64_t sizes[3]) {
+		switch (numDimensions) {
+			case 1:
+				return {sizes[0]};
+			case 2:
+				return {sizes[0], sizes[1]};
+			case 3:
+				return {sizes[0], sizes[1], sizes[2]};
+			default:
+				// let it crash
+				throw std::runtime_error("Invalid trace: a launch has " + std::to_string(numDimensions) + " dimensions");
+		}
+	}
+}
+
+[[maybe_unused]] CommandReplayer::CommandReplayer(
+		const Context &context,
+		cl_device_id device,
+		CommandQueue &commandQueue
+) : context_(context),
+	device_(device),
+	commandQueue_(commandQueue) {}
+
+[[maybe_unused]] ReplayStatistics CommandReplayer::replay(const std::string &path, const bool isAwaitingEachLaunch) {
+	std::ifstream file(path, std::ios::binary);
+	FileHeader fileHeader{};
+	if (!file.read(reinterpret_cast<char *>(&fileHeader), sizeof(fileHeader)) ||
+		std::memcmp(fileHeader.magic, magic, sizeof(magic)) != 0 || fileHeader.version != version) {
+		// let it crash
+		throw std::runtime_error("Failed to replay " + path + ": no trace of version " + std::to_string(version));
+	}
+
+	ReplayStatistics statistics{};
+	std::map<uint64_t, std::unique_ptr<ReadWriteBuffer>> buffers;
+	std::map<uint64_t, std::unique_ptr<Image>> images;
+	std::map<std::string, std::unique_ptr<KernelLibrary>> libraries;
+	std::map<uint64_t, RecordedProgram> programs;
+	std::map<uint64_t, ReplayedKernel> kernels;
+	std::map<uint64_t, std::unique_ptr<Pipe>> pipes;
+	std::map<std::string, size_t> timingIndices;
+	std::vector<unsigned char> hostMemory;
+	double buildSeconds = 0;
+
+	using Clock = std::chrono::steady_clock;
+	const auto start = Clock::now();
+	RecordHeader header{};
+	std::string record;
+	while (file.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+		record.resize(header.sizeInBytes);
+		if (!file.read(record.data(), static_cast<std::streamsize>(record.size()))) {
+			// let it crash
+			throw std::runtime_error("Failed to replay " + path + ": the last record is truncated");
+		}
+		++statistics.numRecords;
+
+		const auto findBuffer = [&buffers](const uint64_t id) -> ReadWriteBuffer * {
+			const auto iterator = buffers.find(id);
+			return iterator == buffers.end() ? nullptr : iterator->second.get();
+		};
+		const auto findImage = [&images](const uint64_t id) -> Image * {
+			const auto iterator = images.find(id);
+			return iterator == images.end() ? nullptr : iterator->second.get();
+		};
+		const auto findKernel = [&kernels](const uint64_t id) -> ReplayedKernel * {
+			const auto iterator = kernels.find(id);
+			return iterator == kernels.end() ? nullptr : &iterator->second;
+		};
+		const auto prepareHostMemory = [&hostMemory](const uint64_t sizeInBytes) {
+			if (hostMemory.size() < sizeInBytes) {
+				hostMemory.resize(sizeInBytes);
+			}
+		};
+
+		bool isSkipped = false;
+		switch (header.type) {
+			case RecordType::Allocation: {
+				const auto allocation = readRecord<AllocationRecord>(record);
+				buffers[allocation.buffer] = std::make_unique<ReadWriteBuffer>(context_, allocation.sizeInBytes);
+				break;
+			}
+			case RecordType::ImageAllocation: {
+				const auto allocation = readRecord<ImageAllocationRecord>(record);
+				images.erase(allocation.image);
+				try {
+					images[allocation.image] = std::make_unique<Image>(
+							context_,
+							cl_image_format{allocation.channelOrder, allocation.channelDataType},
+							toNDRange(allocation.numDimensions, allocation.size),
+							allocation.flags
+					);
+				} catch (const std::exception &exception) {
+					std::cerr << "Skipping image: " << exception.what() << std::endl;
+					isSkipped = true;
+				}
+				break;
+			}
+			case RecordType::Release: {
+				const uint64_t memoryObject = readRecord<ReleaseRecord>(record).buffer;
+				buffers.erase(memoryObject);
+				images.erase(memoryObject);
+				break;
+			}
+			case RecordType::Program: {
+				const auto program = readRecord<ProgramRecord>(record);
+				programs[program.program] = RecordedProgram{
+						program.kind,
+						readTrailer(record, sizeof(ProgramRecord), program.buildOptionsLength),
+						readTrailer(record, sizeof(ProgramRecord) + program.buildOptionsLength, program.dataLength),
+						nullptr,
+						nullptr
+				};
+				break;
+			}
+			case RecordType::LinkedProgram: {
+				const auto linked = readRecord<LinkedProgramRecord>(record);
+				size_t offset = sizeof(LinkedProgramRecord);
+				const auto readNext = [&record, &offset](const uint64_t length) {
+					std::string value = readTrailer(record, offset, length);
+					offset += length;
+					return value;
+				};
+				std::vector<KernelHeader> headers;
+				for (uint64_t i = 0; i < linked.numHeaders; ++i) {
+					const auto header = readRecord<KernelHeaderRecord>(readNext(sizeof(KernelHeaderRecord)));
+					std::string name = readNext(header.nameLength);
+					headers.push_back({std::move(name), readNext(header.sourceLength)});
+				}
+				const std::string libraryCompileOptions = readNext(linked.libraryCompileOptionsLength);
+				const std::string librarySourceCode = readNext(linked.librarySourceLength);
+				// programs linked against the same library share its compiled object, as during the recording
+				std::unique_ptr<KernelLibrary> &library = libraries[record.substr(
+						sizeof(LinkedProgramRecord),
+						offset - sizeof(LinkedProgramRecord)
+				)];
+				std::string buildOptions = readNext(linked.buildOptionsLength);
+				std::string sourceCode = readNext(linked.sourceLength);
+				programs.erase(linked.program);
+				try {
+					if (!library) {
+						library = std::make_unique<KernelLibrary>(
+								context_,
+								headers,
+								librarySourceCode,
+								libraryCompileOptions
+						);
+					}
+					programs[linked.program] = RecordedProgram{
+							ProgramKind::Source,
+							std::move(buildOptions),
+							std::move(sourceCode),
+							library.get(),
+							nullptr
+					};
+				} catch (const std::exception &exception) {
+					std::cerr << "Skipping kernel library: " << exception.what() << std::endl;
+					isSkipped = true;
+				}
+				break;
+			}
+			case RecordType::Kernel: {
+				const auto kernel = readRecord<KernelRecord>(record);
+				const std::string kernelName = readTrailer(record, sizeof(KernelRecord), kernel.nameLength);
+				kernels.erase(kernel.kernel);
+				const auto program = programs.find(kernel.program);
+				if (program == programs.end()) {
+					isSkipped = true;
+					break;
+				}
+				const auto buildStart = Clock::now();
+				try {
+					std::unique_ptr<Program> replayed;
+					if (program->second.library) {
+						if (!program->second.linked) {
+							program->second.linked = std::make_shared<Program>(
+									program->second.data.c_str(),
+									kernelName,
+									*program->second.library,
+									context_,
+									device_,
+									program->second.buildOptions
+							);
+						}
+						replayed = std::make_unique<Program>(*program->second.linked, kernelName);
+					} else if (program->second.kind == ProgramKind::IntermediateLanguage) {
+						replayed = std::make_unique<Program>(
+								program->second.data.data(),
+								program->second.data.size(),
+								kernelName,
+								context_,
+								device_,
+								program->second.buildOptions
+						);
+					} else {
+						const auto built = ProgramRegistry::getInstance().acquire(
+								program->second.data,
+								kernelName,
+								context_,
+								device_,
+								program->second.buildOptions
+						);
+						replayed = std::make_unique<Program>(*built, kernelName);
+					}
+					auto timing = timingIndices.find(kernelName);
+					if (timing == timingIndices.end()) {
+						timing = timingIndices.emplace(kernelName, statistics.kernels.size()).first;
+						statistics.kernels.push_back({kernelName, 0, 0});
+					}
+					kernels[kernel.kernel] = ReplayedKernel{std::move(replayed), timing->second, {}, {}};
+				} catch (const std::exception &exception) {
+					std::cerr << "Skipping kernel " << kernelName << ": " << exception.what() << std::endl;
+					isSkipped = true;
+				}
+				buildSeconds += std::chrono::duration<double>(Clock::now() - buildStart).count();
+				break;
+			}
+			case RecordType::KernelArgument: {
+				const auto argument = readRecord<KernelArgumentRecord>(record);
+				ReplayedKernel *kernel = findKernel(argument.kernel);
+				if (!kernel) {
+					isSkipped = true;
+					break;
+				}
+				try {
+					switch (argument.kind) {
+						case ArgumentKind::Value: {
+							const std::string value = readTrailer(
+									record,
+									sizeof(KernelArgumentRecord),
+									argument.sizeInBytes
+							);
+							kernel->program->setKernelArg(
+									argument.index,
+									argument.sizeInBytes,
+									static_cast<const void *>(value.data())
+							);
+							break;
+						}
+						case ArgumentKind::Local:
+							kernel->program->setKernelArg(
+									argument.index,
+									argument.sizeInBytes,
+									static_cast<const void *>(nullptr)
+							);
+							break;
+						case ArgumentKind::Buffer: {
+							ReadWriteBuffer *buffer = findBuffer(argument.buffer);
+							Image *image = findImage(argument.buffer);
+							if (buffer) {
+								kernel->program->setKernelArg(argument.index, sizeof(cl_mem), *buffer);
+							} else if (image) {
+								kernel->program->setKernelArg(argument.index, sizeof(cl_mem), *image);
+							} else {
+								isSkipped = true;
+							}
+							break;
+						}
+						case ArgumentKind::Sampler: {
+							const auto sampling = readRecord<SamplerArgument>(
+									readTrailer(record, sizeof(KernelArgumentRecord), sizeof(SamplerArgument))
+							);
+							auto sampler = std::make_unique<Sampler>(
+									context_,
+									sampling.isNormalizedCoordinates != 0,
+									sampling.addressingMode,
+									sampling.filterMode
+							);
+							kernel->program->setKernelArg(argument.index, static_cast<cl_sampler>(*sampler));
+							kernel->samplers[argument.index] = std::move(sampler);
+							break;
+						}
+						case ArgumentKind::Pipe: {
+							const auto properties = readRecord<PipeArgument>(
+									readTrailer(record, sizeof(KernelArgumentRecord), sizeof(PipeArgument))
+							);
+							std::unique_ptr<Pipe> &pipe = pipes[argument.buffer];
+							if (!pipe || pipe->getPacketSizeInBytes() != properties.packetSizeInBytes ||
+								pipe->getMaxNumPackets() != properties.maxNumPackets) {
+								pipe = std::make_unique<Pipe>(
+										context_,
+										properties.packetSizeInBytes,
+										properties.maxNumPackets
+								);
+							}
+							kernel->program->setKernelArg(argument.index, *pipe);
+							break;
+						}
+						default:
+							isSkipped = true;
+							break;
+					}
+				} catch (const std::exception &exception) {
+					std::cerr << "Skipping argument " << argument.index << " of kernel "
+							  << statistics.kernels[kernel->timingIndex].kernelName << ": " << exception.what()
+							  << std::endl;
+					isSkipped = true;
+				}
+				if (isSkipped) {
+					kernel->unsupportedArguments.insert(argument.index);
+				} else {
+					kernel->unsupportedArguments.erase(argument.index);
+				}
+				break;
+			}
+			case RecordType::Write: {
+				const auto write = readRecord<WriteRecord>(record);
+				ReadWriteBuffer *buffer = findBuffer(write.buffer);
+				if (!buffer) {
+					isSkipped = true;
+					break;
+				}
+				const void *source;
+				std::string payload;
+				if (write.hasPayload) {
+					payload = readTrailer(record, sizeof(WriteRecord), write.sizeInBytes);
+					source = payload.data();
+				} else {
+					prepareHostMemory(write.sizeInBytes);
+					source = hostMemory.data();
+				}
+				commandQueue_.enqueueCommandCopyBytesFromHostMemoryIntoDeviceMemory(
+						source,
+						*buffer,
+						write.sizeInBytes,
+						write.offsetInBytes
+				);
+				++statistics.numTransfers;
+				statistics.numTransferredBytes += write.sizeInBytes;
+				break;
+			}
+			case RecordType::Read: {
+				const auto read = readRecord<ReadRecord>(record);
+				ReadWriteBuffer *buffer = findBuffer(read.buffer);
+				if (!buffer) {
+					isSkipped = true;
+					break;
+				}
+				prepareHostMemory(read.sizeInBytes);
+				commandQueue_.enqueueCommandCopyBytesFromDeviceMemoryIntoHostMemory(
+						*buffer,
+						hostMemory.data(),
+						read.sizeInBytes,
+						read.offsetInBytes
+				);
+				// the zeros of writes without payload must stay zeros
+				std::memset(hostMemory.data(), 0, read.sizeInBytes);
+				++statistics.numTransfers;
+				statistics.numTransferredBytes += read.sizeInBytes;
+				break;
+			}
+			case RecordType::ImageWrite: {
+				const auto write = readRecord<ImageTransferRecord>(record);
+				Image *image = findImage(write.image);
+				if (!image) {
+					isSkipped = true;
+					break;
+				}
+				const void *source;
+				std::string payload;
+				if (write.hasPayload) {
+					payload = readTrailer(record, sizeof(ImageTransferRecord), write.sizeInBytes);
+					source = payload.data();
+				} else {
+					prepareHostMemory(write.sizeInBytes);
+					source = hostMemory.data();
+				}
+				const cl_uint numDimensions = image->getSize().numDimensions;
+				commandQueue_.enqueueCommandCopyBytesFromHostMemoryIntoImage(
+						source,
+						*image,
+						toNDRange(numDimensions, write.origin),
+						toNDRange(numDimensions, write.region),
+						write.rowPitchInBytes,
+						write.slicePitchInBytes
+				);
+				++statistics.numTransfers;
+				statistics.numTransferredBytes += write.sizeInBytes;
+				break;
+			}
+			case RecordType::ImageRead: {
+				const auto read = readRecord<ImageTransferRecord>(record);
+				Image *image = findImage(read.image);
+				if (!image) {
+					isSkipped = true;
+					break;
+				}
+				prepareHostMemory(read.sizeInBytes);
+				const cl_uint numDimensions = image->getSize().numDimensions;
+				commandQueue_.enqueueCommandCopyBytesFromImageIntoHostMemory(
+						*image,
+						hostMemory.data(),
+						toNDRange(numDimensions, read.origin),
+						toNDRange(numDimensions, read.region),
+						read.rowPitchInBytes,
+						read.slicePitchInBytes
+				);
+				// the zeros of writes without payload must stay zeros
+				std::memset(hostMemory.data(), 0, read.sizeInBytes);
+				++statistics.numTransfers;
+				statistics.numTransferredBytes += read.sizeInBytes;
+				break;
+			}
+			case RecordType::Copy: {
+				const auto copy = readRecord<CopyRecord>(record);
+				ReadWriteBuffer *source = findBuffer(copy.sourceBuffer);
+				ReadWriteBuffer *destination = findBuffer(copy.destinationBuffer);
+				if (!source || !destination) {
+					isSkipped = true;
+					break;
+				}
+				commandQueue_.enqueueCommandCopyBytesFromDeviceMemoryIntoDeviceMemory(
+						*source,
+						*destination,
+						copy.sizeInBytes,
+						copy.sourceOffsetInBytes,
+						copy.destinationOffsetInBytes
+				);
+				++statistics.numTransfers;
+				statistics.numTransferredBytes += copy.sizeInBytes;
+				break;
+			}
+			case RecordType::Fill: {
+				const auto fill = readRecord<FillRecord>(record);
+				ReadWriteBuffer *buffer = findBuffer(fill.buffer);
+				if (!buffer) {
+					isSkipped = true;
+					break;
+				}
+				const std::string pattern = readTrailer(record, sizeof(FillRecord), fill.patternSizeInBytes);
+				commandQueue_.enqueueCommandFillDeviceMemory(
+						*buffer,
+						pattern.data(),
+						pattern.size(),
+						fill.sizeInBytes,
+						fill.offsetInBytes
+				);
+				++statistics.numTransfers;
+				statistics.numTransferredBytes += fill.sizeInBytes;
+				break;
+			}
+			case RecordType::Launch: {
+				const auto launch = readRecord<LaunchRecord>(record);
+				ReplayedKernel *kernel = findKernel(launch.kernel);
+				if (!kernel || !kernel->unsupportedArguments.empty()) {
+					isSkipped = true;
+					break;
+				}
+				const auto launchStart = Clock::now();
+				const NDRange globalWorkSize = toNDRange(launch.numDimensions, launch.globalWorkSize);
+				const NDRange globalWorkOffset = toNDRange(launch.numDimensions, launch.globalWorkOffset);
+				if (launch.flags & 1) {
+					commandQueue_.enqueueCommandExecuteProgramOnDevice(
+							*kernel->program,
+							globalWorkSize,
+							toNDRange(launch.numDimensions, launch.localWorkSize),
+							launch.flags & 2 ? &globalWorkOffset : nullptr
+					);
+				} else {
+					const cl_int status = clEnqueueNDRangeKernel(
+							commandQueue_,
+							kernel->program->getKernel(),
+							launch.numDimensions,
+							launch.flags & 2 ? globalWorkOffset.sizes : nullptr,
+							globalWorkSize.sizes,
+							nullptr,
+							0,
+							nullptr,
+							nullptr
+					);
+					if (status) {
+						// let it crash
+						throw std::runtime_error("Failed to replay a launch of " +
+												 statistics.kernels[kernel->timingIndex].kernelName);
+					}
+				}
+				if (isAwaitingEachLaunch) {
+					commandQueue_.finish();
+					ReplayKernelTiming &timing = statistics.kernels[kernel->timingIndex];
+					++timing.numLaunches;
+					timing.seconds += std::chrono::duration<double>(Clock::now() - launchStart).count();
+				} else {
+					++statistics.kernels[kernel->timingIndex].numLaunches;
+				}
+				++statistics.numLaunches;
+				break;
+			}
+			case RecordType::Finish:
+				commandQueue_.finish();
+				break;
+			default:
+				// records of newer types are ignored
+				isSkipped = true;
+				break;
+		}
+		if (isSkipped) {
+			++statistics.numSkippedRecords;
+		}
+	}
+	commandQueue_.finish();
+	statistics.seconds = std::chrono::duration<double>(Clock::now() - start).count() - buildSeconds;
+	return statistics;
+}
@@ -0,0 +1,321 @@
+#ifndef OPENCL_TOOLKIT_COMMAND_TRACE_FORMAT_H
+#define OPENCL_TOOLKIT_COMMAND_TRACE_FORMAT_H
+
+#include <cstdint>
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief The binary layout of command traces, written by <code>CommandRecorder</code> and read by
+	 * <code>CommandReplayer</code> on the same kind of host, so the structs are stored in native layout.
+	 * @details A trace starts with a <code>FileHeader</code>, followed by records. Each record consists of a
+	 * <code>RecordHeader</code>, the struct of its type and the trailing bytes announced by that struct. Buffers,
+	 * images, programs and kernels are identified by the values of their OpenCL handles at the time of recording.
+	 */
+	namespace CommandTraceFormat {
+
+		/**
+		 * The first bytes of a trace.
+		 */
+		inline constexpr char magic[8] = {'O', 'C', 'L', 'T', 'R', 'A', 'C', 'E'};
+
+		/**
+		 * The version of the layout.
+		 */
+		inline constexpr uint32_t version = 1;
+
+		/**
+		 * @brief The header of a trace.
+		 */
+		struct FileHeader {
+			char magic[8];
+			uint32_t version;
+			uint32_t reserved;
+		};
+
+		/**
+		 * @brief The types of records.
+		 */
+		enum class RecordType : uint32_t {
+			Allocation = 1,
+			Release = 2,
+			Program = 3,
+			Kernel = 4,
+			KernelArgument = 5,
+			Write = 6,
+			Read = 7,
+			Copy = 8,
+			Fill = 9,
+			Launch = 10,
+			Finish = 11,
+			ImageAllocation = 12,
+			ImageWrite = 13,
+			ImageRead = 14,
+			LinkedProgram = 15
+		};
+
+		/**
+		 * @brief The header of a record.
+		 */
+		struct RecordHeader {
+			RecordType type;
+			uint32_t reserved;
+
+			/**
+			 * The time since the start of the recording in nanoseconds.
+			 */
+			uint64_t timestampInNanoseconds;
+
+			/**
+			 * The size of the record after the header in bytes.
+			 */
+			uint64_t sizeInBytes;
+		};
+
+		/**
+		 * @brief The creation of a buffer.
+		 */
+		struct AllocationRecord {
+			uint64_t buffer;
+			uint64_t flags;
+			uint64_t sizeInBytes;
+		};
+
+		/**
+		 * @brief The creation of an image. Sizes of unused dimensions are 0.
+		 */
+		struct ImageAllocationRecord {
+			uint64_t image;
+			uint64_t flags;
+			uint32_t channelOrder;
+			uint32_t channelDataType;
+			uint32_t numDimensions;
+			uint32_t reserved;
+			uint64_t size[3];
+		};
+
+		/**
+		 * @brief The release of a buffer or image.
+		 */
+		struct ReleaseRecord {
+			uint64_t buffer;
+		};
+
+		/**
+		 * @brief How a program was created.
+		 */
+		enum class ProgramKind : uint32_t {
+			/**
+			 * Built from OpenCL C source.
+			 */
+			Source = 1,
+
+			/**
+			 * Built from an intermediate language module.
+			 */
+			IntermediateLanguage = 2
+		};
+
+		/**
+		 * @brief The creation of a program, followed by the build options and the source or module.
+		 */
+		struct ProgramRecord {
+			uint64_t program;
+			ProgramKind kind;
+			uint32_t reserved;
+			uint64_t buildOptionsLength;
+			uint64_t dataLength;
+		};
+
+		/**
+		 * @brief The creation of a program compiled from OpenCL C source and linked against a kernel library. The
+		 * record is followed by the headers of the library, each as a <code>KernelHeaderRecord</code> followed by the
+		 * name and the source of the header, then by the compile options and the source of the library and finally by
+		 * the build options and the source of the program.
+		 */
+		struct LinkedProgramRecord {
+			uint64_t program;
+			uint64_t numHeaders;
+			uint64_t libraryCompileOptionsLength;
+			uint64_t librarySourceLength;
+			uint64_t buildOptionsLength;
+			uint64_t sourceLength;
+		};
+
+		/**
+		 * @brief A header of a kernel library, followed by its name and source.
+		 */
+		struct KernelHeaderRecord {
+			uint64_t nameLength;
+			uint64_t sourceLength;
+		};
+
+		/**
+		 * @brief The creation of a kernel, followed by its name.
+		 */
+		struct KernelRecord {
+			uint64_t kernel;
+			uint64_t program;
+			uint64_t nameLength;
+		};
+
+		/**
+		 * @brief The kinds of kernel arguments.
+		 */
+		enum class ArgumentKind : uint32_t {
+			/**
+			 * A value, stored after the record.
+			 */
+			Value = 1,
+
+			/**
+			 * Local memory of the recorded size.
+			 */
+			Local = 2,
+
+			/**
+			 * A buffer.
+			 */
+			Buffer = 3,
+
+			/**
+			 * A sampler, whose <code>SamplerArgument</code> is stored after the record.
+			 */
+			Sampler = 4,
+
+			/**
+			 * A pipe, whose <code>PipeArgument</code> is stored after the record.
+			 */
+			Pipe = 5,
+
+			/**
+			 * An argument which is not part of the trace, e.g. a pointer to shared virtual memory. Launches of the
+			 * kernel are skipped until the argument is set again.
+			 */
+			Unsupported = 6
+		};
+
+		/**
+		 * The index of <code>Unsupported</code> arguments which stand for the execution info of a kernel, e.g. shared
+		 * virtual memory accessed indirectly.
+		 */
+		inline constexpr uint32_t executionInfoIndex = UINT32_MAX;
+
+		/**
+		 * @brief The setting of a kernel argument, followed by the value of <code>Value</code> arguments. The buffer
+		 * holds the id of <code>Buffer</code> and <code>Pipe</code> arguments.
+		 */
+		struct KernelArgumentRecord {
+			uint64_t kernel;
+			uint32_t index;
+			ArgumentKind kind;
+			uint64_t sizeInBytes;
+			uint64_t buffer;
+		};
+
+		/**
+		 * @brief The properties of a sampler argument.
+		 */
+		struct SamplerArgument {
+			uint32_t isNormalizedCoordinates;
+			uint32_t addressingMode;
+			uint32_t filterMode;
+			uint32_t reserved;
+		};
+
+		/**
+		 * @brief The properties of a pipe argument.
+		 */
+		struct PipeArgument {
+			uint32_t packetSizeInBytes;
+			uint32_t maxNumPackets;
+		};
+
+		/**
+		 * @brief A copy from host into device memory, followed by the payload if recorded.
+		 */
+		struct WriteRecord {
+			uint64_t buffer;
+			uint64_t offsetInBytes;
+			uint64_t sizeInBytes;
+			uint64_t hasPayload;
+		};
+
+		/**
+		 * @brief A copy from device into host memory.
+		 */
+		struct ReadRecord {
+			uint64_t buffer;
+			uint64_t offsetInBytes;
+			uint64_t sizeInBytes;
+		};
+
+		/**
+		 * @brief A copy between host memory and a region of an image, followed by the payload of writes if recorded.
+		 * Unused dimensions have an origin of 0 and a region of 1.
+		 */
+		struct ImageTransferRecord {
+			uint64_t image;
+			uint64_t origin[3];
+			uint64_t region[3];
+
+			/**
+			 * The distance of the rows in host memory as passed, 0 for tightly packed rows.
+			 */
+			uint64_t rowPitchInBytes;
+
+			/**
+			 * The distance of the slices in host memory as passed, 0 for tightly packed slices.
+			 */
+			uint64_t slicePitchInBytes;
+
+			/**
+			 * The size of the host memory spanned by the copy.
+			 */
+			uint64_t sizeInBytes;
+			uint64_t hasPayload;
+		};
+
+		/**
+		 * @brief A copy between buffers.
+		 */
+		struct CopyRecord {
+			uint64_t sourceBuffer;
+			uint64_t destinationBuffer;
+			uint64_t sourceOffsetInBytes;
+			uint64_t destinationOffsetInBytes;
+			uint64_t sizeInBytes;
+		};
+
+		/**
+		 * @brief The filling of a buffer, followed by the pattern.
+		 */
+		struct FillRecord {
+			uint64_t buffer;
+			uint64_t offsetInBytes;
+			uint64_t sizeInBytes;
+			uint64_t patternSizeInBytes;
+		};
+
+		/**
+		 * @brief A kernel launch. Sizes of unused dimensions are 0.
+		 */
+		struct LaunchRecord {
+			uint64_t kernel;
+			uint32_t numDimensions;
+
+			/**
+			 * Bit 0 if the local work size was passed, bit 1 if the global work offset was passed.
+			 */
+			uint32_t flags;
+			uint64_t globalWorkSize[3];
+			uint64_t localWorkSize[3];
+			uint64_t globalWorkOffset[3];
+		};
+	}
+}
+
+#endif //OPENCL_TOOLKIT_COMMAND_TRACE_FORMAT_H
@@ -5,12 +5,14 @@
 
 using namespace OpenClToolkit;
 
-[[maybe_unused]] Context::Context(cl_device_id device) {
+[[maybe_unused]] Context::Context(cl_device_id device) : Context(std::vector<cl_device_id>{device}) {}
+
+[[maybe_unused]] Context::Context(const std::vector<cl_device_id> &devices) : devices_(devices) {
 	cl_int status;
 	self_ = clCreateContext(
 			nullptr,
-			1,
-			&device,
+			static_cast<cl_uint>(devices_.size()),
+			devices_.data(),
 			nullptr,
 			nullptr,
 			&status
@@ -28,6 +30,10 @@ Context::~Context() {
 	}
 }
 
+[[maybe_unused]] const std::vector<cl_device_id> &Context::getDevices() const {
+	return devices_;
+}
+
 Context::operator cl_context() const {
 	return self_;
 }
@@ -0,0 +1,160 @@
+#include <stdexcept>
+
+#include "opencl/converting_uploader.h"
+#include "double_buffered_staging.h"
+
+using namespace OpenClToolkit;
+
+[[maybe_unused]] ConvertingUploader::ConvertingUploader(
+		const Context &context,
+		CommandQueue &commandQueue,
+		const LayoutConverter converter,
+		const size_t chunkSizeInBytes
+) : commandQueue_(commandQueue), converter_(converter) {
+	if (chunkSizeInBytes < sizeof(cl_float)) {
+		// let it crash
+		throw std::runtime_error("Failed to create converting uploader: the chunk size is too small");
+	}
+	staging_ = std::make_unique<DoubleBufferedStaging>(context, commandQueue_, chunkSizeInBytes);
+}
+
+// the staging is an incomplete type in the header
+ConvertingUploader::~ConvertingUploader() = default;
+
+[[maybe_unused]] void ConvertingUploader::uploadRecordsAsFieldArrays(
+		const void *records,
+		const size_t numRecords,
+		const size_t recordSizeInBytes,
+		const std::vector<const BaseBuffer *> &fieldBuffers,
+		const size_t destinationOffsetInRecords
+) {
+	const size_t numFields = fieldBuffers.size();
+	std::vector<void *> fieldArrays(numFields);
+	upload(
+			numRecords,
+			numFields * sizeof(cl_uint),
+			[&](const size_t first, const size_t count, char *stagingMemory, std::vector<Event> &copies) {
+				// each field occupies a contiguous part of the staging buffer
+				for (size_t field = 0; field < numFields; ++field) {
+					fieldArrays[field] = stagingMemory + field * count * sizeof(cl_uint);
+				}
+				converter_.transposeRecordsToFieldArrays(
+						static_cast<const char *>(records) + first * recordSizeInBytes,
+						count,
+						recordSizeInBytes,
+						numFields,
+						fieldArrays.data()
+				);
+				for (size_t field = 0; field < numFields; ++field) {
+					copies.push_back(commandQueue_.enqueueCommandCopyBytesFromHostMemoryIntoDeviceMemoryAsync(
+							fieldArrays[field],
+							*fieldBuffers[field],
+							count * sizeof(cl_uint),
+							(destinationOffsetInRecords + first) * sizeof(cl_uint)
+					));
+				}
+			}
+	);
+}
+
+[[maybe_unused]] void ConvertingUploader::uploadFloatsAsHalves(
+		const cl_float *source,
+		const size_t numElements,
+		const BaseBuffer &destinationDeviceMemory,
+		const size_t destinationOffsetInElements
+) {
+	upload(
+			numElements,
+			sizeof(cl_half),
+			[&](const size_t first, const size_t count, char *stagingMemory, std::vector<Event> &copies) {
+				converter_.convertFloatsToHalves(source + first, reinterpret_cast<cl_half *>(stagingMemory), count);
+				copies.push_back(commandQueue_.enqueueCommandCopyBytesFromHostMemoryIntoDeviceMemoryAsync(
+						stagingMemory,
+						destinationDeviceMemory,
+						count * sizeof(cl_half),
+						(destinationOffsetInElements + first) * sizeof(cl_half)
+				));
+			}
+	);
+}
+
+[[maybe_unused]] void ConvertingUploader::uploadIntegersAsShorts(
+		const cl_int *source,
+		const size_t numElements,
+		const BaseBuffer &destinationDeviceMemory,
+		const size_t destinationOffsetInElements
+) {
+	upload(
+			numElements,
+			sizeof(cl_short),
+			[&](const size_t first, const size_t count, char *stagingMemory, std::vector<Event> &copies) {
+				converter_.narrowIntegers(source + first, reinterpret_cast<cl_short *>(stagingMemory), count);
+				copies.push_back(commandQueue_.enqueueCommandCopyBytesFromHostMemoryIntoDeviceMemoryAsync(
+						stagingMemory,
+						destinationDeviceMemory,
+						count * sizeof(cl_short),
+						(destinationOffsetInElements + first) * sizeof(cl_short)
+				));
+			}
+	);
+}
+
+[[maybe_unused]] void ConvertingUploader::uploadIntegersAsChars(
+		const cl_int *source,
+		const size_t numElements,
+		const BaseBuffer &destinationDeviceMemory,
+		const size_t destinationOffsetInElements
+) {
+	upload(
+			numElements,
+			sizeof(cl_char),
+			[&](const size_t first, const size_t count, char *stagingMemory, std::vector<Event> &copies) {
+				converter_.narrowIntegers(source + first, reinterpret_cast<cl_char *>(stagingMemory), count);
+				copies.push_back(commandQueue_.enqueueCommandCopyBytesFromHostMemoryIntoDeviceMemoryAsync(
+						stagingMemory,
+						destinationDeviceMemory,
+						count * sizeof(cl_char),
+						(destinationOffsetInElements + first) * sizeof(cl_char)
+				));
+			}
+	);
+}
+
+[[maybe_unused]] void ConvertingUploader::downloadHalvesAsFloats(
+		const BaseBuffer &sourceDeviceMemory,
+		cl_float *destination,
+		const size_t numElements,
+		const size_t sourceOffsetInElements
+) {
+	const size_t chunkSizeInBytes = staging_->getChunkSizeInBytes() / sizeof(cl_half) * sizeof(cl_half);
+	staging_->download(
+			sourceDeviceMemory,
+			numElements * sizeof(cl_half),
+			sourceOffsetInElements * sizeof(cl_half),
+			chunkSizeInBytes,
+			[&](const size_t firstByte, const size_t numBytes, const char *stagingMemory) {
+				converter_.convertHalvesToFloats(
+						reinterpret_cast<const cl_half *>(stagingMemory),
+						destination + firstByte / sizeof(cl_half),
+						numBytes / sizeof(cl_half)
+				);
+			}
+	);
+}
+
+[[maybe_unused]] const LayoutConverter &ConvertingUploader::getConverter() const {
+	return converter_;
+}
+
+void ConvertingUploader::upload(
+		const size_t numElements,
+		const size_t stagedBytesPerElement,
+		const std::function<void(size_t, size_t, char *, std::vector<Event> &)> &convertAndCopy
+) {
+	const size_t chunkSize = stagedBytesPerElement ? staging_->getChunkSizeInBytes() / stagedBytesPerElement : 0;
+	if (!chunkSize) {
+		// let it crash
+		throw std::runtime_error("Failed to upload: an element does not fit into the staging buffer");
+	}
+	staging_->upload(numElements, chunkSize, convertAndCopy);
+}
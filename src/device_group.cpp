@@ -0,0 +1,61 @@
+#include <stdexcept>
+
+#include "opencl/device_group.h"
+
+using namespace OpenClToolkit;
+
+[[maybe_unused]] DeviceGroup::DeviceGroup(const std::vector<cl_device_id> &devices) : context_(devices) {
+	commandQueues_.reserve(devices.size());
+	for (const cl_device_id device: devices) {
+		commandQueues_.push_back(std::make_unique<CommandQueue>(context_, device));
+	}
+}
+
+[[maybe_unused]] const Context &DeviceGroup::getContext() const {
+	return context_;
+}
+
+[[maybe_unused]] size_t DeviceGroup::getNumDevices() const {
+	return commandQueues_.size();
+}
+
+[[maybe_unused]] cl_device_id DeviceGroup::getDevice(const size_t deviceIndex) const {
+	return context_.getDevices().at(deviceIndex);
+}
+
+[[maybe_unused]] CommandQueue &DeviceGroup::getCommandQueue(const size_t deviceIndex) const {
+	return *commandQueues_.at(deviceIndex);
+}
+
+[[maybe_unused]] void DeviceGroup::migrate(
+		const std::vector<cl_mem> &memoryObjects,
+		const size_t deviceIndex,
+		const bool isContentUndefined
+) {
+	getCommandQueue(deviceIndex).enqueueCommandMigrateMemoryObjects(
+			memoryObjects,
+			isContentUndefined ? CL_MIGRATE_MEM_OBJECT_CONTENT_UNDEFINED : 0
+	);
+}
+
+[[maybe_unused]] void DeviceGroup::handOff(
+		const std::vector<cl_mem> &memoryObjects,
+		const size_t sourceDeviceIndex,
+		const size_t destinationDeviceIndex
+) {
+	if (sourceDeviceIndex == destinationDeviceIndex) {
+		// the queue is in order, so the consumer sees the content anyway
+		return;
+	}
+	getCommandQueue(destinationDeviceIndex).enqueueCommandMigrateMemoryObjects(
+			memoryObjects,
+			0,
+			&getCommandQueue(sourceDeviceIndex)
+	);
+}
+
+[[maybe_unused]] void DeviceGroup::finish() {
+	for (const auto &commandQueue: commandQueues_) {
+		commandQueue->finish();
+	}
+}
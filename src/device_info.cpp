@@ -0,0 +1,159 @@
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+#include "opencl/device_info.h"
+#include "opencl/context.h"
+#include "opencl/error.h"
+#include "device_query.h"
+
+using namespace OpenClToolkit;
+
+namespace {
+	template<typename T>
+	T queryDeviceValue(cl_device_id device, const cl_device_info parameter) {
+		T value{};
+		const cl_int status = clGetDeviceInfo(device, parameter, sizeof(T), &value, nullptr);
+		if (status) {
+			// let it crash
+			throw std::runtime_error("Cannot query device info: " + toErrorDescription(status));
+		}
+		return value;
+	}
+
+	/**
+	 * @brief Queries the image formats supported by the devices of the passed context.
+	 * @param context a valid context.
+	 * @param imageType the image type.
+	 * @return the supported image formats.
+	 */
+	std::vector<cl_image_format> querySupportedImageFormats(const Context &context, const cl_mem_object_type imageType) {
+		cl_uint numFormats = 0;
+		cl_int status = clGetSupportedImageFormats(context, CL_MEM_READ_WRITE, imageType, 0, nullptr, &numFormats);
+		std::vector<cl_image_format> formats(numFormats);
+		if (!status && numFormats) {
+			status = clGetSupportedImageFormats(
+					context,
+					CL_MEM_READ_WRITE,
+					imageType,
+					numFormats,
+					formats.data(),
+					nullptr
+			);
+		}
+		if (status) {
+			// let it crash
+			throw std::runtime_error("Cannot query the supported image formats: " + toErrorDescription(status));
+		}
+		return formats;
+	}
+}
+
+DeviceInfo::DeviceInfo(cl_device_id device) :
+		name(queryDeviceString(device, CL_DEVICE_NAME)),
+		vendor(queryDeviceString(device, CL_DEVICE_VENDOR)),
+		version(queryDeviceString(device, CL_DEVICE_VERSION)),
+		driverVersion(queryDeviceString(device, CL_DRIVER_VERSION)),
+		extensions(queryDeviceString(device, CL_DEVICE_EXTENSIONS)),
+		type(queryDeviceValue<cl_device_type>(device, CL_DEVICE_TYPE)),
+		maxComputeUnits(queryDeviceValue<cl_uint>(device, CL_DEVICE_MAX_COMPUTE_UNITS)),
+		maxWorkGroupSize(queryDeviceValue<size_t>(device, CL_DEVICE_MAX_WORK_GROUP_SIZE)),
+		globalMemorySize(queryDeviceValue<cl_ulong>(device, CL_DEVICE_GLOBAL_MEM_SIZE)),
+		maxMemoryAllocationSize(queryDeviceValue<cl_ulong>(device, CL_DEVICE_MAX_MEM_ALLOC_SIZE)),
+		localMemorySize(queryDeviceValue<cl_ulong>(device, CL_DEVICE_LOCAL_MEM_SIZE)),
+		hasDedicatedLocalMemory(queryDeviceValue<cl_uint>(device, CL_DEVICE_LOCAL_MEM_TYPE) == CL_LOCAL),
+		globalMemoryCacheLineSize(queryDeviceValue<cl_uint>(device, CL_DEVICE_GLOBAL_MEM_CACHELINE_SIZE)),
+		preferredVectorWidthFloat(queryDeviceValue<cl_uint>(device, CL_DEVICE_PREFERRED_VECTOR_WIDTH_FLOAT)),
+		hasImageSupport(queryDeviceValue<cl_bool>(device, CL_DEVICE_IMAGE_SUPPORT)),
+		maxImage2DWidth(hasImageSupport ? queryDeviceValue<size_t>(device, CL_DEVICE_IMAGE2D_MAX_WIDTH) : 0),
+		maxImage2DHeight(hasImageSupport ? queryDeviceValue<size_t>(device, CL_DEVICE_IMAGE2D_MAX_HEIGHT) : 0),
+		maxImage3DWidth(hasImageSupport ? queryDeviceValue<size_t>(device, CL_DEVICE_IMAGE3D_MAX_WIDTH) : 0),
+		maxImage3DHeight(hasImageSupport ? queryDeviceValue<size_t>(device, CL_DEVICE_IMAGE3D_MAX_HEIGHT) : 0),
+		maxImage3DDepth(hasImageSupport ? queryDeviceValue<size_t>(device, CL_DEVICE_IMAGE3D_MAX_DEPTH) : 0),
+		svmCapabilities(0),
+		hasPipeSupport(false),
+		maxPipePacketSize(0) {
+	const auto numDimensions = queryDeviceValue<cl_uint>(device, CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS);
+	maxWorkItemSizes.resize(numDimensions);
+	const cl_int status = clGetDeviceInfo(
+			device,
+			CL_DEVICE_MAX_WORK_ITEM_SIZES,
+			numDimensions * sizeof(size_t),
+			maxWorkItemSizes.data(),
+			nullptr
+	);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Cannot query the max work item sizes: " + toErrorDescription(status));
+	}
+
+	// devices before OpenCL 2.0 reject the query
+	if (clGetDeviceInfo(device, CL_DEVICE_SVM_CAPABILITIES, sizeof(svmCapabilities), &svmCapabilities, nullptr)) {
+		svmCapabilities = 0;
+	}
+
+	// devices of OpenCL 2.x support pipes but reject the query, which came with OpenCL 3.0
+	cl_bool pipeSupport = CL_FALSE;
+	if (clGetDeviceInfo(device, CL_DEVICE_PIPE_SUPPORT, sizeof(pipeSupport), &pipeSupport, nullptr)) {
+		pipeSupport = version.rfind("OpenCL 2.", 0) == 0;
+	}
+	hasPipeSupport = pipeSupport;
+	if (hasPipeSupport && clGetDeviceInfo(
+			device,
+			CL_DEVICE_PIPE_MAX_PACKET_SIZE,
+			sizeof(maxPipePacketSize),
+			&maxPipePacketSize,
+			nullptr
+	)) {
+		maxPipePacketSize = 0;
+	}
+
+	if (hasImageSupport) {
+		// the formats are a property of contexts, a context of the device alone yields the formats of the device
+		const Context context(device);
+		supportedImageFormats2D = querySupportedImageFormats(context, CL_MEM_OBJECT_IMAGE2D);
+		supportedImageFormats3D = querySupportedImageFormats(context, CL_MEM_OBJECT_IMAGE3D);
+	}
+}
+
+[[maybe_unused]] const DeviceInfo &DeviceInfo::get(cl_device_id device) {
+	static std::mutex mutex;
+	static std::map<cl_device_id, std::unique_ptr<DeviceInfo>> cache;
+	std::lock_guard<std::mutex> lock(mutex);
+	auto &info = cache[device];
+	if (!info) {
+		info.reset(new DeviceInfo(device));
+	}
+	return *info;
+}
+
+[[maybe_unused]] bool DeviceInfo::hasExtension(const std::string &extension) const {
+	std::istringstream stream(extensions);
+	std::string token;
+	while (stream >> token) {
+		if (token == extension) {
+			return true;
+		}
+	}
+	return false;
+}
+
+[[maybe_unused]] bool DeviceInfo::isCpu() const {
+	return type & CL_DEVICE_TYPE_CPU;
+}
+
+[[maybe_unused]] bool DeviceInfo::isImageFormatSupported(
+		const cl_image_format &format,
+		const cl_mem_object_type imageType
+) const {
+	const auto &formats = imageType == CL_MEM_OBJECT_IMAGE3D ? supportedImageFormats3D : supportedImageFormats2D;
+	for (const auto &supportedFormat: formats) {
+		if (supportedFormat.image_channel_order == format.image_channel_order &&
+			supportedFormat.image_channel_data_type == format.image_channel_data_type) {
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,34 @@
+#ifndef OPENCL_TOOLKIT_DEVICE_QUERY_H
+#define OPENCL_TOOLKIT_DEVICE_QUERY_H
+
+#include <string>
+
+#include "opencl/portable_opencl_include.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Queries a string-valued device info, e.g. <code>CL_DEVICE_NAME</code>.
+	 * @param device the device to be queried.
+	 * @param parameter the device info to be queried.
+	 * @return the queried value or an empty string if the query failed.
+	 */
+	inline std::string queryDeviceString(cl_device_id device, cl_device_info parameter) {
+		size_t size = 0;
+		if (clGetDeviceInfo(device, parameter, 0, nullptr, &size) || !size) {
+			return "";
+		}
+		std::string value(size, '\0');
+		if (clGetDeviceInfo(device, parameter, size, value.data(), nullptr)) {
+			return "";
+		}
+		// drop the terminating null character
+		value.resize(size - 1);
+		return value;
+	}
+}
+
+#endif //OPENCL_TOOLKIT_DEVICE_QUERY_H
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "opencl/device_sparse_matrix.h"
+#include "opencl/program_registry.h"
+#include "spmv_kernels.h"
+#include "work_group_size.h"
+
+using namespace OpenClToolkit;
+
+namespace {
+	/**
+	 * The largest number of work items per row of the CSR vector kernel.
+	 */
+	constexpr size_t maxVectorSize = 32;
+
+	/**
+	 * @brief Copies the passed host array into a new device buffer.
+	 * @param context the context of the buffer.
+	 * @param commandQueue the command queue which copies the array.
+	 * @param array the array to be copied.
+	 * @return the device buffer, at least one element large so empty arrays yield valid kernel arguments.
+	 */
+	template<typename T>
+	std::unique_ptr<ReadWriteBuffer> upload(
+			const Context &context,
+			CommandQueue &commandQueue,
+			const std::vector<T> &array
+	) {
+		auto buffer = std::make_unique<ReadWriteBuffer>(context, std::max<size_t>(array.size(), 1) * sizeof(T));
+		if (!array.empty()) {
+			commandQueue.enqueueCommandCopyBytesFromHostMemoryIntoDeviceMemory(
+					array.data(),
+					*buffer,
+					array.size() * sizeof(T)
+			);
+		}
+		return buffer;
+	}
+}
+
+[[maybe_unused]] DeviceSparseMatrix::DeviceSparseMatrix(
+		const Context &context,
+		cl_device_id device,
+		CommandQueue &commandQueue,
+		const CsrMatrix &matrix,
+		const SparseFormat format
+) : commandQueue_(commandQueue),
+	format_(format),
+	numRows_(matrix.numRows),
+	numColumns_(matrix.numColumns),
+	vectorSize_(1),
+	workGroupSize_(1) {
+	if (matrix.numRows >= (size_t(1) << 32)) {
+		// let it crash
+		throw std::runtime_error("Cannot create sparse matrix: at most 2^32 - 1 rows are supported");
+	}
+	const RowLengthStatistics statistics = computeRowLengthStatistics(matrix);
+	if (format_ == SparseFormat::Automatic) {
+		format_ = chooseSparseFormat(statistics);
+	}
+
+	std::string kernelName;
+	std::string buildOptions;
+	if (format_ == SparseFormat::SlicedEll) {
+		const SlicedEllMatrix slicedEll = toSlicedEll(matrix, defaultSliceHeight);
+		offsets_ = upload(context, commandQueue, slicedEll.sliceOffsets);
+		rowLengths_ = upload(context, commandQueue, slicedEll.rowLengths);
+		columnIndices_ = upload(context, commandQueue, slicedEll.columnIndices);
+		values_ = upload(context, commandQueue, slicedEll.values);
+		kernelName = "slicedEll";
+		buildOptions = "-DSLICE_HEIGHT=" + std::to_string(defaultSliceHeight);
+	} else {
+		offsets_ = upload(context, commandQueue, matrix.rowOffsets);
+		columnIndices_ = upload(context, commandQueue, matrix.columnIndices);
+		values_ = upload(context, commandQueue, matrix.values);
+		if (format_ == SparseFormat::CsrVector) {
+			// a vector as long as the mean row length keeps most lanes busy on typical rows
+			while (vectorSize_ < maxVectorSize && static_cast<double>(vectorSize_) < statistics.meanRowLength) {
+				vectorSize_ *= 2;
+			}
+			vectorSize_ = std::max<size_t>(vectorSize_, 2);
+			kernelName = "csrVector";
+			buildOptions = "-DVECTOR_SIZE=" + std::to_string(vectorSize_);
+		} else {
+			kernelName = "csrScalar";
+		}
+	}
+
+	const auto program = ProgramRegistry::getInstance().acquire(
+			spmvKernelSourceCode,
+			kernelName,
+			context,
+			device,
+			buildOptions
+	);
+	kernel_ = std::make_unique<Program>(*program, kernelName);
+	workGroupSize_ = chooseWorkGroupSize(*kernel_, format_ == SparseFormat::CsrVector ? sizeof(cl_float) : 0);
+	if (workGroupSize_ < vectorSize_) {
+		// let it crash
+		throw std::runtime_error("Cannot create sparse matrix: the work group is smaller than a row vector");
+	}
+}
+
+[[maybe_unused]] void DeviceSparseMatrix::multiply(const BaseBuffer &x, const BaseBuffer &y) {
+	if (!numRows_) {
+		return;
+	}
+
+	const auto numRows = static_cast<cl_uint>(numRows_);
+	cl_uint argumentIndex = 0;
+	kernel_->setKernelArg(argumentIndex++, sizeof(cl_uint), &numRows);
+	kernel_->setKernelArg(argumentIndex++, sizeof(cl_mem), *offsets_);
+	if (format_ == SparseFormat::SlicedEll) {
+		kernel_->setKernelArg(argumentIndex++, sizeof(cl_mem), *rowLengths_);
+	}
+	kernel_->setKernelArg(argumentIndex++, sizeof(cl_mem), *columnIndices_);
+	kernel_->setKernelArg(argumentIndex++, sizeof(cl_mem), *values_);
+	kernel_->setKernelArg(argumentIndex++, sizeof(cl_mem), x);
+	kernel_->setKernelArg(argumentIndex++, sizeof(cl_mem), y);
+	if (format_ == SparseFormat::CsrVector) {
+		kernel_->setKernelArg(argumentIndex, workGroupSize_ * sizeof(cl_float), static_cast<const void *>(nullptr));
+	}
+
+	const size_t numThreads = numRows_ * vectorSize_;
+	const size_t numWorkGroups = (numThreads + workGroupSize_ - 1) / workGroupSize_;
+	commandQueue_.enqueueCommandExecuteProgramOnDevice(*kernel_, numWorkGroups * workGroupSize_, workGroupSize_);
+}
+
+[[maybe_unused]] SparseFormat DeviceSparseMatrix::getFormat() const {
+	return format_;
+}
+
+[[maybe_unused]] size_t DeviceSparseMatrix::getNumRows() const {
+	return numRows_;
+}
+
+[[maybe_unused]] size_t DeviceSparseMatrix::getNumColumns() const {
+	return numColumns_;
+}
@@ -0,0 +1,283 @@
+#ifndef OPENCL_TOOLKIT_DOUBLE_BUFFERED_STAGING_H
+#define OPENCL_TOOLKIT_DOUBLE_BUFFERED_STAGING_H
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "opencl/command_queue.h"
+#include "opencl/context.h"
+#include "opencl/error.h"
+#include "opencl/event.h"
+#include "staging_buffer.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Two mapped staging buffers in pinned host memory which alternate, so the host fills or drains one chunk
+	 * while the device copies another.
+	 * @details The staging buffers stay mapped for the lifetime of an instance. The callbacks only see the host
+	 * pointer of a staging buffer; the copies between staging and device memory are enqueued by the callbacks of
+	 * uploads and by the instance for downloads. After a failure, the pending copies are awaited before the failure is
+	 * rethrown, so the staging memory is never written by the device afterwards.
+	 */
+	class DoubleBufferedStaging {
+		public:
+			/**
+			 * The number of staging buffers.
+			 */
+			static constexpr size_t numStagingBuffers = 2;
+
+		private:
+			/**
+			 * The command queue which executes the transfers.
+			 */
+			CommandQueue &commandQueue_;
+
+			/**
+			 * The size of each staging buffer in bytes.
+			 */
+			size_t chunkSizeInBytes_;
+
+			/**
+			 * The staging buffers in pinned host memory.
+			 */
+			std::unique_ptr<BaseBuffer> stagingBuffers_[numStagingBuffers];
+
+			/**
+			 * The host pointers of the mapped staging buffers.
+			 */
+			char *stagingMemory_[numStagingBuffers];
+
+			/**
+			 * The pending copies from or into each staging buffer.
+			 */
+			std::vector<Event> pendingCopies_[numStagingBuffers];
+
+		public:
+			/**
+			 * @brief The parametrized constructor. Creates and maps the staging buffers.
+			 * @param context a valid OpenCL-context.
+			 * @param commandQueue the command queue of the target device which outlives the current instance.
+			 * @param chunkSizeInBytes the size of each of the two staging buffers in bytes.
+			 * @param hostMemory the page aligned host memory to be pinned, which outlives the current instance, or
+			 *                   nullptr to allocate pinned memory.
+			 * @param hostMemoryStrideInBytes the distance of the staging buffers in the passed host memory, a multiple
+			 *                                of the page size of at least the chunk size.
+			 */
+			DoubleBufferedStaging(
+					const Context &context,
+					CommandQueue &commandQueue,
+					const size_t chunkSizeInBytes,
+					void *hostMemory = nullptr,
+					const size_t hostMemoryStrideInBytes = 0
+			) : commandQueue_(commandQueue), chunkSizeInBytes_(chunkSizeInBytes), stagingMemory_() {
+				try {
+					for (size_t i = 0; i < numStagingBuffers; ++i) {
+						if (hostMemory) {
+							stagingBuffers_[i] = std::make_unique<StagingBuffer>(
+									context,
+									chunkSizeInBytes,
+									CL_MEM_READ_WRITE,
+									static_cast<char *>(hostMemory) + i * hostMemoryStrideInBytes
+							);
+						} else {
+							stagingBuffers_[i] = std::make_unique<StagingBuffer>(context, chunkSizeInBytes, CL_MEM_READ_WRITE);
+						}
+						cl_int status;
+						stagingMemory_[i] = static_cast<char *>(clEnqueueMapBuffer(
+								commandQueue_,
+								*stagingBuffers_[i],
+								CL_TRUE,
+								CL_MAP_READ | CL_MAP_WRITE,
+								0,
+								chunkSizeInBytes,
+								0,
+								nullptr,
+								nullptr,
+								&status
+						));
+						if (status) {
+							stagingMemory_[i] = nullptr;
+							// let it crash
+							throw std::runtime_error("Failed to map the staging buffer: " + toErrorDescription(status));
+						}
+					}
+				} catch (...) {
+					for (size_t i = 0; i < numStagingBuffers; ++i) {
+						if (stagingMemory_[i]) {
+							clEnqueueUnmapMemObject(
+									commandQueue_,
+									*stagingBuffers_[i],
+									stagingMemory_[i],
+									0,
+									nullptr,
+									nullptr
+							);
+						}
+					}
+					clFinish(commandQueue_);
+					throw;
+				}
+			}
+
+			/**
+			 * @brief Deleted copy constructor.
+			 */
+			DoubleBufferedStaging(DoubleBufferedStaging const &) = delete;
+
+			/**
+			 * @brief Deleted copy assignment.
+			 */
+			void operator=(DoubleBufferedStaging const &) = delete;
+
+			/**
+			 * @brief The destructor. Awaits the pending copies, unmaps and releases the staging buffers.
+			 */
+			~DoubleBufferedStaging() {
+				drainPendingCopies();
+				for (size_t i = 0; i < numStagingBuffers; ++i) {
+					const cl_int status = clEnqueueUnmapMemObject(
+							commandQueue_,
+							*stagingBuffers_[i],
+							stagingMemory_[i],
+							0,
+							nullptr,
+							nullptr
+					);
+					if (status) {
+						std::cerr << "Failed to unmap the staging buffer. " + toErrorDescription(status) << std::endl;
+					}
+				}
+				clFinish(commandQueue_);
+			}
+
+			/**
+			 * @brief Returns the size of each staging buffer in bytes.
+			 * @return the size of each staging buffer in bytes.
+			 */
+			[[nodiscard]] size_t getChunkSizeInBytes() const {
+				return chunkSizeInBytes_;
+			}
+
+			/**
+			 * @brief Fills the staging buffers chunk by chunk and awaits the copies out of them.
+			 * @param numElements the number of elements.
+			 * @param chunkSizeInElements the number of elements per chunk, which fit into a staging buffer.
+			 * @param fillAndCopy fills a chunk given by its first element and its number of elements into the passed
+			 *                    staging memory and enqueues its copies, whose events it appends.
+			 */
+			void upload(
+					const size_t numElements,
+					const size_t chunkSizeInElements,
+					const std::function<void(size_t, size_t, char *, std::vector<Event> &)> &fillAndCopy
+			) {
+				try {
+					for (size_t first = 0, chunk = 0; first < numElements; first += chunkSizeInElements, ++chunk) {
+						// the device copies from one staging buffer while the host fills the other
+						const size_t index = chunk % numStagingBuffers;
+						awaitPendingCopies(index);
+						const size_t count = std::min(chunkSizeInElements, numElements - first);
+						fillAndCopy(first, count, stagingMemory_[index], pendingCopies_[index]);
+						flush();
+					}
+					for (size_t i = 0; i < numStagingBuffers; ++i) {
+						awaitPendingCopies(i);
+					}
+				} catch (...) {
+					drainPendingCopies();
+					throw;
+				}
+			}
+
+			/**
+			 * @brief Copies device memory chunk by chunk into the staging buffers and drains each chunk. The copy of
+			 * the next chunk overlaps the draining of the current one.
+			 * @param sourceDeviceMemory the device memory to copy from.
+			 * @param numBytes the number of bytes to be copied.
+			 * @param sourceOffsetInBytes the offset in bytes into the device memory.
+			 * @param chunkSizeInBytes the number of bytes per chunk, at most the size of a staging buffer.
+			 * @param drain drains a chunk given by its first byte and its number of bytes from the passed staging
+			 *              memory.
+			 */
+			void download(
+					const BaseBuffer &sourceDeviceMemory,
+					const size_t numBytes,
+					const size_t sourceOffsetInBytes,
+					const size_t chunkSizeInBytes,
+					const std::function<void(size_t, size_t, const char *)> &drain
+			) {
+				const size_t numChunks = (numBytes + chunkSizeInBytes - 1) / chunkSizeInBytes;
+				try {
+					// the copy of the next chunk is enqueued before the current one is drained
+					for (size_t chunk = 0; chunk <= numChunks; ++chunk) {
+						if (chunk < numChunks) {
+							const size_t first = chunk * chunkSizeInBytes;
+							pendingCopies_[chunk % numStagingBuffers].push_back(
+									commandQueue_.enqueueCommandCopyBytesFromDeviceMemoryIntoHostMemoryAsync(
+											sourceDeviceMemory,
+											stagingMemory_[chunk % numStagingBuffers],
+											std::min(chunkSizeInBytes, numBytes - first),
+											sourceOffsetInBytes + first
+									)
+							);
+							flush();
+						}
+						if (chunk) {
+							const size_t first = (chunk - 1) * chunkSizeInBytes;
+							const size_t index = (chunk - 1) % numStagingBuffers;
+							awaitPendingCopies(index);
+							drain(first, std::min(chunkSizeInBytes, numBytes - first), stagingMemory_[index]);
+						}
+					}
+				} catch (...) {
+					drainPendingCopies();
+					throw;
+				}
+			}
+
+		private:
+			/**
+			 * @brief Submits the enqueued copies to the device.
+			 */
+			void flush() {
+				const cl_int status = clFlush(commandQueue_);
+				if (status) {
+					// let it crash
+					throw std::runtime_error("Failed to flush the command queue: " + toErrorDescription(status));
+				}
+			}
+
+			/**
+			 * @brief Awaits the pending copies of a staging buffer.
+			 * @param index the index of the staging buffer.
+			 */
+			void awaitPendingCopies(const size_t index) {
+				for (const Event &copy: pendingCopies_[index]) {
+					copy.wait();
+				}
+				pendingCopies_[index].clear();
+			}
+
+			/**
+			 * @brief Awaits the pending copies of all staging buffers without throwing, e.g. while unwinding a failure.
+			 */
+			void drainPendingCopies() noexcept {
+				for (auto &pendingCopies: pendingCopies_) {
+					for (const Event &copy: pendingCopies) {
+						const cl_event event = copy;
+						clWaitForEvents(1, &event);
+					}
+					pendingCopies.clear();
+				}
+			}
+	};
+}
+
+#endif //OPENCL_TOOLKIT_DOUBLE_BUFFERED_STAGING_H
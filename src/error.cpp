@@ -2,6 +2,15 @@
 
 std::string OpenClToolkit::toErrorDescription(const cl_int errorCode) {
 	switch (errorCode) {
+		case CL_INVALID_LINKER_OPTIONS: // -67
+			return "CL_INVALID_LINKER_OPTIONS: The linker options are invalid.";
+		case CL_INVALID_COMPILER_OPTIONS: // -66
+			return "CL_INVALID_COMPILER_OPTIONS: The compiler options are invalid.";
+		case CL_INVALID_IMAGE_DESCRIPTOR: // -65
+			return "CL_INVALID_IMAGE_DESCRIPTOR: The image type or dimensions are not valid.";
+		case CL_INVALID_OPERATION: // -59
+			return "CL_INVALID_OPERATION: The operation is not allowed in the current state, e.g. a previous build has "
+				   "not completed or the program was not created from source.";
 		case CL_INVALID_EVENT_WAIT_LIST: // -57
 			return "CL_INVALID_EVENT_WAIT_LIST: event_wait_list is NULL and num_events_in_wait_list greater than 0 or "
 				   "event_wait_list is not NULL and num_events_in_wait_list is 0 or "
@@ -18,9 +27,23 @@ std::string OpenClToolkit::toErrorDescription(const cl_int errorCode) {
 			return "CL_INVALID_KERNEL_ARGS: The kernel argument values have not been specified";
 		case CL_INVALID_KERNEL: // -48
 			return "CL_INVALID_KERNEL: Kernel is not a valid kernel object";
+		case CL_INVALID_KERNEL_NAME: // -46
+			return "CL_INVALID_KERNEL_NAME: The kernel name was not found in the program";
 		case CL_INVALID_PROGRAM_EXECUTABLE: // -45
 			return "CL_INVALID_PROGRAM_EXECUTABLE: "
 				   "No successfully built program executable available for device associated with command_queue";
+		case CL_INVALID_PROGRAM: // -44
+			return "CL_INVALID_PROGRAM: The passed program is not a valid program object.";
+		case CL_INVALID_BUILD_OPTIONS: // -43
+			return "CL_INVALID_BUILD_OPTIONS: The build options are invalid.";
+		case CL_INVALID_BINARY: // -42
+			return "CL_INVALID_BINARY: The passed binary or intermediate language module is not valid for the device.";
+		case CL_INVALID_SAMPLER: // -41
+			return "CL_INVALID_SAMPLER: The passed sampler is not a valid sampler object.";
+		case CL_INVALID_IMAGE_SIZE: // -40
+			return "CL_INVALID_IMAGE_SIZE: The image dimensions exceed the maximum of the device.";
+		case CL_INVALID_IMAGE_FORMAT_DESCRIPTOR: // -39
+			return "CL_INVALID_IMAGE_FORMAT_DESCRIPTOR: The image format is not valid.";
 		case CL_INVALID_MEM_OBJECT: // -38
 			return "CL_INVALID_MEM_OBJECT: The passed buffer is not a valid buffer object.";
 		case CL_INVALID_COMMAND_QUEUE: // -36
@@ -33,12 +56,24 @@ std::string OpenClToolkit::toErrorDescription(const cl_int errorCode) {
 			return "CL_INVALID_DEVICE: The device is not valid or is not associated with the context";
 		case CL_INVALID_VALUE: // -30
 			return "CL_INVALID_VALUE: The specified values in properties are not valid.";
+		case CL_LINK_PROGRAM_FAILURE: // -17
+			return "CL_LINK_PROGRAM_FAILURE: Failed to link the compiled objects (see the build log).";
+		case CL_LINKER_NOT_AVAILABLE: // -16
+			return "CL_LINKER_NOT_AVAILABLE: The linker is not available.";
+		case CL_COMPILE_PROGRAM_FAILURE: // -15
+			return "CL_COMPILE_PROGRAM_FAILURE: Failed to compile the program source (see the build log).";
+		case CL_BUILD_PROGRAM_FAILURE: // -11
+			return "CL_BUILD_PROGRAM_FAILURE: Failed to build the program executable (see the build log).";
+		case CL_IMAGE_FORMAT_NOT_SUPPORTED: // -10
+			return "CL_IMAGE_FORMAT_NOT_SUPPORTED: The image format is not supported by the devices of the context.";
 		case CL_OUT_OF_HOST_MEMORY: // -6
 			return "CL_OUT_OF_HOST_MEMORY: Failed to allocate resources required by the OpenCL implementation on the host.";
 		case CL_OUT_OF_RESOURCES: // -5
 			return "CL_OUT_OF_RESOURCES: Failed to allocate resources required by the OpenCL implementation on the device.";
 		case CL_MEM_OBJECT_ALLOCATION_FAILURE: // -4
 			return "CL_MEM_OBJECT_ALLOCATION_FAILURE: Failed to allocate memory for data store associated with buffer.";
+		case CL_COMPILER_NOT_AVAILABLE: // -3
+			return "CL_COMPILER_NOT_AVAILABLE: The compiler is not available.";
 		case CL_SUCCESS: // 0
 			return "CL_SUCCESS: No errors.";
 		default:
@@ -0,0 +1,51 @@
+#include <iostream>
+#include <stdexcept>
+
+#include "opencl/event.h"
+#include "opencl/error.h"
+
+using namespace OpenClToolkit;
+
+[[maybe_unused]] Event::Event(cl_event event) : self_(event) {}
+
+Event::Event(Event &&other) noexcept : self_(other.self_) {
+	other.self_ = nullptr;
+}
+
+Event::~Event() {
+	if (!self_) {
+		return;
+	}
+	const cl_int status = clReleaseEvent(self_);
+	if (status) {
+		std::cerr << "Failed to release event. " + toErrorDescription(status) << std::endl;
+	}
+}
+
+[[maybe_unused]] void Event::wait() const {
+	const cl_int status = clWaitForEvents(1, &self_);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Failed to wait for event. " + toErrorDescription(status));
+	}
+}
+
+[[maybe_unused]] cl_int Event::getExecutionStatus() const {
+	cl_int executionStatus;
+	const cl_int status = clGetEventInfo(
+			self_,
+			CL_EVENT_COMMAND_EXECUTION_STATUS,
+			sizeof(cl_int),
+			&executionStatus,
+			nullptr
+	);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Failed to query event. " + toErrorDescription(status));
+	}
+	return executionStatus;
+}
+
+Event::operator cl_event() const {
+	return self_;
+}
@@ -0,0 +1,56 @@
+#include <mutex>
+
+#include "opencl/evictable_buffer.h"
+#include "opencl/memory_manager.h"
+
+using namespace OpenClToolkit;
+
+[[maybe_unused]] EvictableBuffer::EvictableBuffer(
+		const Context &context,
+		CommandQueue &commandQueue,
+		const size_t sizeInBytes
+) : context_(context),
+	commandQueue_(commandQueue),
+	sizeInBytes_(sizeInBytes),
+	deviceBuffer_(std::make_shared<ReadWriteBuffer>(context, sizeInBytes)),
+	isMoving_(false) {
+	MemoryManager::getInstance().registerBuffer(context, this);
+}
+
+EvictableBuffer::~EvictableBuffer() {
+	MemoryManager::getInstance().unregisterBuffer(context_, this);
+}
+
+[[maybe_unused]] std::shared_ptr<ReadWriteBuffer> EvictableBuffer::acquire() {
+	return MemoryManager::getInstance().acquire(context_, this);
+}
+
+[[maybe_unused]] bool EvictableBuffer::isResident() const {
+	std::lock_guard<std::recursive_mutex> lock(MemoryManager::getInstance().mutex_);
+	return deviceBuffer_ != nullptr;
+}
+
+[[maybe_unused]] size_t EvictableBuffer::getSizeInBytes() const {
+	return sizeInBytes_;
+}
+
+std::shared_ptr<ReadWriteBuffer> EvictableBuffer::beginEviction() {
+	// the buffer is acquired if anyone but the current instance holds it
+	if (isMoving_ || !deviceBuffer_ || deviceBuffer_.use_count() > 1) {
+		return nullptr;
+	}
+	isMoving_ = true;
+	return std::move(deviceBuffer_);
+}
+
+void EvictableBuffer::copyToHost(const ReadWriteBuffer &deviceBuffer) {
+	hostCopy_.resize(sizeInBytes_);
+	commandQueue_.enqueueCommandCopyBytesFromDeviceMemoryIntoHostMemory(deviceBuffer, hostCopy_.data(), sizeInBytes_);
+}
+
+std::shared_ptr<ReadWriteBuffer> EvictableBuffer::restore() {
+	auto deviceBuffer = std::make_shared<ReadWriteBuffer>(context_, sizeInBytes_);
+	commandQueue_.enqueueCommandCopyBytesFromHostMemoryIntoDeviceMemory(hostCopy_.data(), *deviceBuffer, sizeInBytes_);
+	std::vector<unsigned char>().swap(hostCopy_);
+	return deviceBuffer;
+}
@@ -0,0 +1,57 @@
+#include <algorithm>
+
+#include "opencl/executor.h"
+
+using namespace OpenClToolkit;
+
+[[maybe_unused]] InlineExecutor &InlineExecutor::getInstance() {
+	static InlineExecutor instance;
+	return instance;
+}
+
+void InlineExecutor::execute(std::coroutine_handle<> coroutine) {
+	coroutine.resume();
+}
+
+[[maybe_unused]] ThreadPoolExecutor::ThreadPoolExecutor(const size_t numThreads) : isStopping_(false) {
+	const size_t count = std::max<size_t>(numThreads, 1);
+	threads_.reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		threads_.emplace_back(&ThreadPoolExecutor::work, this);
+	}
+}
+
+ThreadPoolExecutor::~ThreadPoolExecutor() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		isStopping_ = true;
+	}
+	condition_.notify_all();
+	for (auto &thread: threads_) {
+		thread.join();
+	}
+}
+
+void ThreadPoolExecutor::execute(std::coroutine_handle<> coroutine) {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		queue_.push_back(coroutine);
+	}
+	condition_.notify_one();
+}
+
+void ThreadPoolExecutor::work() {
+	while (true) {
+		std::coroutine_handle<> coroutine;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait(lock, [this] { return isStopping_ || !queue_.empty(); });
+			if (queue_.empty()) {
+				return;
+			}
+			coroutine = queue_.front();
+			queue_.pop_front();
+		}
+		coroutine.resume();
+	}
+}
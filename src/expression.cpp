@@ -0,0 +1,54 @@
+#include "opencl/expression.h"
+#include "opencl/program_registry.h"
+#include "work_group_size.h"
+
+using namespace OpenClToolkit;
+
+[[maybe_unused]] ExpressionEvaluator::ExpressionEvaluator(
+		const Context &context,
+		cl_device_id device,
+		CommandQueue &commandQueue
+) : context_(context),
+	device_(device),
+	commandQueue_(commandQueue) {}
+
+ExpressionEvaluator::FusedKernel &ExpressionEvaluator::acquireKernel(
+		const std::type_index expressionType,
+		const std::string &sourceCode
+) {
+	auto iterator = kernels_.find(expressionType);
+	if (iterator == kernels_.end()) {
+		const auto program = ProgramRegistry::getInstance().acquire(sourceCode, kernelName, context_, device_);
+		auto kernel = std::make_unique<Program>(*program, kernelName);
+		const size_t workGroupSize = chooseWorkGroupSize(*kernel, 0);
+		iterator = kernels_.emplace(expressionType, FusedKernel{std::move(kernel), workGroupSize}).first;
+	}
+	return iterator->second;
+}
+
+void ExpressionEvaluator::launch(const FusedKernel &fusedKernel, const size_t numElements) {
+	const size_t numThreads =
+			(numElements + fusedKernel.workGroupSize - 1) / fusedKernel.workGroupSize * fusedKernel.workGroupSize;
+	commandQueue_.enqueueCommandExecuteProgramOnDevice(*fusedKernel.kernel, numThreads, fusedKernel.workGroupSize);
+}
+
+std::string ExpressionEvaluator::composeSourceCode(
+		const std::string &typeName,
+		const std::string &parameters,
+		const std::string &body
+) {
+	std::string sourceCode;
+	if (typeName == "double") {
+		sourceCode += "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n\n";
+	}
+	sourceCode += std::string("__kernel void ") + kernelName + "(\n"
+			+ "\t\t__global " + typeName + " *output,\n"
+			+ "\t\tconst ulong n" + parameters + "\n"
+			+ ") {\n"
+			+ "\tconst size_t i = get_global_id(0);\n"
+			+ "\tif (i < n) {\n"
+			+ "\t\toutput[i] = " + body + ";\n"
+			+ "\t}\n"
+			+ "}\n";
+	return sourceCode;
+}
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "opencl/fft.h"
+#include "opencl/program_registry.h"
+#include "fft_kernels.h"
+#include "work_group_size.h"
+
+using namespace OpenClToolkit;
+
+namespace {
+	/**
+	 * The ratio of the circumference of a circle to its diameter.
+	 */
+	constexpr double pi = 3.14159265358979323846;
+
+	/**
+	 * The twiddle tables of the current process per context and transform length. The tables are released with the
+	 * last plan which uses them.
+	 */
+	std::map<std::pair<cl_context, size_t>, std::weak_ptr<ReadWriteBuffer>> twiddleTables;
+
+	/**
+	 * Guards the twiddle tables.
+	 */
+	std::mutex twiddleTablesMutex;
+
+	/**
+	 * @brief Returns whether the passed number is a power of two.
+	 * @param number the number to be checked.
+	 * @return whether the passed number is a power of two.
+	 */
+	bool isPowerOfTwo(const size_t number) {
+		return number && !(number & (number - 1));
+	}
+
+	/**
+	 * @brief Returns the twiddle table of the passed transform length, creating it if no plan holds it.
+	 * @param context the context of the table.
+	 * @param commandQueue the command queue which uploads a new table.
+	 * @param length the transform length.
+	 * @return the table of exp(-2 pi i k / length) for k < length.
+	 */
+	std::shared_ptr<ReadWriteBuffer> acquireTwiddleTable(
+			const Context &context,
+			CommandQueue &commandQueue,
+			const size_t length
+	) {
+		std::lock_guard<std::mutex> lock(twiddleTablesMutex);
+		std::weak_ptr<ReadWriteBuffer> &entry = twiddleTables[{context, length}];
+		std::shared_ptr<ReadWriteBuffer> table = entry.lock();
+		if (table) {
+			return table;
+		}
+
+		// computed in double precision, so the table is exact to float precision
+		std::vector<cl_float2> twiddles(length);
+		const double angleStep = -2.0 * pi / static_cast<double>(length);
+		for (size_t k = 0; k < length; ++k) {
+			const double angle = angleStep * static_cast<double>(k);
+			twiddles[k].s[0] = static_cast<cl_float>(std::cos(angle));
+			twiddles[k].s[1] = static_cast<cl_float>(std::sin(angle));
+		}
+		table = std::make_shared<ReadWriteBuffer>(context, length * sizeof(cl_float2));
+		commandQueue.enqueueCommandCopyBytesFromHostMemoryIntoDeviceMemory(
+				twiddles.data(),
+				*table,
+				length * sizeof(cl_float2)
+		);
+		entry = table;
+		return table;
+	}
+}
+
+[[maybe_unused]] FftPlan::FftPlan(
+		const Context &context,
+		cl_device_id device,
+		CommandQueue &commandQueue,
+		const NDRange &size,
+		const size_t batchSize
+) : commandQueue_(commandQueue),
+	size_(size),
+	batchSize_(batchSize),
+	scratch_(context, std::max<size_t>(size.getTotalSize() * batchSize, 1) * sizeof(cl_float2)),
+	workGroupSize_(1) {
+	if (size.numDimensions > 2) {
+		// let it crash
+		throw std::runtime_error("Cannot create FFT plan: only 1-D and 2-D transforms are supported");
+	}
+	for (cl_uint dimension = 0; dimension < size.numDimensions; ++dimension) {
+		if (!isPowerOfTwo(size.sizes[dimension]) || size.sizes[dimension] >= (size_t(1) << 31)) {
+			// let it crash
+			throw std::runtime_error("Cannot create FFT plan: the lengths must be powers of two below 2^31");
+		}
+	}
+	if (size.getTotalSize() * batchSize >= (size_t(1) << 32)) {
+		// let it crash
+		throw std::runtime_error("Cannot create FFT plan: the batch exceeds 2^32 - 1 elements");
+	}
+
+	for (cl_uint dimension = 0; dimension < size.numDimensions; ++dimension) {
+		const size_t length = size.sizes[dimension];
+		twiddles_.push_back(acquireTwiddleTable(context, commandQueue, length));
+		// the largest radices first, as they need the fewest passes over the memory
+		size_t subTransformLength = 1;
+		while (subTransformLength < length) {
+			const size_t remaining = length / subTransformLength;
+			const cl_uint radix = remaining % 8 == 0 ? 8 : remaining % 4 == 0 ? 4 : 2;
+			std::unique_ptr<Program> &kernel = kernels_[radix];
+			if (!kernel) {
+				const auto program = ProgramRegistry::getInstance().acquire(
+						fftKernelSourceCode,
+						"stockham",
+						context,
+						device,
+						"-DRADIX=" + std::to_string(radix)
+				);
+				kernel = std::make_unique<Program>(*program, "stockham");
+			}
+			passes_.push_back({
+					kernel.get(),
+					twiddles_.back().get(),
+					static_cast<cl_uint>(length),
+					static_cast<cl_uint>(subTransformLength),
+					radix,
+					dimension
+			});
+			subTransformLength *= radix;
+		}
+	}
+
+	workGroupSize_ = maxBuiltInWorkGroupSize;
+	for (const auto &kernel: kernels_) {
+		workGroupSize_ = std::min(workGroupSize_, chooseWorkGroupSize(*kernel.second, 0));
+	}
+	// small work groups leave room for enough of them to hide the latency of the strided accesses
+	workGroupSize_ = std::min<size_t>(workGroupSize_, 64);
+}
+
+[[maybe_unused]] void FftPlan::forward(const BaseBuffer &data) {
+	execute(data, 1.0f);
+}
+
+[[maybe_unused]] void FftPlan::inverse(const BaseBuffer &data) {
+	execute(data, -1.0f);
+}
+
+[[maybe_unused]] const NDRange &FftPlan::getSize() const {
+	return size_;
+}
+
+[[maybe_unused]] size_t FftPlan::getBatchSize() const {
+	return batchSize_;
+}
+
+void FftPlan::execute(const BaseBuffer &data, const cl_float sign) {
+	if (!batchSize_ || passes_.empty()) {
+		return;
+	}
+
+	const size_t sizeX = size_.sizes[0];
+	const size_t sizeY = size_.numDimensions > 1 ? size_.sizes[1] : 1;
+	const cl_ulong batchDistance = sizeX * sizeY;
+	const BaseBuffer *input = &data;
+	const BaseBuffer *output = &scratch_;
+	for (const Pass &pass: passes_) {
+		const bool isRowPass = pass.dimension == 0;
+		const auto numTransforms = static_cast<cl_uint>(isRowPass ? sizeY * batchSize_ : sizeX * batchSize_);
+		const auto transformsPerBatch = static_cast<cl_uint>(isRowPass ? sizeY : sizeX);
+		const cl_ulong transformDistance = isRowPass ? sizeX : 1;
+		const auto stride = static_cast<cl_uint>(isRowPass ? 1 : sizeX);
+		// rows: neighbouring work items share a row; columns: neighbouring work items process neighbouring columns
+		const cl_uint transformDimension = isRowPass ? 1 : 0;
+
+		Program &kernel = *pass.kernel;
+		kernel.setKernelArg(0, sizeof(cl_mem), *input);
+		kernel.setKernelArg(1, sizeof(cl_mem), *output);
+		kernel.setKernelArg(2, sizeof(cl_mem), *pass.twiddles);
+		kernel.setKernelArg(3, sizeof(cl_uint), &pass.length);
+		kernel.setKernelArg(4, sizeof(cl_uint), &pass.subTransformLength);
+		kernel.setKernelArg(5, sizeof(cl_float), &sign);
+		kernel.setKernelArg(6, sizeof(cl_uint), &numTransforms);
+		kernel.setKernelArg(7, sizeof(cl_uint), &transformsPerBatch);
+		kernel.setKernelArg(8, sizeof(cl_ulong), &batchDistance);
+		kernel.setKernelArg(9, sizeof(cl_ulong), &transformDistance);
+		kernel.setKernelArg(10, sizeof(cl_uint), &stride);
+		kernel.setKernelArg(11, sizeof(cl_uint), &transformDimension);
+
+		const size_t numButterflies = pass.length / pass.radix;
+		if (isRowPass) {
+			const size_t localSize = std::min(numButterflies, workGroupSize_);
+			commandQueue_.enqueueCommandExecuteProgramOnDevice(
+					kernel,
+					NDRange(numButterflies, numTransforms),
+					NDRange(localSize, 1)
+			);
+		} else {
+			const size_t numWorkGroups = (numTransforms + workGroupSize_ - 1) / workGroupSize_;
+			commandQueue_.enqueueCommandExecuteProgramOnDevice(
+					kernel,
+					NDRange(numWorkGroups * workGroupSize_, numButterflies),
+					NDRange(workGroupSize_, 1)
+			);
+		}
+		std::swap(input, output);
+	}
+
+	if (input != &data) {
+		commandQueue_.enqueueCommandCopyBytesFromDeviceMemoryIntoDeviceMemory(
+				scratch_,
+				data,
+				size_.getTotalSize() * batchSize_ * sizeof(cl_float2)
+		);
+	}
+}
@@ -0,0 +1,119 @@
+#ifndef OPENCL_TOOLKIT_FFT_KERNELS_H
+#define OPENCL_TOOLKIT_FFT_KERNELS_H
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief The source code of a pass of the Stockham auto-sort FFT for interleaved complex floats.
+	 * @details The radix of the pass is specialized by the build option <code>RADIX</code> (2, 4 or 8). A pass of a
+	 * transform of length n, whose sub-transforms have length ns so far, reads the elements j + r * n / RADIX, applies
+	 * the twiddles and a DFT of length RADIX, and writes the elements (j / ns) * ns * RADIX + j % ns + r * ns. So the
+	 * output is in natural order without a bit reversal. The twiddle table holds exp(-2 pi i k / n) for k < n and is
+	 * conjugated for inverse transforms.
+	 *
+	 * The transforms are addressed by base offset and element stride, so row and column transforms of 2-D data run in
+	 * place of a transposition. <code>transformDimension</code> selects the dimension of the index space which
+	 * enumerates the transforms; the other one enumerates the butterflies of a transform.
+	 */
+	inline constexpr const char *fftKernelSourceCode = R"CLC(
+inline float2 multiply(const float2 a, const float2 b) {
+	return (float2) (a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+}
+
+// multiplies by exp(-sign * pi i / 2)
+inline float2 rotate(const float2 a, const float sign) {
+	return (float2) (sign * a.y, -sign * a.x);
+}
+
+inline void dft2(float2 *v) {
+	const float2 v0 = v[0];
+	v[0] = v0 + v[1];
+	v[1] = v0 - v[1];
+}
+
+inline void dft4(float2 *a0, float2 *a1, float2 *a2, float2 *a3, const float sign) {
+	const float2 t0 = *a0 + *a2;
+	const float2 t1 = *a0 - *a2;
+	const float2 t2 = *a1 + *a3;
+	const float2 t3 = rotate(*a1 - *a3, sign);
+	*a0 = t0 + t2;
+	*a1 = t1 + t3;
+	*a2 = t0 - t2;
+	*a3 = t1 - t3;
+}
+
+inline void dft8(float2 *v, const float sign) {
+	dft4(&v[0], &v[2], &v[4], &v[6], sign);
+	dft4(&v[1], &v[3], &v[5], &v[7], sign);
+	const float c = M_SQRT1_2_F;
+	const float2 o0 = v[1];
+	const float2 o1 = multiply(v[3], (float2) (c, -sign * c));
+	const float2 o2 = rotate(v[5], sign);
+	const float2 o3 = multiply(v[7], (float2) (-c, -sign * c));
+	const float2 e0 = v[0];
+	const float2 e1 = v[2];
+	const float2 e2 = v[4];
+	const float2 e3 = v[6];
+	v[0] = e0 + o0;
+	v[1] = e1 + o1;
+	v[2] = e2 + o2;
+	v[3] = e3 + o3;
+	v[4] = e0 - o0;
+	v[5] = e1 - o1;
+	v[6] = e2 - o2;
+	v[7] = e3 - o3;
+}
+
+__kernel void stockham(
+		__global const float2 *input,
+		__global float2 *output,
+		__global const float2 *twiddles,
+		const uint n,
+		const uint ns,
+		const float sign,
+		const uint numTransforms,
+		const uint transformsPerBatch,
+		const ulong batchDistance,
+		const ulong transformDistance,
+		const uint stride,
+		const uint transformDimension
+) {
+	const uint transform = get_global_id(transformDimension);
+	if (transform >= numTransforms) {
+		return;
+	}
+	const uint j = get_global_id(1 - transformDimension);
+	const size_t base = (transform / transformsPerBatch) * batchDistance +
+						(transform % transformsPerBatch) * transformDistance;
+	const uint k = j % ns;
+	const uint twiddleStep = k * (n / (ns * RADIX));
+
+	float2 v[RADIX];
+	for (uint r = 0; r < RADIX; ++r) {
+		v[r] = input[base + (size_t) (j + r * (n / RADIX)) * stride];
+		if (r) {
+			const float2 twiddle = twiddles[r * twiddleStep];
+			v[r] = multiply(v[r], (float2) (twiddle.x, sign * twiddle.y));
+		}
+	}
+
+#if RADIX == 8
+	dft8(v, sign);
+#elif RADIX == 4
+	dft4(&v[0], &v[1], &v[2], &v[3], sign);
+#else
+	dft2(v);
+#endif
+
+	const uint destination = (j / ns) * ns * RADIX + k;
+	for (uint r = 0; r < RADIX; ++r) {
+		output[base + (size_t) (destination + r * ns) * stride] = v[r];
+	}
+}
+)CLC";
+}
+
+#endif //OPENCL_TOOLKIT_FFT_KERNELS_H
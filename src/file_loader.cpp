@@ -0,0 +1,394 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "opencl/file_loader.h"
+#include "opencl/command_recorder.h"
+#include "opencl/error.h"
+#include "opencl/metrics_collector.h"
+#include "staging_buffer.h"
+
+using namespace OpenClToolkit;
+
+namespace {
+	/**
+	 * The number of chunks whose transfers may be pending at once. Two let the disk read one chunk ahead of the
+	 * transfers.
+	 */
+	constexpr size_t maxChunksInFlight = 2;
+
+	/**
+	 * @brief Returns the description of the last error of a system call.
+	 * @return the description of the last error of a system call.
+	 */
+	std::string getSystemErrorDescription() {
+		return std::strerror(errno);
+	}
+
+	/**
+	 * @brief Represents a file opened for reading.
+	 */
+	class FileDescriptor {
+		private:
+			/**
+			 * The file descriptor.
+			 */
+			int self_;
+
+		public:
+			/**
+			 * @brief Opens the passed file for reading.
+			 * @param path the path of the file.
+			 */
+			explicit FileDescriptor(const std::string &path) : self_(open(path.c_str(), O_RDONLY | O_CLOEXEC)) {
+				if (self_ < 0) {
+					// let it crash
+					throw std::runtime_error("Failed to open " + path + ": " + getSystemErrorDescription());
+				}
+			}
+
+			FileDescriptor(FileDescriptor const &) = delete;
+
+			void operator=(FileDescriptor const &) = delete;
+
+			~FileDescriptor() {
+				close(self_);
+			}
+
+			operator int() const { // NOLINT(google-explicit-constructor)
+				return self_;
+			}
+	};
+
+	/**
+	 * @brief Enqueues a copy from host memory into device memory which is not awaited. The copy is traced and counted
+	 * like the copies of <code>CommandQueue</code>.
+	 * @param commandQueue the command queue which executes the copy.
+	 * @param destinationDeviceMemory the device memory to copy to.
+	 * @param destinationOffsetInBytes the offset in bytes into the device memory.
+	 * @param sourceHostMemory the host memory to copy from. It must stay valid until the copy has completed.
+	 * @param numBytes the number of bytes to copy.
+	 * @return the event of the copy.
+	 */
+	cl_event enqueueWrite(
+			cl_command_queue commandQueue,
+			const BaseBuffer &destinationDeviceMemory,
+			const size_t destinationOffsetInBytes,
+			const void *sourceHostMemory,
+			const size_t numBytes
+	) {
+		CommandRecorder::getInstance().recordWrite(
+				destinationDeviceMemory,
+				destinationOffsetInBytes,
+				numBytes,
+				sourceHostMemory
+		);
+		MetricsCollector::getInstance().recordUpload(numBytes);
+		cl_event event = nullptr;
+		const cl_int status = clEnqueueWriteBuffer(
+				commandQueue,
+				destinationDeviceMemory,
+				CL_FALSE,
+				destinationOffsetInBytes,
+				numBytes,
+				sourceHostMemory,
+				0,
+				nullptr,
+				&event
+		);
+		if (status) {
+			// let it crash
+			throw std::runtime_error("Failed to copy the file into device memory: " + toErrorDescription(status));
+		}
+		return event;
+	}
+
+	/**
+	 * @brief Awaits and releases the passed event.
+	 * @param event the event of a copy.
+	 * @param isThrowing whether a failed copy throws, false while unwinding another failure.
+	 */
+	void awaitEvent(cl_event event, const bool isThrowing = true) {
+		const cl_int status = clWaitForEvents(1, &event);
+		clReleaseEvent(event);
+		if (status && isThrowing) {
+			// let it crash
+			throw std::runtime_error("Failed to copy the file into device memory: " + toErrorDescription(status));
+		}
+	}
+
+	/**
+	 * @brief Reads exactly the passed number of bytes, retrying interrupted and short reads.
+	 * @param fileDescriptor the open file.
+	 * @param destination the memory to read into.
+	 * @param numBytes the number of bytes to read.
+	 * @param fileOffsetInBytes the offset in bytes of the first byte to read.
+	 */
+	void readFully(const int fileDescriptor, char *destination, size_t numBytes, size_t fileOffsetInBytes) {
+		while (numBytes) {
+			const ssize_t numBytesRead = pread(
+					fileDescriptor,
+					destination,
+					numBytes,
+					static_cast<off_t>(fileOffsetInBytes)
+			);
+			if (numBytesRead < 0 && errno == EINTR) {
+				continue;
+			}
+			if (numBytesRead <= 0) {
+				// let it crash
+				throw std::runtime_error("Failed to read the file: " + (numBytesRead ? getSystemErrorDescription() :
+																		std::string("unexpected end of file")));
+			}
+			destination += numBytesRead;
+			numBytes -= static_cast<size_t>(numBytesRead);
+			fileOffsetInBytes += static_cast<size_t>(numBytesRead);
+		}
+	}
+}
+
+[[maybe_unused]] FileLoader::FileLoader(
+		const Context &context,
+		CommandQueue &commandQueue,
+		const size_t chunkSizeInBytes,
+		const FileLoadStrategy strategy
+) : context_(context), commandQueue_(commandQueue), chunkSizeInBytes_(chunkSizeInBytes), strategy_(strategy) {
+	if (!chunkSizeInBytes) {
+		// let it crash
+		throw std::runtime_error("Failed to create file loader: the chunk size is 0");
+	}
+}
+
+[[maybe_unused]] FileLoadStatistics FileLoader::load(
+		const std::string &path,
+		const BaseBuffer &destinationDeviceMemory,
+		const size_t destinationOffsetInBytes,
+		size_t fileOffsetInBytes,
+		size_t numBytes
+) {
+	const auto start = std::chrono::steady_clock::now();
+	const FileDescriptor file(path);
+	struct stat status{};
+	if (fstat(file, &status)) {
+		// let it crash
+		throw std::runtime_error("Failed to query the size of " + path + ": " + getSystemErrorDescription());
+	}
+	const auto fileSize = static_cast<size_t>(status.st_size);
+	fileOffsetInBytes = std::min(fileOffsetInBytes, fileSize);
+	numBytes = std::min(numBytes, fileSize - fileOffsetInBytes);
+
+	bool isMemoryMapped = false;
+	if (numBytes) {
+		if (strategy_ != FileLoadStrategy::StagedRead) {
+			isMemoryMapped = loadMemoryMapped(
+					file,
+					destinationDeviceMemory,
+					destinationOffsetInBytes,
+					fileOffsetInBytes,
+					numBytes
+			);
+		}
+		if (!isMemoryMapped) {
+			if (strategy_ == FileLoadStrategy::MemoryMapped) {
+				// let it crash
+				throw std::runtime_error("Failed to map " + path + ": " + getSystemErrorDescription());
+			}
+			loadStaged(file, destinationDeviceMemory, destinationOffsetInBytes, fileOffsetInBytes, numBytes);
+		}
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return {
+			numBytes,
+			seconds,
+			seconds > 0.0 ? static_cast<double>(numBytes) / seconds / 1e6 : 0.0,
+			isMemoryMapped
+	};
+}
+
+[[maybe_unused]] size_t FileLoader::getFileSize(const std::string &path) {
+	struct stat status{};
+	if (stat(path.c_str(), &status)) {
+		// let it crash
+		throw std::runtime_error("Failed to query the size of " + path + ": " + getSystemErrorDescription());
+	}
+	return static_cast<size_t>(status.st_size);
+}
+
+bool FileLoader::loadMemoryMapped(
+		const int fileDescriptor,
+		const BaseBuffer &destinationDeviceMemory,
+		const size_t destinationOffsetInBytes,
+		const size_t fileOffsetInBytes,
+		const size_t numBytes
+) {
+	const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	const size_t mappingOffset = fileOffsetInBytes - fileOffsetInBytes % pageSize;
+	const size_t leadingBytes = fileOffsetInBytes - mappingOffset;
+	const size_t mappingSize = leadingBytes + numBytes;
+	void *mapping = mmap(
+			nullptr,
+			mappingSize,
+			PROT_READ,
+			MAP_PRIVATE,
+			fileDescriptor,
+			static_cast<off_t>(mappingOffset)
+	);
+	if (mapping == MAP_FAILED) {
+		return false;
+	}
+	auto *const mappingStart = static_cast<char *>(mapping);
+	madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+
+	// advises the kernel about the pages of a range of the requested bytes
+	const auto advise = [&](const size_t begin, const size_t end, const int advice, const bool isInner) {
+		const auto roundDown = [pageSize](const size_t offset) { return offset / pageSize * pageSize; };
+		const auto roundUp = [pageSize](const size_t offset) { return (offset + pageSize - 1) / pageSize * pageSize; };
+		// inner ranges must not touch pages shared with neighbouring chunks which are still pending
+		const size_t alignedBegin = isInner ? roundUp(leadingBytes + begin) : roundDown(leadingBytes + begin);
+		const size_t alignedEnd = isInner ? roundDown(leadingBytes + end) : std::min(roundUp(leadingBytes + end),
+																				  mappingSize);
+		if (alignedBegin < alignedEnd) {
+			madvise(mappingStart + alignedBegin, alignedEnd - alignedBegin, advice);
+		}
+	};
+
+	// pairs of pending copies and the ranges they read
+	std::deque<std::pair<cl_event, std::pair<size_t, size_t>>> pendingCopies;
+	try {
+		for (size_t offset = 0; offset < numBytes; offset += chunkSizeInBytes_) {
+			const size_t size = std::min(chunkSizeInBytes_, numBytes - offset);
+			// the disk reads the next chunk ahead while the current one is copied
+			if (offset + size < numBytes) {
+				advise(offset + size, std::min(offset + size + chunkSizeInBytes_, numBytes), MADV_WILLNEED, false);
+			}
+			pendingCopies.emplace_back(
+					enqueueWrite(
+							commandQueue_,
+							destinationDeviceMemory,
+							destinationOffsetInBytes + offset,
+							mappingStart + leadingBytes + offset,
+							size
+					),
+					std::make_pair(offset, offset + size)
+			);
+			while (pendingCopies.size() > maxChunksInFlight) {
+				// the copy leaves the queue before it is awaited, so a failure never awaits its released event again
+				const auto pendingCopy = pendingCopies.front();
+				pendingCopies.pop_front();
+				awaitEvent(pendingCopy.first);
+				// the copied pages are dropped from the mapping, so the resident memory stays at a few chunks
+				advise(pendingCopy.second.first, pendingCopy.second.second, MADV_DONTNEED, true);
+			}
+		}
+		while (!pendingCopies.empty()) {
+			const cl_event pendingCopy = pendingCopies.front().first;
+			pendingCopies.pop_front();
+			awaitEvent(pendingCopy);
+		}
+	} catch (...) {
+		// the device must not read the mapping after it is gone
+		for (const auto &pendingCopy: pendingCopies) {
+			awaitEvent(pendingCopy.first, false);
+		}
+		munmap(mapping, mappingSize);
+		throw;
+	}
+	munmap(mapping, mappingSize);
+	return true;
+}
+
+void FileLoader::loadStaged(
+		const int fileDescriptor,
+		const BaseBuffer &destinationDeviceMemory,
+		const size_t destinationOffsetInBytes,
+		const size_t fileOffsetInBytes,
+		const size_t numBytes
+) {
+#if defined(POSIX_FADV_SEQUENTIAL)
+	posix_fadvise(
+			fileDescriptor,
+			static_cast<off_t>(fileOffsetInBytes),
+			static_cast<off_t>(numBytes),
+			POSIX_FADV_SEQUENTIAL
+	);
+#endif
+	const size_t stagingSize = std::min(chunkSizeInBytes_, numBytes);
+	const StagingBuffer stagingBuffers[maxChunksInFlight] = {
+			StagingBuffer(context_, stagingSize, CL_MEM_READ_ONLY),
+			StagingBuffer(context_, stagingSize, CL_MEM_READ_ONLY)
+	};
+	char *stagingMemory[maxChunksInFlight] = {};
+	cl_event pendingCopies[maxChunksInFlight] = {};
+	try {
+		for (size_t i = 0; i < maxChunksInFlight; ++i) {
+			cl_int status;
+			stagingMemory[i] = static_cast<char *>(clEnqueueMapBuffer(
+					commandQueue_,
+					stagingBuffers[i],
+					CL_TRUE,
+					CL_MAP_WRITE_INVALIDATE_REGION,
+					0,
+					stagingSize,
+					0,
+					nullptr,
+					nullptr,
+					&status
+			));
+			if (status) {
+				// let it crash
+				throw std::runtime_error("Failed to map the staging buffer: " + toErrorDescription(status));
+			}
+		}
+
+		for (size_t offset = 0, chunk = 0; offset < numBytes; offset += chunkSizeInBytes_, ++chunk) {
+			const size_t size = std::min(chunkSizeInBytes_, numBytes - offset);
+			const size_t index = chunk % maxChunksInFlight;
+			if (pendingCopies[index]) {
+				const cl_event pendingCopy = pendingCopies[index];
+				pendingCopies[index] = nullptr;
+				awaitEvent(pendingCopy);
+			}
+			// the disk reads into one staging buffer while the device copies from the other
+			readFully(fileDescriptor, stagingMemory[index], size, fileOffsetInBytes + offset);
+			pendingCopies[index] = enqueueWrite(
+					commandQueue_,
+					destinationDeviceMemory,
+					destinationOffsetInBytes + offset,
+					stagingMemory[index],
+					size
+			);
+		}
+		for (auto &pendingCopy: pendingCopies) {
+			if (pendingCopy) {
+				const cl_event event = pendingCopy;
+				pendingCopy = nullptr;
+				awaitEvent(event);
+			}
+		}
+	} catch (...) {
+		for (const auto pendingCopy: pendingCopies) {
+			if (pendingCopy) {
+				awaitEvent(pendingCopy, false);
+			}
+		}
+		for (size_t i = 0; i < maxChunksInFlight; ++i) {
+			if (stagingMemory[i]) {
+				clEnqueueUnmapMemObject(commandQueue_, stagingBuffers[i], stagingMemory[i], 0, nullptr, nullptr);
+			}
+		}
+		throw;
+	}
+	for (size_t i = 0; i < maxChunksInFlight; ++i) {
+		commandQueue_.enqueueCommandUnmapMemoryObject(stagingBuffers[i], stagingMemory[i]);
+	}
+	commandQueue_.finish();
+}
@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#include "opencl/gemm.h"
+#include "opencl/device_info.h"
+#include "opencl/program_registry.h"
+#include "gemm_kernels.h"
+
+using namespace OpenClToolkit;
+
+namespace {
+	/**
+	 * The autotuned tilings of the current process per device and precision.
+	 */
+	std::map<std::pair<cl_device_id, GemmPrecision>, GemmTileConfiguration> tunedConfigurations;
+
+	/**
+	 * Guards the autotuned tilings.
+	 */
+	std::mutex tunedConfigurationsMutex;
+}
+
+size_t GemmTileConfiguration::getWorkGroupSize() const {
+	return (tileM / workPerThreadM) * (tileN / workPerThreadN);
+}
+
+size_t GemmTileConfiguration::getLocalMemorySizeInBytes() const {
+	return (tileM * tileK + tileK * tileN) * sizeof(cl_float);
+}
+
+std::string GemmTileConfiguration::toBuildOptions() const {
+	return "-DTILE_M=" + std::to_string(tileM) +
+		   " -DTILE_N=" + std::to_string(tileN) +
+		   " -DTILE_K=" + std::to_string(tileK) +
+		   " -DWPT_M=" + std::to_string(workPerThreadM) +
+		   " -DWPT_N=" + std::to_string(workPerThreadN) +
+		   " -DVECTOR_WIDTH=" + std::to_string(vectorWidth);
+}
+
+[[maybe_unused]] Gemm::Gemm(
+		const Context &context,
+		cl_device_id device,
+		CommandQueue &commandQueue,
+		const GemmPrecision precision
+) : context_(context), device_(device), commandQueue_(commandQueue), precision_(precision), configuration_() {
+	GemmTileConfiguration configuration{};
+	bool isTuned;
+	{
+		std::lock_guard<std::mutex> lock(tunedConfigurationsMutex);
+		const auto iterator = tunedConfigurations.find({device, precision});
+		isTuned = iterator != tunedConfigurations.end();
+		if (isTuned) {
+			configuration = iterator->second;
+		}
+	}
+	if (!isTuned) {
+		const auto candidates = getCandidateTileConfigurations();
+		if (candidates.empty()) {
+			// let it crash
+			throw std::runtime_error("Cannot create GEMM: no tiling fits the work group size and local memory");
+		}
+		configuration = candidates.front();
+	}
+	useTileConfiguration(configuration);
+}
+
+[[maybe_unused]] void Gemm::multiply(
+		const size_t m,
+		const size_t n,
+		const size_t k,
+		const float alpha,
+		const BaseBuffer &a,
+		const BaseBuffer &b,
+		const float beta,
+		const BaseBuffer &c
+) {
+	if (!m || !n) {
+		return;
+	}
+	if (m > std::numeric_limits<cl_uint>::max() || n > std::numeric_limits<cl_uint>::max() ||
+		k > std::numeric_limits<cl_uint>::max()) {
+		// let it crash
+		throw std::runtime_error("Cannot multiply: the matrix dimensions exceed 2^32 - 1");
+	}
+
+	const auto argM = static_cast<cl_uint>(m);
+	const auto argN = static_cast<cl_uint>(n);
+	const auto argK = static_cast<cl_uint>(k);
+	kernel_->setKernelArg(0, sizeof(cl_uint), &argM);
+	kernel_->setKernelArg(1, sizeof(cl_uint), &argN);
+	kernel_->setKernelArg(2, sizeof(cl_uint), &argK);
+	kernel_->setKernelArg(3, sizeof(cl_float), &alpha);
+	kernel_->setKernelArg(4, sizeof(cl_mem), a);
+	kernel_->setKernelArg(5, sizeof(cl_mem), b);
+	kernel_->setKernelArg(6, sizeof(cl_float), &beta);
+	kernel_->setKernelArg(7, sizeof(cl_mem), c);
+
+	const size_t threadsM = configuration_.tileM / configuration_.workPerThreadM;
+	const size_t threadsN = configuration_.tileN / configuration_.workPerThreadN;
+	const size_t numTilesM = (m + configuration_.tileM - 1) / configuration_.tileM;
+	const size_t numTilesN = (n + configuration_.tileN - 1) / configuration_.tileN;
+	commandQueue_.enqueueCommandExecuteProgramOnDevice(
+			*kernel_,
+			NDRange(numTilesN * threadsN, numTilesM * threadsM),
+			NDRange(threadsN, threadsM)
+	);
+}
+
+[[maybe_unused]] GemmTileConfiguration Gemm::autotune(const size_t m, const size_t n, const size_t k) {
+	const size_t elementSize = precision_ == GemmPrecision::Half ? sizeof(cl_half) : sizeof(cl_float);
+	ReadWriteBuffer a(context_, m * k * elementSize);
+	ReadWriteBuffer b(context_, k * n * elementSize);
+	ReadWriteBuffer c(context_, m * n * elementSize);
+	const cl_uchar zero = 0;
+	commandQueue_.enqueueCommandFillDeviceMemory(a, &zero, 1, m * k * elementSize);
+	commandQueue_.enqueueCommandFillDeviceMemory(b, &zero, 1, k * n * elementSize);
+
+	GemmTileConfiguration fastest = configuration_;
+	auto fastestDuration = std::chrono::steady_clock::duration::max();
+	for (const auto &candidate: getCandidateTileConfigurations()) {
+		try {
+			useTileConfiguration(candidate);
+			// the first run includes one-time costs of the driver
+			multiply(m, n, k, 1.0f, a, b, 0.0f, c);
+			commandQueue_.finish();
+			const auto start = std::chrono::steady_clock::now();
+			for (int run = 0; run < 3; ++run) {
+				multiply(m, n, k, 1.0f, a, b, 0.0f, c);
+			}
+			commandQueue_.finish();
+			const auto duration = std::chrono::steady_clock::now() - start;
+			if (duration < fastestDuration) {
+				fastestDuration = duration;
+				fastest = candidate;
+			}
+		} catch (const std::runtime_error &) {
+			// the candidate does not build or launch on the device, e.g. it exceeds the registers
+		}
+	}
+
+	useTileConfiguration(fastest);
+	std::lock_guard<std::mutex> lock(tunedConfigurationsMutex);
+	tunedConfigurations[{device_, precision_}] = fastest;
+	return fastest;
+}
+
+[[maybe_unused]] const GemmTileConfiguration &Gemm::getTileConfiguration() const {
+	return configuration_;
+}
+
+void Gemm::useTileConfiguration(const GemmTileConfiguration &configuration) {
+	std::string buildOptions = configuration.toBuildOptions();
+	if (precision_ == GemmPrecision::Half) {
+		buildOptions += " -DUSE_HALF_STORAGE";
+	}
+	const auto program = ProgramRegistry::getInstance().acquire(
+			gemmKernelSourceCode,
+			"gemm",
+			context_,
+			device_,
+			buildOptions
+	);
+	kernel_ = std::make_unique<Program>(*program, "gemm");
+	configuration_ = configuration;
+}
+
+std::vector<GemmTileConfiguration> Gemm::getCandidateTileConfigurations() const {
+	const DeviceInfo &info = DeviceInfo::get(device_);
+	size_t vectorWidth = 1;
+	while (vectorWidth < 8 && vectorWidth < info.preferredVectorWidthFloat) {
+		vectorWidth *= 2;
+	}
+	// CPUs vectorize across work items and have no dedicated local memory, so small tiles keep the working set in L1
+	const std::vector<GemmTileConfiguration> preferred = info.isCpu() || !info.hasDedicatedLocalMemory ?
+			std::vector<GemmTileConfiguration>{
+					{32, 32, 16, 4, 4, std::max<size_t>(vectorWidth, 4)},
+					{64, 64, 16, 8, 8, std::max<size_t>(vectorWidth, 4)},
+					{16, 16, 16, 2, 2, 4},
+					{16, 16, 8, 1, 1, 1}
+			} :
+			std::vector<GemmTileConfiguration>{
+					{64, 64, 16, 4, 4, 4},
+					{128, 64, 16, 8, 4, 4},
+					{64, 64, 8, 4, 4, 4},
+					{32, 32, 16, 2, 2, 4},
+					{32, 32, 8, 2, 2, 2},
+					{16, 16, 8, 1, 1, 1}
+			};
+
+	std::vector<GemmTileConfiguration> candidates;
+	for (auto configuration: preferred) {
+		configuration.vectorWidth = std::min<size_t>(configuration.vectorWidth, 8);
+		const bool fits = configuration.getWorkGroupSize() <= info.maxWorkGroupSize &&
+						  configuration.tileN / configuration.workPerThreadN <= info.maxWorkItemSizes[0] &&
+						  configuration.tileM / configuration.workPerThreadM <= info.maxWorkItemSizes[1] &&
+						  configuration.getLocalMemorySizeInBytes() <= info.localMemorySize &&
+						  configuration.tileK % configuration.vectorWidth == 0 &&
+						  configuration.tileN % configuration.vectorWidth == 0;
+		if (fits) {
+			candidates.push_back(configuration);
+		}
+	}
+	return candidates;
+}
@@ -0,0 +1,140 @@
+#ifndef OPENCL_TOOLKIT_GEMM_KERNELS_H
+#define OPENCL_TOOLKIT_GEMM_KERNELS_H
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief The source code of the matrix multiplication kernel C = alpha * A * B + beta * C for row-major matrices.
+	 * @details The tiling is specialized by the build options:
+	 * <ul>
+	 *     <li><code>TILE_M</code>, <code>TILE_N</code>, <code>TILE_K</code>: the tile of C computed by a work group
+	 *     and the depth of the tiles of A and B staged in local memory</li>
+	 *     <li><code>WPT_M</code>, <code>WPT_N</code>: the elements of C computed by a work item (register tile)</li>
+	 *     <li><code>VECTOR_WIDTH</code>: the width of the vector loads of interior tiles (1, 2, 4 or 8)</li>
+	 *     <li><code>USE_HALF_STORAGE</code>: if defined, the matrices are stored as <code>half</code> and converted
+	 *     to <code>float</code> on load, so no <code>cl_khr_fp16</code> support is required</li>
+	 * </ul>
+	 * The work group size is (TILE_N / WPT_N, TILE_M / WPT_M).
+	 */
+	inline constexpr const char *gemmKernelSourceCode = R"CLC(
+#define THREADS_M (TILE_M / WPT_M)
+#define THREADS_N (TILE_N / WPT_N)
+#define CAT_(a, b) a##b
+#define CAT(a, b) CAT_(a, b)
+
+#if defined(USE_HALF_STORAGE)
+#define STORAGE half
+#define LOAD(index, p) vload_half(index, p)
+#define LOAD_VECTOR(index, p) CAT(vload_half, VECTOR_WIDTH)(index, p)
+#define STORE(value, index, p) vstore_half(value, index, p)
+#else
+#define STORAGE float
+#define LOAD(index, p) ((p)[index])
+#define LOAD_VECTOR(index, p) CAT(vload, VECTOR_WIDTH)(index, p)
+#define STORE(value, index, p) ((p)[index] = (value))
+#endif
+#define STORE_VECTOR(value, p) CAT(vstore, VECTOR_WIDTH)(value, 0, p)
+
+__kernel __attribute__((reqd_work_group_size(THREADS_N, THREADS_M, 1)))
+void gemm(
+		const uint M,
+		const uint N,
+		const uint K,
+		const float alpha,
+		__global const STORAGE *A,
+		__global const STORAGE *B,
+		const float beta,
+		__global STORAGE *C
+) {
+	__local float tileA[TILE_M][TILE_K];
+	__local float tileB[TILE_K][TILE_N];
+
+	const uint threadN = get_local_id(0);
+	const uint threadM = get_local_id(1);
+	const uint threadId = threadM * THREADS_N + threadN;
+	const uint offsetM = get_group_id(1) * TILE_M;
+	const uint offsetN = get_group_id(0) * TILE_N;
+
+	float accumulators[WPT_M][WPT_N];
+	for (uint m = 0; m < WPT_M; ++m) {
+		for (uint n = 0; n < WPT_N; ++n) {
+			accumulators[m][n] = 0.0f;
+		}
+	}
+
+	for (uint offsetK = 0; offsetK < K; offsetK += TILE_K) {
+#if VECTOR_WIDTH > 1
+		// interior tiles of matrices whose rows consist of whole vectors are staged with vector loads
+		const bool isInterior = offsetM + TILE_M <= M && offsetN + TILE_N <= N && offsetK + TILE_K <= K &&
+								K % VECTOR_WIDTH == 0 && N % VECTOR_WIDTH == 0;
+		if (isInterior) {
+			for (uint i = threadId; i < TILE_M * TILE_K / VECTOR_WIDTH; i += THREADS_M * THREADS_N) {
+				const uint row = i / (TILE_K / VECTOR_WIDTH);
+				const uint column = (i % (TILE_K / VECTOR_WIDTH)) * VECTOR_WIDTH;
+				const size_t index = ((size_t) (offsetM + row) * K + offsetK + column) / VECTOR_WIDTH;
+				STORE_VECTOR(LOAD_VECTOR(index, A), &tileA[row][column]);
+			}
+			for (uint i = threadId; i < TILE_K * TILE_N / VECTOR_WIDTH; i += THREADS_M * THREADS_N) {
+				const uint row = i / (TILE_N / VECTOR_WIDTH);
+				const uint column = (i % (TILE_N / VECTOR_WIDTH)) * VECTOR_WIDTH;
+				const size_t index = ((size_t) (offsetK + row) * N + offsetN + column) / VECTOR_WIDTH;
+				STORE_VECTOR(LOAD_VECTOR(index, B), &tileB[row][column]);
+			}
+		} else
+#endif
+		{
+			// border tiles are padded with zeros
+			for (uint i = threadId; i < TILE_M * TILE_K; i += THREADS_M * THREADS_N) {
+				const uint row = offsetM + i / TILE_K;
+				const uint column = offsetK + i % TILE_K;
+				tileA[i / TILE_K][i % TILE_K] = row < M && column < K ? LOAD((size_t) row * K + column, A) : 0.0f;
+			}
+			for (uint i = threadId; i < TILE_K * TILE_N; i += THREADS_M * THREADS_N) {
+				const uint row = offsetK + i / TILE_N;
+				const uint column = offsetN + i % TILE_N;
+				tileB[i / TILE_N][i % TILE_N] = row < K && column < N ? LOAD((size_t) row * N + column, B) : 0.0f;
+			}
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+
+		for (uint k = 0; k < TILE_K; ++k) {
+			float registersA[WPT_M];
+			float registersB[WPT_N];
+			for (uint m = 0; m < WPT_M; ++m) {
+				registersA[m] = tileA[threadM + m * THREADS_M][k];
+			}
+			for (uint n = 0; n < WPT_N; ++n) {
+				registersB[n] = tileB[k][threadN + n * THREADS_N];
+			}
+			for (uint m = 0; m < WPT_M; ++m) {
+				for (uint n = 0; n < WPT_N; ++n) {
+					accumulators[m][n] = mad(registersA[m], registersB[n], accumulators[m][n]);
+				}
+			}
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+
+	// the strided mapping of the register tile keeps the stores of neighbouring work items contiguous
+	for (uint m = 0; m < WPT_M; ++m) {
+		const uint row = offsetM + threadM + m * THREADS_M;
+		for (uint n = 0; n < WPT_N; ++n) {
+			const uint column = offsetN + threadN + n * THREADS_N;
+			if (row < M && column < N) {
+				const size_t index = (size_t) row * N + column;
+				float value = alpha * accumulators[m][n];
+				if (beta != 0.0f) {
+					value = mad(beta, LOAD(index, C), value);
+				}
+				STORE(value, index, C);
+			}
+		}
+	}
+}
+)CLC";
+}
+
+#endif //OPENCL_TOOLKIT_GEMM_KERNELS_H
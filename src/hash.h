@@ -0,0 +1,45 @@
+#ifndef OPENCL_TOOLKIT_HASH_H
+#define OPENCL_TOOLKIT_HASH_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Computes the 64-bit FNV-1a hash of the passed bytes.
+	 * @details Unlike <code>std::hash</code>, the result is stable across processes, standard libraries and
+	 * platforms, so it can be used for keys which are persisted on disk.
+	 * @param bytes the bytes to be hashed.
+	 * @param seed an optional hash value of previous bytes to continue hashing from.
+	 * @return the 64-bit FNV-1a hash of the passed bytes.
+	 */
+	inline uint64_t fnv1a64(std::string_view bytes, uint64_t seed = 0xcbf29ce484222325ULL) {
+		uint64_t hash = seed;
+		for (const char byte: bytes) {
+			hash ^= static_cast<unsigned char>(byte);
+			hash *= 0x100000001b3ULL;
+		}
+		return hash;
+	}
+
+	/**
+	 * @brief Converts the passed hash value into a fixed-width hexadecimal string.
+	 * @param hash the hash value to be converted.
+	 * @return the passed hash value as a 16-character hexadecimal string.
+	 */
+	inline std::string toHexString(uint64_t hash) {
+		static constexpr char digits[] = "0123456789abcdef";
+		std::string hex(16, '0');
+		for (size_t i = 16; i-- > 0; hash >>= 4) {
+			hex[i] = digits[hash & 0xf];
+		}
+		return hex;
+	}
+}
+
+#endif //OPENCL_TOOLKIT_HASH_H
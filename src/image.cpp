@@ -0,0 +1,161 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "opencl/image.h"
+#include "opencl/command_recorder.h"
+#include "opencl/error.h"
+#include "opencl/memory_manager.h"
+#include "opencl/metrics_collector.h"
+
+using namespace OpenClToolkit;
+
+namespace {
+	/**
+	 * @brief Returns the size of a pixel of the passed format, so an image is charged to the memory budget before it
+	 * is created.
+	 * @param format the channel order and data type.
+	 * @return the size of a pixel in bytes.
+	 */
+	size_t toPixelSizeInBytes(const cl_image_format &format) {
+		size_t channelSizeInBytes;
+		switch (format.image_channel_data_type) {
+			// packed types store all channels of a pixel in one value
+			case CL_UNORM_SHORT_565:
+			case CL_UNORM_SHORT_555:
+				return 2;
+			case CL_UNORM_INT_101010:
+			case CL_UNORM_INT_101010_2:
+				return 4;
+			case CL_SNORM_INT8:
+			case CL_UNORM_INT8:
+			case CL_SIGNED_INT8:
+			case CL_UNSIGNED_INT8:
+				channelSizeInBytes = 1;
+				break;
+			case CL_SNORM_INT16:
+			case CL_UNORM_INT16:
+			case CL_SIGNED_INT16:
+			case CL_UNSIGNED_INT16:
+			case CL_HALF_FLOAT:
+				channelSizeInBytes = 2;
+				break;
+			case CL_SIGNED_INT32:
+			case CL_UNSIGNED_INT32:
+			case CL_FLOAT:
+				channelSizeInBytes = 4;
+				break;
+			default:
+				// let it crash
+				throw std::runtime_error("Failed to create image: unknown channel data type " +
+										 std::to_string(format.image_channel_data_type));
+		}
+		switch (format.image_channel_order) {
+			case CL_R:
+			case CL_A:
+			case CL_Rx:
+			case CL_INTENSITY:
+			case CL_LUMINANCE:
+			case CL_DEPTH:
+				return channelSizeInBytes;
+			case CL_RG:
+			case CL_RA:
+			case CL_RGx:
+				return 2 * channelSizeInBytes;
+			case CL_RGB:
+			case CL_RGBx:
+			case CL_sRGB:
+			case CL_sRGBx:
+				return 3 * channelSizeInBytes;
+			case CL_RGBA:
+			case CL_BGRA:
+			case CL_ARGB:
+			case CL_ABGR:
+			case CL_sRGBA:
+			case CL_sBGRA:
+				return 4 * channelSizeInBytes;
+			default:
+				// let it crash
+				throw std::runtime_error("Failed to create image: unknown channel order " +
+										 std::to_string(format.image_channel_order));
+		}
+	}
+}
+
+[[maybe_unused]] Image::Image(
+		const Context &context,
+		const cl_image_format &format,
+		const NDRange &size,
+		const cl_mem_flags flags
+) : self_(nullptr),
+	context_(context),
+	format_(format),
+	size_(size),
+	sizeInBytes_(toPixelSizeInBytes(format) * size.getTotalSize()),
+	// images in pinned host memory do not count towards the device budget, like such buffers
+	isAccounted_(!(flags & (CL_MEM_ALLOC_HOST_PTR | CL_MEM_USE_HOST_PTR))) {
+	cl_image_desc descriptor{};
+	switch (size.numDimensions) {
+		case 1:
+			descriptor.image_type = CL_MEM_OBJECT_IMAGE1D;
+			break;
+		case 2:
+			descriptor.image_type = CL_MEM_OBJECT_IMAGE2D;
+			break;
+		default:
+			descriptor.image_type = CL_MEM_OBJECT_IMAGE3D;
+			break;
+	}
+	descriptor.image_width = size.sizes[0];
+	descriptor.image_height = size.numDimensions > 1 ? size.sizes[1] : 0;
+	descriptor.image_depth = size.numDimensions > 2 ? size.sizes[2] : 0;
+
+	MemoryManager &memoryManager = MemoryManager::getInstance();
+	if (isAccounted_) {
+		memoryManager.reserve(context_, sizeInBytes_);
+	}
+	cl_int status;
+	self_ = clCreateImage(context, flags, &format, &descriptor, nullptr, &status);
+	// the device may hold less than the budget, then evicting the cold buffers makes room
+	if (isAccounted_ && (status == CL_MEM_OBJECT_ALLOCATION_FAILURE || status == CL_OUT_OF_RESOURCES) &&
+		memoryManager.evictAll(context_)) {
+		self_ = clCreateImage(context, flags, &format, &descriptor, nullptr, &status);
+	}
+	if (status) {
+		if (isAccounted_) {
+			memoryManager.release(context_, sizeInBytes_);
+		}
+		// let it crash
+		throw std::runtime_error("Failed to create image: " + toErrorDescription(status));
+	}
+	MetricsCollector::getInstance().recordAllocation(context, sizeInBytes_);
+	CommandRecorder::getInstance().recordImageAllocation(self_, flags, format, size);
+}
+
+Image::~Image() {
+	CommandRecorder::getInstance().recordRelease(self_);
+	const cl_int status = clReleaseMemObject(self_);
+	if (status) {
+		std::cerr << "Failed to release image: " + toErrorDescription(status) << std::endl;
+	}
+	if (isAccounted_) {
+		MemoryManager::getInstance().release(context_, sizeInBytes_);
+	}
+	MetricsCollector::getInstance().recordRelease(context_, sizeInBytes_);
+}
+
+[[maybe_unused]] const cl_image_format &Image::getFormat() const {
+	return format_;
+}
+
+[[maybe_unused]] const NDRange &Image::getSize() const {
+	return size_;
+}
+
+[[maybe_unused]] size_t Image::getPixelSizeInBytes() const {
+	return toPixelSizeInBytes(format_);
+}
+
+Image::operator cl_mem() const {
+	return self_;
+}
@@ -0,0 +1,248 @@
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "opencl/kernel_library.h"
+#include "opencl/error.h"
+#include "opencl/metrics_collector.h"
+#include "build_log.h"
+#include "device_query.h"
+#include "hash.h"
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace OpenClToolkit;
+
+namespace {
+	/**
+	 * @brief Returns a name for a temporary file which is unique across the processes and threads sharing a cache
+	 * directory.
+	 * @return the process id and a process-wide counter.
+	 */
+	std::string createUniqueTemporarySuffix() {
+		static std::atomic<uint64_t> counter{0};
+#if defined(_WIN32)
+		const auto processId = static_cast<uint64_t>(_getpid());
+#else
+		const auto processId = static_cast<uint64_t>(getpid());
+#endif
+		return ".tmp" + toHexString(processId) + "-" + toHexString(counter++);
+	}
+}
+
+[[maybe_unused]] KernelLibrary::KernelLibrary(
+		const Context &context,
+		const std::vector<KernelHeader> &headers,
+		std::string librarySourceCode,
+		std::string compileOptions,
+		std::string cacheDirectory
+) : context_(context),
+	librarySourceCode_(std::move(librarySourceCode)),
+	compileOptions_(std::move(compileOptions)),
+	cacheDirectory_(std::move(cacheDirectory)) {
+	headerPrograms_.reserve(headers.size());
+	headers_.reserve(headers.size());
+	for (const auto &header: headers) {
+		cl_int status;
+		const char *sourceCode = header.sourceCode.c_str();
+		cl_program headerProgram = clCreateProgramWithSource(context_, 1, &sourceCode, nullptr, &status);
+		if (status) {
+			for (auto program: headerPrograms_) {
+				clReleaseProgram(program);
+			}
+			// let it crash
+			throw std::runtime_error(
+					"Cannot create the program of the header '" + header.name + "': " + toErrorDescription(status)
+			);
+		}
+		headerPrograms_.push_back(headerProgram);
+		headers_.push_back(header);
+	}
+}
+
+KernelLibrary::~KernelLibrary() {
+	for (const auto &[device, compiledObject]: compiledObjects_) {
+		const cl_int status = clReleaseProgram(compiledObject);
+		if (status) {
+			std::cerr << "Failed to release compiled library object. " + toErrorDescription(status) << std::endl;
+		}
+	}
+	for (auto headerProgram: headerPrograms_) {
+		const cl_int status = clReleaseProgram(headerProgram);
+		if (status) {
+			std::cerr << "Failed to release header program. " + toErrorDescription(status) << std::endl;
+		}
+	}
+}
+
+cl_program KernelLibrary::getCompiledObject(cl_device_id device) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	const auto iterator = compiledObjects_.find(device);
+	MetricsCollector &metrics = MetricsCollector::getInstance();
+	metrics.recordCacheLookup("kernel_library", iterator != compiledObjects_.end());
+	if (iterator != compiledObjects_.end()) {
+		return iterator->second;
+	}
+
+	cl_program compiledObject = cacheDirectory_.empty() ? nullptr : loadFromDiskCache(device);
+	if (!cacheDirectory_.empty()) {
+		metrics.recordCacheLookup("kernel_library_disk", compiledObject != nullptr);
+	}
+	if (!compiledObject) {
+		const auto buildStart = std::chrono::steady_clock::now();
+		compiledObject = compile(librarySourceCode_, device);
+		metrics.recordBuild(
+				"library",
+				std::chrono::duration<double>(std::chrono::steady_clock::now() - buildStart).count()
+		);
+		if (!cacheDirectory_.empty()) {
+			storeInDiskCache(device, compiledObject);
+		}
+	}
+	compiledObjects_.emplace(device, compiledObject);
+	return compiledObject;
+}
+
+[[maybe_unused]] const std::vector<KernelHeader> &KernelLibrary::getHeaders() const {
+	return headers_;
+}
+
+[[maybe_unused]] const std::string &KernelLibrary::getSourceCode() const {
+	return librarySourceCode_;
+}
+
+[[maybe_unused]] const std::string &KernelLibrary::getCompileOptions() const {
+	return compileOptions_;
+}
+
+cl_program KernelLibrary::compile(
+		const std::string &sourceCode,
+		cl_device_id device,
+		const std::string &compileOptions
+) const {
+	cl_int status;
+	const char *source = sourceCode.c_str();
+	cl_program program = clCreateProgramWithSource(context_, 1, &source, nullptr, &status);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Cannot create OpenCL-program: " + toErrorDescription(status));
+	}
+
+	std::vector<const char *> headerNames;
+	headerNames.reserve(headers_.size());
+	for (const auto &header: headers_) {
+		headerNames.push_back(header.name.c_str());
+	}
+	const std::string options = compileOptions.empty() ? compileOptions_ : compileOptions_ + " " + compileOptions;
+	status = clCompileProgram(
+			program,
+			1,
+			&device,
+			options.c_str(),
+			static_cast<cl_uint>(headerPrograms_.size()),
+			headerPrograms_.empty() ? nullptr : headerPrograms_.data(),
+			headerNames.empty() ? nullptr : headerNames.data(),
+			nullptr,
+			nullptr
+	);
+	if (status) {
+		std::cerr << "There were problems while compiling the program: " << std::endl
+				  << getBuildLog(program, device) << std::endl;
+		clReleaseProgram(program);
+		// let it crash
+		throw std::runtime_error("Cannot compile OpenCL-program: " + toErrorDescription(status));
+	}
+	return program;
+}
+
+std::string KernelLibrary::getCacheFilePath(cl_device_id device) const {
+	// the compiled object depends on the sources, the options and the exact device and driver
+	uint64_t hash = fnv1a64(librarySourceCode_);
+	for (const auto &header: headers_) {
+		hash = fnv1a64(header.name, hash);
+		hash = fnv1a64(header.sourceCode, hash);
+	}
+	hash = fnv1a64(compileOptions_, hash);
+	hash = fnv1a64(queryDeviceString(device, CL_DEVICE_NAME), hash);
+	hash = fnv1a64(queryDeviceString(device, CL_DEVICE_VERSION), hash);
+	hash = fnv1a64(queryDeviceString(device, CL_DRIVER_VERSION), hash);
+	return (std::filesystem::path(cacheDirectory_) / (toHexString(hash) + ".clobj")).string();
+}
+
+cl_program KernelLibrary::loadFromDiskCache(cl_device_id device) const {
+	std::ifstream file(getCacheFilePath(device), std::ios::binary);
+	if (!file) {
+		return nullptr;
+	}
+	const std::vector<unsigned char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (binary.empty()) {
+		return nullptr;
+	}
+
+	const unsigned char *binaryData = binary.data();
+	const size_t binarySize = binary.size();
+	cl_int binaryStatus;
+	cl_int status;
+	cl_program program = clCreateProgramWithBinary(
+			context_,
+			1,
+			&device,
+			&binarySize,
+			&binaryData,
+			&binaryStatus,
+			&status
+	);
+	if (status || binaryStatus) {
+		// e.g. a driver update invalidated the binary, so recompile
+		if (program) {
+			clReleaseProgram(program);
+		}
+		return nullptr;
+	}
+	return program;
+}
+
+void KernelLibrary::storeInDiskCache(cl_device_id device, cl_program compiledObject) const {
+	size_t binarySize = 0;
+	cl_int status = clGetProgramInfo(compiledObject, CL_PROGRAM_BINARY_SIZES, sizeof(size_t), &binarySize, nullptr);
+	if (status || !binarySize) {
+		std::cerr << "Failed to cache compiled library: cannot query the binary size. " + toErrorDescription(status)
+				  << std::endl;
+		return;
+	}
+	std::vector<unsigned char> binary(binarySize);
+	unsigned char *binaryData = binary.data();
+	status = clGetProgramInfo(compiledObject, CL_PROGRAM_BINARIES, sizeof(unsigned char *), &binaryData, nullptr);
+	if (status) {
+		std::cerr << "Failed to cache compiled library: cannot query the binary. " + toErrorDescription(status)
+				  << std::endl;
+		return;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(cacheDirectory_, error);
+	const std::string path = getCacheFilePath(device);
+	// write to a temporary file first, so concurrent processes never read a partially written binary
+	const std::string temporaryPath = path + createUniqueTemporarySuffix();
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char *>(binary.data()), static_cast<std::streamsize>(binary.size()));
+		file.close();
+		if (!file) {
+			std::cerr << "Failed to cache compiled library: cannot write '" + temporaryPath + "'" << std::endl;
+			std::filesystem::remove(temporaryPath, error);
+			return;
+		}
+	}
+	std::filesystem::rename(temporaryPath, path, error);
+	if (error) {
+		std::filesystem::remove(temporaryPath, error);
+	}
+}
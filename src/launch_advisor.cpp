@@ -0,0 +1,281 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "opencl/launch_advisor.h"
+#include "opencl/device_info.h"
+#include "work_group_size.h"
+
+using namespace OpenClToolkit;
+
+namespace {
+	/**
+	 * The max number of work groups which a GPU compute unit holds at the same time, e.g. 16 on NVIDIA and 32
+	 * on AMD GPUs, the lower one is assumed.
+	 */
+	constexpr size_t maxResidentWorkGroupsPerComputeUnit = 16;
+
+	/**
+	 * Private memory per work item in bytes above which spilled registers are expected to slow the kernel down.
+	 */
+	constexpr cl_ulong maxUnsuspiciousPrivateMemorySize = 256;
+
+	/**
+	 * @brief Estimates the number of work items which a compute unit holds at the same time.
+	 * @param device the descriptor of the device.
+	 * @param preferredMultiple the preferred work group size multiple of the kernel, i.e. the warp or wavefront width.
+	 * @param workGroupSize the number of work items per work group.
+	 * @return the estimated number of resident work items per compute unit.
+	 */
+	size_t estimateMaxResidentWorkItems(
+			const DeviceInfo &device,
+			const size_t preferredMultiple,
+			const size_t workGroupSize
+	) {
+		if (device.isCpu()) {
+			// a compute unit is a hardware thread which runs one work group after the other
+			return workGroupSize;
+		}
+		size_t numResidentWarps = 32;
+		if (device.vendor.find("NVIDIA") != std::string::npos) {
+			numResidentWarps = 64;
+		} else if (device.vendor.find("Advanced Micro Devices") != std::string::npos ||
+				   device.vendor.find("AMD") != std::string::npos) {
+			numResidentWarps = 40;
+		} else if (device.vendor.find("Intel") != std::string::npos) {
+			// a compute unit of Intel GPUs is an execution unit with 7 or 8 hardware threads
+			numResidentWarps = 8;
+		}
+		return std::max(numResidentWarps * preferredMultiple, workGroupSize);
+	}
+
+	/**
+	 * @brief Returns the smallest power of two which is not less than the passed value.
+	 * @param value a positive value.
+	 * @return the smallest power of two which is not less than the passed value.
+	 */
+	size_t roundUpToPowerOfTwo(const size_t value) {
+		size_t result = 1;
+		while (result < value) {
+			result *= 2;
+		}
+		return result;
+	}
+
+	/**
+	 * @brief Distributes the work items of a work group over the dimensions of the launch, the first dimension first.
+	 * @param device the descriptor of the device.
+	 * @param globalWorkSize the requested number of work items per dimension.
+	 * @param workGroupSize the number of work items per work group, a power of two.
+	 * @return the number of work items per work group and dimension.
+	 */
+	NDRange toLocalWorkSize(const DeviceInfo &device, const NDRange &globalWorkSize, const size_t workGroupSize) {
+		size_t sizes[3] = {1, 1, 1};
+		size_t remaining = workGroupSize;
+		for (cl_uint dimension = 0; dimension < globalWorkSize.numDimensions; ++dimension) {
+			// the last dimension takes the rest, even if the global work size is padded for it
+			size_t size = dimension + 1 == globalWorkSize.numDimensions ? remaining : std::min(
+					remaining,
+					roundUpToPowerOfTwo(globalWorkSize.sizes[dimension])
+			);
+			while (dimension < device.maxWorkItemSizes.size() && size > device.maxWorkItemSizes[dimension]) {
+				size /= 2;
+			}
+			sizes[dimension] = size;
+			remaining /= size;
+		}
+		switch (globalWorkSize.numDimensions) {
+			case 1:
+				return {sizes[0]};
+			case 2:
+				return {sizes[0], sizes[1]};
+			default:
+				return {sizes[0], sizes[1], sizes[2]};
+		}
+	}
+
+	/**
+	 * @brief Rounds the global work size up to a multiple of the local work size.
+	 * @param globalWorkSize the requested number of work items per dimension.
+	 * @param localWorkSize the number of work items per work group and dimension.
+	 * @return the padded global work size.
+	 */
+	NDRange toPaddedGlobalWorkSize(const NDRange &globalWorkSize, const NDRange &localWorkSize) {
+		NDRange padded = globalWorkSize;
+		for (cl_uint dimension = 0; dimension < globalWorkSize.numDimensions; ++dimension) {
+			const size_t local = localWorkSize.sizes[dimension];
+			padded.sizes[dimension] = (globalWorkSize.sizes[dimension] + local - 1) / local * local;
+		}
+		return padded;
+	}
+
+	/**
+	 * @brief Formats the sizes of a range, e.g. "256x4".
+	 * @param range the range.
+	 * @return the formatted sizes.
+	 */
+	std::string toString(const NDRange &range) {
+		std::string result = std::to_string(range.sizes[0]);
+		for (cl_uint dimension = 1; dimension < range.numDimensions; ++dimension) {
+			result += "x" + std::to_string(range.sizes[dimension]);
+		}
+		return result;
+	}
+}
+
+[[maybe_unused]] LaunchRecommendation LaunchAdvisor::advise(
+		const Program &program,
+		const NDRange &globalWorkSize,
+		const size_t localMemoryBytesPerWorkItem
+) {
+	const DeviceInfo &device = DeviceInfo::get(program.getDevice());
+	KernelResources resources = program.getKernelResources();
+	const size_t preferredMultiple = std::max<size_t>(resources.preferredWorkGroupSizeMultiple, 1);
+	const bool isWorkGroupSizeRequired = resources.compileWorkGroupSize[0] != 0;
+	const size_t computeUnits = std::max<cl_uint>(device.maxComputeUnits, 1);
+	const cl_ulong availableLocalMemory = device.hasDedicatedLocalMemory ? device.localMemorySize : 0;
+
+	// the candidates are the power of two multiples of the preferred multiple, or the required size only
+	std::vector<NDRange> candidates;
+	if (isWorkGroupSizeRequired) {
+		const size_t *required = resources.compileWorkGroupSize;
+		switch (globalWorkSize.numDimensions) {
+			case 1:
+				candidates.emplace_back(required[0]);
+				break;
+			case 2:
+				candidates.emplace_back(required[0], required[1]);
+				break;
+			default:
+				candidates.emplace_back(required[0], required[1], required[2]);
+				break;
+		}
+	} else {
+		const size_t limit = std::min(resources.maxWorkGroupSize, device.maxWorkGroupSize);
+		size_t size = preferredMultiple <= limit ? preferredMultiple : 1;
+		for (; size <= limit; size *= 2) {
+			const cl_ulong localMemory = resources.localMemorySize + localMemoryBytesPerWorkItem * size;
+			if (availableLocalMemory && localMemory > availableLocalMemory && !candidates.empty()) {
+				break;
+			}
+			candidates.push_back(toLocalWorkSize(device, globalWorkSize, size));
+		}
+	}
+
+	// the score is the occupancy reduced by the share of padding work items
+	LaunchRecommendation best{resources, candidates.front(), globalWorkSize, 0, 0, 0, {}};
+	double bestScore = -1;
+	for (const NDRange &candidate: candidates) {
+		const size_t workGroupSize = candidate.getTotalSize();
+		const NDRange padded = toPaddedGlobalWorkSize(globalWorkSize, candidate);
+		const size_t numWorkGroups = padded.getTotalSize() / workGroupSize;
+		const size_t maxResidentWorkItems = estimateMaxResidentWorkItems(device, preferredMultiple, workGroupSize);
+		size_t residentWorkGroups = std::min(maxResidentWorkItems / workGroupSize, maxResidentWorkGroupsPerComputeUnit);
+		const cl_ulong localMemory = resources.localMemorySize + localMemoryBytesPerWorkItem * workGroupSize;
+		if (availableLocalMemory && localMemory) {
+			residentWorkGroups = std::min<size_t>(residentWorkGroups, availableLocalMemory / localMemory);
+		}
+		residentWorkGroups = std::max<size_t>(residentWorkGroups, 1);
+		const size_t workGroupsPerComputeUnit = std::min(
+				residentWorkGroups,
+				(numWorkGroups + computeUnits - 1) / computeUnits
+		);
+		const double occupancy = static_cast<double>(workGroupsPerComputeUnit * workGroupSize) /
+								 static_cast<double>(maxResidentWorkItems);
+		const double score = occupancy * static_cast<double>(globalWorkSize.getTotalSize()) /
+							 static_cast<double>(padded.getTotalSize());
+
+		// near ties are decided by the distance to the work group size of the built-in kernels
+		const auto distance = [](const size_t size) {
+			return std::abs(std::log2(static_cast<double>(size) / static_cast<double>(maxBuiltInWorkGroupSize)));
+		};
+		if (score > bestScore * 1.01 ||
+			(score >= bestScore * 0.99 && distance(workGroupSize) < distance(best.localWorkSize.getTotalSize()))) {
+			bestScore = score;
+			best = LaunchRecommendation{
+					resources,
+					candidate,
+					padded,
+					numWorkGroups,
+					workGroupsPerComputeUnit,
+					occupancy,
+					{}
+			};
+		}
+	}
+
+	const size_t workGroupSize = best.localWorkSize.getTotalSize();
+	const cl_ulong localMemory = resources.localMemorySize + localMemoryBytesPerWorkItem * workGroupSize;
+	std::vector<std::string> &warnings = best.warnings;
+	if (best.numWorkGroups < computeUnits) {
+		warnings.push_back(
+				"the launch of " + std::to_string(best.numWorkGroups) + " work groups leaves " +
+				std::to_string(computeUnits - best.numWorkGroups) + " of " + std::to_string(computeUnits) +
+				" compute units idle, the device is underfilled"
+		);
+	} else if (best.occupancy < 0.5) {
+		warnings.push_back(
+				"the launch occupies only " + std::to_string(static_cast<int>(best.occupancy * 100)) +
+				"% of the resident work items of the device, too few to hide the memory latency"
+		);
+	}
+	if (availableLocalMemory && localMemory > availableLocalMemory) {
+		warnings.push_back(
+				"the work groups need " + std::to_string(localMemory) + " bytes of local memory, but the device has " +
+				std::to_string(availableLocalMemory) + " bytes only"
+		);
+	} else if (availableLocalMemory && localMemory && availableLocalMemory / localMemory < 2) {
+		warnings.push_back(
+				"the " + std::to_string(localMemory) +
+				" bytes of local memory per work group allow only one work group per compute unit"
+		);
+	}
+	if (!device.isCpu() && resources.privateMemorySize > maxUnsuspiciousPrivateMemorySize) {
+		warnings.push_back(
+				"the kernel uses " + std::to_string(resources.privateMemorySize) +
+				" bytes of private memory per work item, which usually means spilled registers"
+		);
+	}
+	if (workGroupSize % preferredMultiple) {
+		warnings.push_back(
+				"the work group size " + std::to_string(workGroupSize) + " is no multiple of the preferred multiple " +
+				std::to_string(preferredMultiple) + ", some lanes of each warp stay idle"
+		);
+	}
+	if (isWorkGroupSizeRequired && best.globalWorkSize.getTotalSize() != globalWorkSize.getTotalSize()) {
+		warnings.push_back(
+				"the global work size is padded from " + toString(globalWorkSize) + " to " +
+				toString(best.globalWorkSize) + " for the required work group size"
+		);
+	}
+	return best;
+}
+
+[[maybe_unused]] void LaunchAdvisor::printReport(const LaunchRecommendation &recommendation, const bool useStderr) {
+	const KernelResources &resources = recommendation.resources;
+	const NDRange requiredWorkGroupSize(
+			resources.compileWorkGroupSize[0],
+			resources.compileWorkGroupSize[1],
+			resources.compileWorkGroupSize[2]
+	);
+	std::string output =
+			"Kernel " + resources.kernelName + ":\n"
+			"  Max work group size: " + std::to_string(resources.maxWorkGroupSize) +
+			"\n  Required work group size: " + (resources.compileWorkGroupSize[0] ? toString(requiredWorkGroupSize) : "none") +
+			"\n  Preferred work group size multiple: " + std::to_string(resources.preferredWorkGroupSizeMultiple) +
+			"\n  Local memory size [bytes]: " + std::to_string(resources.localMemorySize) +
+			"\n  Private memory size [bytes]: " + std::to_string(resources.privateMemorySize) +
+			"\n  Recommended local work size: " + toString(recommendation.localWorkSize) +
+			"\n  Global work size: " + toString(recommendation.globalWorkSize) +
+			"\n  Work groups: " + std::to_string(recommendation.numWorkGroups) +
+			"\n  Work groups per compute unit: " + std::to_string(recommendation.workGroupsPerComputeUnit) +
+			"\n  Occupancy [%]: " + std::to_string(static_cast<int>(recommendation.occupancy * 100)) + "\n";
+	for (const std::string &warning: recommendation.warnings) {
+		output += "  Warning: " + warning + "\n";
+	}
+	if (useStderr) {
+		std::cerr << output;
+	} else {
+		std::cout << output;
+	}
+}
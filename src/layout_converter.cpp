@@ -0,0 +1,633 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "opencl/layout_converter.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define OPENCL_TOOLKIT_X86_SIMD
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define OPENCL_TOOLKIT_NEON
+#include <arm_neon.h>
+#endif
+
+using namespace OpenClToolkit;
+
+namespace {
+	/**
+	 * @brief Converts a float into a half, rounding to nearest even.
+	 * @param value the float.
+	 * @return the half.
+	 */
+	cl_half toHalf(const cl_float value) {
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		const auto sign = static_cast<uint32_t>((bits >> 16) & 0x8000);
+		const uint32_t exponent = (bits >> 23) & 0xFF;
+		uint32_t mantissa = bits & 0x7FFFFF;
+		if (exponent == 0xFF) {
+			// infinities stay infinities, NaNs stay quiet NaNs
+			return static_cast<cl_half>(sign | 0x7C00 | (mantissa ? 0x200 | (mantissa >> 13) : 0));
+		}
+		const int halfExponent = static_cast<int>(exponent) - 127 + 15;
+		if (halfExponent >= 31) {
+			return static_cast<cl_half>(sign | 0x7C00);
+		}
+		uint32_t half;
+		uint32_t remainder;
+		uint32_t halfway;
+		if (halfExponent <= 0) {
+			if (halfExponent < -10) {
+				return static_cast<cl_half>(sign);
+			}
+			// subnormal halves keep the implicit leading one in the mantissa
+			mantissa |= 0x800000;
+			const auto shift = static_cast<uint32_t>(14 - halfExponent);
+			half = mantissa >> shift;
+			remainder = mantissa & ((1u << shift) - 1);
+			halfway = 1u << (shift - 1);
+		} else {
+			half = static_cast<uint32_t>(halfExponent) << 10 | mantissa >> 13;
+			remainder = mantissa & 0x1FFF;
+			halfway = 0x1000;
+		}
+		// a carry out of the mantissa correctly increments the exponent, up to infinity
+		if (remainder > halfway || (remainder == halfway && (half & 1))) {
+			++half;
+		}
+		return static_cast<cl_half>(sign | half);
+	}
+
+	/**
+	 * @brief Converts a half into a float.
+	 * @param value the half.
+	 * @return the float.
+	 */
+	cl_float toFloat(const cl_half value) {
+		const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+		const uint32_t exponent = (value >> 10) & 0x1F;
+		uint32_t mantissa = value & 0x3FF;
+		uint32_t bits;
+		if (exponent == 0x1F) {
+			bits = sign | 0x7F800000 | mantissa << 13;
+		} else if (exponent) {
+			bits = sign | (exponent + 112) << 23 | mantissa << 13;
+		} else if (!mantissa) {
+			bits = sign;
+		} else {
+			// subnormal halves are normal floats
+			uint32_t floatExponent = 113;
+			while (!(mantissa & 0x400)) {
+				mantissa <<= 1;
+				--floatExponent;
+			}
+			bits = sign | floatExponent << 23 | (mantissa & 0x3FF) << 13;
+		}
+		cl_float result;
+		std::memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+
+	/**
+	 * @brief Narrows an integer with saturation.
+	 * @tparam T the narrow integer type.
+	 * @param value the integer.
+	 * @return the clamped integer.
+	 */
+	template<typename T>
+	T narrow(const cl_int value) {
+		return static_cast<T>(std::clamp<cl_int>(
+				value,
+				std::numeric_limits<T>::min(),
+				std::numeric_limits<T>::max()
+		));
+	}
+
+	/**
+	 * @brief Transposes the passed records without vector instructions.
+	 * @param records the first record.
+	 * @param numRecords the number of records.
+	 * @param recordSizeInWords the distance of the records in 32-bit words.
+	 * @param numFields the number of fields.
+	 * @param fieldArrays the destination array per field.
+	 * @param first the index of the first record to be transposed.
+	 */
+	void transposeScalar(
+			const char *records,
+			const size_t numRecords,
+			const size_t recordSizeInWords,
+			const size_t numFields,
+			void *const *fieldArrays,
+			const size_t first
+	) {
+		for (size_t field = 0; field < numFields; ++field) {
+			auto *destination = static_cast<char *>(fieldArrays[field]);
+			for (size_t record = first; record < numRecords; ++record) {
+				std::memcpy(
+						destination + record * sizeof(uint32_t),
+						records + (record * recordSizeInWords + field) * sizeof(uint32_t),
+						sizeof(uint32_t)
+				);
+			}
+		}
+	}
+
+#if defined(OPENCL_TOOLKIT_X86_SIMD)
+	/**
+	 * The mask of all 16 lanes of AVX-512. The masked intrinsics are used because the unmasked ones of GCC 12 trip
+	 * -Wmaybe-uninitialized.
+	 */
+	constexpr __mmask16 allLanes = 0xFFFF;
+
+	/**
+	 * @brief Transposes the records in blocks of 8 by gathering each field.
+	 * @return the index of the first record which is left to the scalar variant.
+	 */
+	__attribute__((target("avx2"))) size_t transposeAvx2(
+			const char *records,
+			const size_t numRecords,
+			const size_t recordSizeInWords,
+			const size_t numFields,
+			void *const *fieldArrays
+	) {
+		const auto stride = static_cast<int>(recordSizeInWords);
+		const __m256i indices = _mm256_mullo_epi32(
+				_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+				_mm256_set1_epi32(stride)
+		);
+		size_t record = 0;
+		for (; record + 8 <= numRecords; record += 8) {
+			const auto *block = reinterpret_cast<const int *>(records + record * recordSizeInWords * sizeof(uint32_t));
+			for (size_t field = 0; field < numFields; ++field) {
+				const __m256i values = _mm256_i32gather_epi32(block + field, indices, 4);
+				_mm256_storeu_si256(
+						reinterpret_cast<__m256i *>(static_cast<uint32_t *>(fieldArrays[field]) + record),
+						values
+				);
+			}
+		}
+		return record;
+	}
+
+	/**
+	 * @brief Transposes the records in blocks of 16 by gathering each field.
+	 * @return the index of the first record which is left to the scalar variant.
+	 */
+	__attribute__((target("avx512f"))) size_t transposeAvx512(
+			const char *records,
+			const size_t numRecords,
+			const size_t recordSizeInWords,
+			const size_t numFields,
+			void *const *fieldArrays
+	) {
+		const auto stride = static_cast<int>(recordSizeInWords);
+		const __m512i indices = _mm512_mullo_epi32(
+				_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+				_mm512_set1_epi32(stride)
+		);
+		const __m512i zeros = _mm512_setzero_si512();
+		size_t record = 0;
+		for (; record + 16 <= numRecords; record += 16) {
+			const auto *block = reinterpret_cast<const int *>(records + record * recordSizeInWords * sizeof(uint32_t));
+			for (size_t field = 0; field < numFields; ++field) {
+				const __m512i values = _mm512_mask_i32gather_epi32(zeros, allLanes, indices, block + field, 4);
+				_mm512_storeu_si512(static_cast<uint32_t *>(fieldArrays[field]) + record, values);
+			}
+		}
+		return record;
+	}
+
+	/**
+	 * @brief Converts floats into halves in blocks of 8.
+	 * @return the index of the first element which is left to the scalar variant.
+	 */
+	__attribute__((target("avx2,f16c"))) size_t convertFloatsToHalvesAvx2(
+			const cl_float *source,
+			cl_half *destination,
+			const size_t numElements
+	) {
+		size_t i = 0;
+		for (; i + 8 <= numElements; i += 8) {
+			const __m128i halves = _mm256_cvtps_ph(_mm256_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i), halves);
+		}
+		return i;
+	}
+
+	/**
+	 * @brief Converts floats into halves in blocks of 16.
+	 * @return the index of the first element which is left to the scalar variant.
+	 */
+	__attribute__((target("avx512f"))) size_t convertFloatsToHalvesAvx512(
+			const cl_float *source,
+			cl_half *destination,
+			const size_t numElements
+	) {
+		size_t i = 0;
+		for (; i + 16 <= numElements; i += 16) {
+			const __m512 floats = _mm512_loadu_ps(source + i);
+			const __m256i halves = _mm512_maskz_cvtps_ph(allLanes, floats, _MM_FROUND_TO_NEAREST_INT);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(destination + i), halves);
+		}
+		return i;
+	}
+
+	/**
+	 * @brief Converts halves into floats in blocks of 8.
+	 * @return the index of the first element which is left to the scalar variant.
+	 */
+	__attribute__((target("avx2,f16c"))) size_t convertHalvesToFloatsAvx2(
+			const cl_half *source,
+			cl_float *destination,
+			const size_t numElements
+	) {
+		size_t i = 0;
+		for (; i + 8 <= numElements; i += 8) {
+			const __m128i halves = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i));
+			_mm256_storeu_ps(destination + i, _mm256_cvtph_ps(halves));
+		}
+		return i;
+	}
+
+	/**
+	 * @brief Converts halves into floats in blocks of 16.
+	 * @return the index of the first element which is left to the scalar variant.
+	 */
+	__attribute__((target("avx512f"))) size_t convertHalvesToFloatsAvx512(
+			const cl_half *source,
+			cl_float *destination,
+			const size_t numElements
+	) {
+		size_t i = 0;
+		for (; i + 16 <= numElements; i += 16) {
+			const __m256i halves = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i));
+			_mm512_storeu_ps(destination + i, _mm512_maskz_cvtph_ps(allLanes, halves));
+		}
+		return i;
+	}
+
+	/**
+	 * @brief Narrows integers into 16-bit integers in blocks of 16.
+	 * @return the index of the first element which is left to the scalar variant.
+	 */
+	__attribute__((target("avx2"))) size_t narrowIntegersAvx2(
+			const cl_int *source,
+			cl_short *destination,
+			const size_t numElements
+	) {
+		size_t i = 0;
+		for (; i + 16 <= numElements; i += 16) {
+			const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i));
+			const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i + 8));
+			// the packing interleaves the 128-bit lanes, the permutation restores the order
+			const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), 0xD8);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(destination + i), packed);
+		}
+		return i;
+	}
+
+	/**
+	 * @brief Narrows integers into 8-bit integers in blocks of 32.
+	 * @return the index of the first element which is left to the scalar variant.
+	 */
+	__attribute__((target("avx2"))) size_t narrowIntegersAvx2(
+			const cl_int *source,
+			cl_char *destination,
+			const size_t numElements
+	) {
+		size_t i = 0;
+		for (; i + 32 <= numElements; i += 32) {
+			const auto *block = reinterpret_cast<const __m256i *>(source + i);
+			const __m256i first = _mm256_packs_epi32(_mm256_loadu_si256(block), _mm256_loadu_si256(block + 1));
+			const __m256i second = _mm256_packs_epi32(_mm256_loadu_si256(block + 2), _mm256_loadu_si256(block + 3));
+			// both packings interleave the 128-bit lanes, so the 32-bit groups are restored at once
+			const __m256i packed = _mm256_permutevar8x32_epi32(
+					_mm256_packs_epi16(first, second),
+					_mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)
+			);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(destination + i), packed);
+		}
+		return i;
+	}
+
+	/**
+	 * @brief Narrows integers into 16-bit integers in blocks of 16.
+	 * @return the index of the first element which is left to the scalar variant.
+	 */
+	__attribute__((target("avx512f"))) size_t narrowIntegersAvx512(
+			const cl_int *source,
+			cl_short *destination,
+			const size_t numElements
+	) {
+		size_t i = 0;
+		for (; i + 16 <= numElements; i += 16) {
+			const __m256i narrowed = _mm512_maskz_cvtsepi32_epi16(allLanes, _mm512_loadu_si512(source + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(destination + i), narrowed);
+		}
+		return i;
+	}
+
+	/**
+	 * @brief Narrows integers into 8-bit integers in blocks of 16.
+	 * @return the index of the first element which is left to the scalar variant.
+	 */
+	__attribute__((target("avx512f"))) size_t narrowIntegersAvx512(
+			const cl_int *source,
+			cl_char *destination,
+			const size_t numElements
+	) {
+		size_t i = 0;
+		for (; i + 16 <= numElements; i += 16) {
+			const __m128i narrowed = _mm512_maskz_cvtsepi32_epi8(allLanes, _mm512_loadu_si512(source + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i), narrowed);
+		}
+		return i;
+	}
+#endif
+
+#if defined(OPENCL_TOOLKIT_NEON)
+	/**
+	 * @brief Transposes records of 2, 3 or 4 tightly packed fields in blocks of 4 by de-interleaving loads.
+	 * @return the index of the first record which is left to the scalar variant.
+	 */
+	size_t transposeNeon(
+			const char *records,
+			const size_t numRecords,
+			const size_t recordSizeInWords,
+			const size_t numFields,
+			void *const *fieldArrays
+	) {
+		if (numFields != recordSizeInWords || numFields < 2 || numFields > 4) {
+			return 0;
+		}
+		const auto *words = reinterpret_cast<const uint32_t *>(records);
+		const auto field = [fieldArrays](const size_t index, const size_t record) {
+			return static_cast<uint32_t *>(fieldArrays[index]) + record;
+		};
+		size_t record = 0;
+		for (; record + 4 <= numRecords; record += 4) {
+			const uint32_t *block = words + record * numFields;
+			if (numFields == 2) {
+				const uint32x4x2_t values = vld2q_u32(block);
+				vst1q_u32(field(0, record), values.val[0]);
+				vst1q_u32(field(1, record), values.val[1]);
+			} else if (numFields == 3) {
+				const uint32x4x3_t values = vld3q_u32(block);
+				vst1q_u32(field(0, record), values.val[0]);
+				vst1q_u32(field(1, record), values.val[1]);
+				vst1q_u32(field(2, record), values.val[2]);
+			} else {
+				const uint32x4x4_t values = vld4q_u32(block);
+				vst1q_u32(field(0, record), values.val[0]);
+				vst1q_u32(field(1, record), values.val[1]);
+				vst1q_u32(field(2, record), values.val[2]);
+				vst1q_u32(field(3, record), values.val[3]);
+			}
+		}
+		return record;
+	}
+
+	/**
+	 * @brief Converts floats into halves in blocks of 4.
+	 * @return the index of the first element which is left to the scalar variant.
+	 */
+	size_t convertFloatsToHalvesNeon(const cl_float *source, cl_half *destination, const size_t numElements) {
+		size_t i = 0;
+		for (; i + 4 <= numElements; i += 4) {
+			vst1_u16(destination + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(source + i))));
+		}
+		return i;
+	}
+
+	/**
+	 * @brief Converts halves into floats in blocks of 4.
+	 * @return the index of the first element which is left to the scalar variant.
+	 */
+	size_t convertHalvesToFloatsNeon(const cl_half *source, cl_float *destination, const size_t numElements) {
+		size_t i = 0;
+		for (; i + 4 <= numElements; i += 4) {
+			vst1q_f32(destination + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(source + i))));
+		}
+		return i;
+	}
+
+	/**
+	 * @brief Narrows integers into 16-bit integers in blocks of 8.
+	 * @return the index of the first element which is left to the scalar variant.
+	 */
+	size_t narrowIntegersNeon(const cl_int *source, cl_short *destination, const size_t numElements) {
+		size_t i = 0;
+		for (; i + 8 <= numElements; i += 8) {
+			const int16x4_t low = vqmovn_s32(vld1q_s32(source + i));
+			const int16x4_t high = vqmovn_s32(vld1q_s32(source + i + 4));
+			vst1q_s16(destination + i, vcombine_s16(low, high));
+		}
+		return i;
+	}
+
+	/**
+	 * @brief Narrows integers into 8-bit integers in blocks of 8.
+	 * @return the index of the first element which is left to the scalar variant.
+	 */
+	size_t narrowIntegersNeon(const cl_int *source, cl_char *destination, const size_t numElements) {
+		size_t i = 0;
+		for (; i + 8 <= numElements; i += 8) {
+			const int16x4_t low = vqmovn_s32(vld1q_s32(source + i));
+			const int16x4_t high = vqmovn_s32(vld1q_s32(source + i + 4));
+			vst1_s8(destination + i, vqmovn_s16(vcombine_s16(low, high)));
+		}
+		return i;
+	}
+#endif
+}
+
+[[maybe_unused]] LayoutConverter::LayoutConverter(const SimdInstructionSet instructionSet) :
+		instructionSet_(instructionSet) {
+	if (!isSupported(instructionSet)) {
+		// let it crash
+		throw std::runtime_error("Failed to create layout converter: the host does not support the instruction set");
+	}
+}
+
+[[maybe_unused]] SimdInstructionSet LayoutConverter::getInstructionSet() const {
+	return instructionSet_;
+}
+
+[[maybe_unused]] void LayoutConverter::transposeRecordsToFieldArrays(
+		const void *records,
+		const size_t numRecords,
+		const size_t recordSizeInBytes,
+		const size_t numFields,
+		void *const *fieldArrays
+) const {
+	if (recordSizeInBytes % sizeof(uint32_t) || recordSizeInBytes < numFields * sizeof(uint32_t)) {
+		// let it crash
+		throw std::runtime_error("Failed to transpose the records: the record size does not fit the fields");
+	}
+	const auto *bytes = static_cast<const char *>(records);
+	const size_t recordSizeInWords = recordSizeInBytes / sizeof(uint32_t);
+	size_t first = 0;
+	switch (instructionSet_) {
+#if defined(OPENCL_TOOLKIT_X86_SIMD)
+		case SimdInstructionSet::Avx2:
+			first = transposeAvx2(bytes, numRecords, recordSizeInWords, numFields, fieldArrays);
+			break;
+		case SimdInstructionSet::Avx512:
+			first = transposeAvx512(bytes, numRecords, recordSizeInWords, numFields, fieldArrays);
+			break;
+#endif
+#if defined(OPENCL_TOOLKIT_NEON)
+		case SimdInstructionSet::Neon:
+			first = transposeNeon(bytes, numRecords, recordSizeInWords, numFields, fieldArrays);
+			break;
+#endif
+		default:
+			break;
+	}
+	transposeScalar(bytes, numRecords, recordSizeInWords, numFields, fieldArrays, first);
+}
+
+[[maybe_unused]] void LayoutConverter::convertFloatsToHalves(
+		const cl_float *source,
+		cl_half *destination,
+		const size_t numElements
+) const {
+	size_t i = 0;
+	switch (instructionSet_) {
+#if defined(OPENCL_TOOLKIT_X86_SIMD)
+		case SimdInstructionSet::Avx2:
+			i = convertFloatsToHalvesAvx2(source, destination, numElements);
+			break;
+		case SimdInstructionSet::Avx512:
+			i = convertFloatsToHalvesAvx512(source, destination, numElements);
+			break;
+#endif
+#if defined(OPENCL_TOOLKIT_NEON)
+		case SimdInstructionSet::Neon:
+			i = convertFloatsToHalvesNeon(source, destination, numElements);
+			break;
+#endif
+		default:
+			break;
+	}
+	for (; i < numElements; ++i) {
+		destination[i] = toHalf(source[i]);
+	}
+}
+
+[[maybe_unused]] void LayoutConverter::convertHalvesToFloats(
+		const cl_half *source,
+		cl_float *destination,
+		const size_t numElements
+) const {
+	size_t i = 0;
+	switch (instructionSet_) {
+#if defined(OPENCL_TOOLKIT_X86_SIMD)
+		case SimdInstructionSet::Avx2:
+			i = convertHalvesToFloatsAvx2(source, destination, numElements);
+			break;
+		case SimdInstructionSet::Avx512:
+			i = convertHalvesToFloatsAvx512(source, destination, numElements);
+			break;
+#endif
+#if defined(OPENCL_TOOLKIT_NEON)
+		case SimdInstructionSet::Neon:
+			i = convertHalvesToFloatsNeon(source, destination, numElements);
+			break;
+#endif
+		default:
+			break;
+	}
+	for (; i < numElements; ++i) {
+		destination[i] = toFloat(source[i]);
+	}
+}
+
+[[maybe_unused]] void LayoutConverter::narrowIntegers(
+		const cl_int *source,
+		cl_short *destination,
+		const size_t numElements
+) const {
+	size_t i = 0;
+	switch (instructionSet_) {
+#if defined(OPENCL_TOOLKIT_X86_SIMD)
+		case SimdInstructionSet::Avx2:
+			i = narrowIntegersAvx2(source, destination, numElements);
+			break;
+		case SimdInstructionSet::Avx512:
+			i = narrowIntegersAvx512(source, destination, numElements);
+			break;
+#endif
+#if defined(OPENCL_TOOLKIT_NEON)
+		case SimdInstructionSet::Neon:
+			i = narrowIntegersNeon(source, destination, numElements);
+			break;
+#endif
+		default:
+			break;
+	}
+	for (; i < numElements; ++i) {
+		destination[i] = narrow<cl_short>(source[i]);
+	}
+}
+
+[[maybe_unused]] void LayoutConverter::narrowIntegers(
+		const cl_int *source,
+		cl_char *destination,
+		const size_t numElements
+) const {
+	size_t i = 0;
+	switch (instructionSet_) {
+#if defined(OPENCL_TOOLKIT_X86_SIMD)
+		case SimdInstructionSet::Avx2:
+			i = narrowIntegersAvx2(source, destination, numElements);
+			break;
+		case SimdInstructionSet::Avx512:
+			i = narrowIntegersAvx512(source, destination, numElements);
+			break;
+#endif
+#if defined(OPENCL_TOOLKIT_NEON)
+		case SimdInstructionSet::Neon:
+			i = narrowIntegersNeon(source, destination, numElements);
+			break;
+#endif
+		default:
+			break;
+	}
+	for (; i < numElements; ++i) {
+		destination[i] = narrow<cl_char>(source[i]);
+	}
+}
+
+[[maybe_unused]] SimdInstructionSet LayoutConverter::detectInstructionSet() {
+	for (const SimdInstructionSet instructionSet: {SimdInstructionSet::Avx512, SimdInstructionSet::Avx2,
+												   SimdInstructionSet::Neon}) {
+		if (isSupported(instructionSet)) {
+			return instructionSet;
+		}
+	}
+	return SimdInstructionSet::Scalar;
+}
+
+[[maybe_unused]] bool LayoutConverter::isSupported(const SimdInstructionSet instructionSet) {
+	switch (instructionSet) {
+		case SimdInstructionSet::Scalar:
+			return true;
+#if defined(OPENCL_TOOLKIT_X86_SIMD)
+		case SimdInstructionSet::Avx2:
+			return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+		case SimdInstructionSet::Avx512:
+			return __builtin_cpu_supports("avx512f");
+#endif
+#if defined(OPENCL_TOOLKIT_NEON)
+		case SimdInstructionSet::Neon:
+			// NEON is mandatory on 64-bit ARM
+			return true;
+#endif
+		default:
+			return false;
+	}
+}
@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <exception>
+
+#include "opencl/memory_manager.h"
+#include "opencl/device_info.h"
+#include "opencl/evictable_buffer.h"
+
+using namespace OpenClToolkit;
+
+[[maybe_unused]] MemoryManager &MemoryManager::getInstance() {
+	static MemoryManager instance;
+	return instance;
+}
+
+[[maybe_unused]] void MemoryManager::setBudget(cl_context context, const size_t budgetInBytes) {
+	std::vector<Eviction> evictions;
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		Account &account = accounts_[context];
+		account.metrics.budgetInBytes = budgetInBytes;
+		evictions = selectEvictions(account, 0);
+	}
+	completeEvictions(context, evictions);
+}
+
+[[maybe_unused]] void MemoryManager::setBudgetFromDevice(
+		cl_context context,
+		cl_device_id device,
+		const double fraction
+) {
+	const auto globalMemorySize = static_cast<double>(DeviceInfo::get(device).globalMemorySize);
+	setBudget(context, static_cast<size_t>(globalMemorySize * std::clamp(fraction, 0.0, 1.0)));
+}
+
+[[maybe_unused]] MemoryMetrics MemoryManager::getMetrics(cl_context context) {
+	std::lock_guard<std::recursive_mutex> lock(mutex_);
+	MemoryMetrics metrics = accounts_[context].metrics;
+	metrics.pressure = metrics.budgetInBytes ?
+					   static_cast<double>(metrics.allocatedInBytes) / static_cast<double>(metrics.budgetInBytes) :
+					   0.0;
+	return metrics;
+}
+
+void MemoryManager::reserve(cl_context context, const size_t sizeInBytes) {
+	std::vector<Eviction> evictions;
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		Account &account = accounts_[context];
+		MemoryMetrics &metrics = account.metrics;
+		evictions = selectEvictions(account, sizeInBytes);
+		// the evicted bytes are released before the caller allocates
+		const size_t allocatedInBytes = metrics.allocatedInBytes - account.evictingInBytes;
+		if (allocatedInBytes + sizeInBytes > metrics.budgetInBytes) {
+			++metrics.numBudgetOverruns;
+		}
+		metrics.allocatedInBytes += sizeInBytes;
+		metrics.peakAllocatedInBytes = std::max(metrics.peakAllocatedInBytes, allocatedInBytes + sizeInBytes);
+		++metrics.numAllocations;
+	}
+	completeEvictions(context, evictions);
+}
+
+void MemoryManager::release(cl_context context, const size_t sizeInBytes) {
+	std::lock_guard<std::recursive_mutex> lock(mutex_);
+	MemoryMetrics &metrics = accounts_[context].metrics;
+	metrics.allocatedInBytes -= std::min(metrics.allocatedInBytes, sizeInBytes);
+}
+
+size_t MemoryManager::evictAll(cl_context context) {
+	std::vector<Eviction> evictions;
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		evictions = selectEvictions(accounts_[context], 0, true);
+	}
+	return completeEvictions(context, evictions);
+}
+
+std::vector<MemoryManager::Eviction> MemoryManager::selectEvictions(
+		Account &account,
+		const size_t sizeInBytes,
+		const bool evictAll
+) {
+	const MemoryMetrics &metrics = account.metrics;
+	std::vector<Eviction> evictions;
+	for (auto iterator = account.evictableBuffers.begin();
+		 iterator != account.evictableBuffers.end() &&
+		 (evictAll || metrics.allocatedInBytes - account.evictingInBytes + sizeInBytes > metrics.budgetInBytes);
+		 ++iterator) {
+		auto deviceBuffer = (*iterator)->beginEviction();
+		if (deviceBuffer) {
+			account.evictingInBytes += (*iterator)->getSizeInBytes();
+			evictions.push_back({*iterator, std::move(deviceBuffer)});
+		}
+	}
+	return evictions;
+}
+
+size_t MemoryManager::completeEvictions(cl_context context, std::vector<Eviction> &evictions) {
+	size_t numCompleted = 0;
+	std::exception_ptr failure;
+	for (; numCompleted < evictions.size(); ++numCompleted) {
+		try {
+			evictions[numCompleted].buffer->copyToHost(*evictions[numCompleted].deviceBuffer);
+		} catch (...) {
+			failure = std::current_exception();
+			break;
+		}
+		// the release of the device buffer lowers the allocated bytes
+		evictions[numCompleted].deviceBuffer.reset();
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(mutex_);
+	Account &account = accounts_[context];
+	size_t numBytesEvicted = 0;
+	for (size_t i = 0; i < evictions.size(); ++i) {
+		EvictableBuffer *buffer = evictions[i].buffer;
+		if (i < numCompleted) {
+			++account.metrics.numEvictions;
+			account.metrics.evictedBytes += buffer->getSizeInBytes();
+			numBytesEvicted += buffer->getSizeInBytes();
+		} else {
+			// the buffers whose copies did not complete stay resident
+			buffer->deviceBuffer_ = std::move(evictions[i].deviceBuffer);
+		}
+		account.evictingInBytes -= buffer->getSizeInBytes();
+		buffer->isMoving_ = false;
+	}
+	movingCompleted_.notify_all();
+	if (failure) {
+		std::rethrow_exception(failure);
+	}
+	return numBytesEvicted;
+}
+
+void MemoryManager::registerBuffer(cl_context context, EvictableBuffer *buffer) {
+	std::lock_guard<std::recursive_mutex> lock(mutex_);
+	accounts_[context].evictableBuffers.push_back(buffer);
+}
+
+void MemoryManager::unregisterBuffer(cl_context context, EvictableBuffer *buffer) {
+	std::unique_lock<std::recursive_mutex> lock(mutex_);
+	// an eviction started by another thread still copies the buffer
+	movingCompleted_.wait(lock, [buffer] { return !buffer->isMoving_; });
+	accounts_[context].evictableBuffers.remove(buffer);
+}
+
+std::shared_ptr<ReadWriteBuffer> MemoryManager::acquire(cl_context context, EvictableBuffer *buffer) {
+	std::unique_lock<std::recursive_mutex> lock(mutex_);
+	movingCompleted_.wait(lock, [buffer] { return !buffer->isMoving_; });
+	Account &account = accounts_[context];
+	const auto position = std::find(account.evictableBuffers.begin(), account.evictableBuffers.end(), buffer);
+	account.evictableBuffers.splice(account.evictableBuffers.end(), account.evictableBuffers, position);
+	if (buffer->deviceBuffer_) {
+		return buffer->deviceBuffer_;
+	}
+
+	// the restoration allocates, which may evict other buffers, so it runs without the lock
+	buffer->isMoving_ = true;
+	lock.unlock();
+	std::shared_ptr<ReadWriteBuffer> deviceBuffer;
+	try {
+		deviceBuffer = buffer->restore();
+	} catch (...) {
+		lock.lock();
+		buffer->isMoving_ = false;
+		movingCompleted_.notify_all();
+		throw;
+	}
+	lock.lock();
+	buffer->deviceBuffer_ = deviceBuffer;
+	buffer->isMoving_ = false;
+	++account.metrics.numRestorations;
+	account.metrics.restoredBytes += buffer->getSizeInBytes();
+	movingCompleted_.notify_all();
+	return deviceBuffer;
+}
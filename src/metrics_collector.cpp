@@ -0,0 +1,451 @@
+#include <algorithm>
+#include <charconv>
+#include <sstream>
+#include <unordered_map>
+
+#include "opencl/metrics_collector.h"
+#include "device_query.h"
+
+using namespace OpenClToolkit;
+
+namespace {
+	/**
+	 * The upper bounds of the transfer size buckets in bytes, from 4 KiB to 1 GiB.
+	 */
+	const std::vector<double> transferSizeUpperBounds{
+			4096, 16384, 65536, 262144, 1048576, 4194304, 16777216, 67108864, 268435456, 1073741824
+	};
+
+	/**
+	 * The upper bounds of the build duration buckets in seconds.
+	 */
+	const std::vector<double> buildDurationUpperBounds{0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1, 5, 10, 30, 60};
+
+	/**
+	 * @brief Represents a histogram with fixed buckets.
+	 */
+	struct Histogram {
+		/**
+		 * The upper bounds of the buckets.
+		 */
+		const std::vector<double> *upperBounds;
+
+		/**
+		 * The number of observations per bucket, one more than the upper bounds.
+		 */
+		std::vector<uint64_t> bucketCounts;
+
+		/**
+		 * The sum of the observed values.
+		 */
+		double sum;
+
+		/**
+		 * @brief The parametrized constructor.
+		 * @param upperBounds the upper bounds of the buckets which outlive the histogram.
+		 */
+		explicit Histogram(const std::vector<double> &upperBounds) :
+				upperBounds(&upperBounds),
+				bucketCounts(upperBounds.size() + 1, 0),
+				sum(0) {}
+
+		/**
+		 * @brief Adds an observation.
+		 * @param value the observed value.
+		 */
+		void observe(const double value) {
+			const auto bucket = std::lower_bound(upperBounds->begin(), upperBounds->end(), value);
+			++bucketCounts[bucket - upperBounds->begin()];
+			sum += value;
+		}
+
+		/**
+		 * @brief Adds the observations of another histogram with the same buckets.
+		 * @param other the other histogram.
+		 */
+		void add(const Histogram &other) {
+			for (size_t i = 0; i < bucketCounts.size(); ++i) {
+				bucketCounts[i] += other.bucketCounts[i];
+			}
+			sum += other.sum;
+		}
+
+		/**
+		 * @brief Converts the histogram into its snapshot.
+		 * @return the snapshot.
+		 */
+		[[nodiscard]] HistogramSnapshot toSnapshot() const {
+			uint64_t count = 0;
+			for (const uint64_t bucketCount: bucketCounts) {
+				count += bucketCount;
+			}
+			return {*upperBounds, bucketCounts, count, sum};
+		}
+	};
+
+	/**
+	 * @brief Formats a floating-point value as the shortest text which reads back as the same value.
+	 * @param value the value.
+	 * @return the formatted value.
+	 */
+	std::string formatValue(const double value) {
+		char text[32];
+		const auto result = std::to_chars(text, text + sizeof(text), value);
+		return {text, result.ptr};
+	}
+
+	/**
+	 * @brief Escapes a label value of the Prometheus text format.
+	 * @param value the label value.
+	 * @return the escaped label value.
+	 */
+	std::string escapeLabelValue(const std::string &value) {
+		std::string escaped;
+		escaped.reserve(value.size());
+		for (const char character: value) {
+			switch (character) {
+				case '\\':
+					escaped += "\\\\";
+					break;
+				case '"':
+					escaped += "\\\"";
+					break;
+				case '\n':
+					escaped += "\\n";
+					break;
+				default:
+					escaped += character;
+					break;
+			}
+		}
+		return escaped;
+	}
+
+	/**
+	 * @brief Writes the help and type lines of a metric.
+	 * @param output the output.
+	 * @param name the name of the metric.
+	 * @param type the type of the metric.
+	 * @param help the description of the metric.
+	 */
+	void writeHeader(std::ostream &output, const std::string &name, const char *type, const char *help) {
+		output << "# HELP " << name << ' ' << help << '\n' << "# TYPE " << name << ' ' << type << '\n';
+	}
+
+	/**
+	 * @brief Writes the samples of a histogram with cumulative buckets.
+	 * @param output the output.
+	 * @param name the name of the metric.
+	 * @param labels the labels of the histogram followed by a comma, empty if none.
+	 * @param histogram the histogram.
+	 */
+	void writeHistogram(
+			std::ostream &output,
+			const std::string &name,
+			const std::string &labels,
+			const HistogramSnapshot &histogram
+	) {
+		uint64_t cumulativeCount = 0;
+		for (size_t i = 0; i < histogram.bucketCounts.size(); ++i) {
+			cumulativeCount += histogram.bucketCounts[i];
+			output << name << "_bucket{" << labels << "le=\"";
+			if (i < histogram.upperBounds.size()) {
+				output << formatValue(histogram.upperBounds[i]);
+			} else {
+				output << "+Inf";
+			}
+			output << "\"} " << cumulativeCount << '\n';
+		}
+		const std::string labelSet = labels.empty() ? "" : "{" + labels.substr(0, labels.size() - 1) + "}";
+		output << name << "_sum" << labelSet << ' ' << formatValue(histogram.sum) << '\n';
+		output << name << "_count" << labelSet << ' ' << histogram.count << '\n';
+	}
+}
+
+struct MetricsCollector::Shard {
+	/**
+	 * Guards the counters, contended only while a snapshot is taken.
+	 */
+	std::mutex mutex;
+
+	/**
+	 * The bytes copied from host memory into device memory.
+	 */
+	uint64_t uploadedBytes = 0;
+
+	/**
+	 * The bytes copied from device memory into host memory.
+	 */
+	uint64_t downloadedBytes = 0;
+
+	/**
+	 * The number of copies from host memory into device memory.
+	 */
+	uint64_t numUploads = 0;
+
+	/**
+	 * The number of copies from device memory into host memory.
+	 */
+	uint64_t numDownloads = 0;
+
+	/**
+	 * The sizes of the copies in both directions.
+	 */
+	Histogram transferSizes{transferSizeUpperBounds};
+
+	/**
+	 * The number of launches per kernel name.
+	 */
+	std::unordered_map<std::string, uint64_t> kernelLaunches;
+
+	/**
+	 * The build durations per kind of build.
+	 */
+	std::unordered_map<std::string, Histogram> buildDurations;
+
+	/**
+	 * The lookups per cache.
+	 */
+	std::unordered_map<std::string, CacheSnapshot> caches;
+
+	/**
+	 * @brief Adds the counters of another shard. The caller must hold the mutexes of both shards.
+	 * @param other the other shard.
+	 */
+	void add(const Shard &other) {
+		uploadedBytes += other.uploadedBytes;
+		downloadedBytes += other.downloadedBytes;
+		numUploads += other.numUploads;
+		numDownloads += other.numDownloads;
+		transferSizes.add(other.transferSizes);
+		for (const auto &[kernelName, numLaunches]: other.kernelLaunches) {
+			kernelLaunches[kernelName] += numLaunches;
+		}
+		for (const auto &[kind, durations]: other.buildDurations) {
+			buildDurations.try_emplace(kind, buildDurationUpperBounds).first->second.add(durations);
+		}
+		for (const auto &[cache, lookups]: other.caches) {
+			CacheSnapshot &total = caches[cache];
+			total.numHits += lookups.numHits;
+			total.numMisses += lookups.numMisses;
+		}
+	}
+};
+
+class MetricsCollector::ShardOwner {
+	public:
+		/**
+		 * The shard of the current thread.
+		 */
+		Shard shard;
+
+		/**
+		 * The collector which the shard is registered with.
+		 */
+		MetricsCollector &collector;
+
+		/**
+		 * @brief The parametrized constructor. Registers the shard.
+		 * @param collector the collector to register the shard with.
+		 */
+		explicit ShardOwner(MetricsCollector &collector) : collector(collector) {
+			std::lock_guard<std::mutex> lock(collector.shardsMutex_);
+			collector.shards_.push_back(&shard);
+		}
+
+		/**
+		 * @brief The destructor. Adds the shard to the totals of the exited threads and unregisters it.
+		 */
+		~ShardOwner() {
+			std::lock_guard<std::mutex> lock(collector.shardsMutex_);
+			collector.exitedThreads_->add(shard);
+			collector.shards_.erase(std::find(collector.shards_.begin(), collector.shards_.end(), &shard));
+		}
+};
+
+MetricsCollector::MetricsCollector() : exitedThreads_(std::make_unique<Shard>()) {
+
+}
+
+MetricsCollector::~MetricsCollector() = default;
+
+[[maybe_unused]] MetricsCollector &MetricsCollector::getInstance() {
+	static MetricsCollector instance;
+	return instance;
+}
+
+MetricsCollector::Shard &MetricsCollector::getShard() {
+	thread_local ShardOwner owner(*this);
+	return owner.shard;
+}
+
+void MetricsCollector::recordUpload(const size_t numBytes) {
+	Shard &shard = getShard();
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	shard.uploadedBytes += numBytes;
+	++shard.numUploads;
+	shard.transferSizes.observe(static_cast<double>(numBytes));
+}
+
+void MetricsCollector::recordDownload(const size_t numBytes) {
+	Shard &shard = getShard();
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	shard.downloadedBytes += numBytes;
+	++shard.numDownloads;
+	shard.transferSizes.observe(static_cast<double>(numBytes));
+}
+
+void MetricsCollector::recordAllocation(const Context &context, const size_t sizeInBytes) {
+	const cl_device_id device = context.getDevices().front();
+	std::lock_guard<std::mutex> lock(memoryMutex_);
+	// a context cannot be released while it has buffers, so the entry is current for all of them
+	contextDevices_[context] = device;
+	auto iterator = deviceMemory_.find(device);
+	if (iterator == deviceMemory_.end()) {
+		const DeviceMemory memory{queryDeviceString(device, CL_DEVICE_NAME), deviceMemory_.size(), 0, 0, 0};
+		iterator = deviceMemory_.emplace(device, memory).first;
+	}
+	DeviceMemory &memory = iterator->second;
+	memory.liveBytes += sizeInBytes;
+	memory.peakBytes = std::max(memory.peakBytes, memory.liveBytes);
+	++memory.numAllocations;
+}
+
+void MetricsCollector::recordRelease(cl_context context, const size_t sizeInBytes) {
+	std::lock_guard<std::mutex> lock(memoryMutex_);
+	const auto device = contextDevices_.find(context);
+	if (device != contextDevices_.end()) {
+		deviceMemory_[device->second].liveBytes -= sizeInBytes;
+	}
+}
+
+void MetricsCollector::recordLaunch(const std::string &kernelName) {
+	Shard &shard = getShard();
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	++shard.kernelLaunches[kernelName];
+}
+
+void MetricsCollector::recordBuild(const char *kind, const double seconds) {
+	Shard &shard = getShard();
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	shard.buildDurations.try_emplace(kind, buildDurationUpperBounds).first->second.observe(seconds);
+}
+
+void MetricsCollector::recordCacheLookup(const char *cache, const bool isHit) {
+	Shard &shard = getShard();
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	CacheSnapshot &lookups = shard.caches[cache];
+	++(isHit ? lookups.numHits : lookups.numMisses);
+}
+
+[[maybe_unused]] MetricsSnapshot MetricsCollector::snapshot() {
+	Shard total;
+	{
+		std::lock_guard<std::mutex> lock(shardsMutex_);
+		total.add(*exitedThreads_);
+		for (Shard *shard: shards_) {
+			std::lock_guard<std::mutex> shardLock(shard->mutex);
+			total.add(*shard);
+		}
+	}
+
+	MetricsSnapshot snapshot{
+			total.uploadedBytes,
+			total.downloadedBytes,
+			total.numUploads,
+			total.numDownloads,
+			total.transferSizes.toSnapshot(),
+			{},
+			{total.kernelLaunches.begin(), total.kernelLaunches.end()},
+			{},
+			{total.caches.begin(), total.caches.end()}
+	};
+	for (const auto &[kind, durations]: total.buildDurations) {
+		snapshot.buildDurations.emplace(kind, durations.toSnapshot());
+	}
+	{
+		std::lock_guard<std::mutex> lock(memoryMutex_);
+		for (const auto &[device, memory]: deviceMemory_) {
+			snapshot.devices.push_back({
+					device,
+					memory.deviceName,
+					memory.deviceIndex,
+					memory.liveBytes,
+					memory.peakBytes,
+					memory.numAllocations
+			});
+		}
+	}
+	std::sort(snapshot.devices.begin(), snapshot.devices.end(), [](const auto &a, const auto &b) {
+		return a.deviceIndex < b.deviceIndex;
+	});
+	return snapshot;
+}
+
+[[maybe_unused]] std::string MetricsCollector::formatPrometheus(
+		const MetricsSnapshot &snapshot,
+		const std::string &prefix
+) {
+	std::ostringstream output;
+
+	writeHeader(output, prefix + "_uploaded_bytes_total", "counter", "Bytes copied from host into device memory.");
+	output << prefix << "_uploaded_bytes_total " << snapshot.uploadedBytes << '\n';
+	writeHeader(output, prefix + "_downloaded_bytes_total", "counter", "Bytes copied from device into host memory.");
+	output << prefix << "_downloaded_bytes_total " << snapshot.downloadedBytes << '\n';
+	writeHeader(output, prefix + "_uploads_total", "counter", "Copies from host into device memory.");
+	output << prefix << "_uploads_total " << snapshot.numUploads << '\n';
+	writeHeader(output, prefix + "_downloads_total", "counter", "Copies from device into host memory.");
+	output << prefix << "_downloads_total " << snapshot.numDownloads << '\n';
+	writeHeader(output, prefix + "_transfer_size_bytes", "histogram", "Sizes of the copies in both directions.");
+	writeHistogram(output, prefix + "_transfer_size_bytes", "", snapshot.transferSizes);
+
+	std::vector<std::string> deviceLabels;
+	deviceLabels.reserve(snapshot.devices.size());
+	for (const DeviceMemorySnapshot &device: snapshot.devices) {
+		deviceLabels.push_back(
+				"{device=\"" + std::to_string(device.deviceIndex) + "\",device_name=\"" +
+				escapeLabelValue(device.deviceName) + "\"}"
+		);
+	}
+	writeHeader(output, prefix + "_buffer_live_bytes", "gauge", "Bytes currently allocated by buffers and images.");
+	for (size_t i = 0; i < snapshot.devices.size(); ++i) {
+		output << prefix << "_buffer_live_bytes" << deviceLabels[i] << ' ' << snapshot.devices[i].liveBytes << '\n';
+	}
+	writeHeader(output, prefix + "_buffer_peak_bytes", "gauge", "Most bytes allocated at once by buffers and images.");
+	for (size_t i = 0; i < snapshot.devices.size(); ++i) {
+		output << prefix << "_buffer_peak_bytes" << deviceLabels[i] << ' ' << snapshot.devices[i].peakBytes << '\n';
+	}
+	writeHeader(output, prefix + "_buffer_allocations_total", "counter", "Allocations of buffers and images.");
+	for (size_t i = 0; i < snapshot.devices.size(); ++i) {
+		output << prefix << "_buffer_allocations_total" << deviceLabels[i] << ' '
+			   << snapshot.devices[i].numAllocations << '\n';
+	}
+
+	writeHeader(output, prefix + "_kernel_launches_total", "counter", "Kernel launches per kernel.");
+	for (const auto &[kernelName, numLaunches]: snapshot.kernelLaunches) {
+		output << prefix << "_kernel_launches_total{kernel=\"" << escapeLabelValue(kernelName) << "\"} "
+			   << numLaunches << '\n';
+	}
+
+	writeHeader(output, prefix + "_program_build_duration_seconds", "histogram", "Durations of the program builds.");
+	for (const auto &[kind, durations]: snapshot.buildDurations) {
+		writeHistogram(
+				output,
+				prefix + "_program_build_duration_seconds",
+				"kind=\"" + escapeLabelValue(kind) + "\",",
+				durations
+		);
+	}
+
+	writeHeader(output, prefix + "_cache_hits_total", "counter", "Cache lookups which found the entry.");
+	for (const auto &[cache, lookups]: snapshot.caches) {
+		output << prefix << "_cache_hits_total{cache=\"" << escapeLabelValue(cache) << "\"} " << lookups.numHits
+			   << '\n';
+	}
+	writeHeader(output, prefix + "_cache_misses_total", "counter", "Cache lookups which did not find the entry.");
+	for (const auto &[cache, lookups]: snapshot.caches) {
+		output << prefix << "_cache_misses_total{cache=\"" << escapeLabelValue(cache) << "\"} " << lookups.numMisses
+			   << '\n';
+	}
+	return output.str();
+}
@@ -0,0 +1,378 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "opencl/parallel_primitives.h"
+#include "opencl/program_registry.h"
+#include "opencl/device_info.h"
+#include "primitives_kernels.h"
+#include "work_group_size.h"
+
+using namespace OpenClToolkit;
+
+namespace {
+	/**
+	 * The max number of work groups of the grid-stride kernels.
+	 */
+	constexpr size_t maxNumWorkGroups = 1024;
+
+	template<typename T>
+	struct ElementTypeTraits;
+
+	template<>
+	struct ElementTypeTraits<cl_int> {
+		static constexpr const char *buildOptions = "-DT=int -DT_MIN=INT_MIN -DT_MAX=INT_MAX -DU=uint";
+	};
+
+	template<>
+	struct ElementTypeTraits<cl_uint> {
+		static constexpr const char *buildOptions = "-DT=uint -DT_MIN=0 -DT_MAX=UINT_MAX -DU=uint";
+	};
+
+	template<>
+	struct ElementTypeTraits<cl_long> {
+		static constexpr const char *buildOptions = "-DT=long -DT_MIN=LONG_MIN -DT_MAX=LONG_MAX -DU=ulong";
+	};
+
+	template<>
+	struct ElementTypeTraits<cl_ulong> {
+		static constexpr const char *buildOptions = "-DT=ulong -DT_MIN=0 -DT_MAX=ULONG_MAX -DU=ulong";
+	};
+
+	template<>
+	struct ElementTypeTraits<cl_float> {
+		static constexpr const char *buildOptions = "-DT=float -DT_MIN=-INFINITY -DT_MAX=INFINITY";
+	};
+
+	template<>
+	struct ElementTypeTraits<cl_double> {
+		static constexpr const char *buildOptions = "-DT=double -DT_MIN=-INFINITY -DT_MAX=INFINITY";
+	};
+
+	template<typename T>
+	T getIdentity(const BinaryOperation operation) {
+		switch (operation) {
+			case BinaryOperation::Min:
+				return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+															: std::numeric_limits<T>::max();
+			case BinaryOperation::Max:
+				return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+															: std::numeric_limits<T>::lowest();
+			default:
+				return T(0);
+		}
+	}
+}
+
+template<typename T>
+[[maybe_unused]] ParallelPrimitives<T>::ParallelPrimitives(
+		const Context &context,
+		cl_device_id device,
+		CommandQueue &commandQueue,
+		const BinaryOperation operation
+) : context_(context), device_(device), commandQueue_(commandQueue), operation_(operation) {
+	std::string buildOptions = std::string(ElementTypeTraits<T>::buildOptions) +
+							   " -DOPERATION=" + std::to_string(static_cast<int>(operation));
+	if (DeviceInfo::get(device).hasExtension("cl_khr_subgroups")) {
+		buildOptions += " -cl-std=CL2.0 -DUSE_SUBGROUPS";
+	}
+
+	auto &registry = ProgramRegistry::getInstance();
+	const auto program = registry.acquire(primitivesKernelSourceCode, "reduce", context, device, buildOptions);
+	// private kernels of the shared program, so the kernel arguments of different instances do not interfere
+	reduce_ = std::make_unique<Program>(*program, "reduce");
+	scanBlocks_ = std::make_unique<Program>(*program, "scanBlocks");
+	addBlockOffsets_ = std::make_unique<Program>(*program, "addBlockOffsets");
+	markNonZero_ = std::make_unique<Program>(*program, "markNonZero");
+	scatterFlagged_ = std::make_unique<Program>(*program, "scatterFlagged");
+	histogramLocal_ = std::make_unique<Program>(*program, "histogramLocal");
+	histogramGlobal_ = std::make_unique<Program>(*program, "histogramGlobal");
+
+	// the flags of a stream compaction are scanned by a cl_uint sum specialization of the same source
+	const auto flagProgram = registry.acquire(
+			primitivesKernelSourceCode,
+			"scanBlocks",
+			context,
+			device,
+			std::string(ElementTypeTraits<cl_uint>::buildOptions) + " -DOPERATION=0"
+	);
+	scanFlagBlocks_ = std::make_unique<Program>(*flagProgram, "scanBlocks");
+	addFlagBlockOffsets_ = std::make_unique<Program>(*flagProgram, "addBlockOffsets");
+	// flags greater than 1 would make the scan skip positions
+	normalizeFlags_ = std::make_unique<Program>(*flagProgram, "markNonZero");
+
+	reduceWorkGroupSize_ = chooseWorkGroupSize(*reduce_, sizeof(T));
+	// a tile of a scan holds two elements per work item
+	scanWorkGroupSize_ = std::min(
+			chooseWorkGroupSize(*scanBlocks_, 2 * sizeof(T)),
+			chooseWorkGroupSize(*addBlockOffsets_, 0)
+	);
+	flagScanWorkGroupSize_ = std::min(
+			chooseWorkGroupSize(*scanFlagBlocks_, 2 * sizeof(cl_uint)),
+			chooseWorkGroupSize(*addFlagBlockOffsets_, 0)
+	);
+	elementWiseWorkGroupSize_ = std::min({
+			chooseWorkGroupSize(*markNonZero_, 0),
+			chooseWorkGroupSize(*scatterFlagged_, 0),
+			chooseWorkGroupSize(*normalizeFlags_, 0)
+	});
+}
+
+template<typename T>
+[[maybe_unused]] T ParallelPrimitives<T>::reduce(const BaseBuffer &input, const size_t numElements) {
+	if (!numElements) {
+		return getIdentity<T>(operation_);
+	}
+
+	// the number of partial results never exceeds the work group size, so a second pass with one work group suffices
+	const size_t workGroupSize = reduceWorkGroupSize_;
+	const size_t numWorkGroups = std::min((numElements + workGroupSize - 1) / workGroupSize, workGroupSize);
+	ReadWriteBuffer partialResults(context_, numWorkGroups * sizeof(T));
+	ReadWriteBuffer result(context_, sizeof(T));
+
+	const cl_ulong n = numElements;
+	reduce_->setKernelArg(0, sizeof(cl_mem), input);
+	reduce_->setKernelArg(1, sizeof(cl_mem), numWorkGroups > 1 ? partialResults : result);
+	reduce_->setKernelArg(2, sizeof(cl_ulong), &n);
+	reduce_->setKernelArg(3, workGroupSize * sizeof(T), static_cast<const void *>(nullptr));
+	commandQueue_.enqueueCommandExecuteProgramOnDevice(*reduce_, numWorkGroups * workGroupSize, workGroupSize);
+
+	if (numWorkGroups > 1) {
+		const cl_ulong numPartialResults = numWorkGroups;
+		reduce_->setKernelArg(0, sizeof(cl_mem), partialResults);
+		reduce_->setKernelArg(1, sizeof(cl_mem), result);
+		reduce_->setKernelArg(2, sizeof(cl_ulong), &numPartialResults);
+		commandQueue_.enqueueCommandExecuteProgramOnDevice(*reduce_, workGroupSize, workGroupSize);
+	}
+
+	T value;
+	commandQueue_.enqueueCommandCopyBytesFromDeviceMemoryIntoHostMemory(result, &value, sizeof(T));
+	return value;
+}
+
+template<typename T>
+[[maybe_unused]] void ParallelPrimitives<T>::scan(
+		const BaseBuffer &input,
+		const BaseBuffer &output,
+		const size_t numElements,
+		const bool isInclusive
+) {
+	if (numElements) {
+		enqueueScan(*scanBlocks_, *addBlockOffsets_, scanWorkGroupSize_, sizeof(T), input, output, numElements,
+					isInclusive);
+	}
+}
+
+template<typename T>
+[[maybe_unused]] size_t ParallelPrimitives<T>::compact(
+		const BaseBuffer &input,
+		const BaseBuffer &flags,
+		const BaseBuffer &output,
+		const size_t numElements
+) {
+	if (!numElements) {
+		return 0;
+	}
+
+	ReadWriteBuffer normalizedFlags(context_, numElements * sizeof(cl_uint));
+	const cl_ulong n = numElements;
+	normalizeFlags_->setKernelArg(0, sizeof(cl_mem), flags);
+	normalizeFlags_->setKernelArg(1, sizeof(cl_mem), normalizedFlags);
+	normalizeFlags_->setKernelArg(2, sizeof(cl_ulong), &n);
+	commandQueue_.enqueueCommandExecuteProgramOnDevice(
+			*normalizeFlags_,
+			roundUp(numElements, elementWiseWorkGroupSize_),
+			elementWiseWorkGroupSize_
+	);
+	return compactNormalized(input, normalizedFlags, output, numElements);
+}
+
+template<typename T>
+size_t ParallelPrimitives<T>::compactNormalized(
+		const BaseBuffer &input,
+		const BaseBuffer &normalizedFlags,
+		const BaseBuffer &output,
+		const size_t numElements
+) {
+	ReadWriteBuffer positions(context_, numElements * sizeof(cl_uint));
+	ReadWriteBuffer count(context_, sizeof(cl_uint));
+	enqueueScan(*scanFlagBlocks_, *addFlagBlockOffsets_, flagScanWorkGroupSize_, sizeof(cl_uint), normalizedFlags,
+				positions, numElements, false);
+
+	const cl_ulong n = numElements;
+	scatterFlagged_->setKernelArg(0, sizeof(cl_mem), input);
+	scatterFlagged_->setKernelArg(1, sizeof(cl_mem), normalizedFlags);
+	scatterFlagged_->setKernelArg(2, sizeof(cl_mem), positions);
+	scatterFlagged_->setKernelArg(3, sizeof(cl_mem), output);
+	scatterFlagged_->setKernelArg(4, sizeof(cl_mem), count);
+	scatterFlagged_->setKernelArg(5, sizeof(cl_ulong), &n);
+	commandQueue_.enqueueCommandExecuteProgramOnDevice(
+			*scatterFlagged_,
+			roundUp(numElements, elementWiseWorkGroupSize_),
+			elementWiseWorkGroupSize_
+	);
+
+	cl_uint numKeptElements;
+	commandQueue_.enqueueCommandCopyBytesFromDeviceMemoryIntoHostMemory(count, &numKeptElements, sizeof(cl_uint));
+	return numKeptElements;
+}
+
+template<typename T>
+[[maybe_unused]] size_t ParallelPrimitives<T>::compactNonZero(
+		const BaseBuffer &input,
+		const BaseBuffer &output,
+		const size_t numElements
+) {
+	if (!numElements) {
+		return 0;
+	}
+
+	ReadWriteBuffer flags(context_, numElements * sizeof(cl_uint));
+	const cl_ulong n = numElements;
+	markNonZero_->setKernelArg(0, sizeof(cl_mem), input);
+	markNonZero_->setKernelArg(1, sizeof(cl_mem), flags);
+	markNonZero_->setKernelArg(2, sizeof(cl_ulong), &n);
+	commandQueue_.enqueueCommandExecuteProgramOnDevice(
+			*markNonZero_,
+			roundUp(numElements, elementWiseWorkGroupSize_),
+			elementWiseWorkGroupSize_
+	);
+	return compactNormalized(input, flags, output, numElements);
+}
+
+template<typename T>
+[[maybe_unused]] void ParallelPrimitives<T>::histogram(
+		const BaseBuffer &input,
+		const size_t numElements,
+		const BaseBuffer &bins,
+		const cl_uint numBins,
+		const T lowerBound,
+		const T upperBound
+) {
+	if (!(lowerBound < upperBound) || !numBins) {
+		// let it crash
+		throw std::runtime_error("Cannot compute histogram: the range is empty or there are no bins");
+	}
+
+	const cl_uint zero = 0;
+	commandQueue_.enqueueCommandFillDeviceMemory(bins, &zero, sizeof(cl_uint), numBins * sizeof(cl_uint));
+	if (!numElements) {
+		return;
+	}
+
+	const cl_ulong n = numElements;
+	// the local bins of a work group must fit into the local memory, else count in global memory directly
+	const bool useLocalBins = numBins * sizeof(cl_uint) <= histogramLocal_->getDeviceLocalMemorySizeInBytes();
+	Program &kernel = useLocalBins ? *histogramLocal_ : *histogramGlobal_;
+	const size_t workGroupSize = chooseWorkGroupSize(kernel, 0);
+	const size_t numWorkGroups = std::min((numElements + workGroupSize - 1) / workGroupSize, maxNumWorkGroups);
+
+	kernel.setKernelArg(0, sizeof(cl_mem), input);
+	kernel.setKernelArg(1, sizeof(cl_ulong), &n);
+	kernel.setKernelArg(2, sizeof(cl_mem), bins);
+	kernel.setKernelArg(3, sizeof(cl_uint), &numBins);
+	kernel.setKernelArg(4, sizeof(T), &lowerBound);
+	if constexpr (std::is_integral_v<T>) {
+		// the kernel computes the bins exactly from the unsigned range, which cannot overflow
+		using Unsigned = std::make_unsigned_t<T>;
+		const Unsigned range = static_cast<Unsigned>(upperBound) - static_cast<Unsigned>(lowerBound);
+		kernel.setKernelArg(5, sizeof(range), &range);
+	} else {
+		const auto binsPerUnit = static_cast<T>(
+				numBins / (static_cast<double>(upperBound) - static_cast<double>(lowerBound))
+		);
+		kernel.setKernelArg(5, sizeof(T), &binsPerUnit);
+	}
+	if (useLocalBins) {
+		kernel.setKernelArg(6, numBins * sizeof(cl_uint), static_cast<const void *>(nullptr));
+	}
+	commandQueue_.enqueueCommandExecuteProgramOnDevice(kernel, numWorkGroups * workGroupSize, workGroupSize);
+}
+
+template<typename T>
+[[maybe_unused]] void ParallelPrimitives<T>::transform(
+		const BaseBuffer &input,
+		const BaseBuffer &output,
+		const size_t numElements,
+		const std::string &operation
+) {
+	if (!numElements) {
+		return;
+	}
+
+	auto iterator = transforms_.find(operation);
+	if (iterator == transforms_.end()) {
+		const std::string sourceCode = "#define TRANSFORM(x) (" + operation + ")\n" + transformKernelSourceCode;
+		const auto program = ProgramRegistry::getInstance().acquire(
+				sourceCode,
+				"transform",
+				context_,
+				device_,
+				ElementTypeTraits<T>::buildOptions
+		);
+		auto kernel = std::make_unique<Program>(*program, "transform");
+		const size_t workGroupSize = chooseWorkGroupSize(*kernel, 0);
+		iterator = transforms_.emplace(operation, Transform{std::move(kernel), workGroupSize}).first;
+	}
+
+	const Transform &transformKernel = iterator->second;
+	const cl_ulong n = numElements;
+	transformKernel.kernel->setKernelArg(0, sizeof(cl_mem), input);
+	transformKernel.kernel->setKernelArg(1, sizeof(cl_mem), output);
+	transformKernel.kernel->setKernelArg(2, sizeof(cl_ulong), &n);
+	commandQueue_.enqueueCommandExecuteProgramOnDevice(
+			*transformKernel.kernel,
+			roundUp(numElements, transformKernel.workGroupSize),
+			transformKernel.workGroupSize
+	);
+}
+
+template<typename T>
+void ParallelPrimitives<T>::enqueueScan(
+		Program &scanBlocks,
+		Program &addBlockOffsets,
+		const size_t workGroupSize,
+		const size_t elementSize,
+		cl_mem input,
+		cl_mem output,
+		const size_t numElements,
+		const bool isInclusive
+) {
+	const size_t tileSize = 2 * workGroupSize;
+	const size_t numTiles = (numElements + tileSize - 1) / tileSize;
+	// released buffers are kept alive by the OpenCL implementation until the enqueued commands have completed
+	ReadWriteBuffer blockSums(context_, numTiles * elementSize);
+
+	const cl_ulong n = numElements;
+	const cl_uint inclusive = isInclusive ? 1 : 0;
+	scanBlocks.setKernelArg(0, sizeof(cl_mem), input);
+	scanBlocks.setKernelArg(1, sizeof(cl_mem), output);
+	scanBlocks.setKernelArg(2, sizeof(cl_mem), blockSums);
+	scanBlocks.setKernelArg(3, sizeof(cl_ulong), &n);
+	scanBlocks.setKernelArg(4, sizeof(cl_uint), &inclusive);
+	scanBlocks.setKernelArg(5, tileSize * elementSize, static_cast<const void *>(nullptr));
+	commandQueue_.enqueueCommandExecuteProgramOnDevice(scanBlocks, numTiles * workGroupSize, workGroupSize);
+
+	if (numTiles > 1) {
+		// the exclusive scan of the tile totals is the offset of each tile
+		enqueueScan(scanBlocks, addBlockOffsets, workGroupSize, elementSize, blockSums, blockSums, numTiles, false);
+		addBlockOffsets.setKernelArg(0, sizeof(cl_mem), output);
+		addBlockOffsets.setKernelArg(1, sizeof(cl_mem), blockSums);
+		addBlockOffsets.setKernelArg(2, sizeof(cl_ulong), &n);
+		commandQueue_.enqueueCommandExecuteProgramOnDevice(addBlockOffsets, numTiles * workGroupSize, workGroupSize);
+	}
+}
+
+template<typename T>
+size_t ParallelPrimitives<T>::roundUp(const size_t numElements, const size_t workGroupSize) {
+	return (numElements + workGroupSize - 1) / workGroupSize * workGroupSize;
+}
+
+template class OpenClToolkit::ParallelPrimitives<cl_int>;
+template class OpenClToolkit::ParallelPrimitives<cl_uint>;
+template class OpenClToolkit::ParallelPrimitives<cl_long>;
+template class OpenClToolkit::ParallelPrimitives<cl_ulong>;
+template class OpenClToolkit::ParallelPrimitives<cl_float>;
+template class OpenClToolkit::ParallelPrimitives<cl_double>;
@@ -0,0 +1,111 @@
+#include <iostream>
+#include <stdexcept>
+
+#include "opencl/pipe.h"
+#include "opencl/device_info.h"
+#include "opencl/error.h"
+#include "opencl/event.h"
+
+using namespace OpenClToolkit;
+
+[[maybe_unused]] Pipe::Pipe(const Context &context, const cl_uint packetSizeInBytes, const cl_uint maxNumPackets) :
+		packetSizeInBytes_(packetSizeInBytes),
+		maxNumPackets_(maxNumPackets) {
+	for (cl_device_id device: context.getDevices()) {
+		const DeviceInfo &info = DeviceInfo::get(device);
+		if (!info.hasPipeSupport) {
+			// let it crash
+			throw std::runtime_error("Failed to create pipe: " + info.name + " does not support pipes");
+		}
+		if (info.maxPipePacketSize && packetSizeInBytes > info.maxPipePacketSize) {
+			// let it crash
+			throw std::runtime_error("Failed to create pipe: " + info.name + " supports packets of up to " +
+									 std::to_string(info.maxPipePacketSize) + " bytes only");
+		}
+	}
+	cl_int status;
+	self_ = clCreatePipe(context, CL_MEM_READ_WRITE, packetSizeInBytes, maxNumPackets, nullptr, &status);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Failed to create pipe: " + toErrorDescription(status));
+	}
+}
+
+Pipe::~Pipe() {
+	const cl_int status = clReleaseMemObject(self_);
+	if (status) {
+		std::cerr << "Failed to release pipe: " + toErrorDescription(status) << std::endl;
+	}
+}
+
+Pipe::operator cl_mem() const {
+	return self_;
+}
+
+[[maybe_unused]] cl_uint Pipe::getPacketSizeInBytes() const {
+	return packetSizeInBytes_;
+}
+
+[[maybe_unused]] cl_uint Pipe::getMaxNumPackets() const {
+	return maxNumPackets_;
+}
+
+[[maybe_unused]] bool Pipe::isSupported(cl_device_id device) {
+	return DeviceInfo::get(device).hasPipeSupport;
+}
+
+[[maybe_unused]] PipeLauncher::PipeLauncher(const Context &context, cl_device_id device, const Pipe &pipe) :
+		pipe_(pipe),
+		producerQueue_(context, device),
+		consumerQueue_(context, device) {}
+
+[[maybe_unused]] void PipeLauncher::launch(
+		const PipeStage &producer,
+		const PipeStage &consumer,
+		const PipeScheduling scheduling
+) {
+	producer.program.setKernelArg(producer.pipeArgIndex, pipe_);
+	consumer.program.setKernelArg(consumer.pipeArgIndex, pipe_);
+	const Event produced = producerQueue_.enqueueCommandExecuteProgramOnDeviceAsync(
+			producer.program,
+			producer.globalWorkSize,
+			producer.localWorkSize
+	);
+	if (scheduling == PipeScheduling::ProducerFirst) {
+		const cl_event event = produced;
+		const cl_int status = clEnqueueBarrierWithWaitList(consumerQueue_, 1, &event, nullptr);
+		if (status) {
+			// let it crash
+			throw std::runtime_error("Failed to order the pipe stages: " + toErrorDescription(status));
+		}
+	}
+	// both stages are submitted before either is awaited, so they may overlap
+	cl_int status = clFlush(producerQueue_);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Failed to flush the producer queue: " + toErrorDescription(status));
+	}
+	consumerQueue_.enqueueCommandExecuteProgramOnDevice(
+			consumer.program,
+			consumer.globalWorkSize,
+			consumer.localWorkSize
+	);
+	status = clFlush(consumerQueue_);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Failed to flush the consumer queue: " + toErrorDescription(status));
+	}
+}
+
+[[maybe_unused]] void PipeLauncher::finish() {
+	producerQueue_.finish();
+	consumerQueue_.finish();
+}
+
+[[maybe_unused]] CommandQueue &PipeLauncher::getProducerQueue() {
+	return producerQueue_;
+}
+
+[[maybe_unused]] CommandQueue &PipeLauncher::getConsumerQueue() {
+	return consumerQueue_;
+}
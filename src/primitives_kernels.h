@@ -0,0 +1,298 @@
+#ifndef OPENCL_TOOLKIT_PRIMITIVES_KERNELS_H
+#define OPENCL_TOOLKIT_PRIMITIVES_KERNELS_H
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief The source code of the parallel primitives kernels.
+	 * @details The kernels are specialized by the build options:
+	 * <ul>
+	 *     <li><code>T</code>: the element type, e.g. <code>float</code></li>
+	 *     <li><code>T_MIN</code>, <code>T_MAX</code>: the limits of the element type</li>
+	 *     <li><code>U</code>: the unsigned counterpart of an integer element type, undefined for floating point</li>
+	 *     <li><code>OPERATION</code>: 0 for sum, 1 for min and 2 for max</li>
+	 *     <li><code>USE_SUBGROUPS</code>: if defined, work group reductions use subgroup functions</li>
+	 * </ul>
+	 * All kernels expect work group sizes which are a power of two.
+	 */
+	inline constexpr const char *primitivesKernelSourceCode = R"CLC(
+#if defined(cl_khr_fp64)
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+#endif
+#if defined(USE_SUBGROUPS)
+#pragma OPENCL EXTENSION cl_khr_subgroups : enable
+#endif
+
+#if OPERATION == 0
+#define OP(a, b) ((a) + (b))
+#define IDENTITY ((T) 0)
+#define SUB_GROUP_REDUCE sub_group_reduce_add
+#elif OPERATION == 1
+#define OP(a, b) min((a), (b))
+#define IDENTITY ((T) T_MAX)
+#define SUB_GROUP_REDUCE sub_group_reduce_min
+#else
+#define OP(a, b) max((a), (b))
+#define IDENTITY ((T) T_MIN)
+#define SUB_GROUP_REDUCE sub_group_reduce_max
+#endif
+
+// Reduces the passed values of all work items of the work group. The result is valid in work item 0 only.
+T reduceWorkGroup(T value, __local T *scratch) {
+	const uint localId = get_local_id(0);
+#if defined(USE_SUBGROUPS)
+	value = SUB_GROUP_REDUCE(value);
+	if (get_sub_group_local_id() == 0) {
+		scratch[get_sub_group_id()] = value;
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+	if (get_sub_group_id() == 0) {
+		value = IDENTITY;
+		for (uint i = get_sub_group_local_id(); i < get_num_sub_groups(); i += get_sub_group_size()) {
+			value = OP(value, scratch[i]);
+		}
+		value = SUB_GROUP_REDUCE(value);
+	}
+	return value;
+#else
+	scratch[localId] = value;
+	barrier(CLK_LOCAL_MEM_FENCE);
+	for (uint stride = get_local_size(0) >> 1; stride > 0; stride >>= 1) {
+		if (localId < stride) {
+			scratch[localId] = OP(scratch[localId], scratch[localId + stride]);
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+	return scratch[0];
+#endif
+}
+
+// Reduces the input to one partial result per work group.
+__kernel void reduce(__global const T *input, __global T *partialResults, const ulong n, __local T *scratch) {
+	T value = IDENTITY;
+	for (ulong i = get_global_id(0); i < n; i += get_global_size(0)) {
+		value = OP(value, input[i]);
+	}
+	value = reduceWorkGroup(value, scratch);
+	if (get_local_id(0) == 0) {
+		partialResults[get_group_id(0)] = value;
+	}
+}
+
+// Scans tiles of 2 * work group size elements with the work-efficient Blelloch algorithm and stores the total of each
+// tile in blockSums. The input and the output may be the same buffer.
+__kernel void scanBlocks(
+		__global const T *input,
+		__global T *output,
+		__global T *blockSums,
+		const ulong n,
+		const uint isInclusive,
+		__local T *tile
+) {
+	const uint localId = get_local_id(0);
+	const uint localSize = get_local_size(0);
+	const uint tileSize = localSize << 1;
+	const ulong first = get_group_id(0) * (ulong) tileSize + localId;
+	const ulong second = first + localSize;
+	const T firstValue = first < n ? input[first] : IDENTITY;
+	const T secondValue = second < n ? input[second] : IDENTITY;
+	tile[localId] = firstValue;
+	tile[localId + localSize] = secondValue;
+
+	// up-sweep: build the reduction tree in place
+	uint distance = 1;
+	for (uint active = localSize; active > 0; active >>= 1) {
+		barrier(CLK_LOCAL_MEM_FENCE);
+		if (localId < active) {
+			const uint left = distance * (2 * localId + 1) - 1;
+			const uint right = distance * (2 * localId + 2) - 1;
+			tile[right] = OP(tile[left], tile[right]);
+		}
+		distance <<= 1;
+	}
+	if (localId == 0) {
+		blockSums[get_group_id(0)] = tile[tileSize - 1];
+		tile[tileSize - 1] = IDENTITY;
+	}
+
+	// down-sweep: distribute the partial results
+	for (uint active = 1; active < tileSize; active <<= 1) {
+		distance >>= 1;
+		barrier(CLK_LOCAL_MEM_FENCE);
+		if (localId < active) {
+			const uint left = distance * (2 * localId + 1) - 1;
+			const uint right = distance * (2 * localId + 2) - 1;
+			const T leftValue = tile[left];
+			tile[left] = tile[right];
+			tile[right] = OP(tile[right], leftValue);
+		}
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	if (first < n) {
+		output[first] = isInclusive ? OP(tile[localId], firstValue) : tile[localId];
+	}
+	if (second < n) {
+		output[second] = isInclusive ? OP(tile[localId + localSize], secondValue) : tile[localId + localSize];
+	}
+}
+
+// Combines each element of a tile with the exclusive scan of the tile totals.
+__kernel void addBlockOffsets(__global T *data, __global const T *blockOffsets, const ulong n) {
+	const uint localSize = get_local_size(0);
+	const T offset = blockOffsets[get_group_id(0)];
+	const ulong first = get_group_id(0) * (ulong) (localSize << 1) + get_local_id(0);
+	if (first < n) {
+		data[first] = OP(offset, data[first]);
+	}
+	if (first + localSize < n) {
+		data[first + localSize] = OP(offset, data[first + localSize]);
+	}
+}
+
+// Flags the non-zero elements of the input.
+__kernel void markNonZero(__global const T *input, __global uint *flags, const ulong n) {
+	const ulong i = get_global_id(0);
+	if (i < n) {
+		flags[i] = input[i] != (T) 0;
+	}
+}
+
+// Moves the flagged elements to the positions computed by an exclusive scan of the flags and stores their count. The
+// flags must be 0 or 1, else the scan skips positions.
+__kernel void scatterFlagged(
+		__global const T *input,
+		__global const uint *flags,
+		__global const uint *positions,
+		__global T *output,
+		__global uint *count,
+		const ulong n
+) {
+	const ulong i = get_global_id(0);
+	if (i < n) {
+		if (flags[i]) {
+			output[positions[i]] = input[i];
+		}
+		if (i == n - 1) {
+			*count = positions[i] + (flags[i] != 0);
+		}
+	}
+}
+
+#if defined(U)
+#define BIN_SCALE U
+// Returns the bin of an element which is at least the lower bound, or numBins if the element is not below the upper
+// bound. The bin is the distance to the lower bound times the number of bins divided by the range, computed exactly
+// on the unsigned integers.
+uint toBin(const T value, const T lowerBound, const uint numBins, const U range) {
+	const ulong distance = (U) value - (U) lowerBound;
+	if (distance >= range) {
+		return numBins;
+	}
+	if (sizeof(U) < sizeof(ulong)) {
+		// the product of 32 bit integers fits into 64 bits
+		return (uint) (distance * numBins / range);
+	}
+	// long division of the 128 bit product, whose quotient is below the number of bins and thus fits into 32 bits,
+	// so the upper half of the product divided by 2^32 is already below the range
+	const ulong low = distance * numBins;
+	ulong remainder = (mul_hi(distance, (ulong) numBins) << 32) | (low >> 32);
+	uint bin = 0;
+	for (int i = 31; i >= 0; --i) {
+		const ulong carry = remainder >> 63;
+		remainder = (remainder << 1) | ((low >> i) & 1);
+		bin <<= 1;
+		if (carry || remainder >= range) {
+			remainder -= range;
+			bin |= 1;
+		}
+	}
+	return bin;
+}
+#else
+#define BIN_SCALE T
+// Returns the bin of an element which is at least the lower bound, or numBins if the element is not below the upper
+// bound.
+uint toBin(const T value, const T lowerBound, const uint numBins, const T binsPerUnit) {
+	const T bin = (value - lowerBound) * binsPerUnit;
+	return bin < (T) numBins ? (uint) bin : numBins;
+}
+#endif
+
+// Counts the elements per bin in local memory first, then merges the bins of the work group into the global bins.
+__kernel void histogramLocal(
+		__global const T *input,
+		const ulong n,
+		__global uint *bins,
+		const uint numBins,
+		const T lowerBound,
+		const BIN_SCALE binScale,
+		__local uint *localBins
+) {
+	for (uint i = get_local_id(0); i < numBins; i += get_local_size(0)) {
+		localBins[i] = 0;
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+	for (ulong i = get_global_id(0); i < n; i += get_global_size(0)) {
+		const T value = input[i];
+		if (value >= lowerBound) {
+			const uint bin = toBin(value, lowerBound, numBins, binScale);
+			if (bin < numBins) {
+				atomic_inc(&localBins[bin]);
+			}
+		}
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+	for (uint i = get_local_id(0); i < numBins; i += get_local_size(0)) {
+		if (localBins[i]) {
+			atomic_add(&bins[i], localBins[i]);
+		}
+	}
+}
+
+// Counts the elements per bin directly in global memory, for bin counts exceeding the local memory.
+__kernel void histogramGlobal(
+		__global const T *input,
+		const ulong n,
+		__global uint *bins,
+		const uint numBins,
+		const T lowerBound,
+		const BIN_SCALE binScale
+) {
+	for (ulong i = get_global_id(0); i < n; i += get_global_size(0)) {
+		const T value = input[i];
+		if (value >= lowerBound) {
+			const uint bin = toBin(value, lowerBound, numBins, binScale);
+			if (bin < numBins) {
+				atomic_inc(&bins[bin]);
+			}
+		}
+	}
+}
+)CLC";
+
+	/**
+	 * @brief The source code of the element-wise transform kernel.
+	 * @details The kernel is specialized by the build options <code>T</code>, the element type, and by the macro
+	 * <code>TRANSFORM(x)</code>, which must be defined in front of the source code.
+	 */
+	inline constexpr const char *transformKernelSourceCode = R"CLC(
+#if defined(cl_khr_fp64)
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+#endif
+
+// Applies TRANSFORM to each element. The output may be the input.
+__kernel void transform(__global const T *input, __global T *output, const ulong n) {
+	const ulong i = get_global_id(0);
+	if (i < n) {
+		const T x = input[i];
+		output[i] = TRANSFORM(x);
+	}
+}
+)CLC";
+}
+
+#endif //OPENCL_TOOLKIT_PRIMITIVES_KERNELS_H
@@ -1,7 +1,14 @@
+#include <chrono>
+#include <cstring>
 #include <stdexcept>
 #include <iostream>
 
 #include "opencl/program.h"
+#include "opencl/error.h"
+#include "opencl/command_recorder.h"
+#include "opencl/metrics_collector.h"
+#include "opencl/pipe.h"
+#include "build_log.h"
 
 using namespace OpenClToolkit;
 
@@ -9,7 +16,8 @@ using namespace OpenClToolkit;
 		const char *kernelSourceCode,
 		const std::string &kernelName,
 		const Context& context,
-		cl_device_id device
+		cl_device_id device,
+		const std::string &buildOptions
 ) : kernelName_(kernelName), device_(device) {
 	cl_int status;
 	program_ = clCreateProgramWithSource(
@@ -25,38 +33,150 @@ using namespace OpenClToolkit;
 				"Cannot create OpenCL-program: " + getProgramCreationFailureReason(status)
 		);
 	}
+	CommandRecorder::getInstance().recordProgram(
+			program_,
+			RecordedProgramKind::Source,
+			buildOptions,
+			kernelSourceCode,
+			std::strlen(kernelSourceCode)
+	);
+
+	buildAndCreateKernel(buildOptions, "source");
+}
 
-	status = clBuildProgram(
+[[maybe_unused]] Program::Program(
+		const void *intermediateLanguage,
+		const size_t intermediateLanguageSizeInBytes,
+		const std::string &kernelName,
+		const Context &context,
+		cl_device_id device,
+		const std::string &buildOptions
+) : kernelName_(kernelName), device_(device) {
+	if (!isIntermediateLanguageSupported(device)) {
+		// let it crash
+		throw std::runtime_error(
+				"Cannot create OpenCL-program: the target device does not accept SPIR-V modules"
+		);
+	}
+
+	cl_int status;
+	program_ = clCreateProgramWithIL(
+			context,
+			intermediateLanguage,
+			intermediateLanguageSizeInBytes,
+			&status
+	);
+	if (status) {
+		// let it crash
+		throw std::runtime_error(
+				"Cannot create OpenCL-program from intermediate language: " + getProgramCreationFailureReason(status)
+		);
+	}
+	CommandRecorder::getInstance().recordProgram(
 			program_,
+			RecordedProgramKind::IntermediateLanguage,
+			buildOptions,
+			intermediateLanguage,
+			intermediateLanguageSizeInBytes
+	);
+
+	buildAndCreateKernel(buildOptions, "intermediate_language");
+}
+
+[[maybe_unused]] Program::Program(
+		const char *kernelSourceCode,
+		const std::string &kernelName,
+		KernelLibrary &library,
+		const Context &context,
+		cl_device_id device,
+		const std::string &buildOptions
+) : kernelName_(kernelName), device_(device) {
+	// the library object is owned by the library, the compiled kernel object is released after linking
+	cl_program compiledLibrary = library.getCompiledObject(device);
+	const auto buildStart = std::chrono::steady_clock::now();
+	const cl_program inputPrograms[] = {library.compile(kernelSourceCode, device, buildOptions), compiledLibrary};
+
+	cl_int status;
+	program_ = clLinkProgram(
+			context,
 			1,
 			&device,
 			nullptr,
+			2,
+			inputPrograms,
+			nullptr,
+			nullptr,
+			&status
+	);
+	clReleaseProgram(inputPrograms[0]);
+
+	if (status) {
+		if (program_) {
+			std::cerr << "There were problems while linking the kernel: " << std::endl
+					  << getBuildLog(program_, device) << std::endl;
+			clReleaseProgram(program_);
+		}
+		// let it crash
+		throw std::runtime_error("Cannot link OpenCL-program: " + toErrorDescription(status));
+	}
+	MetricsCollector::getInstance().recordBuild(
+			"linked",
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - buildStart).count()
+	);
+	CommandRecorder::getInstance().recordLinkedProgram(program_, library, kernelSourceCode, buildOptions);
+
+	createKernel();
+}
+
+[[maybe_unused]] Program::Program(const Program &builtProgram, const std::string &kernelName) :
+		program_(builtProgram.program_), kernelName_(kernelName), device_(builtProgram.device_) {
+	const cl_int status = clRetainProgram(program_);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Cannot retain OpenCL-program: " + toErrorDescription(status));
+	}
+	try {
+		createKernel();
+	} catch (...) {
+		clReleaseProgram(program_);
+		throw;
+	}
+}
+
+void Program::buildAndCreateKernel(const std::string &buildOptions, const char *buildKind) {
+	const auto buildStart = std::chrono::steady_clock::now();
+	cl_int status = clBuildProgram(
+			program_,
+			1,
+			&device_,
+			buildOptions.c_str(),
 			nullptr,
 			nullptr
 	);
+	MetricsCollector::getInstance().recordBuild(
+			buildKind,
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - buildStart).count()
+	);
 
 	if (status) {
 		std::cerr << "There were problems while building the kernel: " << std::endl;
-		char buildLog[4096];
-		clGetProgramBuildInfo(
-				program_,
-				device,
-				CL_PROGRAM_BUILD_LOG,
-				sizeof(char) * 4096,
-				buildLog,
-				nullptr
-		);
-		std::cerr << buildLog << std::endl;
+		std::cerr << getBuildLog(program_, device_) << std::endl;
 		// let it crash
 		throw std::runtime_error("Cannot build OpenCL-program: " + getProgramBuildFailureReason(status));
 	}
 
-	kernel_ = clCreateKernel(program_, kernelName.c_str(), &status);
+	createKernel();
+}
+
+void Program::createKernel() {
+	cl_int status;
+	kernel_ = clCreateKernel(program_, kernelName_.c_str(), &status);
 
 	if (status) {
 		// let it crash
 		throw std::runtime_error("Cannot create kernel: " + getKernelCreationFailureReason(status));
 	}
+	CommandRecorder::getInstance().recordKernel(kernel_, program_, kernelName_);
 }
 
 Program::~Program() {
@@ -104,7 +224,48 @@ Program::~Program() {
 	return kernel_;
 }
 
+[[maybe_unused]] cl_device_id Program::getDevice() const {
+	return device_;
+}
+
+[[maybe_unused]] const std::string &Program::getKernelName() const {
+	return kernelName_;
+}
+
+[[maybe_unused]] KernelResources Program::getKernelResources() const {
+	KernelResources resources{};
+	resources.kernelName = kernelName_;
+	const auto query = [this](const cl_kernel_work_group_info name, const size_t size, void *value) {
+		const cl_int status = clGetKernelWorkGroupInfo(kernel_, device_, name, size, value, nullptr);
+		if (status) {
+			// let it crash
+			throw std::runtime_error("Cannot retrieve the resources of kernel " + kernelName_ + ": " +
+									 getKernelWorkGroupInfoQueryFailureReason(status));
+		}
+	};
+	query(CL_KERNEL_WORK_GROUP_SIZE, sizeof(resources.maxWorkGroupSize), &resources.maxWorkGroupSize);
+	query(CL_KERNEL_COMPILE_WORK_GROUP_SIZE, sizeof(resources.compileWorkGroupSize), resources.compileWorkGroupSize);
+	query(CL_KERNEL_LOCAL_MEM_SIZE, sizeof(resources.localMemorySize), &resources.localMemorySize);
+	query(CL_KERNEL_PRIVATE_MEM_SIZE, sizeof(resources.privateMemorySize), &resources.privateMemorySize);
+	query(
+			CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE,
+			sizeof(resources.preferredWorkGroupSizeMultiple),
+			&resources.preferredWorkGroupSizeMultiple
+	);
+	return resources;
+}
+
 [[maybe_unused]] void Program::setKernelArg(const cl_uint argIndex, const size_t argSize, const void *argValue) {
+	applyKernelArg(argIndex, argSize, argValue);
+	CommandRecorder::getInstance().recordKernelArgument(kernel_, argIndex, argSize, argValue);
+}
+
+[[maybe_unused]] void Program::setKernelArg(cl_uint argIndex, size_t argSize, cl_mem buffer) {
+	applyKernelArg(argIndex, argSize, &buffer);
+	CommandRecorder::getInstance().recordKernelBufferArgument(kernel_, argIndex, buffer);
+}
+
+void Program::applyKernelArg(const cl_uint argIndex, const size_t argSize, const void *argValue) {
 	cl_int status;
 	status = clSetKernelArg(
 			kernel_,
@@ -144,8 +305,48 @@ Program::~Program() {
 	}
 }
 
-[[maybe_unused]] void Program::setKernelArg(cl_uint argIndex, size_t argSize, cl_mem buffer) {
-	setKernelArg(argIndex,argSize, &buffer);
+[[maybe_unused]] void Program::setKernelArg(const cl_uint argIndex, cl_sampler sampler) {
+	applyKernelArg(argIndex, sizeof(cl_sampler), &sampler);
+	CommandRecorder::getInstance().recordKernelSamplerArgument(kernel_, argIndex, sampler);
+}
+
+[[maybe_unused]] void Program::setKernelArg(const cl_uint argIndex, const Pipe &pipe) {
+	const cl_mem memoryObject = pipe;
+	applyKernelArg(argIndex, sizeof(cl_mem), &memoryObject);
+	CommandRecorder::getInstance().recordKernelPipeArgument(
+			kernel_,
+			argIndex,
+			memoryObject,
+			pipe.getPacketSizeInBytes(),
+			pipe.getMaxNumPackets()
+	);
+}
+
+[[maybe_unused]] void Program::setKernelArgSvmPointer(const cl_uint argIndex, const void *pointer) {
+	const cl_int status = clSetKernelArgSVMPointer(kernel_, argIndex, pointer);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Failed to set the shared virtual memory argument " + std::to_string(argIndex) +
+								 ": " + toErrorDescription(status));
+	}
+	CommandRecorder::getInstance().recordUnsupportedKernelArgument(kernel_, argIndex);
+}
+
+[[maybe_unused]] void Program::setIndirectSvmPointers(const std::vector<void *> &pointers) {
+	const cl_int status = clSetKernelExecInfo(
+			kernel_,
+			CL_KERNEL_EXEC_INFO_SVM_PTRS,
+			pointers.size() * sizeof(void *),
+			pointers.data()
+	);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Failed to declare the indirect shared virtual memory: " +
+								 toErrorDescription(status));
+	}
+	if (!pointers.empty()) {
+		CommandRecorder::getInstance().recordIndirectSvmPointers(kernel_);
+	}
 }
 
 size_t Program::getMaxWorkGroupSizeInBytes() const {
@@ -244,7 +445,22 @@ size_t Program::getDeviceLocalMemorySizeInBytes() const {
 	}
 }
 
+[[maybe_unused]] bool Program::isIntermediateLanguageSupported(cl_device_id device) {
+	size_t size = 0;
+	if (clGetDeviceInfo(device, CL_DEVICE_IL_VERSION, 0, nullptr, &size) || size <= 1) {
+		// devices prior OpenCL 2.1 do not know the query at all
+		return false;
+	}
+	std::string ilVersions(size, '\0');
+	if (clGetDeviceInfo(device, CL_DEVICE_IL_VERSION, size, ilVersions.data(), nullptr)) {
+		return false;
+	}
+	return ilVersions.find("SPIR-V") != std::string::npos;
+}
+
 [[maybe_unused]] void Program::execute(cl_command_queue commandQueue, const size_t numThreads) const {
+	CommandRecorder::getInstance().recordLaunch(kernel_, 1, &numThreads, nullptr, nullptr);
+	MetricsCollector::getInstance().recordLaunch(kernelName_);
 	const cl_int status = clEnqueueNDRangeKernel(
 			commandQueue,
 			kernel_,
@@ -331,6 +547,10 @@ std::string Program::getProgramCreationFailureReason(const cl_int errorCode) {
 			return "the passed context is invalid";
 		case CL_INVALID_VALUE:
 			return "NULL was passed for the kernel source code";
+		case CL_INVALID_BINARY:
+			return "the passed intermediate language module is not valid or not supported by the implementation";
+		case CL_INVALID_OPERATION:
+			return "no device in the context supports intermediate languages";
 		case CL_OUT_OF_HOST_MEMORY:
 			return "allocate resources required by the OpenCL implementation on the host";
 		default:
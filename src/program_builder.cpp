@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "opencl/program_builder.h"
+
+using namespace OpenClToolkit;
+
+[[maybe_unused]] ProgramBuilder::ProgramBuilder(size_t numWorkers) : isShuttingDown_(false) {
+	if (!numWorkers) {
+		numWorkers = std::max(1u, std::thread::hardware_concurrency());
+	}
+	workers_.reserve(numWorkers);
+	for (size_t i = 0; i < numWorkers; ++i) {
+		workers_.emplace_back(&ProgramBuilder::work, this);
+	}
+}
+
+ProgramBuilder::~ProgramBuilder() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		isShuttingDown_ = true;
+	}
+	buildSubmitted_.notify_all();
+	for (auto &worker: workers_) {
+		worker.join();
+	}
+}
+
+[[maybe_unused]] std::future<std::unique_ptr<Program>> ProgramBuilder::submit(
+		std::string kernelSourceCode,
+		std::string kernelName,
+		const Context &context,
+		cl_device_id device,
+		std::string buildOptions
+) {
+	return enqueue(std::packaged_task<std::unique_ptr<Program>()>(
+			[source = std::move(kernelSourceCode), name = std::move(kernelName), &context, device,
+					options = std::move(buildOptions)]() {
+				return std::make_unique<Program>(source.c_str(), name, context, device, options);
+			}
+	));
+}
+
+[[maybe_unused]] std::future<std::unique_ptr<Program>> ProgramBuilder::submit(
+		std::vector<unsigned char> intermediateLanguage,
+		std::string kernelName,
+		const Context &context,
+		cl_device_id device,
+		std::string buildOptions
+) {
+	return enqueue(std::packaged_task<std::unique_ptr<Program>()>(
+			[module = std::move(intermediateLanguage), name = std::move(kernelName), &context, device,
+					options = std::move(buildOptions)]() {
+				return std::make_unique<Program>(module.data(), module.size(), name, context, device, options);
+			}
+	));
+}
+
+std::future<std::unique_ptr<Program>> ProgramBuilder::enqueue(std::packaged_task<std::unique_ptr<Program>()> build) {
+	auto future = build.get_future();
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (isShuttingDown_) {
+			// let it crash
+			throw std::runtime_error("Cannot submit build: the program builder is shutting down");
+		}
+		pendingBuilds_.push_back(std::move(build));
+	}
+	buildSubmitted_.notify_one();
+	return future;
+}
+
+void ProgramBuilder::work() {
+	for (;;) {
+		std::packaged_task<std::unique_ptr<Program>()> build;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			buildSubmitted_.wait(lock, [this] { return isShuttingDown_ || !pendingBuilds_.empty(); });
+			if (pendingBuilds_.empty()) {
+				// shutting down and nothing left to build
+				return;
+			}
+			build = std::move(pendingBuilds_.front());
+			pendingBuilds_.pop_front();
+		}
+		// exceptions thrown by the build are stored in the future
+		build();
+	}
+}
@@ -0,0 +1,146 @@
+#include <chrono>
+
+#include "opencl/program_registry.h"
+#include "opencl/metrics_collector.h"
+#include "hash.h"
+
+using namespace OpenClToolkit;
+
+namespace {
+	/**
+	 * @brief Returns the passed registered program if its kernel has the passed name, otherwise another kernel of it.
+	 * The other kernel keeps the registered program referenced, so the registry does not evict it meanwhile.
+	 * @param program the registered program.
+	 * @param kernelName the name of the kernel.
+	 * @return the program with the kernel of the passed name.
+	 */
+	std::shared_ptr<Program> toKernel(const std::shared_ptr<Program> &program, const std::string &kernelName) {
+		if (program->getKernelName() == kernelName) {
+			return program;
+		}
+		return std::shared_ptr<Program>(new Program(*program, kernelName), [program](Program *kernel) {
+			delete kernel;
+		});
+	}
+}
+
+[[maybe_unused]] ProgramRegistry::ProgramRegistry(const size_t capacity) : capacity_(capacity) {
+
+}
+
+[[maybe_unused]] ProgramRegistry &ProgramRegistry::getInstance() {
+	static ProgramRegistry instance;
+	return instance;
+}
+
+[[maybe_unused]] std::shared_ptr<Program> ProgramRegistry::acquire(
+		const std::string &kernelSourceCode,
+		const std::string &kernelName,
+		const Context &context,
+		cl_device_id device,
+		const std::string &buildOptions
+) {
+	const auto program = acquire(
+			Key{fnv1a64(kernelSourceCode), false, kernelSourceCode, buildOptions, context, device},
+			[&]() {
+				return std::make_shared<Program>(kernelSourceCode.c_str(), kernelName, context, device, buildOptions);
+			}
+	);
+	return toKernel(program, kernelName);
+}
+
+[[maybe_unused]] std::shared_ptr<Program> ProgramRegistry::acquireIntermediateLanguage(
+		const void *intermediateLanguage,
+		const size_t intermediateLanguageSizeInBytes,
+		const std::string &kernelName,
+		const Context &context,
+		cl_device_id device,
+		const std::string &buildOptions
+) {
+	std::string module(static_cast<const char *>(intermediateLanguage), intermediateLanguageSizeInBytes);
+	const uint64_t hash = fnv1a64(module);
+	const auto program = acquire(
+			Key{hash, true, std::move(module), buildOptions, context, device},
+			[&]() {
+				return std::make_shared<Program>(
+						intermediateLanguage,
+						intermediateLanguageSizeInBytes,
+						kernelName,
+						context,
+						device,
+						buildOptions
+				);
+			}
+	);
+	return toKernel(program, kernelName);
+}
+
+std::shared_ptr<Program> ProgramRegistry::acquire(
+		const Key &key,
+		const std::function<std::shared_ptr<Program>()> &build
+) {
+	std::promise<std::shared_ptr<Program>> promise;
+	std::shared_future<std::shared_ptr<Program>> registeredProgram;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		const auto iterator = entries_.find(key);
+		if (iterator != entries_.end()) {
+			usageOrder_.splice(usageOrder_.begin(), usageOrder_, iterator->second.usagePosition);
+			registeredProgram = iterator->second.program;
+		} else {
+			usageOrder_.push_front(key);
+			entries_.emplace(key, Entry{promise.get_future().share(), usageOrder_.begin()});
+		}
+	}
+	MetricsCollector::getInstance().recordCacheLookup("program_registry", registeredProgram.valid());
+	if (registeredProgram.valid()) {
+		// the program may still be built by another thread
+		return registeredProgram.get();
+	}
+
+	// the current thread is the only one building the program
+	std::shared_ptr<Program> program;
+	try {
+		program = build();
+	} catch (...) {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			// forget the failed build, so a later request retries it
+			const auto iterator = entries_.find(key);
+			usageOrder_.erase(iterator->second.usagePosition);
+			entries_.erase(iterator);
+		}
+		promise.set_exception(std::current_exception());
+		throw;
+	}
+	promise.set_value(program);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	evict(false);
+	return program;
+}
+
+[[maybe_unused]] size_t ProgramRegistry::size() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return entries_.size();
+}
+
+[[maybe_unused]] void ProgramRegistry::evictUnreferenced() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	evict(true);
+}
+
+void ProgramRegistry::evict(const bool evictAll) {
+	auto position = usageOrder_.end();
+	while (position != usageOrder_.begin() && (evictAll || entries_.size() > capacity_)) {
+		--position;
+		const auto iterator = entries_.find(*position);
+		const auto &program = iterator->second.program;
+		const bool isBuilt = program.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+		// only the registry itself references the program
+		if (isBuilt && program.get().use_count() == 1) {
+			entries_.erase(iterator);
+			position = usageOrder_.erase(position);
+		}
+	}
+}
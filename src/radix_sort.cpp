@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "opencl/radix_sort.h"
+#include "opencl/program_registry.h"
+#include "radix_sort_kernels.h"
+#include "work_group_size.h"
+#if OPENCL_TOOLKIT_HAS_EMBEDDED_SPIRV
+#include "radixSortUint_spirv.h"
+#include "radixSortUlong_spirv.h"
+#endif
+
+using namespace OpenClToolkit;
+
+namespace {
+	/**
+	 * The number of bits per digit, must match RADIX_BITS of the kernels.
+	 */
+	constexpr size_t radixBits = 4;
+
+	/**
+	 * The number of different digits.
+	 */
+	constexpr size_t radix = 1 << radixBits;
+
+	/**
+	 * The number of elements per work item of a block. More elements per block shrink the histogram which is scanned
+	 * per pass.
+	 */
+	constexpr size_t itemsPerWorkItem = 16;
+
+	template<typename K>
+	struct KeyTypeTraits;
+
+	template<>
+	struct KeyTypeTraits<cl_uint> {
+		static constexpr const char *buildOptions = "-DK=uint";
+#if OPENCL_TOOLKIT_HAS_EMBEDDED_SPIRV
+		static constexpr const unsigned char *spirv = Embedded::radixSortUintSpirv;
+		static constexpr size_t spirvSizeInBytes = Embedded::radixSortUintSpirvSize;
+#endif
+	};
+
+	template<>
+	struct KeyTypeTraits<cl_ulong> {
+		static constexpr const char *buildOptions = "-DK=ulong";
+#if OPENCL_TOOLKIT_HAS_EMBEDDED_SPIRV
+		static constexpr const unsigned char *spirv = Embedded::radixSortUlongSpirv;
+		static constexpr size_t spirvSizeInBytes = Embedded::radixSortUlongSpirvSize;
+#endif
+	};
+}
+
+template<typename K>
+[[maybe_unused]] RadixSort<K>::RadixSort(const Context &context, cl_device_id device, CommandQueue &commandQueue) :
+		context_(context),
+		commandQueue_(commandQueue),
+		scan_(context, device, commandQueue, BinaryOperation::Sum) {
+	std::shared_ptr<Program> program;
+#if OPENCL_TOOLKIT_HAS_EMBEDDED_SPIRV
+	// the module built into the library skips the OpenCL C front end of the driver
+	if (Program::isIntermediateLanguageSupported(device)) {
+		try {
+			program = ProgramRegistry::getInstance().acquireIntermediateLanguage(
+					KeyTypeTraits<K>::spirv,
+					KeyTypeTraits<K>::spirvSizeInBytes,
+					"radixHistogram",
+					context,
+					device
+			);
+		} catch (const std::exception &exception) {
+			// e.g. a driver which rejects the module, so the source code is built instead
+			std::cerr << "Failed to build the SPIR-V module of the radix sort, falling back to its source code. "
+					  << exception.what() << std::endl;
+		}
+	}
+#endif
+	if (!program) {
+		program = ProgramRegistry::getInstance().acquire(
+				radixSortKernelSourceCode,
+				"radixHistogram",
+				context,
+				device,
+				KeyTypeTraits<K>::buildOptions
+		);
+	}
+	histogram_ = std::make_unique<Program>(*program, "radixHistogram");
+	scatter_ = std::make_unique<Program>(*program, "radixScatter");
+	// the scatter holds a key, a value, a digit and two scan slots per work item in local memory
+	workGroupSize_ = std::min(
+			chooseWorkGroupSize(*histogram_, 0),
+			chooseWorkGroupSize(*scatter_, sizeof(K) + 4 * sizeof(cl_uint))
+	);
+}
+
+template<typename K>
+[[maybe_unused]] void RadixSort<K>::sort(const BaseBuffer &keys, const size_t numElements, const size_t numKeyBits) {
+	enqueueSort(keys, nullptr, numElements, numKeyBits);
+}
+
+template<typename K>
+[[maybe_unused]] void RadixSort<K>::sortByKey(
+		const BaseBuffer &keys,
+		const BaseBuffer &values,
+		const size_t numElements,
+		const size_t numKeyBits
+) {
+	enqueueSort(keys, &values, numElements, numKeyBits);
+}
+
+template<typename K>
+void RadixSort<K>::enqueueSort(
+		const BaseBuffer &keys,
+		const BaseBuffer *values,
+		const size_t numElements,
+		const size_t numKeyBits
+) {
+	if (numElements >= (size_t(1) << 32)) {
+		// let it crash
+		throw std::runtime_error("Cannot sort: at most 2^32 - 1 elements can be sorted at once");
+	}
+	if (numElements < 2 || !numKeyBits) {
+		return;
+	}
+
+	const size_t numPasses = (std::min(numKeyBits, sizeof(K) * 8) + radixBits - 1) / radixBits;
+	const size_t itemsPerBlock = workGroupSize_ * itemsPerWorkItem;
+	const size_t numBlocks = (numElements + itemsPerBlock - 1) / itemsPerBlock;
+
+	ReadWriteBuffer temporaryKeys(context_, numElements * sizeof(K));
+	// without values the value arguments are never accessed, but must be valid buffers
+	std::unique_ptr<ReadWriteBuffer> temporaryValues;
+	if (values) {
+		temporaryValues = std::make_unique<ReadWriteBuffer>(context_, numElements * sizeof(cl_uint));
+	}
+	ReadWriteBuffer digitOffsets(context_, radix * numBlocks * sizeof(cl_uint));
+
+	const BaseBuffer *keysIn = &keys;
+	const BaseBuffer *keysOut = &temporaryKeys;
+	const BaseBuffer *valuesIn = values ? values : &keys;
+	const BaseBuffer *valuesOut = values ? temporaryValues.get() : &temporaryKeys;
+
+	const cl_ulong n = numElements;
+	const auto itemsPerBlockArg = static_cast<cl_uint>(itemsPerBlock);
+	const cl_uint hasValues = values ? 1 : 0;
+	for (size_t pass = 0; pass < numPasses; ++pass) {
+		const auto shift = static_cast<cl_uint>(pass * radixBits);
+
+		histogram_->setKernelArg(0, sizeof(cl_mem), *keysIn);
+		histogram_->setKernelArg(1, sizeof(cl_mem), digitOffsets);
+		histogram_->setKernelArg(2, sizeof(cl_ulong), &n);
+		histogram_->setKernelArg(3, sizeof(cl_uint), &shift);
+		histogram_->setKernelArg(4, sizeof(cl_uint), &itemsPerBlockArg);
+		commandQueue_.enqueueCommandExecuteProgramOnDevice(*histogram_, numBlocks * workGroupSize_, workGroupSize_);
+
+		scan_.scan(digitOffsets, digitOffsets, radix * numBlocks, false);
+
+		scatter_->setKernelArg(0, sizeof(cl_mem), *keysIn);
+		scatter_->setKernelArg(1, sizeof(cl_mem), *keysOut);
+		scatter_->setKernelArg(2, sizeof(cl_mem), *valuesIn);
+		scatter_->setKernelArg(3, sizeof(cl_mem), *valuesOut);
+		scatter_->setKernelArg(4, sizeof(cl_mem), digitOffsets);
+		scatter_->setKernelArg(5, sizeof(cl_ulong), &n);
+		scatter_->setKernelArg(6, sizeof(cl_uint), &shift);
+		scatter_->setKernelArg(7, sizeof(cl_uint), &itemsPerBlockArg);
+		scatter_->setKernelArg(8, sizeof(cl_uint), &hasValues);
+		scatter_->setKernelArg(9, workGroupSize_ * sizeof(K), static_cast<const void *>(nullptr));
+		scatter_->setKernelArg(10, workGroupSize_ * sizeof(cl_uint), static_cast<const void *>(nullptr));
+		scatter_->setKernelArg(11, workGroupSize_ * sizeof(cl_uint), static_cast<const void *>(nullptr));
+		scatter_->setKernelArg(12, 2 * workGroupSize_ * sizeof(cl_uint), static_cast<const void *>(nullptr));
+		commandQueue_.enqueueCommandExecuteProgramOnDevice(*scatter_, numBlocks * workGroupSize_, workGroupSize_);
+
+		std::swap(keysIn, keysOut);
+		if (values) {
+			std::swap(valuesIn, valuesOut);
+		}
+	}
+
+	// after an odd number of passes the result is in the temporary buffers
+	if (keysIn != &keys) {
+		commandQueue_.enqueueCommandCopyBytesFromDeviceMemoryIntoDeviceMemory(*keysIn, keys, numElements * sizeof(K));
+		if (values) {
+			commandQueue_.enqueueCommandCopyBytesFromDeviceMemoryIntoDeviceMemory(
+					*valuesIn,
+					*values,
+					numElements * sizeof(cl_uint)
+			);
+		}
+	}
+}
+
+template class OpenClToolkit::RadixSort<cl_uint>;
+template class OpenClToolkit::RadixSort<cl_ulong>;
@@ -0,0 +1,151 @@
+#ifndef OPENCL_TOOLKIT_RADIX_SORT_KERNELS_H
+#define OPENCL_TOOLKIT_RADIX_SORT_KERNELS_H
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief The source code of the radix sort kernels.
+	 * @details The key type is specialized by the build option <code>K</code>, e.g. <code>-DK=uint</code>. Each pass
+	 * sorts by one digit of <code>RADIX_BITS</code> bits. The input is split into blocks of
+	 * <code>itemsPerBlock</code> elements, one work group per block. All kernels expect work group sizes which are a
+	 * power of two.
+	 */
+	inline constexpr const char *radixSortKernelSourceCode = R"CLC(
+#define RADIX_BITS 4
+#define RADIX (1 << RADIX_BITS)
+#define DIGIT(key, shift) ((uint) (((key) >> (shift)) & (RADIX - 1)))
+
+// Counts the digits of each block. The counts are stored digit-major, i.e. histogram[digit * numBlocks + block], so an
+// exclusive scan of the histogram yields the stable output offset of each digit of each block.
+__kernel void radixHistogram(
+		__global const K *keys,
+		__global uint *histogram,
+		const ulong n,
+		const uint shift,
+		const uint itemsPerBlock
+) {
+	__local uint counts[RADIX];
+	const uint localId = get_local_id(0);
+	for (uint digit = localId; digit < RADIX; digit += get_local_size(0)) {
+		counts[digit] = 0;
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	const ulong begin = get_group_id(0) * (ulong) itemsPerBlock;
+	const ulong end = min(begin + itemsPerBlock, n);
+	for (ulong i = begin + localId; i < end; i += get_local_size(0)) {
+		atomic_inc(&counts[DIGIT(keys[i], shift)]);
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for (uint digit = localId; digit < RADIX; digit += get_local_size(0)) {
+		histogram[digit * get_num_groups(0) + get_group_id(0)] = counts[digit];
+	}
+}
+
+// Returns the exclusive prefix sum of the passed values of the work group (Hillis-Steele, double buffered).
+uint scanWorkGroupExclusive(const uint value, __local uint *scratch, uint *total) {
+	const uint localId = get_local_id(0);
+	const uint localSize = get_local_size(0);
+	uint out = 0;
+	scratch[localId] = value;
+	barrier(CLK_LOCAL_MEM_FENCE);
+	for (uint offset = 1; offset < localSize; offset <<= 1) {
+		const uint in = out;
+		out = 1 - out;
+		const uint current = scratch[in * localSize + localId];
+		scratch[out * localSize + localId] = localId >= offset ?
+				current + scratch[in * localSize + localId - offset] : current;
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+	const uint inclusive = scratch[out * localSize + localId];
+	*total = scratch[out * localSize + localSize - 1];
+	barrier(CLK_LOCAL_MEM_FENCE);
+	return inclusive - value;
+}
+
+// Moves the keys (and values) of each block to their positions for the current digit. Each chunk of a block is sorted
+// by the digit in local memory with one stable split per bit first, so the writes of equal digits are contiguous.
+__kernel void radixScatter(
+		__global const K *keysIn,
+		__global K *keysOut,
+		__global const uint *valuesIn,
+		__global uint *valuesOut,
+		__global const uint *digitOffsets,
+		const ulong n,
+		const uint shift,
+		const uint itemsPerBlock,
+		const uint hasValues,
+		__local K *localKeys,
+		__local uint *localValues,
+		__local uint *localDigits,
+		__local uint *scratch
+) {
+	__local uint runningOffsets[RADIX];
+	__local uint chunkCounts[RADIX];
+	__local uint digitStarts[RADIX];
+	const uint localId = get_local_id(0);
+	const uint localSize = get_local_size(0);
+
+	for (uint digit = localId; digit < RADIX; digit += localSize) {
+		runningOffsets[digit] = digitOffsets[digit * get_num_groups(0) + get_group_id(0)];
+	}
+
+	const ulong begin = get_group_id(0) * (ulong) itemsPerBlock;
+	const ulong end = min(begin + itemsPerBlock, n);
+	for (ulong chunk = begin; chunk < end; chunk += localSize) {
+		const uint numValid = (uint) min((ulong) localSize, end - chunk);
+		const bool isValid = localId < numValid;
+		K key = isValid ? keysIn[chunk + localId] : (K) 0;
+		uint value = isValid && hasValues ? valuesIn[chunk + localId] : 0;
+		// invalid items get the largest digit, so the stable sort moves them behind all valid items
+		uint digit = isValid ? DIGIT(key, shift) : RADIX - 1;
+
+		for (uint i = localId; i < RADIX; i += localSize) {
+			chunkCounts[i] = 0;
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+		if (isValid) {
+			atomic_inc(&chunkCounts[digit]);
+		}
+
+		for (uint bit = 0; bit < RADIX_BITS; ++bit) {
+			const uint isSet = (digit >> bit) & 1;
+			uint numZeros;
+			const uint zerosBefore = scanWorkGroupExclusive(!isSet, scratch, &numZeros);
+			const uint position = isSet ? numZeros + localId - zerosBefore : zerosBefore;
+			localKeys[position] = key;
+			localValues[position] = value;
+			localDigits[position] = digit;
+			barrier(CLK_LOCAL_MEM_FENCE);
+			key = localKeys[localId];
+			value = localValues[localId];
+			digit = localDigits[localId];
+			barrier(CLK_LOCAL_MEM_FENCE);
+		}
+
+		if (localId < numValid && (localId == 0 || localDigits[localId - 1] != digit)) {
+			digitStarts[digit] = localId;
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+		if (localId < numValid) {
+			const uint destination = runningOffsets[digit] + localId - digitStarts[digit];
+			keysOut[destination] = key;
+			if (hasValues) {
+				valuesOut[destination] = value;
+			}
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+		for (uint i = localId; i < RADIX; i += localSize) {
+			runningOffsets[i] += chunkCounts[i];
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+}
+)CLC";
+}
+
+#endif //OPENCL_TOOLKIT_RADIX_SORT_KERNELS_H
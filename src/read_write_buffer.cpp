@@ -0,0 +1,8 @@
+#include "opencl/read_write_buffer.h"
+
+using namespace OpenClToolkit;
+
+[[maybe_unused]] ReadWriteBuffer::ReadWriteBuffer(const Context &context, const size_t size) :
+		BaseBuffer(context, size, CL_MEM_READ_WRITE) {
+
+}
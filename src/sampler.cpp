@@ -0,0 +1,38 @@
+#include <iostream>
+#include <stdexcept>
+
+#include "opencl/sampler.h"
+#include "opencl/error.h"
+
+using namespace OpenClToolkit;
+
+[[maybe_unused]] Sampler::Sampler(
+		const Context &context,
+		const bool isNormalizedCoordinates,
+		const cl_addressing_mode addressingMode,
+		const cl_filter_mode filterMode
+) {
+	const cl_sampler_properties properties[] = {
+			CL_SAMPLER_NORMALIZED_COORDS, static_cast<cl_sampler_properties>(isNormalizedCoordinates),
+			CL_SAMPLER_ADDRESSING_MODE, static_cast<cl_sampler_properties>(addressingMode),
+			CL_SAMPLER_FILTER_MODE, static_cast<cl_sampler_properties>(filterMode),
+			0
+	};
+	cl_int status;
+	self_ = clCreateSamplerWithProperties(context, properties, &status);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Failed to create sampler: " + toErrorDescription(status));
+	}
+}
+
+Sampler::~Sampler() {
+	const cl_int status = clReleaseSampler(self_);
+	if (status) {
+		std::cerr << "Failed to release sampler: " + toErrorDescription(status) << std::endl;
+	}
+}
+
+Sampler::operator cl_sampler() const {
+	return self_;
+}
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "opencl/segmented_buffer.h"
+#include "opencl/device_info.h"
+
+using namespace OpenClToolkit;
+
+namespace {
+	/**
+	 * @brief Represents a segment of a virtual buffer.
+	 */
+	class Segment : public BaseBuffer {
+		public:
+			Segment(const Context &context, const size_t size, const cl_mem_flags flags) :
+					BaseBuffer(context, size, flags) {}
+	};
+}
+
+[[maybe_unused]] SegmentedBuffer::SegmentedBuffer(
+		const Context &context,
+		cl_device_id device,
+		const size_t sizeInBytes,
+		const size_t elementSizeInBytes,
+		const cl_mem_flags flags,
+		const size_t maxSegmentSizeInBytes
+) : sizeInBytes_(sizeInBytes), elementSizeInBytes_(elementSizeInBytes), segmentSizeInBytes_(0) {
+	if (!sizeInBytes || !elementSizeInBytes || sizeInBytes % elementSizeInBytes) {
+		// let it crash
+		throw std::runtime_error("Failed to create segmented buffer: the size must be a positive multiple of the "
+								 "element size");
+	}
+	size_t limit = static_cast<size_t>(DeviceInfo::get(device).maxMemoryAllocationSize);
+	if (maxSegmentSizeInBytes) {
+		limit = std::min(limit, maxSegmentSizeInBytes);
+	}
+	segmentSizeInBytes_ = limit / elementSizeInBytes * elementSizeInBytes;
+	if (!segmentSizeInBytes_) {
+		// let it crash
+		throw std::runtime_error("Failed to create segmented buffer: an element exceeds the max segment size");
+	}
+
+	for (size_t offset = 0; offset < sizeInBytes; offset += segmentSizeInBytes_) {
+		segments_.push_back(std::make_unique<Segment>(
+				context,
+				std::min(segmentSizeInBytes_, sizeInBytes - offset),
+				flags
+		));
+	}
+}
+
+[[maybe_unused]] size_t SegmentedBuffer::getSizeInBytes() const {
+	return sizeInBytes_;
+}
+
+[[maybe_unused]] size_t SegmentedBuffer::getElementSizeInBytes() const {
+	return elementSizeInBytes_;
+}
+
+[[maybe_unused]] size_t SegmentedBuffer::getNumSegments() const {
+	return segments_.size();
+}
+
+[[maybe_unused]] const BaseBuffer &SegmentedBuffer::getSegment(const size_t index) const {
+	return *segments_.at(index);
+}
+
+[[maybe_unused]] size_t SegmentedBuffer::getSegmentOffsetInBytes(const size_t index) const {
+	return index * segmentSizeInBytes_;
+}
+
+[[maybe_unused]] size_t SegmentedBuffer::getSegmentSizeInBytes(const size_t index) const {
+	return std::min(segmentSizeInBytes_, sizeInBytes_ - getSegmentOffsetInBytes(index));
+}
+
+[[maybe_unused]] size_t SegmentedBuffer::getSegmentIndex(const size_t offsetInBytes) const {
+	return offsetInBytes / segmentSizeInBytes_;
+}
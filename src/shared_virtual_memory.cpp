@@ -0,0 +1,84 @@
+#include <iostream>
+#include <stdexcept>
+
+#include "opencl/shared_virtual_memory.h"
+#include "opencl/device_info.h"
+#include "opencl/error.h"
+
+using namespace OpenClToolkit;
+
+[[maybe_unused]] SvmGranularity OpenClToolkit::getSupportedSvmGranularity(
+		cl_device_id device,
+		const SvmGranularity requestedGranularity
+) {
+	const cl_device_svm_capabilities capabilities = DeviceInfo::get(device).svmCapabilities;
+	if (requestedGranularity == SvmGranularity::FineGrain && (capabilities & CL_DEVICE_SVM_FINE_GRAIN_BUFFER)) {
+		return SvmGranularity::FineGrain;
+	}
+	if (requestedGranularity != SvmGranularity::None && (capabilities & CL_DEVICE_SVM_COARSE_GRAIN_BUFFER)) {
+		return SvmGranularity::CoarseGrain;
+	}
+	return SvmGranularity::None;
+}
+
+void *OpenClToolkit::allocateSharedVirtualMemory(
+		cl_context context,
+		const SvmGranularity granularity,
+		const size_t sizeInBytes,
+		const size_t alignment
+) {
+	if (granularity == SvmGranularity::None) {
+		return ::operator new(sizeInBytes, std::align_val_t(alignment));
+	}
+	cl_svm_mem_flags flags = CL_MEM_READ_WRITE;
+	if (granularity == SvmGranularity::FineGrain) {
+		flags |= CL_MEM_SVM_FINE_GRAIN_BUFFER;
+	}
+	// a zero-sized request yields nullptr, which is not a valid result of an allocator
+	void *memory = clSVMAlloc(context, flags, sizeInBytes ? sizeInBytes : 1, static_cast<cl_uint>(alignment));
+	if (!memory) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void OpenClToolkit::freeSharedVirtualMemory(
+		cl_context context,
+		const SvmGranularity granularity,
+		void *memory,
+		const size_t alignment
+) noexcept {
+	if (granularity == SvmGranularity::None) {
+		::operator delete(memory, std::align_val_t(alignment));
+	} else {
+		clSVMFree(context, memory);
+	}
+}
+
+[[maybe_unused]] SvmMapGuard::SvmMapGuard(
+		CommandQueue &commandQueue,
+		const SvmGranularity granularity,
+		void *memory,
+		const size_t sizeInBytes,
+		const cl_map_flags mapFlags
+) : commandQueue_(commandQueue), memory_(nullptr) {
+	if (granularity != SvmGranularity::CoarseGrain || !memory || !sizeInBytes) {
+		return;
+	}
+	const cl_int status = clEnqueueSVMMap(commandQueue, CL_TRUE, mapFlags, memory, sizeInBytes, 0, nullptr, nullptr);
+	if (status) {
+		// let it crash
+		throw std::runtime_error("Failed to map shared virtual memory: " + toErrorDescription(status));
+	}
+	memory_ = memory;
+}
+
+SvmMapGuard::~SvmMapGuard() {
+	if (!memory_) {
+		return;
+	}
+	const cl_int status = clEnqueueSVMUnmap(commandQueue_, memory_, 0, nullptr, nullptr);
+	if (status) {
+		std::cerr << "Failed to unmap shared virtual memory: " + toErrorDescription(status) << std::endl;
+	}
+}
@@ -0,0 +1,166 @@
+#ifndef OPENCL_TOOLKIT_SOCKET_IO_H
+#define OPENCL_TOOLKIT_SOCKET_IO_H
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Returns the description of the current <code>errno</code>.
+	 * @return the description of the current <code>errno</code>.
+	 */
+	inline std::string toSystemErrorDescription() {
+		return std::string(std::strerror(errno)) + " (errno " + std::to_string(errno) + ")";
+	}
+
+	/**
+	 * @brief Fills the address of a Unix domain socket.
+	 * @param path the path of the socket.
+	 * @param address receives the address.
+	 */
+	inline void toUnixSocketAddress(const std::string &path, sockaddr_un &address) {
+		if (path.size() >= sizeof(address.sun_path)) {
+			// let it crash
+			throw std::runtime_error("Invalid socket path: " + path + " is too long");
+		}
+		std::memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+	}
+
+	/**
+	 * @brief Sends all passed bytes, optionally attaching a file descriptor to the first byte.
+	 * @param socket the connected socket.
+	 * @param data the bytes to be sent.
+	 * @param numBytes the number of bytes.
+	 * @param fileDescriptor the file descriptor to be attached, -1 for none.
+	 * @return false if the peer closed the connection or the socket failed.
+	 */
+	inline bool sendAll(const int socket, const void *data, size_t numBytes, const int fileDescriptor = -1) {
+		auto *bytes = static_cast<const char *>(data);
+		bool isFileDescriptorPending = fileDescriptor >= 0;
+		while (numBytes) {
+			iovec vector{const_cast<char *>(bytes), numBytes};
+			msghdr message{};
+			message.msg_iov = &vector;
+			message.msg_iovlen = 1;
+			alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+			if (isFileDescriptorPending) {
+				message.msg_control = control;
+				message.msg_controllen = sizeof(control);
+				cmsghdr *header = CMSG_FIRSTHDR(&message);
+				header->cmsg_level = SOL_SOCKET;
+				header->cmsg_type = SCM_RIGHTS;
+				header->cmsg_len = CMSG_LEN(sizeof(int));
+				std::memcpy(CMSG_DATA(header), &fileDescriptor, sizeof(int));
+			}
+			const ssize_t numSent = sendmsg(socket, &message, MSG_NOSIGNAL);
+			if (numSent < 0 && errno == EINTR) {
+				continue;
+			}
+			if (numSent <= 0) {
+				return false;
+			}
+			isFileDescriptorPending = false;
+			bytes += numSent;
+			numBytes -= static_cast<size_t>(numSent);
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Takes the file descriptors attached to a received message.
+	 * @param message the received message.
+	 * @param fileDescriptor receives an attached file descriptor, unchanged if none; nullptr to close attached ones.
+	 */
+	inline void takeFileDescriptors(msghdr &message, int *fileDescriptor) {
+		for (cmsghdr *header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header)) {
+			if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS) {
+				int received;
+				std::memcpy(&received, CMSG_DATA(header), sizeof(int));
+				if (fileDescriptor && *fileDescriptor < 0) {
+					*fileDescriptor = received;
+				} else {
+					close(received);
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Receives exactly the passed number of bytes and any file descriptor attached to them.
+	 * @param socket the connected socket.
+	 * @param data receives the bytes.
+	 * @param numBytes the number of bytes.
+	 * @param fileDescriptor receives an attached file descriptor, unchanged if none; nullptr to close attached ones.
+	 * @return false if the peer closed the connection, the socket failed or timed out.
+	 */
+	inline bool receiveAll(const int socket, void *data, size_t numBytes, int *fileDescriptor = nullptr) {
+		auto *bytes = static_cast<char *>(data);
+		while (numBytes) {
+			iovec vector{bytes, numBytes};
+			msghdr message{};
+			message.msg_iov = &vector;
+			message.msg_iovlen = 1;
+			alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+			message.msg_control = control;
+			message.msg_controllen = sizeof(control);
+			const ssize_t numReceived = recvmsg(socket, &message, 0);
+			if (numReceived < 0 && errno == EINTR) {
+				continue;
+			}
+			if (numReceived <= 0) {
+				return false;
+			}
+			takeFileDescriptors(message, fileDescriptor);
+			bytes += numReceived;
+			numBytes -= static_cast<size_t>(numReceived);
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Receives up to the passed number of bytes without blocking, and any file descriptor attached to them.
+	 * @param socket the connected socket.
+	 * @param data receives the bytes.
+	 * @param maxNumBytes the largest number of bytes to be received.
+	 * @param fileDescriptor receives an attached file descriptor, unchanged if none; nullptr to close attached ones.
+	 * @return the number of bytes received, 0 if none are available, or -1 if the peer closed the connection or the
+	 * socket failed.
+	 */
+	inline ssize_t receiveAvailable(
+			const int socket,
+			void *data,
+			const size_t maxNumBytes,
+			int *fileDescriptor = nullptr
+	) {
+		iovec vector{data, maxNumBytes};
+		msghdr message{};
+		message.msg_iov = &vector;
+		message.msg_iovlen = 1;
+		alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+		message.msg_control = control;
+		message.msg_controllen = sizeof(control);
+		const ssize_t numReceived = recvmsg(socket, &message, MSG_DONTWAIT);
+		if (numReceived < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+			return 0;
+		}
+		if (numReceived <= 0) {
+			return -1;
+		}
+		takeFileDescriptors(message, fileDescriptor);
+		return numReceived;
+	}
+}
+
+#endif //OPENCL_TOOLKIT_SOCKET_IO_H
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "opencl/sparse_matrix.h"
+
+using namespace OpenClToolkit;
+
+namespace {
+	/**
+	 * The largest ratio of stored to actual elements for which the sliced ELLPACK format is chosen.
+	 */
+	constexpr double maxSlicedEllPaddingRatio = 1.5;
+
+	/**
+	 * The mean row length from which a vector of work items per row pays off.
+	 */
+	constexpr double minCsrVectorMeanRowLength = 8.0;
+
+	/**
+	 * The coefficient of variation of the row lengths from which the rows are considered load-imbalanced.
+	 */
+	constexpr double minImbalancedCoefficientOfVariation = 1.0;
+
+	/**
+	 * @brief Validates the structure of the passed matrix.
+	 * @param matrix the matrix to be validated.
+	 */
+	void validate(const CsrMatrix &matrix) {
+		const bool isValid = matrix.rowOffsets.size() == matrix.numRows + 1 &&
+							 matrix.rowOffsets.front() == 0 &&
+							 matrix.rowOffsets.back() == matrix.columnIndices.size() &&
+							 matrix.columnIndices.size() == matrix.values.size() &&
+							 std::is_sorted(matrix.rowOffsets.begin(), matrix.rowOffsets.end());
+		if (!isValid) {
+			// let it crash
+			throw std::runtime_error("Invalid CSR matrix: inconsistent row offsets, column indices or values");
+		}
+	}
+}
+
+[[maybe_unused]] RowLengthStatistics OpenClToolkit::computeRowLengthStatistics(
+		const CsrMatrix &matrix,
+		const size_t sliceHeight
+) {
+	validate(matrix);
+	RowLengthStatistics statistics{matrix.numRows, matrix.values.size(), 0.0, 0.0, 0, 0};
+	if (!matrix.numRows) {
+		return statistics;
+	}
+
+	double sumOfSquares = 0.0;
+	for (size_t sliceStart = 0; sliceStart < matrix.numRows; sliceStart += sliceHeight) {
+		size_t sliceWidth = 0;
+		for (size_t row = sliceStart; row < std::min(sliceStart + sliceHeight, matrix.numRows); ++row) {
+			const size_t length = matrix.rowOffsets[row + 1] - matrix.rowOffsets[row];
+			sliceWidth = std::max(sliceWidth, length);
+			sumOfSquares += static_cast<double>(length) * static_cast<double>(length);
+		}
+		statistics.maxRowLength = std::max(statistics.maxRowLength, sliceWidth);
+		statistics.slicedEllSize += sliceWidth * sliceHeight;
+	}
+	statistics.meanRowLength = static_cast<double>(statistics.numNonZeros) / static_cast<double>(matrix.numRows);
+	const double variance = sumOfSquares / static_cast<double>(matrix.numRows) -
+							statistics.meanRowLength * statistics.meanRowLength;
+	statistics.rowLengthStandardDeviation = std::sqrt(std::max(variance, 0.0));
+	return statistics;
+}
+
+[[maybe_unused]] SparseFormat OpenClToolkit::chooseSparseFormat(const RowLengthStatistics &statistics) {
+	if (!statistics.numNonZeros) {
+		return SparseFormat::CsrScalar;
+	}
+	const double paddingRatio = static_cast<double>(statistics.slicedEllSize) /
+								static_cast<double>(statistics.numNonZeros);
+	if (paddingRatio <= maxSlicedEllPaddingRatio &&
+		statistics.slicedEllSize <= std::numeric_limits<cl_uint>::max()) {
+		return SparseFormat::SlicedEll;
+	}
+	const double coefficientOfVariation = statistics.rowLengthStandardDeviation / statistics.meanRowLength;
+	if (statistics.meanRowLength >= minCsrVectorMeanRowLength ||
+		coefficientOfVariation >= minImbalancedCoefficientOfVariation) {
+		return SparseFormat::CsrVector;
+	}
+	return SparseFormat::CsrScalar;
+}
+
+[[maybe_unused]] SlicedEllMatrix OpenClToolkit::toSlicedEll(const CsrMatrix &matrix, const size_t sliceHeight) {
+	if (!sliceHeight) {
+		// let it crash
+		throw std::runtime_error("Cannot convert to sliced ELL: the slice height is 0");
+	}
+	const RowLengthStatistics statistics = computeRowLengthStatistics(matrix, sliceHeight);
+	if (statistics.slicedEllSize > std::numeric_limits<cl_uint>::max()) {
+		// let it crash
+		throw std::runtime_error("Cannot convert to sliced ELL: the padded matrix exceeds 2^32 - 1 elements");
+	}
+
+	SlicedEllMatrix result{matrix.numRows, matrix.numColumns, sliceHeight, {}, {}, {}, {}};
+	result.sliceOffsets.reserve((matrix.numRows + sliceHeight - 1) / sliceHeight + 1);
+	result.rowLengths.resize(matrix.numRows);
+	result.columnIndices.assign(statistics.slicedEllSize, 0);
+	result.values.assign(statistics.slicedEllSize, 0.0f);
+
+	cl_uint sliceOffset = 0;
+	for (size_t sliceStart = 0; sliceStart < matrix.numRows; sliceStart += sliceHeight) {
+		result.sliceOffsets.push_back(sliceOffset);
+		const size_t sliceEnd = std::min(sliceStart + sliceHeight, matrix.numRows);
+		cl_uint sliceWidth = 0;
+		for (size_t row = sliceStart; row < sliceEnd; ++row) {
+			const cl_uint begin = matrix.rowOffsets[row];
+			const cl_uint length = matrix.rowOffsets[row + 1] - begin;
+			result.rowLengths[row] = length;
+			sliceWidth = std::max(sliceWidth, length);
+			for (cl_uint j = 0; j < length; ++j) {
+				const size_t index = sliceOffset + j * sliceHeight + (row - sliceStart);
+				result.columnIndices[index] = matrix.columnIndices[begin + j];
+				result.values[index] = matrix.values[begin + j];
+			}
+		}
+		sliceOffset += static_cast<cl_uint>(sliceWidth * sliceHeight);
+	}
+	result.sliceOffsets.push_back(sliceOffset);
+	return result;
+}
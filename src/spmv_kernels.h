@@ -0,0 +1,107 @@
+#ifndef OPENCL_TOOLKIT_SPMV_KERNELS_H
+#define OPENCL_TOOLKIT_SPMV_KERNELS_H
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief The source code of the sparse matrix-vector multiplication kernels y = A * x.
+	 * @details The kernels are specialized by the build options:
+	 * <ul>
+	 *     <li><code>VECTOR_SIZE</code>: the number of work items which share a row in <code>csrVector</code>, a power
+	 *     of two which divides the work group size</li>
+	 *     <li><code>SLICE_HEIGHT</code>: the number of rows per slice in <code>slicedEll</code></li>
+	 * </ul>
+	 */
+	inline constexpr const char *spmvKernelSourceCode = R"CLC(
+#ifndef VECTOR_SIZE
+#define VECTOR_SIZE 1
+#endif
+#ifndef SLICE_HEIGHT
+#define SLICE_HEIGHT 32
+#endif
+
+// one work item per row, for short rows of similar length
+__kernel void csrScalar(
+		const uint numRows,
+		__global const uint *rowOffsets,
+		__global const uint *columnIndices,
+		__global const float *values,
+		__global const float *x,
+		__global float *y
+) {
+	const uint row = get_global_id(0);
+	if (row >= numRows) {
+		return;
+	}
+	const uint end = rowOffsets[row + 1];
+	float sum = 0.0f;
+	for (uint i = rowOffsets[row]; i < end; ++i) {
+		sum = mad(values[i], x[columnIndices[i]], sum);
+	}
+	y[row] = sum;
+}
+
+// VECTOR_SIZE work items per row: the loads of a row are coalesced and long rows are split among several work items
+__kernel void csrVector(
+		const uint numRows,
+		__global const uint *rowOffsets,
+		__global const uint *columnIndices,
+		__global const float *values,
+		__global const float *x,
+		__global float *y,
+		__local float *partialSums
+) {
+	const uint localId = get_local_id(0);
+	const uint lane = localId % VECTOR_SIZE;
+	const uint row = get_global_id(0) / VECTOR_SIZE;
+
+	float sum = 0.0f;
+	if (row < numRows) {
+		const uint end = rowOffsets[row + 1];
+		for (uint i = rowOffsets[row] + lane; i < end; i += VECTOR_SIZE) {
+			sum = mad(values[i], x[columnIndices[i]], sum);
+		}
+	}
+	partialSums[localId] = sum;
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for (uint offset = VECTOR_SIZE / 2; offset > 0; offset /= 2) {
+		if (lane < offset) {
+			partialSums[localId] += partialSums[localId + offset];
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+	if (lane == 0 && row < numRows) {
+		y[row] = partialSums[localId];
+	}
+}
+
+// one work item per row, the elements of a slice are stored column-major so neighbouring rows load contiguously
+__kernel void slicedEll(
+		const uint numRows,
+		__global const uint *sliceOffsets,
+		__global const uint *rowLengths,
+		__global const uint *columnIndices,
+		__global const float *values,
+		__global const float *x,
+		__global float *y
+) {
+	const uint row = get_global_id(0);
+	if (row >= numRows) {
+		return;
+	}
+	const uint length = rowLengths[row];
+	uint index = sliceOffsets[row / SLICE_HEIGHT] + row % SLICE_HEIGHT;
+	float sum = 0.0f;
+	for (uint i = 0; i < length; ++i, index += SLICE_HEIGHT) {
+		sum = mad(values[index], x[columnIndices[index]], sum);
+	}
+	y[row] = sum;
+}
+)CLC";
+}
+
+#endif //OPENCL_TOOLKIT_SPMV_KERNELS_H
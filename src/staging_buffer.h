@@ -0,0 +1,44 @@
+#ifndef OPENCL_TOOLKIT_STAGING_BUFFER_H
+#define OPENCL_TOOLKIT_STAGING_BUFFER_H
+
+#include "opencl/base_buffer.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * @brief Represents a buffer in pinned host memory, which the device reads and writes at the peak transfer rate.
+	 */
+	class StagingBuffer : public BaseBuffer {
+		public:
+			/**
+			 * @brief The parametrized constructor.
+			 * @param context a valid OpenCL-context.
+			 * @param size the size of the buffer in bytes.
+			 * @param deviceAccess the access of the device, e.g. <code>CL_MEM_READ_ONLY</code> if the buffer is only
+			 *                     copied to the device.
+			 */
+			StagingBuffer(const Context &context, const size_t size, const cl_mem_flags deviceAccess) :
+					BaseBuffer(context, size, deviceAccess | CL_MEM_ALLOC_HOST_PTR) {}
+
+			/**
+			 * @brief The parametrized constructor. Pins the passed host memory instead of allocating it, e.g. to
+			 * control its placement.
+			 * @param context a valid OpenCL-context.
+			 * @param size the size of the buffer in bytes.
+			 * @param deviceAccess the access of the device, e.g. <code>CL_MEM_READ_ONLY</code> if the buffer is only
+			 *                     copied to the device.
+			 * @param hostMemory the page aligned host memory of at least the passed size, which outlives the buffer.
+			 */
+			StagingBuffer(
+					const Context &context,
+					const size_t size,
+					const cl_mem_flags deviceAccess,
+					void *hostMemory
+			) : BaseBuffer(context, size, deviceAccess | CL_MEM_USE_HOST_PTR, hostMemory) {}
+	};
+}
+
+#endif //OPENCL_TOOLKIT_STAGING_BUFFER_H
@@ -0,0 +1,434 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+#include "opencl/staging_service.h"
+#include "opencl/device_info.h"
+#include "double_buffered_staging.h"
+
+using namespace OpenClToolkit;
+
+namespace {
+	/**
+	 * <code>CL_DEVICE_PCI_BUS_INFO_KHR</code> of <code>cl_khr_pci_bus_info</code>.
+	 */
+	constexpr cl_device_info pciBusInfoKhr = 0x410F;
+
+	/**
+	 * <code>CL_DEVICE_PCI_BUS_ID_NV</code> of <code>cl_nv_device_attribute_query</code>.
+	 */
+	constexpr cl_device_info pciBusIdNv = 0x4008;
+
+	/**
+	 * <code>CL_DEVICE_PCI_SLOT_ID_NV</code> of <code>cl_nv_device_attribute_query</code>.
+	 */
+	constexpr cl_device_info pciSlotIdNv = 0x4009;
+
+	/**
+	 * <code>CL_DEVICE_PCI_DOMAIN_ID_NV</code> of <code>cl_nv_device_attribute_query</code>, unknown to old drivers.
+	 */
+	constexpr cl_device_info pciDomainIdNv = 0x400A;
+
+	/**
+	 * The smallest number of bytes a worker thread copies, so small chunks are not split into tiny parts.
+	 */
+	constexpr size_t minBytesPerWorker = 64 << 10;
+
+	/**
+	 * @brief The address of a PCI function, laid out like <code>cl_device_pci_bus_info_khr</code>.
+	 */
+	struct PciAddress {
+		/**
+		 * The PCI domain.
+		 */
+		cl_uint domain;
+
+		/**
+		 * The PCI bus.
+		 */
+		cl_uint bus;
+
+		/**
+		 * The PCI device.
+		 */
+		cl_uint device;
+
+		/**
+		 * The PCI function.
+		 */
+		cl_uint function;
+	};
+
+	/**
+	 * @brief Queries the PCI address of a device through the vendor extensions.
+	 * @param device the device.
+	 * @param address receives the PCI address.
+	 * @return whether the address is known.
+	 */
+	bool queryPciAddress(cl_device_id device, PciAddress &address) {
+		const DeviceInfo &info = DeviceInfo::get(device);
+		if (info.hasExtension("cl_khr_pci_bus_info")) {
+			return !clGetDeviceInfo(device, pciBusInfoKhr, sizeof(address), &address, nullptr);
+		}
+		if (info.hasExtension("cl_nv_device_attribute_query")) {
+			cl_uint bus;
+			cl_uint slot;
+			if (clGetDeviceInfo(device, pciBusIdNv, sizeof(bus), &bus, nullptr) ||
+				clGetDeviceInfo(device, pciSlotIdNv, sizeof(slot), &slot, nullptr)) {
+				return false;
+			}
+			cl_uint domain;
+			if (clGetDeviceInfo(device, pciDomainIdNv, sizeof(domain), &domain, nullptr)) {
+				domain = 0;
+			}
+			address = {domain, bus, slot >> 3, slot & 7};
+			return true;
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Returns the processors of a NUMA node.
+	 * @param numaNode the NUMA node.
+	 * @return the indices of the processors, empty if unknown.
+	 */
+	std::vector<int> readProcessorsOfNumaNode(const int numaNode) {
+		std::ifstream file("/sys/devices/system/node/node" + std::to_string(numaNode) + "/cpulist");
+		std::string list;
+		std::vector<int> processors;
+		if (!std::getline(file, list)) {
+			return processors;
+		}
+		// the list looks like "0-15,32-47"
+		std::istringstream stream(list);
+		std::string range;
+		while (std::getline(stream, range, ',')) {
+			int first;
+			int last;
+			const int numValues = std::sscanf(range.c_str(), "%d-%d", &first, &last);
+			if (numValues < 1) {
+				continue;
+			}
+			for (int processor = first; processor <= (numValues == 2 ? last : first); ++processor) {
+				processors.push_back(processor);
+			}
+		}
+		return processors;
+	}
+
+	/**
+	 * @brief Restricts the calling thread to the passed processors.
+	 * @param processors the indices of the processors, empty for no restriction.
+	 */
+	void pinToProcessors([[maybe_unused]] const std::vector<int> &processors) {
+#if defined(__linux__)
+		if (processors.empty()) {
+			return;
+		}
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (const int processor: processors) {
+			if (processor < CPU_SETSIZE) {
+				CPU_SET(processor, &set);
+			}
+		}
+		// a failure leaves the thread unpinned, which is slower but correct
+		sched_setaffinity(0, sizeof(set), &set);
+#endif
+	}
+
+	/**
+	 * @brief Allocates page aligned host memory whose pages are placed on the passed NUMA node when first touched.
+	 * @param sizeInBytes the size in bytes, a multiple of the page size.
+	 * @param numaNode the NUMA node, -1 for no placement.
+	 * @return the host memory.
+	 */
+	void *allocateOnNumaNode(const size_t sizeInBytes, [[maybe_unused]] const int numaNode) {
+		void *memory = mmap(nullptr, sizeInBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (memory == MAP_FAILED) {
+			// let it crash
+			throw std::runtime_error("Failed to allocate the staging memory: " + std::string(std::strerror(errno)));
+		}
+#if defined(__linux__)
+		if (numaNode >= 0) {
+			// MPOL_PREFERRED of <linux/mempolicy.h>, which falls back to other nodes rather than failing
+			constexpr int preferredPolicy = 1;
+			constexpr size_t bitsPerWord = 8 * sizeof(unsigned long);
+			const auto node = static_cast<size_t>(numaNode);
+			std::vector<unsigned long> nodeMask(node / bitsPerWord + 1, 0);
+			nodeMask[node / bitsPerWord] = 1ul << (node % bitsPerWord);
+			if (syscall(SYS_mbind, memory, sizeInBytes, preferredPolicy, nodeMask.data(),
+						nodeMask.size() * bitsPerWord + 1, 0)) {
+				std::cerr << "Failed to place the staging memory on NUMA node " << numaNode << ": "
+						  << std::strerror(errno) << std::endl;
+			}
+		}
+#endif
+		return memory;
+	}
+
+	/**
+	 * @brief Copies a part of the concatenation of the passed ranges.
+	 * @param ranges the ranges of host memory.
+	 * @param offsets the offset of each range in the concatenation, followed by its total size.
+	 * @param begin the offset of the first byte to copy.
+	 * @param end the offset after the last byte to copy.
+	 * @param destination the memory to copy to.
+	 */
+	void gather(
+			const std::vector<HostMemoryRange> &ranges,
+			const std::vector<size_t> &offsets,
+			size_t begin,
+			const size_t end,
+			char *destination
+	) {
+		auto range = static_cast<size_t>(std::upper_bound(offsets.begin(), offsets.end(), begin) - offsets.begin()) - 1;
+		while (begin < end) {
+			const size_t numBytes = std::min(end, offsets[range + 1]) - begin;
+			const char *source = static_cast<const char *>(ranges[range].memory) + (begin - offsets[range]);
+			std::memcpy(destination, source, numBytes);
+			destination += numBytes;
+			begin += numBytes;
+			++range;
+		}
+	}
+
+	/**
+	 * @brief Returns the part of a chunk which a worker thread copies.
+	 * @param sizeInBytes the size of the chunk in bytes.
+	 * @param numWorkers the number of worker threads.
+	 * @param index the index of the worker thread.
+	 * @return the offsets of the first byte and after the last byte of the part.
+	 */
+	std::pair<size_t, size_t> getPart(const size_t sizeInBytes, const size_t numWorkers, const size_t index) {
+		// parts of whole cache lines keep the worker threads from sharing lines
+		const size_t evenSize = std::max((sizeInBytes + numWorkers - 1) / numWorkers, minBytesPerWorker);
+		const size_t partSize = (evenSize + 63) / 64 * 64;
+		const size_t begin = std::min(index * partSize, sizeInBytes);
+		return {begin, std::min(begin + partSize, sizeInBytes)};
+	}
+}
+
+[[maybe_unused]] StagingService::StagingService(
+		const Context &context,
+		CommandQueue &commandQueue,
+		cl_device_id device,
+		const size_t numThreads,
+		const int numaNode,
+		const size_t chunkSizeInBytes
+) : commandQueue_(commandQueue),
+	numaNode_(numaNode == automaticNumaNode ? findNumaNode(device) : numaNode),
+	chunkSizeInBytes_(chunkSizeInBytes),
+	hostMemory_(nullptr),
+	hostMemorySizeInBytes_(0),
+	task_(nullptr),
+	taskGeneration_(0),
+	numBusyWorkers_(0),
+	isStopping_(false) {
+	if (!chunkSizeInBytes) {
+		// let it crash
+		throw std::runtime_error("Failed to create staging service: the chunk size is 0");
+	}
+	const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	const size_t alignedChunkSize = (chunkSizeInBytes + pageSize - 1) / pageSize * pageSize;
+	hostMemorySizeInBytes_ = DoubleBufferedStaging::numStagingBuffers * alignedChunkSize;
+	hostMemory_ = allocateOnNumaNode(hostMemorySizeInBytes_, numaNode_);
+
+	const std::vector<int> processors = numaNode_ >= 0 ? readProcessorsOfNumaNode(numaNode_) : std::vector<int>();
+	const size_t count = std::max<size_t>(numThreads, 1);
+	workers_.reserve(count);
+	try {
+		for (size_t i = 0; i < count; ++i) {
+			workers_.emplace_back([this, processors, i] {
+				pinToProcessors(processors);
+				work(i);
+			});
+		}
+		// the pinned threads touch the pages first, which places them even without a memory policy
+		runOnWorkers([this](const size_t index) {
+			const auto [begin, end] = getPart(hostMemorySizeInBytes_, workers_.size(), index);
+			std::memset(static_cast<char *>(hostMemory_) + begin, 0, end - begin);
+		});
+		staging_ = std::make_unique<DoubleBufferedStaging>(
+				context,
+				commandQueue_,
+				chunkSizeInBytes,
+				hostMemory_,
+				alignedChunkSize
+		);
+	} catch (...) {
+		stopWorkers();
+		munmap(hostMemory_, hostMemorySizeInBytes_);
+		throw;
+	}
+}
+
+StagingService::~StagingService() {
+	// the buffers must be released before the memory they pin
+	staging_.reset();
+	stopWorkers();
+	munmap(hostMemory_, hostMemorySizeInBytes_);
+}
+
+[[maybe_unused]] void StagingService::copyFromHostMemoryIntoDeviceMemory(
+		const void *sourceHostMemory,
+		const BaseBuffer &destinationDeviceMemory,
+		const size_t numBytesToCopy,
+		const size_t destinationOffsetInBytes
+) {
+	gatherFromHostMemoryIntoDeviceMemory(
+			{{sourceHostMemory, numBytesToCopy}},
+			destinationDeviceMemory,
+			destinationOffsetInBytes
+	);
+}
+
+[[maybe_unused]] void StagingService::gatherFromHostMemoryIntoDeviceMemory(
+		const std::vector<HostMemoryRange> &sourceRanges,
+		const BaseBuffer &destinationDeviceMemory,
+		const size_t destinationOffsetInBytes
+) {
+	std::vector<size_t> offsets(1, 0);
+	offsets.reserve(sourceRanges.size() + 1);
+	for (const HostMemoryRange &range: sourceRanges) {
+		offsets.push_back(offsets.back() + range.sizeInBytes);
+	}
+	// the device copies from one staging buffer while the worker threads fill the other
+	staging_->upload(
+			offsets.back(),
+			chunkSizeInBytes_,
+			[&](const size_t first, const size_t size, char *stagingMemory, std::vector<Event> &copies) {
+				runOnWorkers([&](const size_t worker) {
+					const auto [begin, end] = getPart(size, workers_.size(), worker);
+					gather(sourceRanges, offsets, first + begin, first + end, stagingMemory + begin);
+				});
+				copies.push_back(commandQueue_.enqueueCommandCopyBytesFromHostMemoryIntoDeviceMemoryAsync(
+						stagingMemory,
+						destinationDeviceMemory,
+						size,
+						destinationOffsetInBytes + first
+				));
+			}
+	);
+}
+
+[[maybe_unused]] void StagingService::copyFromDeviceMemoryIntoHostMemory(
+		const BaseBuffer &sourceDeviceMemory,
+		void *destinationHostMemory,
+		const size_t numBytesToCopy,
+		const size_t sourceOffsetInBytes
+) {
+	staging_->download(
+			sourceDeviceMemory,
+			numBytesToCopy,
+			sourceOffsetInBytes,
+			chunkSizeInBytes_,
+			[&](const size_t first, const size_t size, const char *stagingMemory) {
+				runOnWorkers([&](const size_t worker) {
+					const auto [begin, end] = getPart(size, workers_.size(), worker);
+					std::memcpy(
+							static_cast<char *>(destinationHostMemory) + first + begin,
+							stagingMemory + begin,
+							end - begin
+					);
+				});
+			}
+	);
+}
+
+[[maybe_unused]] int StagingService::getNumaNode() const {
+	return numaNode_;
+}
+
+[[maybe_unused]] int StagingService::findNumaNode(cl_device_id device) {
+	PciAddress address{};
+	if (!queryPciAddress(device, address)) {
+		return -1;
+	}
+	char path[64];
+	std::snprintf(
+			path,
+			sizeof(path),
+			"/sys/bus/pci/devices/%04x:%02x:%02x.%x/numa_node",
+			address.domain,
+			address.bus,
+			address.device,
+			address.function
+	);
+	std::ifstream file(path);
+	int numaNode = -1;
+	if (!(file >> numaNode)) {
+		return -1;
+	}
+	return numaNode;
+}
+
+void StagingService::runOnWorkers(const std::function<void(size_t)> &task) {
+	std::unique_lock<std::mutex> lock(mutex_);
+	task_ = &task;
+	failure_ = nullptr;
+	numBusyWorkers_ = workers_.size();
+	++taskGeneration_;
+	taskAvailable_.notify_all();
+	taskCompleted_.wait(lock, [this] { return !numBusyWorkers_; });
+	task_ = nullptr;
+	if (failure_) {
+		std::rethrow_exception(failure_);
+	}
+}
+
+void StagingService::work(const size_t index) {
+	size_t lastGeneration = 0;
+	while (true) {
+		const std::function<void(size_t)> *task;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			taskAvailable_.wait(lock, [this, lastGeneration] {
+				return isStopping_ || taskGeneration_ != lastGeneration;
+			});
+			if (isStopping_) {
+				return;
+			}
+			lastGeneration = taskGeneration_;
+			task = task_;
+		}
+		std::exception_ptr failure;
+		try {
+			(*task)(index);
+		} catch (...) {
+			failure = std::current_exception();
+		}
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (failure && !failure_) {
+			failure_ = failure;
+		}
+		if (!--numBusyWorkers_) {
+			taskCompleted_.notify_one();
+		}
+	}
+}
+
+void StagingService::stopWorkers() noexcept {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		isStopping_ = true;
+	}
+	taskAvailable_.notify_all();
+	for (auto &worker: workers_) {
+		worker.join();
+	}
+	workers_.clear();
+}
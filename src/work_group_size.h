@@ -0,0 +1,39 @@
+#ifndef OPENCL_TOOLKIT_WORK_GROUP_SIZE_H
+#define OPENCL_TOOLKIT_WORK_GROUP_SIZE_H
+
+#include <algorithm>
+
+#include "opencl/program.h"
+
+/**
+ * @brief Namespace of this toolkit.
+ */
+namespace OpenClToolkit {
+
+	/**
+	 * The largest work group size chosen for the built-in kernels. Larger work groups rarely pay off for memory-bound
+	 * kernels but increase the cost of the work group barriers.
+	 */
+	inline constexpr size_t maxBuiltInWorkGroupSize = 256;
+
+	/**
+	 * @brief Returns the largest power of two which is accepted by the kernel of the passed program, does not exceed
+	 * <code>maxBuiltInWorkGroupSize</code> and whose local memory demand fits into the local memory of the device.
+	 * @param program the program whose kernel is launched.
+	 * @param localMemoryBytesPerWorkItem the local memory demand per work item in bytes, 0 if none.
+	 * @return the chosen work group size.
+	 */
+	inline size_t chooseWorkGroupSize(const Program &program, const size_t localMemoryBytesPerWorkItem) {
+		size_t limit = std::min(program.getMaxWorkGroupSizeInBytes(), maxBuiltInWorkGroupSize);
+		if (localMemoryBytesPerWorkItem) {
+			limit = std::min(limit, program.getDeviceLocalMemorySizeInBytes() / localMemoryBytesPerWorkItem);
+		}
+		size_t size = 1;
+		while (size * 2 <= limit) {
+			size *= 2;
+		}
+		return size;
+	}
+}
+
+#endif //OPENCL_TOOLKIT_WORK_GROUP_SIZE_H
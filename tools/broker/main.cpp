@@ -0,0 +1,52 @@
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "opencl/broker_server.h"
+#include "opencl/device_manager.h"
+
+using namespace OpenClToolkit;
+
+namespace {
+	/**
+	 * The broker stopped by the signal handler.
+	 */
+	BrokerServer *runningBroker = nullptr;
+
+	/**
+	 * @brief Stops the broker on SIGINT and SIGTERM.
+	 */
+	void onSignal(int) {
+		if (runningBroker) {
+			runningBroker->stop();
+		}
+	}
+}
+
+/**
+ * @brief Runs the broker on the GPUs of the current system, or on the default device if there are none, until SIGINT
+ * or SIGTERM. The devices are offered in this order, so clients address them by index.
+ * Usage: opencl-toolkit-broker [socket path]
+ */
+int main(int argc, char *argv[]) {
+	const std::string socketPath = argc > 1 ? argv[1] : "/tmp/opencl-toolkit-broker.sock";
+	const DeviceManager &deviceManager = DeviceManager::getInstance();
+	std::vector<cl_device_id> devices = deviceManager.getOpenClCompatibleGpus();
+	if (devices.empty() && deviceManager.isDefaultDeviceAvailable()) {
+		devices.push_back(deviceManager.getDefaultOpenClDevice());
+	}
+	if (devices.empty()) {
+		std::cerr << "No OpenCL device available." << std::endl;
+		return 1;
+	}
+
+	BrokerServer broker(socketPath, devices);
+	runningBroker = &broker;
+	std::signal(SIGINT, onSignal);
+	std::signal(SIGTERM, onSignal);
+	std::cout << "Serving " << devices.size() << " device(s) on " << socketPath << std::endl;
+	broker.run();
+	runningBroker = nullptr;
+	return 0;
+}
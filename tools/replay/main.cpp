@@ -0,0 +1,50 @@
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "opencl/command_queue.h"
+#include "opencl/command_replayer.h"
+#include "opencl/context.h"
+#include "opencl/device_manager.h"
+
+using namespace OpenClToolkit;
+
+/**
+ * @brief Replays a trace recorded with OPENCL_TOOLKIT_TRACE on the default device and prints the time per kernel.
+ * With --no-sync the launches are not awaited one by one, so only the total time is measured.
+ * Usage: opencl-toolkit-replay <trace> [--no-sync]
+ */
+int main(int argc, char *argv[]) {
+	if (argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " <trace> [--no-sync]" << std::endl;
+		return 2;
+	}
+	const bool isAwaitingEachLaunch = argc < 3 || std::strcmp(argv[2], "--no-sync") != 0;
+	const DeviceManager &deviceManager = DeviceManager::getInstance();
+	if (!deviceManager.isDefaultDeviceAvailable()) {
+		std::cerr << "No OpenCL device available." << std::endl;
+		return 1;
+	}
+
+	cl_device_id device = deviceManager.getDefaultOpenClDevice();
+	Context context(device);
+	CommandQueue commandQueue(context, device);
+	CommandReplayer replayer(context, device, commandQueue);
+	const ReplayStatistics statistics = replayer.replay(argv[1], isAwaitingEachLaunch);
+
+	std::cout << statistics.numRecords << " records, " << statistics.numLaunches << " launches, "
+			  << statistics.numTransfers << " transfers (" << statistics.numTransferredBytes << " bytes), "
+			  << statistics.numSkippedRecords << " skipped, " << statistics.seconds << " s" << std::endl;
+	if (isAwaitingEachLaunch) {
+		std::cout << std::left << std::setw(40) << "kernel" << std::right << std::setw(12) << "launches"
+				  << std::setw(16) << "total [ms]" << std::setw(16) << "mean [us]" << std::endl;
+		for (const ReplayKernelTiming &kernel: statistics.kernels) {
+			const double meanMicroseconds = kernel.numLaunches ? kernel.seconds * 1e6 / kernel.numLaunches : 0;
+			std::cout << std::left << std::setw(40) << kernel.kernelName << std::right << std::setw(12)
+					  << kernel.numLaunches << std::setw(16) << kernel.seconds * 1e3 << std::setw(16)
+					  << meanMicroseconds << std::endl;
+		}
+	}
+	return 0;
+}